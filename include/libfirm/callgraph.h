@@ -151,6 +151,22 @@ FIRM_API void set_irp_loop_nesting_depth_state(loop_nesting_depth_state s);
 /** Marks the nesting depth state of the program representation as inconsistent. */
 FIRM_API void set_irp_loop_nesting_depth_state_inconsistent(void);
 
+/** A function type returning the execution count of a block. */
+typedef double callgraph_count_func(const ir_node *block);
+
+/**
+ * Reorders the graphs of the program for code locality.
+ *
+ * Builds a call graph whose edges are weighted with the execution counts of
+ * the blocks containing the calls and merges each function into the cluster
+ * of its hottest caller (call-chain clustering).  The clusters are then laid
+ * out by decreasing density, so never executed functions end up last.  The
+ * new order is deterministic and can be observed with get_irp_irg().
+ *
+ * @param get_count  returns the (profiled) execution count of a block
+ */
+FIRM_API void order_irp_irgs_by_call_chains(callgraph_count_func *get_count);
+
 /** @} */
 
 #include "end.h"
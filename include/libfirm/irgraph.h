@@ -12,6 +12,7 @@
 #define FIRM_IR_IRGRAPH_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include "firm_types.h"
 
 #include "begin.h"
@@ -132,6 +133,27 @@ FIRM_API ir_graph *new_ir_graph(ir_entity *ent, int n_loc);
  */
 FIRM_API void free_ir_graph(ir_graph *irg);
 
+/**
+ * Frees several irgraphs at once.
+ *
+ * Like free_ir_graph() but removes all graphs from the list in irprog in one
+ * pass, keeping the order of the remaining graphs.
+ */
+FIRM_API void free_ir_graphs(size_t n, ir_graph *const *irgs);
+
+/**
+ * Computes a structural hash of an irgraph.
+ *
+ * The hash only depends on the graph structure, node attributes, the linker
+ * names of referenced entities and the layout of referenced types. It is
+ * independent of node numbers and addresses, so identical functions hash
+ * identically in different compiler runs.
+ *
+ * @returns the hash, or 0 if the graph references something that cannot be
+ *          identified across compiler runs (like block labels)
+ */
+FIRM_API uint64_t get_irg_structural_hash(ir_graph *irg);
+
 /** Returns the entity of an IR graph. */
 FIRM_API ir_entity *get_irg_entity(const ir_graph *irg);
 /** Sets the entity of an IR graph. */
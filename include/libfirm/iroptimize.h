@@ -47,6 +47,17 @@ FIRM_API void opt_jumpthreading(ir_graph* irg);
  */
 FIRM_API void opt_bool(ir_graph *irg);
 
+/**
+ * Eliminates redundant compares, like bounds checks, whose outcome follows
+ * from dominating conditions, Confirm nodes and induction variables.
+ * eg. the check i < n in the body of for (i = 0; i < n; ++i) is removed.
+ * Like the other optimizations, the pass is not scheduled by libFirm itself;
+ * frontends run it after Confirm construction and before loop optimizations.
+ *
+ * @param irg  the graph
+ */
+FIRM_API void opt_bounds_checks(ir_graph *irg);
+
 /**
  * Reduces the number of Conv nodes in the given ir graph.
  *
@@ -180,13 +191,21 @@ FIRM_API void optimize_load_store(ir_graph *irg);
 
 /**
  * Combine adjacent "small" load/store operations into bigger ones.
+ *
+ * Isomorphic values stored to adjacent addresses are packed into a single
+ * value of twice the width (superword-level parallelism within a general
+ * purpose register): Loads from adjacent addresses are merged into one wide
+ * Load and bitwise operations on such values and constants are performed
+ * once on the packed value.
  */
 FIRM_API void combine_memops(ir_graph *irg);
 
 /**
  * New experimental alternative to optimize_load_store.
  * Based on a dataflow analysis, so load/stores are moved out of loops
- * where possible
+ * where possible. Partially redundant Loads are made fully redundant by
+ * inserting Loads on the paths where the value is not available, if the
+ * estimated execution frequency of these paths is lower.
  */
 FIRM_API void opt_ldst(ir_graph *irg);
 
@@ -438,12 +457,30 @@ FIRM_API void do_loop_unrolling(ir_graph *irg);
 /**
  * Perform loop unrolling on a given graph.
  *
+ * The unroll factor always divides the trip count.  If the counter reaches
+ * the limit exactly, the exit tests of the copied loop headers are folded and
+ * the unrolled body becomes straight-line code that can be widened by
+ * combine_memops().
+ *
  * @param irg       the IR-graph to optimize
  * @param factor    the unroll factor
  * @param maxsize   the maximum number of nodes in a loop
  */
 FIRM_API void unroll_loops(ir_graph *irg, unsigned factor, unsigned maxsize);
 
+/**
+ * Interchanges and tiles perfectly nested counted loops.
+ *
+ * Nests of two loops, whose memory accesses stride through memory along the
+ * inner loop, are interchanged if no dependence forbids it. If strided
+ * accesses remain, the inner loop is split into tiles of @p tile_size
+ * iterations and the loop over the tiles is moved outside of the nest.
+ *
+ * @param irg        the IR-graph to optimize
+ * @param tile_size  the number of inner iterations per tile, 0 disables tiling
+ */
+FIRM_API void optimize_loop_nests(ir_graph *irg, unsigned tile_size);
+
 /**
  * Perform loop peeling on a given graph.
  */
@@ -463,7 +500,11 @@ FIRM_API void garbage_collect_entities(void);
  * Performs dead node elimination by copying the ir graph to a new obstack.
  *
  *  The major intention of this pass is to free memory occupied by
- *  dead nodes and outdated analyzes information.  Further this
+ *  dead nodes and outdated analyzes information.  If only a small part of
+ *  the graph's memory is occupied by dead nodes, the graph is not copied,
+ *  which would temporarily double its memory, but compacted in place: Node
+ *  indices are renumbered densely and the dead nodes are freed by a later
+ *  run.  Further this
  *  function removes Bad predecessors from Blocks and the corresponding
  *  inputs to Phi nodes.  This opens optimization potential for other
  *  optimizations.  Further this phase reduces dead Block<->Jmp
@@ -277,6 +277,14 @@ FIRM_API ir_entity *clone_entity(ir_entity const *old, ident *name,
  */
 FIRM_API void free_entity(ir_entity *ent);
 
+/**
+ * Frees several entities at once.
+ *
+ * Removes them from their owners in one pass per owner, so entities with
+ * the same owner should be adjacent in @p entities.
+ */
+FIRM_API void free_entities(size_t n, ir_entity *const *entities);
+
 /** Returns the name of an entity. */
 FIRM_API const char *get_entity_name(const ir_entity *ent);
 
@@ -871,6 +879,13 @@ FIRM_API int tr_verify(void);
  */
 FIRM_API void free_type(ir_type *tp);
 
+/**
+ * Frees several types at once.
+ *
+ * Like free_type() but removes all types from the type list in one pass.
+ */
+FIRM_API void free_types(size_t n, ir_type *const *types);
+
 /** Returns opcode of type @p type */
 FIRM_API tp_opcode get_type_opcode(const ir_type *type);
 
@@ -1453,6 +1468,13 @@ FIRM_API size_t get_compound_member_index(ir_type const *tp,
 /** Remove a member from a compound type. */
 FIRM_API void remove_compound_member(ir_type *compound, ir_entity *entity);
 
+/**
+ * Removes several members from a compound type in one pass, keeping the
+ * order of the remaining members.
+ */
+FIRM_API void remove_compound_members(ir_type *compound, size_t n,
+                                      ir_entity *const *members);
+
 /**
  * Layout members of a compound type in the default way (as determined
  * by the target ABI). The compound type may not contain bitfield
@@ -842,3 +842,194 @@ void set_irp_loop_nesting_depth_state_inconsistent(void)
 	if (irp->lnd_state == loop_nesting_depth_consistent)
 		irp->lnd_state = loop_nesting_depth_inconsistent;
 }
+
+/** Maximal size of a call-chain cluster (in nodes). */
+#define MAX_CLUSTER_SIZE  (1 << 16)
+/** A merge may not degrade the density of the caller cluster more than this. */
+#define MAX_DENSITY_LOSS  8.0
+
+typedef struct cc_cluster_t cc_cluster_t;
+
+typedef struct cc_func_t {
+	ir_graph     *irg;
+	size_t        idx;           /**< position in the original irp order */
+	double        count;         /**< execution count of the function */
+	double        caller_weight; /**< weight of the hottest call edge */
+	ir_graph     *caller;        /**< caller on the hottest call edge */
+	double        weight;        /**< weight of calls from the current caller */
+	cc_cluster_t *cluster;
+} cc_func_t;
+
+struct cc_cluster_t {
+	cc_func_t **funcs;
+	double      count;
+	double      size;
+	size_t      idx;
+};
+
+typedef struct cc_env_t {
+	callgraph_count_func *get_count;
+	cc_func_t           **touched;
+} cc_env_t;
+
+static double get_cluster_density(cc_cluster_t const *const cluster)
+{
+	return cluster->count / cluster->size;
+}
+
+/**
+ * Accumulates the weight of all calls of the walked graph in the callee.
+ */
+static void cc_collect_call(ir_node *const node, void *const data)
+{
+	if (!is_Call(node))
+		return;
+
+	cc_env_t *const env = (cc_env_t*)data;
+	ir_graph *const irg = get_irn_irg(node);
+	double    const w   = env->get_count(get_nodes_block(node));
+	if (w <= 0)
+		return;
+
+	bool   const has_info  = get_irg_callee_info_state(irg) == irg_callee_info_consistent;
+	size_t const n_callees = has_info ? cg_get_call_n_callees(node) : 1;
+	for (size_t i = 0; i < n_callees; ++i) {
+		ir_entity *const callee_e = has_info ? cg_get_call_callee(node, i)
+		                                     : get_Call_callee(node);
+		if (callee_e == NULL)
+			continue;
+		ir_graph *const callee = get_entity_linktime_irg(callee_e);
+		if (callee == NULL || callee == irg)
+			continue;
+		cc_func_t *const func = (cc_func_t*)get_irg_link(callee);
+		if (func == NULL)
+			continue;
+		if (func->weight == 0)
+			ARR_APP1(cc_func_t*, env->touched, func);
+		func->weight += w / n_callees;
+	}
+}
+
+static int cmp_func_count(void const *const a, void const *const b)
+{
+	cc_func_t const *const fa = *(cc_func_t const**)a;
+	cc_func_t const *const fb = *(cc_func_t const**)b;
+	if (fa->count != fb->count)
+		return fa->count < fb->count ? 1 : -1;
+	return fa->idx < fb->idx ? -1 : fa->idx > fb->idx;
+}
+
+static int cmp_cluster_density(void const *const a, void const *const b)
+{
+	cc_cluster_t const *const ca = *(cc_cluster_t const**)a;
+	cc_cluster_t const *const cb = *(cc_cluster_t const**)b;
+	double const da = get_cluster_density(ca);
+	double const db = get_cluster_density(cb);
+	if (da != db)
+		return da < db ? 1 : -1;
+	return ca->idx < cb->idx ? -1 : ca->idx > cb->idx;
+}
+
+void order_irp_irgs_by_call_chains(callgraph_count_func *const get_count)
+{
+	size_t const n_irgs = get_irp_n_irgs();
+	if (n_irgs < 2)
+		return;
+
+	irp_reserve_resources(irp, IRP_RESOURCE_IRG_LINK);
+
+	cc_func_t    *const funcs    = XMALLOCNZ(cc_func_t, n_irgs);
+	cc_cluster_t *const clusters = XMALLOCNZ(cc_cluster_t, n_irgs);
+	foreach_irp_irg(i, irg) {
+		cc_func_t    *const func    = &funcs[i];
+		cc_cluster_t *const cluster = &clusters[i];
+		func->irg      = irg;
+		func->idx      = i;
+		func->count    = get_count(get_irg_start_block(irg));
+		func->cluster  = cluster;
+		cluster->funcs = NEW_ARR_F(cc_func_t*, 1);
+		cluster->funcs[0] = func;
+		cluster->count = func->count;
+		cluster->size  = get_irg_last_idx(irg);
+		cluster->idx   = i;
+		set_irg_link(irg, func);
+	}
+
+	/* Build the weighted call graph: only the hottest caller of each
+	 * function is needed for the clustering. */
+	cc_env_t env = {
+		.get_count = get_count,
+		.touched   = NEW_ARR_F(cc_func_t*, 0),
+	};
+	foreach_irp_irg(i, irg) {
+		irg_walk_graph(irg, cc_collect_call, NULL, &env);
+		for (size_t j = 0, n = ARR_LEN(env.touched); j < n; ++j) {
+			cc_func_t *const callee = env.touched[j];
+			if (callee->weight > callee->caller_weight) {
+				callee->caller_weight = callee->weight;
+				callee->caller        = irg;
+			}
+			callee->weight = 0;
+		}
+		ARR_SHRINKLEN(env.touched, 0);
+	}
+	DEL_ARR_F(env.touched);
+
+	/* Visit functions in order of decreasing hotness and append each one to
+	 * the cluster of its hottest caller (C3 heuristic). */
+	cc_func_t **const sorted = XMALLOCN(cc_func_t*, n_irgs);
+	for (size_t i = 0; i < n_irgs; ++i)
+		sorted[i] = &funcs[i];
+	qsort(sorted, n_irgs, sizeof(*sorted), cmp_func_count);
+
+	for (size_t i = 0; i < n_irgs; ++i) {
+		cc_func_t *const func = sorted[i];
+		if (func->count <= 0 || func->caller == NULL)
+			continue;
+		cc_cluster_t *const from = func->cluster;
+		cc_cluster_t *const to   = ((cc_func_t*)get_irg_link(func->caller))->cluster;
+		if (from == to)
+			continue;
+		if (from->size + to->size > MAX_CLUSTER_SIZE)
+			continue;
+		double const merged_density
+			= (from->count + to->count) / (from->size + to->size);
+		if (merged_density * MAX_DENSITY_LOSS < get_cluster_density(to))
+			continue;
+
+		for (size_t j = 0, n = ARR_LEN(from->funcs); j < n; ++j) {
+			cc_func_t *const moved = from->funcs[j];
+			moved->cluster = to;
+			ARR_APP1(cc_func_t*, to->funcs, moved);
+		}
+		to->count += from->count;
+		to->size  += from->size;
+		ARR_SHRINKLEN(from->funcs, 0);
+	}
+	free(sorted);
+
+	/* Lay out the clusters by decreasing density. */
+	cc_cluster_t **const order   = XMALLOCN(cc_cluster_t*, n_irgs);
+	size_t               n_order = 0;
+	for (size_t i = 0; i < n_irgs; ++i) {
+		if (ARR_LEN(clusters[i].funcs) > 0)
+			order[n_order++] = &clusters[i];
+	}
+	qsort(order, n_order, sizeof(*order), cmp_cluster_density);
+
+	size_t pos = 0;
+	for (size_t i = 0; i < n_order; ++i) {
+		cc_func_t **const members = order[i]->funcs;
+		for (size_t j = 0, n = ARR_LEN(members); j < n; ++j)
+			set_irp_irg(pos++, members[j]->irg);
+	}
+	assert(pos == n_irgs);
+
+	free(order);
+	for (size_t i = 0; i < n_irgs; ++i)
+		DEL_ARR_F(clusters[i].funcs);
+	free(clusters);
+	free(funcs);
+
+	irp_free_resources(irp, IRP_RESOURCE_IRG_LINK);
+}
@@ -16,6 +16,7 @@
 #include "irnode_t.h"
 #include "irnodemap.h"
 #include "iropt.h"
+#include "tv_t.h"
 #include <assert.h>
 
 #ifndef VERIFY_CONSTBITS
@@ -114,32 +115,80 @@ static bool is_undefined(bitinfo const *const b)
 	return tarval_is_null(b->z) && tarval_is_all_one(b->o);
 }
 
-/** Set analysis information for node @p irn. */
-static bool set_bitinfo(ir_node const *const irn, ir_tarval *const z, ir_tarval *const o)
+static bool mode_is_intb(ir_mode const *const m)
 {
-	ir_graph   *const irg  = get_irn_irg(irn);
-	ir_nodemap *const map  = &irg->bitinfo.map;
-	bitinfo          *b    = ir_nodemap_get(bitinfo, map, irn);
+	return mode_is_int(m) || m == mode_b;
+}
+
+static void store_bitinfo(bitinfo *const b, ir_tarval *const z, ir_tarval *const o)
+{
+	b->z = z;
+	b->o = o;
+	if (get_mode_word_bits(get_tarval_mode(z)) != 0) {
+		b->z_word = get_tarval_word(z);
+		b->o_word = get_tarval_word(o);
+	}
+}
+
+static bitinfo *get_or_new_bitinfo(ir_node const *const irn, bool *const is_new)
+{
+	ir_graph   *const irg = get_irn_irg(irn);
+	ir_nodemap *const map = &irg->bitinfo.map;
+	bitinfo          *b   = ir_nodemap_get(bitinfo, map, irn);
+	*is_new = b == NULL;
 	if (b == NULL) {
 		struct obstack *const obst = &irg->bitinfo.obst;
 		b = OALLOCZ(obst, bitinfo);
 		ir_nodemap_insert(map, irn, b);
-	} else if (z == b->z && o == b->o) {
-		return false;
-	} else {
+	}
+	return b;
+}
+
+static void dump_bitinfo(ir_node const *const irn, bitinfo const *const b)
+{
+	(void)irn;
+	(void)b;
+	DB((dbg, LEVEL_3, "Set %+F: 0:%T 1:%T%s\n", irn, b->z, b->o, is_undefined(b) ? " (bottom)" : tarval_is_all_one(b->z) && tarval_is_null(b->o) ? " (top)" : ""));
+}
+
+/** Set analysis information for node @p irn. */
+static bool set_bitinfo(ir_node const *const irn, ir_tarval *const z, ir_tarval *const o)
+{
+	bool     is_new;
+	bitinfo *b = get_or_new_bitinfo(irn, &is_new);
+	if (!is_new) {
+		if (z == b->z && o == b->o)
+			return false;
 		/* Assert ascending chain. */
 		assert(tarval_is_null(tarval_andnot(b->z, z)));
 		assert(tarval_is_null(tarval_andnot(o, b->o)));
 	}
-	b->z = z;
-	b->o = o;
-	DB((dbg, LEVEL_3, "Set %+F: 0:%T 1:%T%s\n", irn, z, o, is_undefined(b) ? " (bottom)" : tarval_is_all_one(z) && tarval_is_null(o) ? " (top)" : ""));
+	store_bitinfo(b, z, o);
+	dump_bitinfo(irn, b);
 	return true;
 }
 
-static bool mode_is_intb(ir_mode const *const m)
+/**
+ * Set analysis information given as native words for node @p irn.  Tarvals
+ * are only created, if the information changed.
+ */
+static bool set_bitinfo_word(ir_node const *const irn, ir_mode *const mode, uint64_t const z, uint64_t const o)
 {
-	return mode_is_int(m) || m == mode_b;
+	bool     is_new;
+	bitinfo *b = get_or_new_bitinfo(irn, &is_new);
+	if (!is_new) {
+		if (z == b->z_word && o == b->o_word)
+			return false;
+		/* Assert ascending chain. */
+		assert((b->z_word & ~z) == 0);
+		assert((o & ~b->o_word) == 0);
+	}
+	b->z      = new_tarval_from_word(z, mode);
+	b->o      = new_tarval_from_word(o, mode);
+	b->z_word = z;
+	b->o_word = o;
+	dump_bitinfo(irn, b);
+	return true;
 }
 
 bitinfo const *try_get_bitinfo(ir_node const *const irn)
@@ -193,10 +242,8 @@ static bitinfo *get_bitinfo_recursive(ir_node const *const irn)
 		struct obstack *const obst = &irg->bitinfo.obst;
 		if (!b)
 			b = OALLOCZ(obst, bitinfo);
-		if (b->state == BITINFO_INVALID) {
-			b->z = get_mode_null(mode);
-			b->o = get_mode_all_one(mode);
-		}
+		if (b->state == BITINFO_INVALID)
+			store_bitinfo(b, get_mode_null(mode), get_mode_all_one(mode));
 		ir_nodemap_insert(map, irn, b);
 
 		calc_bitinfo(irn, b);
@@ -211,7 +258,11 @@ bitinfo *get_bitinfo(ir_node const *const irn)
 	return get_bitinfo_func(irn);
 }
 
-static bool transfer(ir_node const *const irn)
+/**
+ * Computes the bit information of @p irn from the information of its operands
+ * using tarvals.  Returns false, if @p irn is not analysed.
+ */
+static bool transfer_tarval(ir_node const *const irn, ir_tarval **const res_z, ir_tarval **const res_o)
 {
 	ir_tarval *const f = tarval_b_false;
 	ir_tarval *const t = tarval_b_true;
@@ -471,8 +522,15 @@ undefined:
 						ir_tarval  *const all_one       = get_mode_all_one(m);
 						ir_tarval  *const oversize_mask = tarval_andnot(modulo_mask, size_mask);
 
-						z = zero;
-						o = tarval_is_null(tarval_and(rz, oversize_mask)) ? all_one : zero;
+						if (tarval_is_null(tarval_and(rz, oversize_mask))) {
+							z = zero;
+							o = all_one;
+						} else {
+							/* Shifting by at least the mode size fills with the sign. */
+							ir_tarval *const size = new_tarval_from_long(size_bits, rmode);
+							z = tarval_shrs(lz, size);
+							o = tarval_shrs(lo, size);
+						}
 
 						if (tarval_is_null(tarval_and(ro, oversize_mask))) {
 							ir_tarval *const rmask  = tarval_and(size_mask, modulo_mask);
@@ -754,8 +812,468 @@ result_unknown:
 		return false;
 	}
 
-set_info:;
-	bool changed = set_bitinfo(irn, z, o);
+set_info:
+	*res_z = z;
+	*res_o = o;
+	return true;
+}
+
+typedef uint64_t (word_shift_func)(ir_mode const *mode, uint64_t w, uint64_t amount);
+
+static void transfer_word_shift(ir_mode *const m, ir_node const *const left, ir_node const *const right, word_shift_func *const shift, uint64_t *const res_z, uint64_t *const res_o)
+{
+	bitinfo  *const l    = get_bitinfo_recursive(left);
+	bitinfo  *const r    = get_bitinfo_recursive(right);
+	uint64_t  const lz   = l->z_word;
+	uint64_t  const lo   = l->o_word;
+	uint64_t  const rz   = r->z_word;
+	uint64_t  const ro   = r->o_word;
+	unsigned  const bits = get_mode_size_bits(m);
+	uint64_t  const mask = word_mask(bits);
+	if (rz == ro) {
+		*res_z = shift(m, lz, rz);
+		*res_o = shift(m, lo, rz);
+		return;
+	}
+
+	ir_mode  *const rmode         = get_irn_mode(right);
+	uint64_t  const rmode_mask    = word_mask(get_mode_word_bits(rmode));
+	uint64_t  const size_mask     = ((uint64_t)bits - 1) & rmode_mask;
+	uint64_t  const modulo_mask   = ((uint64_t)get_mode_modulo_shift(m) - 1) & rmode_mask;
+	uint64_t  const oversize_mask = modulo_mask & ~size_mask;
+
+	/* Shifting by at least the mode size gives 0 or, for Shrs, fills with
+	 * the sign. */
+	uint64_t z = 0;
+	uint64_t o = mask;
+	if ((rz & oversize_mask) != 0) {
+		z = shift(m, lz, bits);
+		o = shift(m, lo, bits);
+	}
+
+	if ((ro & oversize_mask) == 0) {
+		uint64_t const rmask  = size_mask & modulo_mask;
+		uint64_t const rsure  = ~(ro ^ rz) & rmask;
+		uint64_t const rbound = (rmask + 1) & rmode_mask;
+		for (uint64_t shift_amount = 0; shift_amount != rbound; shift_amount = (shift_amount + 1) & rmode_mask) {
+			if ((rsure & (shift_amount ^ rz)) == 0) {
+				z |= shift(m, lz, shift_amount);
+				o &= shift(m, lo, shift_amount);
+			}
+		}
+	}
+
+	/* Ensure that we do not create undefined bit information. */
+	assert(z != 0 || o != mask);
+	*res_z = z;
+	*res_o = o;
+}
+
+/**
+ * Checks whether the bit information of @p irn can be computed on native
+ * words.  This must not depend on the analysis state of the operands.
+ */
+static bool is_word_transfer_possible(ir_node const *const irn, ir_mode const *const m)
+{
+	if (get_mode_word_bits(m) == 0 || !tarval_get_wrap_on_overflow())
+		return false;
+
+	foreach_irn_in(irn, i, pred) {
+		ir_mode *const pred_mode = get_irn_mode(pred);
+		if (mode_is_int(pred_mode) && get_mode_word_bits(pred_mode) == 0)
+			return false;
+	}
+
+	switch (get_irn_opcode(irn)) {
+	case iro_Shl:
+	case iro_Shr:
+	case iro_Shrs: {
+		ir_mode *const rmode = get_irn_mode(get_binop_right(irn));
+		return mode_is_int(rmode) && !mode_is_signed(rmode);
+	}
+
+	case iro_Cmp: {
+		/* Bounds are not defined for mode_b. */
+		ir_relation const relation = get_Cmp_relation(irn);
+		return get_irn_mode(get_Cmp_left(irn)) != mode_b
+		    || relation == ir_relation_equal
+		    || relation == ir_relation_less_greater;
+	}
+
+	case iro_Proj: {
+		ir_node const *const pred = get_Proj_pred(irn);
+		return !is_Tuple(pred)
+		    || get_irn_mode(get_Tuple_pred(pred, get_Proj_num(irn))) == m;
+	}
+
+	default:
+		return true;
+	}
+}
+
+/**
+ * Computes the bit information of the integer or boolean node @p irn on native
+ * words.  Gives the same results as transfer_tarval(), but does not create
+ * intermediate tarvals.  Returns false, if the mode of @p irn or one of its
+ * operands does not fit into a native word.
+ */
+static bool transfer_word(ir_node const *const irn, ir_mode *const m, uint64_t *const res_z, uint64_t *const res_o)
+{
+	if (!is_word_transfer_possible(irn, m))
+		return false;
+
+	DB((dbg, LEVEL_3, "transfer %+F\n", irn));
+
+	ir_tarval *const f    = tarval_b_false;
+	unsigned   const bits = get_mode_word_bits(m);
+	uint64_t   const mask = word_mask(bits);
+	uint64_t         z;
+	uint64_t         o;
+
+	if (is_Phi(irn)) {
+		ir_node *const block = get_nodes_block(irn);
+
+repeatphi:
+		z = 0;
+		o = mask;
+		foreach_irn_in(block, i, pred_block) {
+			bitinfo *const b_cfg = get_bitinfo_recursive(pred_block);
+			if (b_cfg->z != f) {
+				bitinfo *const b = get_bitinfo_recursive(get_Phi_pred(irn, i));
+				z |= b->z_word;
+				o &= b->o_word;
+			}
+		}
+		/* Computing bitinfo for operand 1 might render operand 0 unstable.
+		 * Thus, evaluate the operands until all of them are stable. */
+		foreach_irn_in(block, i, pred_block) {
+			bitinfo *const b_cfg = get_bitinfo_recursive(pred_block);
+			if (b_cfg->z != f) {
+				bitinfo *const b = get_bitinfo_direct(get_Phi_pred(irn, i));
+				if (b->state == BITINFO_UNSTABLE) {
+					goto repeatphi;
+				}
+			}
+		}
+		goto set_info;
+	}
+
+	/* Undefined if any input is undefined. */
+	foreach_irn_in(irn, i, pred) {
+		bitinfo *const pred_b = get_bitinfo_recursive(pred);
+		if (pred_b != NULL && is_undefined(pred_b))
+			goto undefined;
+	}
+
+	switch (get_irn_opcode(irn)) {
+	case iro_Bad:
+undefined:
+		z = 0;
+		o = mask;
+		break;
+
+	case iro_Const:
+		z = o = get_tarval_word(get_Const_tarval(irn));
+		break;
+
+	case iro_Confirm: {
+		bitinfo *const b = get_bitinfo_recursive(get_Confirm_value(irn));
+		/* TODO Use bound and relation. */
+		z = b->z_word;
+		o = b->o_word;
+		if ((get_Confirm_relation(irn) & ~ir_relation_unordered) == ir_relation_equal) {
+			bitinfo *const bound_b = get_bitinfo_recursive(get_Confirm_bound(irn));
+			z &= bound_b->z_word;
+			o |= bound_b->o_word;
+		}
+		break;
+	}
+
+	case iro_Shl:
+		transfer_word_shift(m, get_Shl_left(irn), get_Shl_right(irn), &word_shl, &z, &o);
+		break;
+
+	case iro_Shr:
+		transfer_word_shift(m, get_Shr_left(irn), get_Shr_right(irn), &word_shr, &z, &o);
+		break;
+
+	case iro_Shrs:
+		transfer_word_shift(m, get_Shrs_left(irn), get_Shrs_right(irn), &word_shrs, &z, &o);
+		break;
+
+	case iro_Add: {
+		bitinfo  *const l   = get_bitinfo_recursive(get_Add_left(irn));
+		bitinfo  *const r   = get_bitinfo_recursive(get_Add_right(irn));
+		uint64_t  const lz  = l->z_word;
+		uint64_t  const lo  = l->o_word;
+		uint64_t  const rz  = r->z_word;
+		uint64_t  const ro  = r->o_word;
+		uint64_t  const vz  = (lz + rz) & mask;
+		uint64_t  const vo  = (lo + ro) & mask;
+		uint64_t  const nc  = (lz ^ lo) | (rz ^ ro) | (vz ^ vo);
+		z = vz | nc;
+		o = vz & ~nc;
+		break;
+	}
+
+	case iro_Sub: {
+		bitinfo *const l = get_bitinfo_recursive(get_Sub_left(irn));
+		bitinfo *const r = get_bitinfo_recursive(get_Sub_right(irn));
+		// might subtract pointers
+		if (l == NULL || r == NULL)
+			goto cannot_analyse;
+
+		uint64_t const lz = l->z_word;
+		uint64_t const lo = l->o_word;
+		uint64_t const rz = r->z_word;
+		uint64_t const ro = r->o_word;
+		uint64_t const vz = (lo - rz) & mask;
+		uint64_t const vo = (lz - ro) & mask;
+		uint64_t const nc = (lz ^ lo) | (rz ^ ro) | (vz ^ vo);
+		z = vz | nc;
+		o = vz & ~nc;
+		break;
+	}
+
+	case iro_Mul: {
+		bitinfo *const l  = get_bitinfo_recursive(get_Mul_left(irn));
+		bitinfo *const r  = get_bitinfo_recursive(get_Mul_right(irn));
+		uint64_t       lz = l->z_word;
+		uint64_t       lo = l->o_word;
+		uint64_t       rz = r->z_word;
+		uint64_t       ro = r->o_word;
+		if (lz == lo && rz == ro) {
+			z = o = (lz * rz) & mask;
+		} else {
+			z = o = 0;
+			while (rz != 0) {
+				if (rz & 1) {
+					uint64_t const vz = (lz + z) & mask;
+					uint64_t const vo = (lo + o) & mask;
+					uint64_t const nc = (lz ^ lo) | (z ^ o) | (vz ^ vo);
+					uint64_t const az = vz | nc;
+					uint64_t const ao = vz & ~nc;
+
+					if (ro & 1) {
+						z = az;
+						o = ao;
+					} else {
+						z |= az;
+						o &= ao;
+					}
+				}
+				lz = (lz << 1) & mask;
+				lo = (lo << 1) & mask;
+				rz >>= 1;
+				ro >>= 1;
+			}
+		}
+		break;
+	}
+
+	case iro_Minus: {
+		/* -a = 0 - a */
+		bitinfo  *const b  = get_bitinfo_recursive(get_Minus_op(irn));
+		uint64_t  const bz = b->z_word;
+		uint64_t  const bo = b->o_word;
+		uint64_t  const vz = -bz & mask;
+		uint64_t  const vo = -bo & mask;
+		uint64_t  const nc = (bz ^ bo) | (vz ^ vo);
+		z = vz | nc;
+		o = vz & ~nc;
+		break;
+	}
+
+	case iro_And: {
+		bitinfo *const l = get_bitinfo_recursive(get_And_left(irn));
+		bitinfo *const r = get_bitinfo_recursive(get_And_right(irn));
+		z = l->z_word & r->z_word;
+		o = l->o_word & r->o_word;
+		break;
+	}
+
+	case iro_Or: {
+		bitinfo *const l = get_bitinfo_recursive(get_Or_left(irn));
+		bitinfo *const r = get_bitinfo_recursive(get_Or_right(irn));
+		z = l->z_word | r->z_word;
+		o = l->o_word | r->o_word;
+		break;
+	}
+
+	case iro_Eor: {
+		bitinfo  *const l  = get_bitinfo_recursive(get_Eor_left(irn));
+		bitinfo  *const r  = get_bitinfo_recursive(get_Eor_right(irn));
+		uint64_t  const lz = l->z_word;
+		uint64_t  const lo = l->o_word;
+		uint64_t  const rz = r->z_word;
+		uint64_t  const ro = r->o_word;
+		z = (lz & ~ro) | (rz & ~lo);
+		o = (ro & ~lz) | (lo & ~rz);
+		break;
+	}
+
+	case iro_Not: {
+		bitinfo *const b = get_bitinfo_recursive(get_Not_op(irn));
+		z = ~b->o_word & mask;
+		o = ~b->z_word & mask;
+		break;
+	}
+
+	case iro_Conv: {
+		ir_node *const op = get_Conv_op(irn);
+		bitinfo *const b  = get_bitinfo_recursive(op);
+		if (b == NULL) // Happens when converting from float values.
+			goto result_unknown;
+		ir_mode *const op_mode = get_irn_mode(op);
+		z = b->z_word;
+		o = b->o_word;
+		if (mode_is_signed(op_mode)) {
+			unsigned const op_bits = get_mode_word_bits(op_mode);
+			z = word_sign_extend(z, op_bits);
+			o = word_sign_extend(o, op_bits);
+		}
+		z &= mask;
+		o &= mask;
+		break;
+	}
+
+	case iro_Mux: {
+		bitinfo *const bf = get_bitinfo_recursive(get_Mux_false(irn));
+		bitinfo *const bt = get_bitinfo_recursive(get_Mux_true(irn));
+		bitinfo *const c  = get_bitinfo_recursive(get_Mux_sel(irn));
+		if (c->o_word != 0) {
+			z = bt->z_word;
+			o = bt->o_word;
+		} else if (c->z_word == 0) {
+			z = bf->z_word;
+			o = bf->o_word;
+		} else {
+			z = bf->z_word | bt->z_word;
+			o = bf->o_word & bt->o_word;
+		}
+		break;
+	}
+
+	case iro_Cmp: {
+		bitinfo *const l = get_bitinfo_recursive(get_Cmp_left(irn));
+		bitinfo *const r = get_bitinfo_recursive(get_Cmp_right(irn));
+		if (l == NULL || r == NULL)
+			goto result_unknown; // Cmp compares something we cannot evaluate.
+		ir_mode    *const op_mode  = get_irn_mode(get_Cmp_left(irn));
+		uint64_t    const lz       = l->z_word;
+		uint64_t    const lo       = l->o_word;
+		uint64_t    const rz       = r->z_word;
+		uint64_t    const ro       = r->o_word;
+		ir_relation const relation = get_Cmp_relation(irn);
+		switch (relation) {
+		case ir_relation_less_greater:
+			if ((ro & ~lz) != 0 || (lo & ~rz) != 0) {
+				// At least one bit differs.
+				z = o = 1;
+			} else if (lz == lo && rz == ro && lz == rz) {
+				z = o = 0;
+			} else {
+				goto result_unknown;
+			}
+			break;
+
+		case ir_relation_equal:
+			if ((ro & ~lz) != 0 || (lo & ~rz) != 0) {
+				// At least one bit differs.
+				z = o = 0;
+			} else if (lz == lo && rz == ro && lz == rz) {
+				z = o = 1;
+			} else {
+				goto result_unknown;
+			}
+			break;
+
+		case ir_relation_less_equal:
+		case ir_relation_less:
+		case ir_relation_greater_equal:
+		case ir_relation_greater: {
+			/* TODO handle negative values */
+			if (mode_is_signed(op_mode)) {
+				uint64_t const sign = (uint64_t)1 << (get_mode_word_bits(op_mode) - 1);
+				if ((lz | lo | rz | ro) & sign)
+					goto result_unknown;
+			}
+
+			ir_relation const upper = lz < ro ? ir_relation_less : lz > ro ? ir_relation_greater : ir_relation_equal;
+			ir_relation const lower = lo < rz ? ir_relation_less : lo > rz ? ir_relation_greater : ir_relation_equal;
+			if (relation & ir_relation_less) {
+				if (upper & relation) {
+					/* Left upper bound is smaller(/equal) than right lower bound. */
+					z = o = 1;
+				} else if (!(lower & relation)) {
+					/* Left lower bound is not smaller(/equal) than right upper bound. */
+					z = o = 0;
+				} else {
+					goto result_unknown;
+				}
+			} else {
+				if (!(upper & relation)) {
+					/* Left upper bound is not greater(/equal) than right lower bound. */
+					z = o = 0;
+				} else if (lower & relation) {
+					/* Left lower bound is greater(/equal) than right upper bound. */
+					z = o = 1;
+				} else {
+					goto result_unknown;
+				}
+			}
+			break;
+		}
+
+		default:
+			goto cannot_analyse;
+		}
+		break;
+	}
+
+	case iro_Proj: {
+		ir_node *const pred = get_Proj_pred(irn);
+		if (is_Tuple(pred)) {
+			unsigned       pn = get_Proj_num(irn);
+			ir_node *const op = get_Tuple_pred(pred, pn);
+			bitinfo *const b  = get_bitinfo_recursive(op);
+			z = b->z_word;
+			o = b->o_word;
+			goto set_info;
+		}
+		goto cannot_analyse;
+	}
+
+	default:
+cannot_analyse:
+		DB((dbg, LEVEL_4, "cannot analyse %+F\n", irn));
+result_unknown:
+		z = mask;
+		o = 0;
+		break;
+	}
+
+set_info:
+	*res_z = z;
+	*res_o = o;
+	return true;
+}
+
+static bool transfer(ir_node const *const irn)
+{
+	ir_mode *const m = get_irn_mode(irn);
+	bool           changed;
+	uint64_t       z_word;
+	uint64_t       o_word;
+	if (mode_is_intb(m) && transfer_word(irn, m, &z_word, &o_word)) {
+		changed = set_bitinfo_word(irn, m, z_word, o_word);
+	} else {
+		ir_tarval *z;
+		ir_tarval *o;
+		if (!transfer_tarval(irn, &z, &o))
+			return false;
+		changed = set_bitinfo(irn, z, o);
+	}
 	DB((dbg, LEVEL_4, "finish transfer %+F\n", irn));
 	return changed;
 }
@@ -855,6 +1373,14 @@ static void verify_constbits_walker(ir_node *const n, void *const env)
 			*bi     = old;
 			*failed = true;
 		}
+
+		/* Cross-check the native word lattice against tarval arithmetic. */
+		ir_tarval *z;
+		ir_tarval *o;
+		if (transfer_tarval(n, &z, &o) && (z != bi->z || o != bi->o)) {
+			ir_fprintf(stderr, "---> tarval transfer differs for %+F: 0:%T 1:%T\n", n, z, o);
+			*failed = true;
+		}
 	}
 }
 
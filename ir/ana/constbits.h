@@ -2,6 +2,7 @@
 #define CONSTBITS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "tv.h"
 
 typedef enum bitinfo_state {
@@ -15,6 +16,8 @@ typedef struct bitinfo
 {
 	ir_tarval    *z; /**< safe zeroes, 0 = bit is zero,       1 = bit maybe is 1 */
 	ir_tarval    *o; /**< safe ones,   0 = bit maybe is zero, 1 = bit is 1 */
+	uint64_t      z_word; /**< z as native word, if the mode has at most 64 bits */
+	uint64_t      o_word; /**< o as native word, if the mode has at most 64 bits */
 	bitinfo_state state;
 } bitinfo;
 
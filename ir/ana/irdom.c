@@ -12,16 +12,20 @@
 #include "irdom_t.h"
 
 #include "array.h"
+#include "debug.h"
 #include "ircons_t.h"
 #include "iredges_t.h"
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "irouts_t.h"
+#include "panic.h"
 #include "util.h"
 #include "xmalloc.h"
 #include <string.h>
 
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
 static inline ir_dom_info *get_dom_info(ir_node *block)
 {
 	assert(is_Block(block));
@@ -708,3 +712,145 @@ void compute_postdoms(ir_graph *irg)
 	postdom_tree_walk(get_irg_end_block(irg), assign_tree_postdom_pre_order,
 	                  assign_tree_postdom_pre_order_max, &tree_pre_order);
 }
+
+/*
+ * Incremental maintenance of the dominator tree.
+ *
+ * dom_split_edge() keeps the idom links, the dominated lists and the depths
+ * up to date.  The tree pre-order numbers used by block_dominates() are only
+ * refreshed by dom_renumber_tree(), so several updates can be batched.
+ */
+
+static void init_new_dom_info(ir_dom_info *info)
+{
+	memset(info, 0, sizeof(*info));
+	info->pre_num   = -1;
+	info->dom_depth = -1;
+}
+
+/** Makes @p idom the immediate dominator of @p block. */
+static void relink_idom(ir_node *block, ir_node *idom)
+{
+	ir_dom_info *bi = get_dom_info(block);
+	if (bi->idom != NULL) {
+		ir_node **link = &get_dom_info(bi->idom)->first;
+		while (*link != block)
+			link = &get_dom_info(*link)->next;
+		*link = bi->next;
+	}
+
+	ir_dom_info *ii = get_dom_info(idom);
+	bi->idom  = idom;
+	bi->next  = ii->first;
+	ii->first = block;
+}
+
+/** Recomputes the depths in the subtree below @p block. */
+static void update_subtree_depth(ir_node *block)
+{
+	int const depth = get_dom_info(block)->dom_depth + 1;
+	for (ir_node *p = get_dom_info(block)->first; p; p = get_dom_info(p)->next) {
+		get_dom_info(p)->dom_depth = depth;
+		update_subtree_depth(p);
+	}
+}
+
+/** Tests whether @p dominator is on the idom chain of @p block. */
+static bool is_on_idom_chain(ir_node *dominator, ir_node *block)
+{
+	for (ir_node *b = block; b != NULL; b = get_dom_info(b)->idom) {
+		if (b == dominator)
+			return true;
+	}
+	return false;
+}
+
+static bool is_dom_reachable(ir_node *block)
+{
+	return get_dom_info(block)->dom_depth >= 0;
+}
+
+void dom_split_edge(ir_node *new_block, ir_node *block)
+{
+	assert(get_Block_n_cfgpreds(new_block) == 1);
+	init_new_dom_info(get_dom_info(new_block));
+
+	ir_node *pred = get_Block_cfgpred_block(new_block, 0);
+	if (pred == NULL || !is_dom_reachable(pred))
+		return;
+
+	relink_idom(new_block, pred);
+	get_dom_info(new_block)->dom_depth = get_dom_info(pred)->dom_depth + 1;
+
+	/* new_block dominates block iff all other entries into block are
+	 * unreachable or back edges from blocks dominated by block. */
+	for (int i = 0, n = get_Block_n_cfgpreds(block); i < n; ++i) {
+		ir_node *other = get_Block_cfgpred_block(block, i);
+		if (other == NULL || other == new_block || !is_dom_reachable(other))
+			continue;
+		if (!is_on_idom_chain(block, other))
+			return;
+	}
+	ir_graph *irg = get_irn_irg(block);
+	if (block == get_irg_end_block(irg)) {
+		foreach_irn_in(get_irg_end(irg), i, kept) {
+			if (is_Block(kept) && kept != new_block && is_dom_reachable(kept))
+				return;
+		}
+	}
+
+	relink_idom(block, new_block);
+	get_dom_info(block)->dom_depth = get_dom_info(new_block)->dom_depth + 1;
+	update_subtree_depth(block);
+}
+
+#ifdef DEBUG_libfirm
+typedef struct idom_pair_t {
+	ir_node *block;
+	ir_node *idom;
+} idom_pair_t;
+
+static void collect_idom(ir_node *block, void *env)
+{
+	idom_pair_t **pairs = (idom_pair_t**)env;
+	idom_pair_t   pair  = { block, get_dom_info(block)->idom };
+	ARR_APP1(idom_pair_t, *pairs, pair);
+}
+
+/**
+ * Checking mode: compares the incrementally maintained tree against a full
+ * recomputation.
+ */
+static void check_incremental(ir_graph *irg)
+{
+	idom_pair_t *pairs = NEW_ARR_F(idom_pair_t, 0);
+	irg_block_walk_graph(irg, collect_idom, NULL, &pairs);
+	compute_doms(irg);
+	for (size_t i = 0, n = ARR_LEN(pairs); i < n; ++i) {
+		ir_node *block = pairs[i].block;
+		ir_node *idom  = get_dom_info(block)->idom;
+		if (idom != pairs[i].idom)
+			panic("incremental update of %+F: expected idom %+F, got %+F",
+			      block, idom, pairs[i].idom);
+	}
+	DEL_ARR_F(pairs);
+}
+#endif
+
+void dom_renumber_tree(ir_graph *irg)
+{
+#ifdef DEBUG_libfirm
+	if (firm_dbg_get_mask(dbg) & LEVEL_1) {
+		check_incremental(irg);
+		return;
+	}
+#endif
+	unsigned tree_pre_order = 0;
+	dom_tree_walk(get_irg_start_block(irg), assign_tree_dom_pre_order,
+	              assign_tree_dom_pre_order_max, &tree_pre_order);
+}
+
+void firm_init_dom(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.ana.dom");
+}
@@ -57,6 +57,27 @@ unsigned get_Block_pdom_max_subtree_pre_num(const ir_node *bl);
 
 void ir_free_dominance_frontiers(ir_graph *irg);
 
+/**
+ * Updates the dominator tree after the control flow edge into @p block has
+ * been split by @p new_block, which must have exactly one predecessor.
+ *
+ * This is the only incremental update, post dominance is not maintained.
+ * Passes making other control flow changes invalidate the dominance
+ * property, so it is recomputed on demand.
+ */
+void dom_split_edge(ir_node *new_block, ir_node *block);
+
+/**
+ * Recomputes the tree pre-order numbers after a batch of incremental
+ * updates.  block_dominates() must not be used before this is done.
+ * With the debug module firm.ana.dom at level 1 the tree is checked against
+ * a full recomputation instead.
+ */
+void dom_renumber_tree(ir_graph *irg);
+
+/** Initializes the dominance module. */
+void firm_init_dom(void);
+
 /**
  * Iterate over all nodes which are immediately dominated by a given
  * node.
@@ -21,8 +21,17 @@
 #include "iroptimize.h"
 #include "irouts_t.h"
 #include "irprintf.h"
+#include "panic.h"
 #include "pdeq.h"
-#include "tv.h"
+#include "tv_t.h"
+
+#ifndef VERIFY_VRP
+#	ifdef DEBUG_libfirm
+#		define VERIFY_VRP 1
+#	else
+#		define VERIFY_VRP 0
+#	endif
+#endif
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg;)
 
@@ -32,23 +41,49 @@ typedef struct vrp_env_t {
 	ir_vrp_info *info;
 } vrp_env_t;
 
-static vrp_attr *vrp_get_or_set_info(ir_vrp_info *info, const ir_node *node)
+/**
+ * Analysis information of a node.  For modes with at most 64 bits the
+ * information is additionally kept as native words, so updates do not need to
+ * create tarvals for intermediate results.
+ */
+typedef struct vrp_node {
+	vrp_attr attr;         /**< The published information, must be first. */
+	bool     native;       /**< The words below mirror attr. */
+	bool     has_bounds;   /**< attr.range_bottom/top are not tarval_bad. */
+	uint64_t bits_set;
+	uint64_t bits_not_set;
+	uint64_t range_bottom;
+	uint64_t range_top;
+} vrp_node;
+
+static vrp_node *vrp_get_or_set_node(ir_vrp_info *info, const ir_node *node)
 {
-	vrp_attr *attr = ir_nodemap_get(vrp_attr, &info->infos, node);
-	if (attr == NULL) {
+	vrp_node *vrp = ir_nodemap_get(vrp_node, &info->infos, node);
+	if (vrp == NULL) {
 		ir_mode *mode = get_irn_mode(node);
 		assert(mode_is_int(mode));
 
-		attr = OALLOCZ(&info->obst, vrp_attr);
-		attr->range_type   = VRP_UNDEFINED;
-		attr->bits_set     = get_mode_null(mode);
-		attr->bits_not_set = get_mode_all_one(mode);
-		attr->range_bottom = tarval_bad;
-		attr->range_top    = tarval_bad;
+		vrp = OALLOCZ(&info->obst, vrp_node);
+		vrp->attr.range_type   = VRP_UNDEFINED;
+		vrp->attr.bits_set     = get_mode_null(mode);
+		vrp->attr.bits_not_set = get_mode_all_one(mode);
+		vrp->attr.range_bottom = tarval_bad;
+		vrp->attr.range_top    = tarval_bad;
+
+		unsigned const bits = get_mode_word_bits(mode);
+		if (bits != 0) {
+			vrp->native       = true;
+			vrp->bits_not_set = word_mask(bits);
+		}
 
-		ir_nodemap_insert(&info->infos, node, attr);
+		ir_nodemap_insert(&info->infos, node, vrp);
 	}
-	return attr;
+	return vrp;
+}
+
+static vrp_attr *vrp_get_or_set_info(ir_vrp_info *info, const ir_node *node)
+{
+	return &vrp_get_or_set_node(info, node)->attr;
 }
 
 vrp_attr *vrp_get_info(const ir_node *node)
@@ -56,10 +91,12 @@ vrp_attr *vrp_get_info(const ir_node *node)
 	ir_graph *irg = get_irn_irg(node);
 	if (irg->vrp.infos.data == NULL)
 		return NULL;
-	return ir_nodemap_get(vrp_attr, &irg->vrp.infos, node);
+	vrp_node *vrp = ir_nodemap_get(vrp_node, &irg->vrp.infos, node);
+	return vrp != NULL ? &vrp->attr : NULL;
 }
 
-static int vrp_update_node(ir_vrp_info *info, ir_node *node)
+/** Updates the information @p vrp of @p node using tarval arithmetic. */
+static int vrp_update_node_tarval(ir_vrp_info *info, ir_node *node, vrp_attr *vrp)
 {
 	ir_tarval       *new_bits_set      = get_tarval_bad();
 	ir_tarval       *new_bits_not_set  = get_tarval_bad();
@@ -67,11 +104,6 @@ static int vrp_update_node(ir_vrp_info *info, ir_node *node)
 	ir_tarval       *new_range_top     = get_tarval_bad();
 	enum range_types new_range_type    = VRP_UNDEFINED;
 	bool             something_changed = false;
-	if (!mode_is_int(get_irn_mode(node))) {
-		return 0; /* we don't optimize for non-int-nodes*/
-	}
-
-	vrp_attr *vrp = vrp_get_or_set_info(info, node);
 
 	/* TODO: Check if all predecessors have valid VRP information*/
 
@@ -459,6 +491,480 @@ static int vrp_update_node(ir_vrp_info *info, ir_node *node)
 	return something_changed;
 }
 
+/** Native word version of tarval_cmp() for values of mode @p mode. */
+static ir_relation word_cmp(const ir_mode *mode, uint64_t a, uint64_t b)
+{
+	if (a == b)
+		return ir_relation_equal;
+	if (mode_is_signed(mode)) {
+		unsigned const bits = get_mode_size_bits(mode);
+		uint64_t const sign = (uint64_t)1 << 63;
+		a = word_sign_extend(a, bits) ^ sign;
+		b = word_sign_extend(b, bits) ^ sign;
+	}
+	return a < b ? ir_relation_less : ir_relation_greater;
+}
+
+/**
+ * Native word version of tarval_add() and tarval_sub() without wrap around.
+ * Returns false on overflow.
+ */
+static bool word_add_no_wrap(const ir_mode *mode, uint64_t a, uint64_t b,
+                             bool sub, uint64_t *res)
+{
+	unsigned const bits = get_mode_size_bits(mode);
+	uint64_t       r;
+	if (!mode_is_signed(mode)) {
+		if (sub) {
+			if (a < b)
+				return false;
+			r = a - b;
+		} else {
+			r = a + b;
+			if (r < a || r > word_mask(bits))
+				return false;
+		}
+	} else {
+		uint64_t const sa = word_sign_extend(a, bits);
+		uint64_t const sb = word_sign_extend(b, bits);
+		r = sub ? sa - sb : sa + sb;
+		if (bits < 64) {
+			if (word_sign_extend(r, bits) != r)
+				return false;
+		} else if (((sub ? sa ^ sb : ~(sa ^ sb)) & (sa ^ r)) >> 63) {
+			return false;
+		}
+	}
+	*res = r & word_mask(bits);
+	return true;
+}
+
+/**
+ * Returns the information of operand @p op, if it is available as native
+ * words of mode @p mode.
+ */
+static const vrp_node *vrp_get_word_operand(ir_vrp_info *info,
+                                            const ir_node *op, ir_mode *mode)
+{
+	const vrp_node *vrp = vrp_get_or_set_node(info, op);
+	return vrp->native && get_irn_mode(op) == mode ? vrp : NULL;
+}
+
+static void vrp_set_bounds(vrp_node *vrp, ir_mode *mode, bool has_bounds,
+                           uint64_t bottom, uint64_t top)
+{
+	vrp->has_bounds        = has_bounds;
+	vrp->range_bottom      = bottom;
+	vrp->range_top         = top;
+	vrp->attr.range_bottom = has_bounds ? new_tarval_from_word(bottom, mode) : tarval_bad;
+	vrp->attr.range_top    = has_bounds ? new_tarval_from_word(top, mode) : tarval_bad;
+}
+
+/**
+ * Updates the information @p vrp of @p node on native words.  Gives the same
+ * results as vrp_update_node_tarval(), but tarvals are only created for
+ * changed information.  Returns false, if @p node or one of its operands
+ * cannot be handled on native words.
+ */
+static bool vrp_update_node_word(ir_vrp_info *info, ir_node *node,
+                                 vrp_node *vrp, int *changed)
+{
+	ir_mode *const mode = get_irn_mode(node);
+	if (!vrp->native || !tarval_get_wrap_on_overflow())
+		return false;
+
+	uint64_t const   mask              = word_mask(get_mode_size_bits(mode));
+	bool             has_new_bits      = false;
+	uint64_t         new_bits_set      = 0;
+	uint64_t         new_bits_not_set  = 0;
+	enum range_types new_range_type    = VRP_UNDEFINED;
+	bool             new_has_bounds    = false;
+	uint64_t         new_range_bottom  = 0;
+	uint64_t         new_range_top     = 0;
+	bool             something_changed = false;
+
+	switch (get_irn_opcode(node)) {
+	case iro_Const: {
+		uint64_t const w = get_tarval_word(get_Const_tarval(node));
+		has_new_bits     = true;
+		new_bits_set     = w;
+		new_bits_not_set = w;
+		new_has_bounds   = true;
+		new_range_bottom = w;
+		new_range_top    = w;
+		new_range_type   = VRP_RANGE;
+		break;
+	}
+
+	case iro_And: {
+		const vrp_node *l = vrp_get_word_operand(info, get_And_left(node), mode);
+		const vrp_node *r = vrp_get_word_operand(info, get_And_right(node), mode);
+		if (l == NULL || r == NULL)
+			return false;
+		has_new_bits     = true;
+		new_bits_set     = l->bits_set & r->bits_set;
+		new_bits_not_set = l->bits_not_set & r->bits_not_set;
+		break;
+	}
+
+	case iro_Add:
+	case iro_Sub: {
+		const ir_node *left   = get_binop_left(node);
+		const ir_node *right  = get_binop_right(node);
+		bool const     is_sub = is_Sub(node);
+		if (is_sub && !mode_is_int(get_irn_mode(left))) {
+			*changed = 0;
+			return true;
+		}
+
+		const vrp_node *l = vrp_get_word_operand(info, left, mode);
+		const vrp_node *r = vrp_get_word_operand(info, right, mode);
+		if (l == NULL || r == NULL)
+			return false;
+
+		if (l->attr.range_type == VRP_UNDEFINED
+		 || r->attr.range_type == VRP_UNDEFINED
+		 || l->attr.range_type == VRP_VARYING
+		 || r->attr.range_type == VRP_VARYING) {
+			*changed = 0;
+			return true;
+		}
+
+		if (l->attr.range_type == VRP_RANGE
+		 && r->attr.range_type == VRP_RANGE) {
+			assert(l->has_bounds && r->has_bounds);
+			uint64_t top;
+			uint64_t bottom;
+			bool     ok;
+			if (is_sub) {
+				ok  = word_add_no_wrap(mode, l->range_top, r->range_bottom, true, &top);
+				ok &= word_add_no_wrap(mode, l->range_bottom, r->range_top, true, &bottom);
+			} else {
+				ok  = word_add_no_wrap(mode, l->range_top, r->range_top, false, &top);
+				ok &= word_add_no_wrap(mode, l->range_bottom, r->range_bottom, false, &bottom);
+			}
+
+			if (ok) {
+				new_has_bounds   = true;
+				new_range_bottom = bottom;
+				new_range_top    = top;
+				new_range_type   = VRP_RANGE;
+			} else {
+				/* TODO Implement overflow handling*/
+				new_range_type = VRP_UNDEFINED;
+			}
+		}
+		break;
+	}
+
+	case iro_Or: {
+		const vrp_node *l = vrp_get_word_operand(info, get_Or_left(node), mode);
+		const vrp_node *r = vrp_get_word_operand(info, get_Or_right(node), mode);
+		if (l == NULL || r == NULL)
+			return false;
+		has_new_bits     = true;
+		new_bits_set     = l->bits_set | r->bits_set;
+		new_bits_not_set = l->bits_not_set | r->bits_not_set;
+		break;
+	}
+
+	case iro_Shl:
+	case iro_Shr:
+	case iro_Shrs: {
+		const vrp_node *l = vrp_get_word_operand(info, get_binop_left(node), mode);
+		if (l == NULL)
+			return false;
+
+		/* We can only compute this if the right value is a constant*/
+		const ir_node *right = get_binop_right(node);
+		if (is_Const(right)) {
+			ir_tarval *const amount_tv = get_Const_tarval(right);
+			ir_mode   *const rmode     = get_tarval_mode(amount_tv);
+			if (!mode_is_int(rmode) || mode_is_signed(rmode)
+			 || get_mode_word_bits(rmode) == 0)
+				return false;
+
+			uint64_t const amount = get_tarval_word(amount_tv);
+			uint64_t (*const shift)(const ir_mode*, uint64_t, uint64_t)
+				= is_Shl(node) ? word_shl : is_Shr(node) ? word_shr : word_shrs;
+			has_new_bits     = true;
+			new_bits_set     = shift(mode, l->bits_set, amount);
+			new_bits_not_set = shift(mode, l->bits_not_set, amount);
+		}
+		break;
+	}
+
+	case iro_Eor: {
+		const vrp_node *l = vrp_get_word_operand(info, get_Eor_left(node), mode);
+		const vrp_node *r = vrp_get_word_operand(info, get_Eor_right(node), mode);
+		if (l == NULL || r == NULL)
+			return false;
+		has_new_bits     = true;
+		new_bits_set     = (l->bits_set & ~r->bits_not_set)
+		                 | (~l->bits_not_set & r->bits_set);
+		new_bits_not_set = ~((l->bits_set & r->bits_set)
+		                     | (~l->bits_not_set & ~r->bits_not_set)) & mask;
+		break;
+	}
+
+	case iro_Id: {
+		const vrp_node *pred = vrp_get_word_operand(info, get_Id_pred(node), mode);
+		if (pred == NULL)
+			return false;
+		has_new_bits     = true;
+		new_bits_set     = pred->bits_set;
+		new_bits_not_set = pred->bits_not_set;
+		new_has_bounds   = pred->has_bounds;
+		new_range_bottom = pred->range_bottom;
+		new_range_top    = pred->range_top;
+		new_range_type   = pred->attr.range_type;
+		break;
+	}
+
+	case iro_Not: {
+		const vrp_node *pred = vrp_get_word_operand(info, get_Not_op(node), mode);
+		if (pred == NULL)
+			return false;
+		has_new_bits     = true;
+		new_bits_set     = ~pred->bits_not_set & mask;
+		new_bits_not_set = ~pred->bits_set & mask;
+		break;
+	}
+
+	case iro_Conv: {
+		const ir_node *pred     = get_Conv_op(node);
+		ir_mode       *old_mode = get_irn_mode(pred);
+		if (!mode_is_int(old_mode)) {
+			*changed = 0;
+			return true;
+		}
+
+		const vrp_node *vrp_pred = vrp_get_or_set_node(info, pred);
+		if (!vrp_pred->native)
+			return false;
+
+		/* Convert the source bits like tarval_convert_to(). */
+		unsigned const old_bits   = get_mode_size_bits(old_mode);
+		bool     const old_signed = mode_is_signed(old_mode);
+		uint64_t       all_one    = word_mask(old_bits);
+		uint64_t       bits_set   = vrp_pred->bits_set;
+		uint64_t       not_set    = vrp_pred->bits_not_set;
+		if (old_signed) {
+			all_one  = word_sign_extend(all_one, old_bits);
+			bits_set = word_sign_extend(bits_set, old_bits);
+			not_set  = word_sign_extend(not_set, old_bits);
+		}
+
+		/* The second and is needed if target type is smaller*/
+		has_new_bits     = true;
+		new_bits_not_set = all_one & not_set & mask;
+		new_bits_set     = new_bits_not_set & bits_set;
+		/* The range is never taken over, as tarval_cmp() never returns
+		 * ir_relation_less_equal or ir_relation_greater_equal. */
+		break;
+	}
+
+	case iro_Confirm: {
+		const ir_relation relation = get_Confirm_relation(node);
+		const ir_node    *bound    = get_Confirm_bound(node);
+
+		if (relation == ir_relation_less_greater
+		 || relation == ir_relation_less_equal) {
+			/** @todo: Handle non-Const bounds */
+			if (is_Const(bound)) {
+				ir_tarval *const tv = get_Const_tarval(bound);
+				if (get_tarval_mode(tv) != mode)
+					return false;
+				new_has_bounds = true;
+				new_range_top  = get_tarval_word(tv);
+				if (relation == ir_relation_less_greater) {
+					new_range_type   = VRP_ANTIRANGE;
+					new_range_bottom = new_range_top;
+				} else {
+					new_range_type   = VRP_RANGE;
+					new_range_bottom = get_tarval_word(get_mode_min(mode));
+				}
+			}
+		}
+		break;
+	}
+
+	case iro_Phi: {
+		/* combine all ranges*/
+		const vrp_node *pred = vrp_get_word_operand(info, get_Phi_pred(node, 0), mode);
+		if (pred == NULL)
+			return false;
+		has_new_bits     = true;
+		new_bits_set     = pred->bits_set;
+		new_bits_not_set = pred->bits_not_set;
+		new_has_bounds   = pred->has_bounds;
+		new_range_bottom = pred->range_bottom;
+		new_range_top    = pred->range_top;
+		new_range_type   = pred->attr.range_type;
+
+		for (int i = 1, num = get_Phi_n_preds(node); i < num; i++) {
+			pred = vrp_get_word_operand(info, get_Phi_pred(node, i), mode);
+			if (pred == NULL)
+				return false;
+			if (new_range_type == VRP_RANGE && pred->attr.range_type == VRP_RANGE) {
+				if (word_cmp(mode, new_range_top, pred->range_top) == ir_relation_less)
+					new_range_top = pred->range_top;
+				if (word_cmp(mode, new_range_bottom, pred->range_bottom) == ir_relation_greater)
+					new_range_bottom = pred->range_bottom;
+			} else {
+				new_range_type = VRP_VARYING;
+			}
+			new_bits_set     &= pred->bits_set;
+			new_bits_not_set |= pred->bits_not_set;
+		}
+		break;
+	}
+
+	default:
+		/* unhandled, therefore never updated */
+		break;
+	}
+
+	/* All bits have the mode of the node, and bounds have it as well unless
+	 * they are bad.  So the bounds differ in mode iff only one is bad. */
+	vrp_attr *const attr = &vrp->attr;
+	if (attr->range_type != VRP_UNDEFINED && new_range_type != VRP_UNDEFINED && new_has_bounds != vrp->has_bounds) {
+		attr->range_type = VRP_VARYING;
+	}
+
+	/* Merge the newly calculated values with those that might already exist*/
+	if (has_new_bits) {
+		new_bits_set |= vrp->bits_set;
+		if (new_bits_set != vrp->bits_set) {
+			something_changed = true;
+			vrp->bits_set     = new_bits_set;
+			attr->bits_set    = new_tarval_from_word(new_bits_set, mode);
+		}
+		new_bits_not_set &= vrp->bits_not_set;
+		if (new_bits_not_set != vrp->bits_not_set) {
+			something_changed  = true;
+			vrp->bits_not_set  = new_bits_not_set;
+			attr->bits_not_set = new_tarval_from_word(new_bits_not_set, mode);
+		}
+	}
+
+	if (attr->range_type == VRP_UNDEFINED &&
+	    new_range_type != VRP_UNDEFINED) {
+		something_changed = true;
+		attr->range_type  = new_range_type;
+		vrp_set_bounds(vrp, mode, new_has_bounds, new_range_bottom, new_range_top);
+	} else if (attr->range_type == VRP_RANGE || attr->range_type == VRP_ANTIRANGE) {
+		uint64_t bottom = vrp->range_bottom;
+		uint64_t top    = vrp->range_top;
+		assert(vrp->has_bounds);
+		assert(new_has_bounds || (new_range_type != VRP_RANGE && new_range_type != VRP_ANTIRANGE));
+		if (attr->range_type == VRP_RANGE) {
+			if (new_range_type == VRP_RANGE) {
+				if (word_cmp(mode, bottom, new_range_bottom) == ir_relation_less)
+					bottom = new_range_bottom;
+				if (word_cmp(mode, top, new_range_top) == ir_relation_greater)
+					top = new_range_top;
+			}
+
+			if (new_range_type == VRP_ANTIRANGE) {
+				/* if they are overlapping, cut the range.*/
+				/* TODO: Maybe we can preserve more information here*/
+				if (word_cmp(mode, bottom, new_range_top) == ir_relation_greater &&
+				    word_cmp(mode, bottom, new_range_bottom) == ir_relation_greater) {
+					bottom = new_range_top;
+				} else if (word_cmp(mode, top, new_range_bottom) == ir_relation_greater &&
+				           word_cmp(mode, top, new_range_top) == ir_relation_less) {
+					top = new_range_bottom;
+				}
+			}
+		} else {
+			if (new_range_type == VRP_ANTIRANGE) {
+				if (word_cmp(mode, bottom, new_range_bottom) == ir_relation_greater)
+					bottom = new_range_bottom;
+				if (word_cmp(mode, top, new_range_top) == ir_relation_less)
+					top = new_range_top;
+			}
+
+			if (new_range_type == VRP_RANGE) {
+				if (word_cmp(mode, bottom, new_range_top) == ir_relation_greater)
+					bottom = new_range_top;
+				if (word_cmp(mode, top, new_range_bottom) == ir_relation_less)
+					top = new_range_bottom;
+			}
+		}
+
+		if (bottom != vrp->range_bottom || top != vrp->range_top) {
+			something_changed = true;
+			vrp_set_bounds(vrp, mode, true, bottom, top);
+		}
+	}
+
+	assert((vrp->bits_set & ~vrp->bits_not_set) == 0);
+	*changed = something_changed;
+	return true;
+}
+
+/** Updates the native words of @p vrp after a tarval update. */
+static void vrp_sync_words(vrp_node *vrp, ir_mode *mode)
+{
+	const vrp_attr *attr = &vrp->attr;
+	vrp->native = false;
+	if (get_mode_word_bits(mode) == 0
+	 || get_tarval_mode(attr->bits_set) != mode
+	 || get_tarval_mode(attr->bits_not_set) != mode)
+		return;
+
+	ir_tarval *bottom = attr->range_bottom;
+	ir_tarval *top    = attr->range_top;
+	if (bottom == tarval_bad && top == tarval_bad) {
+		vrp->has_bounds = false;
+	} else if (bottom != tarval_bad && top != tarval_bad
+	        && get_tarval_mode(bottom) == mode && get_tarval_mode(top) == mode) {
+		vrp->has_bounds   = true;
+		vrp->range_bottom = get_tarval_word(bottom);
+		vrp->range_top    = get_tarval_word(top);
+	} else {
+		return;
+	}
+	vrp->bits_set     = get_tarval_word(attr->bits_set);
+	vrp->bits_not_set = get_tarval_word(attr->bits_not_set);
+	vrp->native       = true;
+}
+
+#if VERIFY_VRP
+static bool vrp_attr_equal(const vrp_attr *a, const vrp_attr *b)
+{
+	return a->bits_set == b->bits_set && a->bits_not_set == b->bits_not_set
+	    && a->range_type == b->range_type
+	    && a->range_bottom == b->range_bottom && a->range_top == b->range_top;
+}
+#endif
+
+static int vrp_update_node(ir_vrp_info *info, ir_node *node)
+{
+	ir_mode *const mode = get_irn_mode(node);
+	if (!mode_is_int(mode)) {
+		return 0; /* we don't optimize for non-int-nodes*/
+	}
+
+	vrp_node *const vrp = vrp_get_or_set_node(info, node);
+#if VERIFY_VRP
+	vrp_attr  expected         = vrp->attr;
+	int const expected_changed = vrp_update_node_tarval(info, node, &expected);
+#endif
+	int changed;
+	if (vrp_update_node_word(info, node, vrp, &changed)) {
+#if VERIFY_VRP
+		if (changed != expected_changed || !vrp_attr_equal(&vrp->attr, &expected))
+			panic("word and tarval update differ for %+F", node);
+#endif
+	} else {
+		changed = vrp_update_node_tarval(info, node, &vrp->attr);
+		vrp_sync_words(vrp, mode);
+	}
+	return changed;
+}
+
 static void vrp_first_pass(ir_node *n, void *e)
 {
 	if (is_Block(n))
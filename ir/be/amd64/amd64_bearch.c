@@ -19,6 +19,7 @@
 #include "beflags.h"
 #include "beirg.h"
 #include "bemodule.h"
+#include "bepostsched.h"
 #include "bera.h"
 #include "besched.h"
 #include "bespillslots.h"
@@ -27,6 +28,7 @@
 #include "gen_amd64_regalloc_if.h"
 #include "irarch.h"
 #include "ircons.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgopt.h"
@@ -459,7 +461,8 @@ static void introduce_epilogue(ir_node *ret, bool omit_fp)
 	}
 }
 
-static void introduce_prologue(ir_graph *const irg, bool omit_fp)
+static void introduce_prologue(ir_graph *const irg, bool omit_fp,
+                               ir_node *const prologue_block)
 {
 	const arch_register_t *sp         = &amd64_registers[REG_RSP];
 	const arch_register_t *bp         = &amd64_registers[REG_RBP];
@@ -492,22 +495,33 @@ static void introduce_prologue(ir_graph *const irg, bool omit_fp)
 		/* make sure the initial IncSP is really used by someone */
 		be_keep_if_unused(incsp);
 	} else {
-		ir_node *const incsp = amd64_new_IncSP(block, initial_sp,
-		                                       frame_size, false);
-		sched_add_after(start, incsp);
-		edges_reroute_except(initial_sp, incsp, incsp);
+		ir_node *const anchor = prologue_block == block ? start
+			: be_move_after_schedule_first(prologue_block);
+		ir_node *const incsp  = amd64_new_IncSP(prologue_block, initial_sp,
+		                                        frame_size, false);
+		sched_add_after(anchor, incsp);
+		be_reroute_frame_users(initial_sp, incsp, incsp, prologue_block);
 	}
 }
 
 static void introduce_prologue_epilogue(ir_graph *irg, bool omit_fp)
 {
+	/* Without a frame pointer the frame setup may be sunk into the region
+	 * actually using the frame, returns outside of it need no epilogue. */
+	ir_node *const start_block    = get_irg_start_block(irg);
+	ir_node *const initial_sp     = be_get_Start_proj(irg, &amd64_registers[REG_RSP]);
+	ir_node *const prologue_block
+		= omit_fp ? be_place_prologue(initial_sp) : start_block;
+
 	/* introduce epilogue for every return node */
 	foreach_irn_in(get_irg_end_block(irg), i, ret) {
 		assert(is_amd64_ret(ret));
-		introduce_epilogue(ret, omit_fp);
+		if (prologue_block == start_block
+		 || block_dominates(prologue_block, get_nodes_block(ret)))
+			introduce_epilogue(ret, omit_fp);
 	}
 
-	introduce_prologue(irg, omit_fp);
+	introduce_prologue(irg, omit_fp, prologue_block);
 }
 
 static bool node_has_sp_base(ir_node const *const node,
@@ -615,7 +629,7 @@ static void amd64_finish_and_emit(ir_graph *irg)
 	be_sort_frame_entities(frame, omit_fp);
 	unsigned const misalign = AMD64_REGISTER_SIZE; /* return address on stack */
 	int      const begin    = omit_fp ? 0 : -AMD64_REGISTER_SIZE;
-	be_layout_frame_type(frame, begin, misalign);
+	be_layout_frame_type(frame, begin, misalign, omit_fp);
 
 	irg_block_walk_graph(irg, NULL, amd64_after_ra_walker, NULL);
 
@@ -630,6 +644,12 @@ static void amd64_finish_and_emit(ir_graph *irg)
 	/* Fix 2-address code constraints. */
 	amd64_finish_irg(irg);
 
+	if (be_options.post_sched) {
+		be_timer_push(T_SCHED);
+		be_schedule_after_ra(irg, &amd64_reg_classes[CLASS_amd64_flags]);
+		be_timer_pop(T_SCHED);
+	}
+
 	amd64_simulate_graph_x87(irg);
 
 	amd64_peephole_optimization(irg);
@@ -643,6 +663,7 @@ static void amd64_finish_and_emit(ir_graph *irg)
 static void amd64_finish(void)
 {
 	amd64_free_opcodes();
+	obstack_free(&amd64_opcodes_obst, NULL);
 }
 
 static const regalloc_if_t amd64_regalloc_if = {
@@ -773,6 +794,7 @@ static void amd64_init(void)
 	amd64_setup_cg_config();
 	amd64_init_types();
 	amd64_register_init();
+	obstack_init(&amd64_opcodes_obst);
 	amd64_create_opcodes();
 	amd64_cconv_init();
 	x86_set_be_asm_constraint_support(&amd64_asm_constraints);
@@ -788,6 +810,23 @@ static unsigned amd64_get_op_estimated_cost(const ir_node *node)
 	return 1;
 }
 
+static unsigned amd64_get_op_latency(const ir_node *node)
+{
+	if (!is_amd64_irn(node))
+		return 1;
+
+	if (is_amd64_copyB_i(node)) {
+		unsigned const size = get_amd64_copyb_attr_const(node)->size;
+		return 20 + size * 4 / 3;
+	}
+
+	unsigned cost = get_amd64_latency(node);
+	/* memory operands go through the load pipeline */
+	if (amd64_loads(node))
+		cost += 4;
+	return cost;
+}
+
 /** we don't have a concept of aliasing registers, so enumerate them
  * manually for the asm nodes. */
 static be_register_name_t const amd64_additional_reg_names[] = {
@@ -828,6 +867,7 @@ arch_isa_if_t const amd64_isa_if = {
 	.additional_reg_names  = amd64_additional_reg_names,
 	.handle_intrinsics     = amd64_handle_intrinsics,
 	.get_op_estimated_cost = amd64_get_op_estimated_cost,
+	.get_op_latency        = amd64_get_op_latency,
 };
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_amd64)
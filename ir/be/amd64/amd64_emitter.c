@@ -22,6 +22,7 @@
 #include "beirg.h"
 #include "benode.h"
 #include "besched.h"
+#include "bestack.h"
 #include "gen_amd64_emitter.h"
 #include "gen_amd64_regalloc_if.h"
 #include "iredges_t.h"
@@ -31,7 +32,6 @@
 #include <inttypes.h>
 
 static bool omit_fp;
-static int  frame_type_size;
 static int  callframe_offset;
 
 static char get_gp_size_suffix(x86_insn_size_t const size)
@@ -225,11 +225,13 @@ static void amd64_emit_immediate64(const amd64_imm64_t *const imm)
 		return;
 	}
 	x86_emit_relocation_no_offset(imm->kind, imm->entity);
+	if (imm->offset > 0)
+		be_emit_char('+');
 	if (imm->offset != 0)
-		be_emit_irprintf("%+" PRId64, imm->offset);
+		be_emit_int(imm->offset);
 }
 
-static void amd64_emit_am(const ir_node *const node, bool indirect_star)
+void amd64_emit_am(const ir_node *const node, bool indirect_star)
 {
 	const amd64_addr_attr_t *const attr = get_amd64_addr_attr_const(node);
 
@@ -328,7 +330,9 @@ static void emit_shiftop(const ir_node *const node)
 
 	switch (attr->base.op_mode) {
 	case AMD64_OP_SHIFT_IMM: {
-		be_emit_irprintf("$%u, ", attr->immediate);
+		be_emit_char('$');
+		be_emit_int(attr->immediate);
+		be_emit_cstring(", ");
 		const arch_register_t *reg = arch_get_irn_register_in(node, 0);
 		emit_register_mode(reg, attr->base.size);
 		return;
@@ -347,162 +351,212 @@ static void emit_shiftop(const ir_node *const node)
 	panic("invalid op_mode for shiftop");
 }
 
-void amd64_emitf(ir_node const *const node, char const *fmt, ...)
+void amd64_emit_addr(ir_node const *const node)
 {
-	BE_EMITF(node, fmt, ap, false) {
-		amd64_emit_mod_t mod = EMIT_NONE;
-		for (;;) {
-			switch (*fmt) {
-			case '^': mod |= EMIT_IGNORE_MODE;   break;
-			case '3': mod |= EMIT_FORCE_32;      break;
-			case '#': mod |= EMIT_CONV_DEST;     break;
-			case '*': mod |= EMIT_INDIRECT_STAR; break;
-			default:
-				goto end_of_mods;
-			}
-			++fmt;
+	amd64_addr_attr_t const *const attr = get_amd64_addr_attr_const(node);
+	x86_emit_addr(node, &attr->addr);
+}
+
+void amd64_emit_insn_suffix(ir_node const *const node)
+{
+	amd64_attr_t const *const attr = get_amd64_attr_const(node);
+	amd64_emit_insn_size_suffix(attr->size);
+}
+
+void amd64_emit_xmm_suffix(ir_node const *const node)
+{
+	amd64_attr_t const *const attr = get_amd64_attr_const(node);
+	amd64_emit_xmm_size_suffix(attr->size);
+}
+
+void amd64_emit_in_register(ir_node const *const node, unsigned const pos)
+{
+	amd64_attr_t    const *const attr = get_amd64_attr_const(node);
+	arch_register_t const *const reg  = arch_get_irn_register_in(node, pos);
+	emit_register_mode(reg, attr->size);
+}
+
+void amd64_emit_out_register(ir_node const *const node, unsigned const pos)
+{
+	amd64_attr_t    const *const attr = get_amd64_attr_const(node);
+	arch_register_t const *const reg  = arch_get_irn_register_out(node, pos);
+	emit_register_mode(reg, attr->size);
+}
+
+/**
+ * Emits the conversion at @p *fmt_p and advances it behind the conversion.
+ */
+static void amd64_emit_conversion(ir_node const *const node,
+                                  char const **const fmt_p, va_list *const ap)
+{
+	char const *fmt = *fmt_p;
+	amd64_emit_mod_t mod = EMIT_NONE;
+	for (;;) {
+		switch (*fmt) {
+		case '^': mod |= EMIT_IGNORE_MODE;   break;
+		case '3': mod |= EMIT_FORCE_32;      break;
+		case '#': mod |= EMIT_CONV_DEST;     break;
+		case '*': mod |= EMIT_INDIRECT_STAR; break;
+		default:
+			goto end_of_mods;
 		}
+		++fmt;
+	}
 end_of_mods:
 
-		switch (*fmt++) {
-			arch_register_t const *reg;
-
-			case 'A':
-				switch (*fmt++) {
-				case 'F': {
-					x87_attr_t const *const attr
-						= amd64_get_x87_attr_const(node);
-					char const *const fmt
-						= attr->res_in_reg ? "%%st, %%%s" : "%%%s, %%st";
-					be_emit_irprintf(fmt, attr->reg->name);
-					break;
-				}
-				case 'M':
-					amd64_emit_am(node, mod & EMIT_INDIRECT_STAR);
-					break;
-				default: {
-					amd64_addr_attr_t const *const attr
-						= get_amd64_addr_attr_const(node);
-					x86_emit_addr(node, &attr->addr);
-					--fmt;
-				}
-				}
-				break;
+	switch (*fmt++) {
+		arch_register_t const *reg;
 
-			case 'C': {
-				amd64_movimm_attr_t const *const attr
-					= get_amd64_movimm_attr_const(node);
-				amd64_emit_immediate64(&attr->immediate);
+		case 'A':
+			switch (*fmt++) {
+			case 'F': {
+				x87_attr_t const *const attr
+					= amd64_get_x87_attr_const(node);
+				char const *const fmt
+					= attr->res_in_reg ? "%%st, %%%s" : "%%%s, %%st";
+				be_emit_irprintf(fmt, attr->reg->name);
 				break;
 			}
-
-			case 'D':
-				if (!is_digit(*fmt))
-					goto unknown;
-				reg = arch_get_irn_register_out(node, *fmt++ - '0');
-				goto emit_R;
-
-			case 'E': {
-				ir_entity const *const ent = va_arg(ap, ir_entity const*);
-				be_gas_emit_entity(ent);
+			case 'M':
+				amd64_emit_am(node, mod & EMIT_INDIRECT_STAR);
 				break;
+			default: {
+				amd64_addr_attr_t const *const attr
+					= get_amd64_addr_attr_const(node);
+				x86_emit_addr(node, &attr->addr);
+				--fmt;
+			}
 			}
+			break;
 
-			case 'F': {
-				if (*fmt == 'M') {
-					++fmt;
-					amd64_addr_attr_t const *const attr
-						= get_amd64_addr_attr_const(node);
-					amd64_emit_x87_size_suffix(attr->base.size);
-				} else if (*fmt == 'P') {
-					++fmt;
-					x87_attr_t const *const attr
-						= amd64_get_x87_attr_const(node);
-					if (attr->pop)
-						be_emit_char('p');
-				} else if (*fmt == '0') {
-					++fmt;
-					x87_attr_t const *const attr
-						= amd64_get_x87_attr_const(node);
-					be_emit_char('%');
-					be_emit_string(attr->reg->name);
-				} else if (*fmt == 'R') {
-					++fmt;
-					x87_attr_t const *const attr
-						= amd64_get_x87_attr_const(node);
-					/** see also ia32_emitter comment */
-					if (attr->reverse)
-						be_emit_char('r');
-				} else
-					goto unknown;
-				break;
+		case 'C': {
+			amd64_movimm_attr_t const *const attr
+				= get_amd64_movimm_attr_const(node);
+			amd64_emit_immediate64(&attr->immediate);
+			break;
+		}
+
+		case 'D':
+			if (!is_digit(*fmt))
+				goto unknown;
+			reg = arch_get_irn_register_out(node, *fmt++ - '0');
+			goto emit_R;
+
+		case 'E': {
+			ir_entity const *const ent = va_arg(*ap, ir_entity const*);
+			be_gas_emit_entity(ent);
+			break;
+		}
+
+		case 'F': {
+			if (*fmt == 'M') {
+				++fmt;
+				amd64_addr_attr_t const *const attr
+					= get_amd64_addr_attr_const(node);
+				amd64_emit_x87_size_suffix(attr->base.size);
+			} else if (*fmt == 'P') {
+				++fmt;
+				x87_attr_t const *const attr
+					= amd64_get_x87_attr_const(node);
+				if (attr->pop)
+					be_emit_char('p');
+			} else if (*fmt == '0') {
+				++fmt;
+				x87_attr_t const *const attr
+					= amd64_get_x87_attr_const(node);
+				be_emit_char('%');
+				be_emit_string(attr->reg->name);
+			} else if (*fmt == 'R') {
+				++fmt;
+				x87_attr_t const *const attr
+					= amd64_get_x87_attr_const(node);
+				/** see also ia32_emitter comment */
+				if (attr->reverse)
+					be_emit_char('r');
+			} else
+				goto unknown;
+			break;
+		}
+
+		case 'P': {
+			x86_condition_code_t cc;
+			if (*fmt == 'X') {
+				// Fetch cc from varargs
+				++fmt;
+				cc = (x86_condition_code_t)va_arg(*ap, int);
+			} else if (is_digit(*fmt)) {
+				// Format string is backwards compatible to IA32 backend.
+				// Fetch cc from node attributes
+				++fmt;
+				cc = get_amd64_cc_attr_const(node)->cc;
+			} else {
+				panic("unknown modifier");
 			}
+			x86_emit_condition_code(cc);
+			break;
+		}
+
+		case 'R':
+			reg = va_arg(*ap, arch_register_t const*);
+			goto emit_R;
 
-			case 'P': {
-				x86_condition_code_t cc;
-				if (*fmt == 'X') {
-					// Fetch cc from varargs
-					++fmt;
-					cc = (x86_condition_code_t)va_arg(ap, int);
-				} else if (is_digit(*fmt)) {
-					// Format string is backwards compatible to IA32 backend.
-					// Fetch cc from node attributes
-					++fmt;
-					cc = get_amd64_cc_attr_const(node)->cc;
-				} else {
-					panic("unknown modifier");
-				}
-				x86_emit_condition_code(cc);
+		case 'S': {
+			if (*fmt == 'O') {
+				++fmt;
+				emit_shiftop(node);
 				break;
 			}
-
-			case 'R':
-				reg = va_arg(ap, arch_register_t const*);
-				goto emit_R;
-
-			case 'S': {
-				if (*fmt == 'O') {
-					++fmt;
-					emit_shiftop(node);
-					break;
-				}
-				if (!is_digit(*fmt))
-					goto unknown;
-				int const pos = *fmt++ - '0';
-				reg = arch_get_irn_register_in(node, pos);
+			if (!is_digit(*fmt))
+				goto unknown;
+			int const pos = *fmt++ - '0';
+			reg = arch_get_irn_register_in(node, pos);
 emit_R:
-				if (mod & EMIT_IGNORE_MODE) {
-					emit_register(reg);
-				} else if (mod & EMIT_FORCE_32) {
-					emit_register_mode(reg, X86_SIZE_32);
-				} else if (mod & EMIT_CONV_DEST) {
-					amd64_attr_t const *const attr = get_amd64_attr_const(node);
-					x86_insn_size_t src_size  = attr->size;
-					x86_insn_size_t dest_size = src_size == X86_SIZE_64
-					                            ? X86_SIZE_64 : X86_SIZE_32;
-					emit_register_mode(reg, dest_size);
-				} else {
-					amd64_attr_t const *const attr = get_amd64_attr_const(node);
-					emit_register_mode(reg, attr->size);
-				}
-				break;
+			if (mod & EMIT_IGNORE_MODE) {
+				emit_register(reg);
+			} else if (mod & EMIT_FORCE_32) {
+				emit_register_mode(reg, X86_SIZE_32);
+			} else if (mod & EMIT_CONV_DEST) {
+				amd64_attr_t const *const attr = get_amd64_attr_const(node);
+				x86_insn_size_t src_size  = attr->size;
+				x86_insn_size_t dest_size = src_size == X86_SIZE_64
+				                            ? X86_SIZE_64 : X86_SIZE_32;
+				emit_register_mode(reg, dest_size);
+			} else {
+				amd64_attr_t const *const attr = get_amd64_attr_const(node);
+				emit_register_mode(reg, attr->size);
 			}
+			break;
+		}
 
-			case 'M': {
-				amd64_attr_t const *const attr = get_amd64_attr_const(node);
-				if (*fmt == 'X') {
-					++fmt;
-					amd64_emit_xmm_size_suffix(attr->size);
-				} else {
-					amd64_emit_insn_size_suffix(attr->size);
-				}
-				break;
+		case 'M': {
+			amd64_attr_t const *const attr = get_amd64_attr_const(node);
+			if (*fmt == 'X') {
+				++fmt;
+				amd64_emit_xmm_size_suffix(attr->size);
+			} else {
+				amd64_emit_insn_size_suffix(attr->size);
 			}
+			break;
+		}
 
-			default:
+		default:
 unknown:
-				panic("unknown format conversion");
-		}
+			panic("unknown format conversion");
+	}
+	*fmt_p = fmt;
+}
+
+void amd64_emitf(ir_node const *const node, char const *fmt, ...)
+{
+	BE_EMITF(node, fmt, ap, false) {
+		amd64_emit_conversion(node, &fmt, &ap);
+	}
+}
+
+void amd64_emitf_part(ir_node const *const node, char const *fmt, ...)
+{
+	BE_EMITF_PART(node, fmt, ap) {
+		amd64_emit_conversion(node, &fmt, &ap);
 	}
 }
 
@@ -830,12 +884,8 @@ static void amd64_gen_block(ir_node *block)
 	be_gas_begin_block(block);
 
 	if (omit_fp) {
-		ir_graph *irg = get_irn_irg(block);
-		callframe_offset = 8; /* 8 bytes for the return address */
-		/* RSP guessing, TODO perform a real RSP simulation */
-		if (block != get_irg_start_block(irg)) {
-			callframe_offset += frame_type_size;
-		}
+		/* 8 bytes for the return address */
+		callframe_offset = 8 + be_get_block_sp_offset(block);
 		be_dwarf_callframe_offset(callframe_offset);
 	}
 
@@ -872,8 +922,6 @@ void amd64_emit_function(ir_graph *irg)
 	omit_fp = irg_data->omit_fp;
 
 	if (omit_fp) {
-		ir_type *frame_type = get_irg_frame_type(irg);
-		frame_type_size = get_type_size(frame_type);
 		be_dwarf_callframe_register(&amd64_registers[REG_RSP]);
 	} else {
 		/* well not entirely correct here, we should emit this after the
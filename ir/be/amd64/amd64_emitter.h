@@ -11,6 +11,7 @@
 #define FIRM_BE_AMD64_AMD64_EMITTER_H
 
 #include "firm_types.h"
+#include <stdbool.h>
 
 /**
  * fmt  parameter               output
@@ -26,6 +27,24 @@
  */
 void amd64_emitf(ir_node const *node, char const *fmt, ...);
 
+/**
+ * Like amd64_emitf() but appends to the current line without finishing it.
+ */
+void amd64_emitf_part(ir_node const *node, char const *fmt, ...);
+
+/**
+ * @{
+ * Emit single operands, used by the generated emitters instead of the
+ * amd64_emitf() conversions %A, %AM, %D, %M, %MX and %S.
+ */
+void amd64_emit_addr(ir_node const *node);
+void amd64_emit_am(ir_node const *node, bool indirect_star);
+void amd64_emit_in_register(ir_node const *node, unsigned pos);
+void amd64_emit_insn_suffix(ir_node const *node);
+void amd64_emit_out_register(ir_node const *node, unsigned pos);
+void amd64_emit_xmm_suffix(ir_node const *node);
+/** @} */
+
 void amd64_emit_function(ir_graph *irg);
 
 #endif
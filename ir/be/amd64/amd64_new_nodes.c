@@ -28,6 +28,8 @@
 #include <inttypes.h>
 #include <stdlib.h>
 
+struct obstack amd64_opcodes_obst;
+
 x87_attr_t *amd64_get_x87_attr(ir_node *const node)
 {
 	amd64_attr_t const *const attr = get_amd64_attr_const(node);
@@ -90,6 +92,7 @@ void amd64_dump_node(FILE *F, const ir_node *n, dump_reason_t reason)
 		amd64_op_mode_t const op_mode = attr->op_mode;
 		fprintf(F, "mode = %s\n", get_op_mode_string(op_mode));
 		fprintf(F, "size = %u\n", x86_bytes_from_size(attr->size));
+		fprintf(F, "latency = %u\n", get_amd64_latency(n));
 		switch (op_mode) {
 		case AMD64_OP_ADDR_REG:
 		case AMD64_OP_REG_ADDR: {
@@ -254,3 +257,18 @@ int amd64_x87_binop_addr_attrs_equal(const ir_node *const a,
 	/* ignore x87 part for now */
 	return amd64_binop_addr_attrs_equal(a, b);
 }
+
+unsigned get_amd64_latency(const ir_node *node)
+{
+	assert(is_amd64_irn(node));
+	const ir_op           *op      = get_irn_op(node);
+	const amd64_op_attr_t *op_attr = (amd64_op_attr_t*)get_op_attr(op);
+	return op_attr->latency;
+}
+
+void amd64_init_op(ir_op *op, unsigned latency)
+{
+	amd64_op_attr_t *attr = OALLOCZ(&amd64_opcodes_obst, amd64_op_attr_t);
+	attr->latency = latency;
+	set_op_attr(op, attr);
+}
@@ -201,6 +201,13 @@ static inline amd64_x87_binop_addr_attr_t *get_amd64_x87_binop_addr_attr(
 x87_attr_t *amd64_get_x87_attr(ir_node *node);
 x87_attr_t const *amd64_get_x87_attr_const(ir_node const *node);
 
+/**
+ * Gets the instruction latency.
+ */
+unsigned get_amd64_latency(const ir_node *node);
+
+extern struct obstack amd64_opcodes_obst;
+
 /* Include the generated headers */
 #include "gen_amd64_new_nodes.h"
 
@@ -50,6 +50,10 @@ typedef struct amd64_imm64_t {
 	ENUMBF(x86_immediate_kind_t) kind : 8;
 } amd64_imm64_t;
 
+typedef struct amd64_op_attr_t {
+	unsigned latency;
+} amd64_op_attr_t;
+
 typedef struct amd64_attr_t {
 	except_attr exc; /**< the exception attribute. MUST be the first one. */
 	ENUMBF(amd64_op_mode_t) op_mode : 5;
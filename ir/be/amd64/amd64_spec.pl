@@ -73,6 +73,18 @@ $mode_x87   = "x86_mode_E";
 	commutative => "(arch_irn_flags_t)amd64_arch_irn_flag_commutative_binop",
 );
 
+# Emit template conversions translated into direct calls by the emitter
+# generator (see generate_emitter.pl).
+%emit_conversions = (
+	'A(?![FM])' => 'amd64_emit_addr(node)',
+	'AM'        => 'amd64_emit_am(node, false)',
+	'\*AM'      => 'amd64_emit_am(node, true)',
+	'D(\d)'     => 'amd64_emit_out_register(node, $1)',
+	'M'         => 'amd64_emit_insn_suffix(node)',
+	'MX'        => 'amd64_emit_xmm_suffix(node)',
+	'S(\d)'     => 'amd64_emit_in_register(node, $1)',
+);
+
 %init_attr = (
 	amd64_attr_t =>
 		"init_amd64_attributes(res, op_mode, size);",
@@ -386,18 +398,31 @@ cqto => {
 	           ."x86_insn_size_t size    = X86_SIZE_64;\n",
 },
 
-div => { template => $divop },
+div => {
+	template => $divop,
+	latency  => 26,
+},
 
-idiv => { template => $divop },
+idiv => {
+	template => $divop,
+	latency  => 26,
+},
 
-imul => { template => $binop_commutative },
+imul => {
+	template => $binop_commutative,
+	latency  => 3,
+},
 
 imul_1op => {
 	template => $mulop,
 	name     => "imul",
+	latency  => 3,
 },
 
-mul => { template => $mulop },
+mul => {
+	template => $mulop,
+	latency  => 3,
+},
 
 or => { template => $binop_commutative },
 
@@ -492,6 +517,7 @@ cmpxchg => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "lock cmpxchg%M %AM",
+	latency   => 5,
 },
 
 # TODO Setcc can also operate on memory
@@ -572,17 +598,27 @@ ret => {
 	emit     => "ret",
 },
 
-bsf => { template => $unop_out },
+bsf => {
+	template => $unop_out,
+	latency  => 3,
+},
 
-bsr => { template => $unop_out },
+bsr => {
+	template => $unop_out,
+	latency  => 3,
+},
 
 # SSE
 
-adds => { template => $binopx_commutative },
+adds => {
+	template => $binopx_commutative,
+	latency  => 4,
+},
 
 divs => {
 	template => $binopx,
 	emit     => "divs%MX %AM",
+	latency  => 13,
 },
 
 movs_xmm => {
@@ -591,7 +627,10 @@ movs_xmm => {
 	emit     => "movs%MX %AM, %D0",
 },
 
-muls => { template => $binopx_commutative },
+muls => {
+	template => $binopx_commutative,
+	latency  => 4,
+},
 
 movs_store_xmm => {
 	op_flags  => [ "uses_memory" ],
@@ -607,6 +646,7 @@ movs_store_xmm => {
 subs => {
 	template => $binopx,
 	emit     => "subs%MX %AM",
+	latency  => 4,
 },
 
 ucomis => {
@@ -618,6 +658,7 @@ ucomis => {
 	attr_type => "amd64_binop_addr_attr_t",
 	attr      => "const amd64_binop_addr_attr_t *attr_init",
 	emit      => "ucomis%MX %AM",
+	latency   => 2,
 },
 
 xorp_0 => {
@@ -640,7 +681,8 @@ movd_xmm_gp => {
 	out_reqs  => [ "gp" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
-	emit      => "movd %S0, %D0"
+	emit      => "movd %S0, %D0",
+	latency   => 2,
 },
 
 movd_gp_xmm => {
@@ -651,7 +693,8 @@ movd_gp_xmm => {
 	out_reqs  => [ "xmm" ],
 	attr_type => "amd64_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
-	emit      => "movd %S0, %D0"
+	emit      => "movd %S0, %D0",
+	latency   => 2,
 },
 
 pxor_0 => {
@@ -666,21 +709,37 @@ pxor_0 => {
 
 # Conversion operations
 
-cvtss2sd => { template => $cvtop2x },
+cvtss2sd => {
+	template => $cvtop2x,
+	latency  => 4,
+},
 
 cvtsd2ss => {
 	template => $cvtop2x,
 	attr     => "amd64_op_mode_t op_mode, x86_addr_t addr",
 	fixed    => "x86_insn_size_t size = X86_SIZE_64;\n",
+	latency  => 4,
 },
 
-cvttsd2si => { template => $cvtopx2i },
+cvttsd2si => {
+	template => $cvtopx2i,
+	latency  => 6,
+},
 
-cvttss2si => { template => $cvtopx2i },
+cvttss2si => {
+	template => $cvtopx2i,
+	latency  => 6,
+},
 
-cvtsi2ss => { template => $cvtop2x },
+cvtsi2ss => {
+	template => $cvtop2x,
+	latency  => 4,
+},
 
-cvtsi2sd => { template => $cvtop2x },
+cvtsi2sd => {
+	template => $cvtop2x,
+	latency  => 4,
+},
 
 movd => {
 	template => $movopx,
@@ -754,9 +813,15 @@ l_haddpd => {
 
 punpckldq => { template => $binopx },
 
-subpd => { template => $binopx },
+subpd => {
+	template => $binopx,
+	latency  => 4,
+},
 
-haddpd => { template => $binopx },
+haddpd => {
+	template => $binopx,
+	latency  => 6,
+},
 
 fldz => { template => $x87const },
 
@@ -784,6 +849,7 @@ fild => {
 	attr_type => "amd64_x87_addr_attr_t",
 	attr      => "x86_insn_size_t size, amd64_op_mode_t op_mode, x86_addr_t addr",
 	emit      => "fild%M %AM",
+	latency   => 6,
 },
 
 fisttp => {
@@ -804,21 +870,25 @@ fstp => {
 fadd => {
 	template => $x87binop,
 	emit     => "fadd%FP %AF",
+	latency  => 3,
 },
 
 fdiv => {
 	template => $x87binop,
 	emit     => "fdiv%FR%FP %AF",
+	latency  => 20,
 },
 
 fmul => {
 	template => $x87binop,
 	emit     => "fmul%FP %AF",
+	latency  => 5,
 },
 
 fsub => {
 	template => $x87binop,
 	emit     => "fsub%FR%FP %AF",
+	latency  => 3,
 },
 
 fchs => { template => $x87unop },
@@ -866,8 +936,40 @@ fpop => {
 
 # FMA instructions
 
-vfmadd132s => { template => $fmaop },
-vfmadd213s => { template => $fmaop },
-vfmadd231s => { template => $fmaop },
+vfmadd132s => {
+	template => $fmaop,
+	latency  => 4,
+},
+vfmadd213s => {
+	template => $fmaop,
+	latency  => 4,
+},
+vfmadd231s => {
+	template => $fmaop,
+	latency  => 4,
+},
 
 );
+
+# Transform some attributes
+foreach my $op (keys(%nodes)) {
+	my $node         = $nodes{$op};
+	my $op_attr_init = $node->{op_attr_init};
+
+	if (defined($op_attr_init)) {
+		$op_attr_init .= "\n\t";
+	} else {
+		$op_attr_init = "";
+	}
+
+	# Instructions without explicit latency are assumed to take a single cycle
+	my $latency = $node->{latency};
+	if (!defined($latency)) {
+		$latency = $op =~ m/^l_/ ? 0 : 1;
+	}
+	$op_attr_init .= "amd64_init_op(op, $latency);";
+
+	$node->{op_attr_init} = $op_attr_init;
+}
+
+print "";
@@ -210,13 +210,13 @@ static const ir_settings_arch_dep_t arm_arch_dep = {
 	.replace_muls         = true,
 	.replace_divs         = true,
 	.replace_mods         = true,
-	.allow_mulhs          = false,
-	.allow_mulhu          = false,
+	.allow_mulhs          = true,
+	.allow_mulhu          = true,
 	.also_use_subs        = true,
 	.maximum_shifts       = 1,
 	.highest_shift_amount = 63,
 	.evaluate             = NULL,
-	.max_bits_for_mulh    = ARM_MACHINE_SIZE,
+	.max_bits_for_mulh    = 2 * ARM_MACHINE_SIZE,
 };
 
 static void arm_lower_for_target(void)
@@ -242,9 +242,10 @@ static void arm_lower_for_target(void)
 		be_after_irp_transform("lower-fp");
 	}
 
-	ir_builtin_kind supported[1];
+	ir_builtin_kind supported[2];
 	size_t s = 0;
 	supported[s++] = ir_bk_clz;
+	supported[s++] = ir_bk_saturating_increment;
 	assert(s <= ARRAY_SIZE(supported));
 	lower_builtins(s, supported, NULL);
 	be_after_irp_transform("lower-builtins");
@@ -16,6 +16,7 @@
 #include "be_t.h"
 #include "beasm.h"
 #include "beblocksched.h"
+#include "becache.h"
 #include "bediagnostic.h"
 #include "beemithlp.h"
 #include "beemitter.h"
@@ -219,6 +220,7 @@ static void arm_emit_shifter_operand(const ir_node *node)
 static unsigned get_unique_label(void)
 {
 	static unsigned id = 0;
+	be_cache_mark_unreproducible();
 	return ++id;
 }
 
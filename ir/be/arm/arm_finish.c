@@ -135,7 +135,7 @@ void arm_finish_graph(ir_graph *irg)
 	ir_type *const frame = get_irg_frame_type(irg);
 	be_sort_frame_entities(frame, omit_fp);
 	unsigned const misalign = 0;
-	be_layout_frame_type(frame, 0, misalign);
+	be_layout_frame_type(frame, 0, misalign, omit_fp);
 
 	introduce_prolog_epilog(irg);
 
@@ -80,6 +80,13 @@ static void lower64_minus(ir_node *const node)
 	ir_set_dw_lowered(node, res_low, sbc);
 }
 
+/**
+ * Lowers a Mul:
+ * res_low  = left_low * right_low
+ * res_high = umulh(left_low, right_low) + left_high * right_low
+ *          + left_low * right_high
+ * The products with a high word are omitted if it is known to be zero.
+ */
 static void lower64_mul(ir_node *const node)
 {
 	dbg_info *dbgi       = get_irn_dbg_info(node);
@@ -87,21 +94,156 @@ static void lower64_mul(ir_node *const node)
 	ir_node  *left       = get_Mul_left(node);
 	ir_node  *right      = get_Mul_right(node);
 	ir_node  *left_low   = get_lowered_low(left);
-	ir_node  *left_high  = get_lowered_high(left);
 	ir_node  *right_low  = get_lowered_low(right);
-	ir_node  *right_high = get_lowered_high(right);
 	ir_mode  *mode       = get_node_high_mode(node);
-	ir_node  *conv_l_low = new_rd_Conv(dbgi, block, left_low, mode);
-	ir_node  *mul1       = new_rd_Mul(dbgi, block, conv_l_low, right_high);
 	ir_node  *umull      = new_bd_arm_UMulL_t(dbgi, block, left_low, right_low);
 	ir_mode  *umode      = get_irn_mode(right_low);
 	ir_node  *umull_low  = new_r_Proj(umull, umode, pn_arm_UMulL_t_low);
-	ir_node  *umull_high = new_r_Proj(umull, mode, pn_arm_UMulL_t_high);
-	ir_node  *conv_r_low = new_rd_Conv(dbgi, block, right_low, mode);
-	ir_node  *mul2       = new_rd_Mul(dbgi, block, conv_r_low, left_high);
-	ir_node  *add1       = new_rd_Add(dbgi, block, mul2, mul1);
-	ir_node  *add2       = new_rd_Add(dbgi, block, add1, umull_high);
-	ir_set_dw_lowered(node, umull_low, add2);
+	ir_node  *res_high   = new_r_Proj(umull, mode, pn_arm_UMulL_t_high);
+	if (!is_high_word_zero(right)) {
+		ir_node *conv_l_low = new_rd_Conv(dbgi, block, left_low, mode);
+		ir_node *mul1       = new_rd_Mul(dbgi, block, conv_l_low, get_lowered_high(right));
+		res_high = new_rd_Add(dbgi, block, mul1, res_high);
+	}
+	if (!is_high_word_zero(left)) {
+		ir_node *conv_r_low = new_rd_Conv(dbgi, block, right_low, mode);
+		ir_node *mul2       = new_rd_Mul(dbgi, block, conv_r_low, get_lowered_high(left));
+		res_high = new_rd_Add(dbgi, block, mul2, res_high);
+	}
+	ir_set_dw_lowered(node, umull_low, res_high);
+}
+
+/** Creates the double-word product of two words as @p low and @p high. */
+static void create_umull(dbg_info *const dbgi, ir_node *const block,
+                         ir_node *const left, ir_node *const right,
+                         ir_node **const low, ir_node **const high)
+{
+	ir_node *umull = new_bd_arm_UMulL_t(dbgi, block, left, right);
+	ir_mode *umode = get_irn_mode(left);
+	*low  = new_r_Proj(umull, umode, pn_arm_UMulL_t_low);
+	*high = new_r_Proj(umull, umode, pn_arm_UMulL_t_high);
+}
+
+/** Adds the word @p word to the double-word @p low, @p high. */
+static void add_word(dbg_info *const dbgi, ir_node *const block,
+                     ir_node **const low, ir_node **const high,
+                     ir_node *const word)
+{
+	ir_mode  *umode = get_irn_mode(word);
+	ir_graph *irg   = get_irn_irg(block);
+	ir_node  *zero  = new_r_Const_null(irg, umode);
+	ir_node  *adds  = new_bd_arm_AddS_t(dbgi, block, *low, word);
+	ir_node  *flags = new_r_Proj(adds, mode_ANY, pn_arm_AddS_t_flags);
+	*low  = new_r_Proj(adds, umode, pn_arm_AddS_t_res);
+	*high = new_bd_arm_AdC_t(dbgi, block, *high, zero, flags, umode);
+}
+
+/**
+ * Lowers a Mulh: The high double-word of the product is assembled from the
+ * four products of the words, the carries are propagated with AddS/AdC.
+ * For signed operands each operand is subtracted from the unsigned result if
+ * the other one is negative.
+ */
+static void lower64_mulh(ir_node *const node)
+{
+	dbg_info *dbgi       = get_irn_dbg_info(node);
+	ir_node  *block      = get_nodes_block(node);
+	ir_node  *left       = get_Mulh_left(node);
+	ir_node  *right      = get_Mulh_right(node);
+	ir_node  *left_low   = get_lowered_low(left);
+	ir_node  *right_low  = get_lowered_low(right);
+	ir_mode  *umode      = get_irn_mode(left_low);
+	ir_node  *left_high  = get_lowered_high(left);
+	ir_node  *right_high = get_lowered_high(right);
+	ir_mode  *mode       = get_node_high_mode(node);
+	if (mode != umode) {
+		left_high  = new_rd_Conv(dbgi, block, left_high, umode);
+		right_high = new_rd_Conv(dbgi, block, right_high, umode);
+	}
+
+	/* t = left_low * right_high + umulh(left_low, right_low) */
+	ir_node *ll_rl_l;
+	ir_node *ll_rl_h;
+	ir_node *t_low;
+	ir_node *t_high;
+	create_umull(dbgi, block, left_low, right_low, &ll_rl_l, &ll_rl_h);
+	create_umull(dbgi, block, left_low, right_high, &t_low, &t_high);
+	add_word(dbgi, block, &t_low, &t_high, ll_rl_h);
+
+	/* u = left_high * right_low + t_low */
+	ir_node *u_low;
+	ir_node *u_high;
+	create_umull(dbgi, block, left_high, right_low, &u_low, &u_high);
+	add_word(dbgi, block, &u_low, &u_high, t_low);
+
+	/* res = left_high * right_high + t_high + u_high */
+	ir_node *res_low;
+	ir_node *res_high;
+	create_umull(dbgi, block, left_high, right_high, &res_low, &res_high);
+	add_word(dbgi, block, &res_low, &res_high, t_high);
+	add_word(dbgi, block, &res_low, &res_high, u_high);
+
+	if (mode_is_signed(mode)) {
+		/* res -= (left < 0 ? right : 0) + (right < 0 ? left : 0) */
+		ir_graph *irg   = get_irn_irg(node);
+		ir_node  *c31   = new_r_Const_long(irg, umode, 31);
+		ir_node  *const operands[][3] = {
+			{ left_high,  right_low, right_high },
+			{ right_high, left_low,  left_high  },
+		};
+		for (size_t i = 0; i < ARRAY_SIZE(operands); ++i) {
+			ir_node *sign  = new_rd_Shrs(dbgi, block, operands[i][0], c31);
+			ir_node *sub_l = new_rd_And(dbgi, block, sign, operands[i][1]);
+			ir_node *sub_h = new_rd_And(dbgi, block, sign, operands[i][2]);
+			ir_node *subs  = new_bd_arm_SubS_t(dbgi, block, res_low, sub_l);
+			ir_node *flags = new_r_Proj(subs, mode_ANY, pn_arm_SubS_t_flags);
+			res_low  = new_r_Proj(subs, umode, pn_arm_SubS_t_res);
+			res_high = new_bd_arm_SbC_t(dbgi, block, res_high, sub_h, flags,
+			                            umode);
+		}
+		res_high = new_rd_Conv(dbgi, block, res_high, mode);
+	}
+	ir_set_dw_lowered(node, res_low, res_high);
+}
+
+/**
+ * Lowers a saturating increment without Mux:
+ * (low, high) = x + 1, then add -1 to both words if both are zero.
+ */
+static void lower64_builtin(ir_node *const node)
+{
+	if (get_Builtin_kind(node) != ir_bk_saturating_increment) {
+		ir_default_lower_dw_Builtin(node);
+		return;
+	}
+	ir_node *const proj = get_Proj_for_pn(node, pn_Builtin_max + 1);
+	if (proj == NULL)
+		return;
+
+	dbg_info *dbgi     = get_irn_dbg_info(node);
+	ir_graph *irg      = get_irn_irg(node);
+	ir_node  *block    = get_nodes_block(node);
+	ir_node  *op       = get_Builtin_param(node, 0);
+	ir_node  *op_low   = get_lowered_low(op);
+	ir_mode  *umode    = get_irn_mode(op_low);
+	ir_mode  *mode     = get_node_high_mode(proj);
+	ir_node  *op_high  = new_rd_Conv(dbgi, block, get_lowered_high(op), umode);
+	ir_node  *one      = new_r_Const_one(irg, umode);
+	ir_node  *zero     = new_r_Const_null(irg, umode);
+	ir_node  *adds     = new_bd_arm_AddS_t(dbgi, block, op_low, one);
+	ir_node  *inc_low  = new_r_Proj(adds, umode, pn_arm_AddS_t_res);
+	ir_node  *flags    = new_r_Proj(adds, mode_ANY, pn_arm_AddS_t_flags);
+	ir_node  *inc_high = new_bd_arm_AdC_t(dbgi, block, op_high, zero, flags,
+	                                      umode);
+	/* mask = (inc_low | inc_high) == 0 ? -1 : 0 */
+	ir_node  *inc_or   = new_rd_Or(dbgi, block, inc_low, inc_high);
+	ir_node  *neg      = new_rd_Minus(dbgi, block, inc_or);
+	ir_node  *nonzero  = new_rd_Or(dbgi, block, inc_or, neg);
+	ir_node  *c31      = new_r_Const_long(irg, mode_Iu, 31);
+	ir_node  *sign     = new_rd_Shrs(dbgi, block, new_rd_Not(dbgi, block, nonzero), c31);
+	ir_node  *res_low  = new_rd_Add(dbgi, block, inc_low, sign);
+	ir_node  *res_high = new_rd_Add(dbgi, block, inc_high, sign);
+	ir_set_dw_lowered(proj, res_low, new_rd_Conv(dbgi, block, res_high, mode));
 }
 
 static ir_entity *ldivmod;
@@ -336,14 +478,16 @@ void arm_lower_64bit(void)
 	arm_create_opcodes();
 
 	ir_prepare_dw_lowering(&lower_dw_params);
-	ir_register_dw_lower_function(op_Add,   lower64_add);
-	ir_register_dw_lower_function(op_Div,   lower64_div);
-	ir_register_dw_lower_function(op_Minus, lower64_minus);
-	ir_register_dw_lower_function(op_Mod,   lower64_mod);
-	ir_register_dw_lower_function(op_Mul,   lower64_mul);
-	ir_register_dw_lower_function(op_Shl,   lower64_shl);
-	ir_register_dw_lower_function(op_Shr,   lower64_shr);
-	ir_register_dw_lower_function(op_Shrs,  lower64_shrs);
-	ir_register_dw_lower_function(op_Sub,   lower64_sub);
+	ir_register_dw_lower_function(op_Add,     lower64_add);
+	ir_register_dw_lower_function(op_Builtin, lower64_builtin);
+	ir_register_dw_lower_function(op_Div,     lower64_div);
+	ir_register_dw_lower_function(op_Minus,   lower64_minus);
+	ir_register_dw_lower_function(op_Mod,     lower64_mod);
+	ir_register_dw_lower_function(op_Mul,     lower64_mul);
+	ir_register_dw_lower_function(op_Mulh,    lower64_mulh);
+	ir_register_dw_lower_function(op_Shl,     lower64_shl);
+	ir_register_dw_lower_function(op_Shr,     lower64_shr);
+	ir_register_dw_lower_function(op_Shrs,    lower64_shrs);
+	ir_register_dw_lower_function(op_Sub,     lower64_sub);
 	ir_lower_dw_ops();
 }
@@ -699,6 +699,25 @@ static ir_node *gen_Mul(ir_node *node)
 	}
 }
 
+static ir_node *gen_Mulh(ir_node *node)
+{
+	ir_mode *mode = get_irn_mode(node);
+	if (get_mode_size_bits(mode) != get_mode_size_bits(arm_mode_gp))
+		panic("Mulh of %+F not lowered", mode);
+
+	ir_node  *block     = be_transform_nodes_block(node);
+	ir_node  *new_left  = be_transform_node(get_Mulh_left(node));
+	ir_node  *new_right = be_transform_node(get_Mulh_right(node));
+	dbg_info *dbgi      = get_irn_dbg_info(node);
+	if (mode_is_signed(mode)) {
+		ir_node *smull = new_bd_arm_SMulL(dbgi, block, new_left, new_right);
+		return be_new_Proj(smull, pn_arm_SMulL_high);
+	} else {
+		ir_node *umull = new_bd_arm_UMulL(dbgi, block, new_left, new_right);
+		return be_new_Proj(umull, pn_arm_UMulL_high);
+	}
+}
+
 static ir_node *gen_arm_UMulL_t(ir_node *node)
 {
 	ir_node  *block     = be_transform_nodes_block(node);
@@ -1379,6 +1398,19 @@ static ir_node *gen_clz(ir_node *node)
 	return new_bd_arm_Clz(dbg, block, new_op);
 }
 
+/**
+ * Transform saturating increment: x + (~x >= 1)
+ */
+static ir_node *gen_saturating_increment(ir_node *node)
+{
+	dbg_info *dbgi    = get_irn_dbg_info(node);
+	ir_node  *block   = be_transform_nodes_block(node);
+	ir_node  *operand = be_transform_node(get_Builtin_param(node, 0));
+	ir_node  *not     = new_bd_arm_Mvn_reg(dbgi, block, operand);
+	ir_node  *cmp     = new_bd_arm_Cmp_imm(dbgi, block, not, 1, 0, false, true);
+	return new_bd_arm_AdC_imm(dbgi, block, operand, cmp, 0, 0);
+}
+
 /**
  * Transform Builtin node.
  */
@@ -1395,13 +1427,14 @@ static ir_node *gen_Builtin(ir_node *node)
 		break;
 	case ir_bk_clz:
 		return gen_clz(node);
+	case ir_bk_saturating_increment:
+		return gen_saturating_increment(node);
 	case ir_bk_ctz:
 	case ir_bk_parity:
 	case ir_bk_popcount:
 	case ir_bk_bswap:
 	case ir_bk_outport:
 	case ir_bk_inport:
-	case ir_bk_saturating_increment:
 	case ir_bk_compare_swap:
 	case ir_bk_may_alias:
 	case ir_bk_va_start:
@@ -1429,6 +1462,7 @@ static ir_node *gen_Proj_Builtin(ir_node *proj)
 	case ir_bk_parity:
 	case ir_bk_popcount:
 	case ir_bk_bswap:
+	case ir_bk_saturating_increment:
 		assert(get_Proj_num(proj) == pn_Builtin_max+1);
 		return new_node;
 	case ir_bk_trap:
@@ -1438,7 +1472,6 @@ static ir_node *gen_Proj_Builtin(ir_node *proj)
 		assert(get_Proj_num(proj) == pn_Builtin_M);
 		return new_node;
 	case ir_bk_inport:
-	case ir_bk_saturating_increment:
 	case ir_bk_compare_swap:
 	case ir_bk_may_alias:
 	case ir_bk_va_start:
@@ -2072,6 +2105,7 @@ static void arm_register_transformers(void)
 	be_set_transform_function(op_Member,      gen_Member);
 	be_set_transform_function(op_Minus,       gen_Minus);
 	be_set_transform_function(op_Mul,         gen_Mul);
+	be_set_transform_function(op_Mulh,        gen_Mulh);
 	be_set_transform_function(op_Not,         gen_Not);
 	be_set_transform_function(op_Or,          gen_Or);
 	be_set_transform_function(op_Phi,         gen_Phi);
@@ -37,7 +37,11 @@ struct be_options_t {
 	bool timing;               /**< time the backend phases */
 	bool opt_profile_generate; /**< instrument code for profiling */
 	bool opt_profile_use;      /**< use existing profile data */
+	bool opt_reorder_funcs;    /**< order functions by profiled call chains */
+	char order_file[1024];     /**< linker function order file to write */
 	bool omit_fp;              /**< try to omit the frame pointer */
+	bool shrink_wrap;          /**< sink the stack frame setup */
+	bool post_sched;           /**< schedule again after register allocation */
 	bool do_verify;            /**< backend verify option */
 	char ilp_solver[128];      /**< the ilp solver name */
 	bool verbose_asm;          /**< dump verbose assembler */
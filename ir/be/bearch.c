@@ -125,6 +125,14 @@ arch_register_t const *arch_find_register(char const *const name)
 	return NULL;
 }
 
+unsigned arch_get_op_latency(ir_node const *const node)
+{
+	arch_isa_if_t const *const isa = ir_target.isa;
+	if (isa->get_op_latency != NULL)
+		return isa->get_op_latency(node);
+	return isa->get_op_estimated_cost(node);
+}
+
 void arch_set_additional_pressure(ir_node *const node,
                                   arch_register_class_t const *const cls,
                                   be_add_pressure_t const pressure)
@@ -322,6 +322,12 @@ struct arch_isa_if_t {
 	 * number of cycles necessary to execute the instruction.
 	 */
 	unsigned (*get_op_estimated_cost)(const ir_node *irn);
+
+	/**
+	 * Get the latency of node @p irn in cycles, as used by the schedulers.
+	 * May be NULL, then get_op_estimated_cost() is used instead.
+	 */
+	unsigned (*get_op_latency)(const ir_node *irn);
 };
 
 static inline bool arch_irn_is_ignore(const ir_node *irn)
@@ -339,6 +345,11 @@ static inline bool arch_irn_consider_in_reg_alloc(
 
 arch_register_t const *arch_find_register(char const *name);
 
+/**
+ * Returns the latency of @p node in cycles as seen by the schedulers.
+ */
+unsigned arch_get_op_latency(ir_node const *node);
+
 #define be_foreach_value(node, value, code) \
 	do { \
 		if (get_irn_mode(node) == mode_T) { \
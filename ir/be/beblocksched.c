@@ -18,6 +18,11 @@
  * to change as many edges to fallthroughs as possible, this is done by setting
  * a next and prev pointers on blocks. The greedy algorithm sorts the edges by
  * execution frequencies and tries to transform them to fallthroughs in this order
+ *
+ * The alternative extended TSP algorithm (Newell, Pupyrev: "Improved Basic Block
+ * Reordering", 2020) additionally rewards short forward and backward jumps. It
+ * starts with a chain per block and repeatedly merges the two chains (possibly
+ * splitting one of them) which yield the largest gain of the ExtTSP score.
  */
 #include "beblocksched.h"
 
@@ -31,11 +36,37 @@
 #include "irgmod.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "irtools.h"
+#include "lc_opts.h"
+#include "lc_opts_enum.h"
 #include "pdeq.h"
+#include "statev_t.h"
 #include "util.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
+typedef enum blocksched_algo_t {
+	BLOCKSCHED_GREEDY,
+	BLOCKSCHED_EXTTSP,
+} blocksched_algo_t;
+
+static int algo = BLOCKSCHED_GREEDY;
+
+static const lc_opt_enum_int_items_t algo_items[] = {
+	{ "greedy", BLOCKSCHED_GREEDY },
+	{ "exttsp", BLOCKSCHED_EXTTSP },
+	{ NULL,     0 }
+};
+
+static lc_opt_enum_int_var_t algo_var = {
+	&algo, algo_items
+};
+
+static const lc_opt_table_entry_t blocksched_options[] = {
+	LC_OPT_ENT_ENUM_INT("algo", "the block scheduling algorithm", &algo_var),
+	LC_OPT_LAST
+};
+
 static bool blocks_removed;
 
 /**
@@ -532,7 +563,608 @@ static ir_node **create_blocksched_array(blocksched_env_t *const env)
 	return block_list;
 }
 
-ir_node **be_create_block_schedule(ir_graph *irg)
+/* Parameters of the ExtTSP score, taken from the paper. */
+#define EXTTSP_FALLTHROUGH_WEIGHT 1.0
+#define EXTTSP_FORWARD_WEIGHT     0.1
+#define EXTTSP_BACKWARD_WEIGHT    0.1
+#define EXTTSP_FORWARD_DISTANCE   1024
+#define EXTTSP_BACKWARD_DISTANCE  640
+/** Chains longer than this are not split during merging. */
+#define EXTTSP_SPLIT_THRESHOLD    128
+/** Estimated size of a single instruction in bytes. */
+#define EXTTSP_INSN_SIZE          4
+
+typedef struct tsp_chain_t      tsp_chain_t;
+typedef struct tsp_chain_edge_t tsp_chain_edge_t;
+
+typedef struct tsp_block_t {
+	ir_node     *block;
+	tsp_chain_t *chain;  /**< the chain containing the block */
+	unsigned     size;   /**< estimated code size in bytes */
+	unsigned     offset; /**< address in the layout currently evaluated */
+	double       freq;   /**< execution frequency */
+} tsp_block_t;
+
+/** A control flow edge between two blocks. */
+typedef struct tsp_jump_t {
+	tsp_block_t *src;
+	tsp_block_t *dst;
+	double       freq;
+} tsp_jump_t;
+
+/** The ways to merge chain Y into chain X = X1 X2 split at some position. */
+typedef enum tsp_merge_type_t {
+	MERGE_X_Y,
+	MERGE_Y_X,
+	MERGE_X1_Y_X2,
+	MERGE_Y_X2_X1,
+	MERGE_X2_X1_Y,
+} tsp_merge_type_t;
+
+/** Jumps between two chains together with the best way to merge them. */
+struct tsp_chain_edge_t {
+	tsp_chain_t      *chain0;
+	tsp_chain_t      *chain1;
+	tsp_jump_t      **jumps;   /**< jumps between both chains */
+	bool              valid;   /**< the fields below are up to date */
+	bool              swapped; /**< chain1 is split and chain0 inserted */
+	tsp_merge_type_t  type;
+	size_t            split;   /**< split position */
+	double            gain;
+};
+
+struct tsp_chain_t {
+	tsp_block_t      **blocks; /**< the blocks in layout order */
+	tsp_jump_t       **jumps;  /**< jumps inside the chain */
+	tsp_chain_edge_t **edges;  /**< edges to adjacent chains */
+	double             score;  /**< ExtTSP score of the jumps inside */
+	double             freq;   /**< summed frequency of all blocks */
+	unsigned           size;   /**< summed size of all blocks */
+	unsigned           id;
+	bool               dead;   /**< chain has been merged into another */
+};
+
+typedef struct tsp_env_t {
+	ir_graph     *irg;
+	struct obstack obst;
+	tsp_block_t **blocks;
+	tsp_chain_t **chains;
+	tsp_jump_t  **jumps;
+} tsp_env_t;
+
+static tsp_block_t *get_tsp_block(ir_node const *const block)
+{
+	return (tsp_block_t*)get_irn_link(block);
+}
+
+static double exttsp_jump_score(tsp_jump_t const *const jump)
+{
+	unsigned const src_end   = jump->src->offset + jump->src->size;
+	unsigned const dst_start = jump->dst->offset;
+	if (src_end == dst_start)
+		return jump->freq * EXTTSP_FALLTHROUGH_WEIGHT;
+	if (src_end < dst_start) {
+		unsigned const dist = dst_start - src_end;
+		if (dist <= EXTTSP_FORWARD_DISTANCE)
+			return jump->freq * EXTTSP_FORWARD_WEIGHT
+			     * (1.0 - (double)dist / EXTTSP_FORWARD_DISTANCE);
+	} else {
+		unsigned const dist = src_end - dst_start;
+		if (dist <= EXTTSP_BACKWARD_DISTANCE)
+			return jump->freq * EXTTSP_BACKWARD_WEIGHT
+			     * (1.0 - (double)dist / EXTTSP_BACKWARD_DISTANCE);
+	}
+	return 0.0;
+}
+
+static double exttsp_jumps_score(tsp_jump_t *const *const jumps)
+{
+	double score = 0.0;
+	for (size_t i = 0, n = ARR_LEN(jumps); i < n; ++i) {
+		score += exttsp_jump_score(jumps[i]);
+	}
+	return score;
+}
+
+/** Assigns addresses to the blocks of a sequence of up to three segments. */
+static void exttsp_assign_offsets(tsp_block_t *const *const *const segs,
+                                  size_t const *const lens)
+{
+	unsigned offset = 0;
+	for (size_t s = 0; s < 3; ++s) {
+		for (size_t i = 0; i < lens[s]; ++i) {
+			tsp_block_t *const block = segs[s][i];
+			block->offset = offset;
+			offset       += block->size;
+		}
+	}
+}
+
+/**
+ * Computes the segments of the sequence resulting from merging chain @p y
+ * into @p x.
+ */
+static void exttsp_merge_segments(tsp_chain_t const *const x,
+                                  tsp_chain_t const *const y,
+                                  tsp_merge_type_t const type,
+                                  size_t const split,
+                                  tsp_block_t *const **const segs,
+                                  size_t *const lens)
+{
+	tsp_block_t *const *const xb = x->blocks;
+	tsp_block_t *const *const yb = y->blocks;
+	size_t              const xn = ARR_LEN(xb);
+	size_t              const yn = ARR_LEN(yb);
+	switch (type) {
+	case MERGE_X_Y:
+		segs[0] = xb;         lens[0] = xn;
+		segs[1] = yb;         lens[1] = yn;
+		segs[2] = NULL;       lens[2] = 0;
+		return;
+	case MERGE_Y_X:
+		segs[0] = yb;         lens[0] = yn;
+		segs[1] = xb;         lens[1] = xn;
+		segs[2] = NULL;       lens[2] = 0;
+		return;
+	case MERGE_X1_Y_X2:
+		segs[0] = xb;         lens[0] = split;
+		segs[1] = yb;         lens[1] = yn;
+		segs[2] = xb + split; lens[2] = xn - split;
+		return;
+	case MERGE_Y_X2_X1:
+		segs[0] = yb;         lens[0] = yn;
+		segs[1] = xb + split; lens[1] = xn - split;
+		segs[2] = xb;         lens[2] = split;
+		return;
+	case MERGE_X2_X1_Y:
+		segs[0] = xb + split; lens[0] = xn - split;
+		segs[1] = xb;         lens[1] = split;
+		segs[2] = yb;         lens[2] = yn;
+		return;
+	}
+	panic("invalid merge type");
+}
+
+/**
+ * Evaluates all ways to merge chain @p y into chain @p x and records the best
+ * one in @p edge.
+ */
+static void exttsp_eval_merges(tsp_env_t const *const env,
+                               tsp_chain_edge_t *const edge,
+                               tsp_chain_t const *const x,
+                               tsp_chain_t const *const y, bool const swapped)
+{
+	ir_node *const start   = get_irg_start_block(env->irg);
+	size_t   const xn      = ARR_LEN(x->blocks);
+	size_t   const max_pos = xn <= EXTTSP_SPLIT_THRESHOLD ? xn : 1;
+	double   const base    = x->score + y->score;
+	for (size_t split = 0; split < max_pos; ++split) {
+		tsp_merge_type_t const first = split == 0 ? MERGE_X_Y : MERGE_X1_Y_X2;
+		tsp_merge_type_t const last  = split == 0 ? MERGE_Y_X : MERGE_X2_X1_Y;
+		for (tsp_merge_type_t type = first; type <= last; ++type) {
+			tsp_block_t *const *segs[3];
+			size_t               lens[3];
+			exttsp_merge_segments(x, y, type, split, segs, lens);
+
+			/* the start block has to stay in front */
+			tsp_block_t *const head = segs[0][0];
+			if ((x->blocks[0]->block == start || y->blocks[0]->block == start)
+			    && head->block != start)
+				continue;
+
+			exttsp_assign_offsets(segs, lens);
+			double const gain = exttsp_jumps_score(x->jumps)
+			                  + exttsp_jumps_score(y->jumps)
+			                  + exttsp_jumps_score(edge->jumps) - base;
+			if (gain > edge->gain) {
+				edge->gain    = gain;
+				edge->type    = type;
+				edge->split   = split;
+				edge->swapped = swapped;
+			}
+		}
+	}
+}
+
+static void exttsp_update_edge(tsp_env_t const *const env,
+                               tsp_chain_edge_t *const edge)
+{
+	if (edge->valid)
+		return;
+	edge->gain = 0.0;
+	exttsp_eval_merges(env, edge, edge->chain0, edge->chain1, false);
+	exttsp_eval_merges(env, edge, edge->chain1, edge->chain0, true);
+	edge->valid = true;
+}
+
+static void exttsp_remove_edge(tsp_chain_t *const chain,
+                               tsp_chain_edge_t const *const edge)
+{
+	for (size_t i = 0, n = ARR_LEN(chain->edges); i < n; ++i) {
+		if (chain->edges[i] == edge) {
+			chain->edges[i] = chain->edges[n - 1];
+			ARR_SHRINKLEN(chain->edges, n - 1);
+			return;
+		}
+	}
+	panic("chain edge not found");
+}
+
+static tsp_chain_edge_t *exttsp_find_edge(tsp_chain_t const *const chain,
+                                          tsp_chain_t const *const other)
+{
+	for (size_t i = 0, n = ARR_LEN(chain->edges); i < n; ++i) {
+		tsp_chain_edge_t *const edge = chain->edges[i];
+		if (edge->chain0 == other || edge->chain1 == other)
+			return edge;
+	}
+	return NULL;
+}
+
+static tsp_chain_edge_t *exttsp_new_edge(tsp_env_t *const env,
+                                         tsp_chain_t *const chain0,
+                                         tsp_chain_t *const chain1)
+{
+	tsp_chain_edge_t *const edge = OALLOCZ(&env->obst, tsp_chain_edge_t);
+	edge->chain0 = chain0;
+	edge->chain1 = chain1;
+	edge->jumps  = NEW_ARR_F(tsp_jump_t*, 0);
+	ARR_APP1(tsp_chain_edge_t*, chain0->edges, edge);
+	ARR_APP1(tsp_chain_edge_t*, chain1->edges, edge);
+	return edge;
+}
+
+static void exttsp_append_jumps(tsp_jump_t ***const dest,
+                                tsp_jump_t *const *const src)
+{
+	for (size_t i = 0, n = ARR_LEN(src); i < n; ++i) {
+		ARR_APP1(tsp_jump_t*, *dest, src[i]);
+	}
+}
+
+/** Merges the chains connected by @p edge as recorded in the edge. */
+static void exttsp_merge(tsp_chain_edge_t *const edge)
+{
+	tsp_chain_t *const x = edge->swapped ? edge->chain1 : edge->chain0;
+	tsp_chain_t *const y = edge->swapped ? edge->chain0 : edge->chain1;
+	DB((dbg, LEVEL_2, "merge chain %u into %u (type %d, split %zu, gain %.3g)\n",
+	    y->id, x->id, (int)edge->type, edge->split, edge->gain));
+
+	tsp_block_t *const *segs[3];
+	size_t               lens[3];
+	exttsp_merge_segments(x, y, edge->type, edge->split, segs, lens);
+	tsp_block_t **blocks = NEW_ARR_F(tsp_block_t*, 0);
+	for (size_t s = 0; s < 3; ++s) {
+		for (size_t i = 0; i < lens[s]; ++i) {
+			tsp_block_t *const block = segs[s][i];
+			block->chain = x;
+			ARR_APP1(tsp_block_t*, blocks, block);
+		}
+	}
+	DEL_ARR_F(x->blocks);
+	x->blocks = blocks;
+
+	exttsp_append_jumps(&x->jumps, y->jumps);
+	exttsp_append_jumps(&x->jumps, edge->jumps);
+	x->freq += y->freq;
+	x->size += y->size;
+
+	/* the edges of y now connect x with the other chain */
+	exttsp_remove_edge(x, edge);
+	for (size_t i = 0, n = ARR_LEN(y->edges); i < n; ++i) {
+		tsp_chain_edge_t *const yedge = y->edges[i];
+		if (yedge == edge)
+			continue;
+		tsp_chain_t *const other
+			= yedge->chain0 == y ? yedge->chain1 : yedge->chain0;
+		tsp_chain_edge_t *const xedge = exttsp_find_edge(x, other);
+		if (xedge != NULL) {
+			exttsp_append_jumps(&xedge->jumps, yedge->jumps);
+			exttsp_remove_edge(other, yedge);
+			DEL_ARR_F(yedge->jumps);
+		} else {
+			if (yedge->chain0 == y) {
+				yedge->chain0 = x;
+			} else {
+				yedge->chain1 = x;
+			}
+			ARR_APP1(tsp_chain_edge_t*, x->edges, yedge);
+		}
+	}
+	/* the layout of x changed, so all merge candidates have to be updated */
+	for (size_t i = 0, n = ARR_LEN(x->edges); i < n; ++i) {
+		x->edges[i]->valid = false;
+	}
+
+	size_t const xn = ARR_LEN(x->blocks);
+	tsp_block_t *const *const xsegs[3] = { x->blocks, NULL, NULL };
+	size_t               const xlens[3] = { xn, 0, 0 };
+	exttsp_assign_offsets(xsegs, xlens);
+	x->score = exttsp_jumps_score(x->jumps);
+
+	DEL_ARR_F(edge->jumps);
+	DEL_ARR_F(y->blocks);
+	DEL_ARR_F(y->jumps);
+	DEL_ARR_F(y->edges);
+	y->blocks = NULL;
+	y->jumps  = NULL;
+	y->edges  = NULL;
+	y->dead   = true;
+}
+
+static void exttsp_merge_chains(tsp_env_t *const env)
+{
+	for (;;) {
+		tsp_chain_edge_t *best = NULL;
+		double            best_gain = 1e-9;
+		for (size_t c = 0, n = ARR_LEN(env->chains); c < n; ++c) {
+			tsp_chain_t *const chain = env->chains[c];
+			if (chain->dead)
+				continue;
+			for (size_t i = 0, m = ARR_LEN(chain->edges); i < m; ++i) {
+				tsp_chain_edge_t *const edge = chain->edges[i];
+				/* visit every edge once */
+				if (edge->chain0 != chain)
+					continue;
+				exttsp_update_edge(env, edge);
+				if (edge->gain > best_gain) {
+					best_gain = edge->gain;
+					best      = edge;
+				}
+			}
+		}
+		if (best == NULL)
+			break;
+		exttsp_merge(best);
+	}
+}
+
+static double exttsp_density(tsp_chain_t const *const chain)
+{
+	return chain->freq / chain->size;
+}
+
+static int cmp_chains(void const *const d1, void const *const d2)
+{
+	tsp_chain_t const *const c1 = *(tsp_chain_t const *const *)d1;
+	tsp_chain_t const *const c2 = *(tsp_chain_t const *const *)d2;
+	/* the start block has to stay first */
+	ir_graph *const irg   = get_irn_irg(c1->blocks[0]->block);
+	ir_node  *const start = get_irg_start_block(irg);
+	bool      const s1    = c1->blocks[0]->block == start;
+	bool      const s2    = c2->blocks[0]->block == start;
+	if (s1 != s2)
+		return s2 - s1;
+	/* hot chains first, cold code ends up at the end of the function */
+	double const d1v = exttsp_density(c1);
+	double const d2v = exttsp_density(c2);
+	if (d1v != d2v)
+		return d1v < d2v ? 1 : -1;
+	return (c1->id > c2->id) - (c1->id < c2->id);
+}
+
+/** Estimates the size of the code emitted for @p block. */
+static unsigned exttsp_block_size(ir_node *const block)
+{
+	unsigned n_insns = 1;
+	sched_foreach(block, node) {
+		if (!is_Phi(node))
+			++n_insns;
+	}
+	return n_insns * EXTTSP_INSN_SIZE;
+}
+
+static unsigned exttsp_n_succs(ir_node const *const block)
+{
+	unsigned n = 0;
+	foreach_block_succ(block, edge) {
+		++n;
+	}
+	return n;
+}
+
+/**
+ * Estimates the frequency of the control flow edge from @p pred_block to
+ * @p block by splitting the execution frequency of @p pred_block evenly
+ * between its successors.
+ */
+static double exttsp_edge_freq(ir_node const *const pred_block,
+                               ir_node const *const block)
+{
+	if (get_Block_n_cfgpreds(block) == 1)
+		return get_block_execfreq(block);
+	return get_block_execfreq(pred_block) / exttsp_n_succs(pred_block);
+}
+
+/** Collects the blocks reachable from the start block. */
+static void exttsp_collect_blocks(tsp_env_t *const env)
+{
+	ir_graph *const irg = env->irg;
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
+	inc_irg_visited(irg);
+	/* Exclude the end block from the block schedule. */
+	mark_irn_visited(get_irg_end_block(irg));
+
+	ir_node **stack = NEW_ARR_F(ir_node*, 0);
+	ir_node  *start = get_irg_start_block(irg);
+	mark_irn_visited(start);
+	ARR_APP1(ir_node*, stack, start);
+	while (ARR_LEN(stack) > 0) {
+		size_t   const top   = ARR_LEN(stack) - 1;
+		ir_node *const block = stack[top];
+		ARR_SHRINKLEN(stack, top);
+
+		tsp_block_t *const tblock = OALLOCZ(&env->obst, tsp_block_t);
+		tblock->block = block;
+		tblock->size  = exttsp_block_size(block);
+		tblock->freq  = get_block_execfreq(block);
+		set_irn_link(block, tblock);
+		ARR_APP1(tsp_block_t*, env->blocks, tblock);
+
+		foreach_block_succ(block, edge) {
+			ir_node *const succ = get_edge_src_irn(edge);
+			if (!irn_visited_else_mark(succ))
+				ARR_APP1(ir_node*, stack, succ);
+		}
+	}
+	DEL_ARR_F(stack);
+	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
+}
+
+/** Creates the jumps between the collected blocks. */
+static void exttsp_collect_jumps(tsp_env_t *const env)
+{
+	for (size_t b = 0, n = ARR_LEN(env->blocks); b < n; ++b) {
+		tsp_block_t *const dst   = env->blocks[b];
+		ir_node     *const block = dst->block;
+		int          const arity = get_Block_n_cfgpreds(block);
+		for (int i = 0; i < arity; ++i) {
+			ir_node *const pred_block = get_Block_cfgpred_block(block, i);
+			if (pred_block == NULL)
+				continue;
+			tsp_block_t *const src = get_tsp_block(pred_block);
+			if (src == NULL || src == dst)
+				continue;
+
+			tsp_jump_t *const jump = OALLOC(&env->obst, tsp_jump_t);
+			jump->src  = src;
+			jump->dst  = dst;
+			jump->freq = exttsp_edge_freq(pred_block, block);
+			ARR_APP1(tsp_jump_t*, env->jumps, jump);
+		}
+	}
+}
+
+static void exttsp_create_chains(tsp_env_t *const env)
+{
+	for (size_t b = 0, n = ARR_LEN(env->blocks); b < n; ++b) {
+		tsp_block_t *const block = env->blocks[b];
+		tsp_chain_t *const chain = OALLOCZ(&env->obst, tsp_chain_t);
+		chain->blocks = NEW_ARR_F(tsp_block_t*, 1);
+		chain->blocks[0] = block;
+		chain->jumps  = NEW_ARR_F(tsp_jump_t*, 0);
+		chain->edges  = NEW_ARR_F(tsp_chain_edge_t*, 0);
+		chain->freq   = block->freq;
+		chain->size   = block->size;
+		chain->id     = b;
+		block->chain  = chain;
+		ARR_APP1(tsp_chain_t*, env->chains, chain);
+	}
+
+	for (size_t j = 0, n = ARR_LEN(env->jumps); j < n; ++j) {
+		tsp_jump_t  *const jump   = env->jumps[j];
+		tsp_chain_t *const chain0 = jump->src->chain;
+		tsp_chain_t *const chain1 = jump->dst->chain;
+		tsp_chain_edge_t *edge = exttsp_find_edge(chain0, chain1);
+		if (edge == NULL)
+			edge = exttsp_new_edge(env, chain0, chain1);
+		ARR_APP1(tsp_jump_t*, edge->jumps, jump);
+	}
+}
+
+static ir_node **exttsp_create_block_schedule(ir_graph *const irg)
+{
+	tsp_env_t env = {
+		.irg    = irg,
+		.blocks = NEW_ARR_F(tsp_block_t*, 0),
+		.chains = NEW_ARR_F(tsp_chain_t*, 0),
+		.jumps  = NEW_ARR_F(tsp_jump_t*, 0),
+	};
+	obstack_init(&env.obst);
+
+	exttsp_collect_blocks(&env);
+	exttsp_collect_jumps(&env);
+	exttsp_create_chains(&env);
+	exttsp_merge_chains(&env);
+
+	/* concatenate the remaining chains */
+	tsp_chain_t **chains = NEW_ARR_F(tsp_chain_t*, 0);
+	for (size_t c = 0, n = ARR_LEN(env.chains); c < n; ++c) {
+		tsp_chain_t *const chain = env.chains[c];
+		if (!chain->dead)
+			ARR_APP1(tsp_chain_t*, chains, chain);
+	}
+	QSORT_ARR(chains, cmp_chains);
+
+	DB((dbg, LEVEL_1, "Blockschedule:\n"));
+	size_t         const count      = ARR_LEN(env.blocks);
+	struct obstack *const obst      = be_get_be_obst(irg);
+	ir_node       **const block_list = NEW_ARR_D(ir_node*, obst, count);
+	size_t                i          = 0;
+	for (size_t c = 0, n = ARR_LEN(chains); c < n; ++c) {
+		tsp_chain_t *const chain = chains[c];
+		for (size_t b = 0, m = ARR_LEN(chain->blocks); b < m; ++b) {
+			tsp_block_t *const block = chain->blocks[b];
+			assert(i < count);
+			block_list[i++] = block->block;
+			DB((dbg, LEVEL_1, "\t%+F\n", block->block));
+		}
+		DEL_ARR_F(chain->blocks);
+		DEL_ARR_F(chain->jumps);
+		for (size_t e = 0, m = ARR_LEN(chain->edges); e < m; ++e) {
+			tsp_chain_edge_t *const edge = chain->edges[e];
+			/* edges are shared by both chains, free them once */
+			if (edge->chain0 == chain)
+				DEL_ARR_F(edge->jumps);
+		}
+		DEL_ARR_F(chain->edges);
+	}
+	assert(i == count);
+
+	DEL_ARR_F(chains);
+	DEL_ARR_F(env.jumps);
+	DEL_ARR_F(env.chains);
+	DEL_ARR_F(env.blocks);
+	obstack_free(&env.obst, NULL);
+	return block_list;
+}
+
+/**
+ * Computes the ExtTSP score of a block schedule.  This allows comparing the
+ * quality of the different algorithms.
+ */
+static double exttsp_schedule_score(ir_node *const *const block_list)
+{
+	size_t   const n_blocks = ARR_LEN(block_list);
+	unsigned      *offsets  = XMALLOCN(unsigned, n_blocks + 1);
+	unsigned       offset   = 0;
+	for (size_t i = 0; i < n_blocks; ++i) {
+		ir_node *const block = block_list[i];
+		set_irn_link(block, INT_TO_PTR(i));
+		offsets[i] = offset;
+		offset    += exttsp_block_size(block);
+	}
+	offsets[n_blocks] = offset;
+
+	double score = 0.0;
+	for (size_t i = 0; i < n_blocks; ++i) {
+		ir_node *const block = block_list[i];
+		tsp_block_t dst = {
+			.offset = offsets[i],
+			.size   = offsets[i + 1] - offsets[i],
+		};
+		for (int p = 0, arity = get_Block_n_cfgpreds(block); p < arity; ++p) {
+			ir_node *const pred_block = get_Block_cfgpred_block(block, p);
+			if (pred_block == NULL)
+				continue;
+			size_t const pi = PTR_TO_INT(get_irn_link(pred_block));
+			tsp_block_t src = {
+				.offset = offsets[pi],
+				.size   = offsets[pi + 1] - offsets[pi],
+			};
+			tsp_jump_t const jump = {
+				.src  = &src,
+				.dst  = &dst,
+				.freq = exttsp_edge_freq(pred_block, block),
+			};
+			score += exttsp_jump_score(&jump);
+		}
+	}
+	free(offsets);
+	return score;
+}
+
+static ir_node **greedy_create_block_schedule(ir_graph *irg)
 {
 	blocksched_env_t env = {
 		.irg        = irg,
@@ -560,8 +1192,34 @@ ir_node **be_create_block_schedule(ir_graph *irg)
 	return block_list;
 }
 
+ir_node **be_create_block_schedule(ir_graph *irg)
+{
+	ir_node **block_list;
+	if (algo == BLOCKSCHED_EXTTSP) {
+		remove_empty_blocks(irg);
+
+		ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+		block_list = exttsp_create_block_schedule(irg);
+		ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	} else {
+		block_list = greedy_create_block_schedule(irg);
+	}
+
+	if (stat_ev_enabled) {
+		ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+		stat_ev_dbl("blocksched_exttsp_score",
+		            exttsp_schedule_score(block_list));
+		ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	}
+	return block_list;
+}
+
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_blocksched)
 void be_init_blocksched(void)
 {
+	lc_opt_entry_t *be_grp         = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_entry_t *blocksched_grp = lc_opt_get_grp(be_grp, "blocksched");
+	lc_opt_add_table(blocksched_grp, blocksched_options);
+
 	FIRM_DBG_REGISTER(dbg, "firm.be.blocksched");
 }
@@ -0,0 +1,448 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Content addressed cache for the assembly of single functions.
+ *
+ * The key of a function is a structural hash of its graph combined with the
+ * target, platform and all backend options. The cached value is the
+ * assembly emitted for the function. Block labels inside it are stored
+ * relative to the first label of the function and relocated when the code is
+ * replayed, so the output with and without cache hits is identical.
+ *
+ * Code is only stored if it depends on nothing but the graph: Functions
+ * referencing entities created by the backend (constants, thunks,
+ * trampolines) or globally numbered labels are always compiled.
+ */
+#include "becache.h"
+
+#include "be_t.h"
+#include "bedwarf.h"
+#include "beemitter.h"
+#include "begnuas.h"
+#include "beirg.h"
+#include "bemodule.h"
+#include "debug.h"
+#include "entity_t.h"
+#include "irgraph_t.h"
+#include "irprog_t.h"
+#include "irtools.h"
+#include "lc_opts.h"
+#include "obst.h"
+#include "platform_t.h"
+#include "statev_t.h"
+#include "target_t.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+/** Increase when the format of cache files or the key computation changes. */
+#define CACHE_VERSION 1
+#define CACHE_HEADER  "# libfirm code cache"
+#define CACHE_SUFFIX  ".s"
+
+#define FNV64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV64_PRIME        0x100000001b3ULL
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+static char     cache_dir[1024];
+static int      cache_size = 256; /**< size limit of the cache in MiB */
+static bool     cache_stats;
+
+static bool           active;
+static uint64_t       unit_hash;       /**< hash of target and options */
+static long           entity_nr_limit; /**< entities from here on are new */
+static struct obstack capture_obst;
+static bool           capturing;
+static bool           reproducible;
+static uint64_t       current_key;
+static unsigned       current_base;
+
+static struct {
+	unsigned hits;
+	unsigned misses;
+	unsigned stored;
+	unsigned rejected;
+} stats;
+
+static uint64_t hash64_bytes(uint64_t hash, void const *data, size_t len)
+{
+	unsigned char const *bytes = (unsigned char const*)data;
+	for (size_t i = 0; i < len; ++i) {
+		hash ^= bytes[i];
+		hash *= FNV64_PRIME;
+	}
+	return hash;
+}
+
+static uint64_t hash64_u64(uint64_t hash, uint64_t value)
+{
+	return hash64_bytes(hash, &value, sizeof(value));
+}
+
+static uint64_t hash64_str(uint64_t hash, char const *str)
+{
+	if (str == NULL)
+		return hash64_u64(hash, 0);
+	size_t const len = strlen(str);
+	return hash64_bytes(hash64_u64(hash, len), str, len);
+}
+
+static void hash_option(lc_opt_entry_t const *opt, char const *path,
+                        char const *value, void *env)
+{
+	(void)opt;
+	/* the cache settings do not influence the generated code */
+	if (strncmp(path, "cache.", 6) == 0)
+		return;
+	uint64_t *const hash = (uint64_t*)env;
+	*hash = hash64_str(hash64_str(*hash, path), value);
+}
+
+static uint64_t compute_unit_hash(void)
+{
+	uint64_t hash = hash64_u64(FNV64_OFFSET_BASIS, CACHE_VERSION);
+	hash = hash64_str(hash, ir_target.isa->name);
+	hash = hash64_str(hash, ir_target.experimental);
+	hash = hash64_u64(hash, ir_target.fast_unaligned_memaccess);
+	hash = hash64_u64(hash, ir_target.float_int_overflow);
+	hash = hash64_u64(hash, ir_platform.object_format);
+	hash = hash64_u64(hash, ir_platform.pic_style);
+	hash = hash64_u64(hash, (unsigned char)ir_platform.user_label_prefix);
+	hash = hash64_u64(hash, ir_platform.is_darwin);
+	hash = hash64_u64(hash, ir_platform.supports_thread_local_storage);
+	hash = hash64_u64(hash, ir_platform.ia32_struct_in_regs);
+	hash = hash64_u64(hash, ir_platform.ia32_po2_stackalign);
+	hash = hash64_u64(hash, ir_platform.amd64_x64abi);
+
+	lc_opt_entry_t *const be_grp = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_walk_values(be_grp, hash_option, &hash);
+	return hash;
+}
+
+/**
+ * Returns the name of the cache file for @p key with @p suffix appended.  The
+ * name is allocated on the capture obstack.
+ */
+static char *get_cache_file_name(uint64_t key, char const *suffix)
+{
+	obstack_printf(&capture_obst, "%s/%016" PRIx64 CACHE_SUFFIX "%s",
+	               cache_dir, key, suffix);
+	obstack_1grow(&capture_obst, '\0');
+	return (char*)obstack_finish(&capture_obst);
+}
+
+/**
+ * Writes a fragment to the output, relocating its block labels to @p base.
+ */
+static void write_fragment(char const *data, size_t len, unsigned base)
+{
+	char const *const end = data + len;
+	while (data != end) {
+		char const *const marker
+			= (char const*)memchr(data, BE_GAS_BLOCK_MARKER, end - data);
+		if (marker == NULL) {
+			be_emit_write_raw(data, end - data);
+			return;
+		}
+		be_emit_write_raw(data, marker - data);
+
+		char *number_end;
+		unsigned long const nr = strtoul(marker + 1, &number_end, 10);
+		assert(number_end < end && *number_end == BE_GAS_BLOCK_MARKER);
+		char buf[24];
+		int const n = snprintf(buf, sizeof(buf), "%lu", base + nr);
+		be_emit_write_raw(buf, n);
+		data = number_end + 1;
+	}
+}
+
+/**
+ * Checks that a loaded fragment is well-formed, so a damaged cache file can
+ * never crash the compiler.
+ */
+static bool is_valid_fragment(char const *data, size_t len)
+{
+	bool in_marker = false;
+	for (size_t i = 0; i < len; ++i) {
+		char const c = data[i];
+		if (c == BE_GAS_BLOCK_MARKER) {
+			if (in_marker && data[i - 1] == BE_GAS_BLOCK_MARKER)
+				return false;
+			in_marker = !in_marker;
+		} else if (in_marker && (c < '0' || c > '9')) {
+			return false;
+		}
+	}
+	return !in_marker;
+}
+
+static bool replay(uint64_t key)
+{
+	char *const name = get_cache_file_name(key, "");
+	FILE *const f    = fopen(name, "rb");
+	if (f == NULL) {
+		obstack_free(&capture_obst, name);
+		return false;
+	}
+
+	bool     res         = false;
+	unsigned version     = 0;
+	unsigned n_block_nrs = 0;
+	if (fscanf(f, CACHE_HEADER " %u %u", &version, &n_block_nrs) != 2
+	    || version != CACHE_VERSION || fgetc(f) != '\n')
+		goto out;
+
+	char   buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		obstack_grow(&capture_obst, buf, n);
+	size_t const len  = obstack_object_size(&capture_obst);
+	char  *const data = (char*)obstack_finish(&capture_obst);
+	if (!ferror(f) && is_valid_fragment(data, len)) {
+		unsigned const base = be_gas_skip_fragment(n_block_nrs);
+		write_fragment(data, len, base);
+		res = true;
+	}
+
+out:
+	fclose(f);
+#ifndef _WIN32
+	/* remember the use for the least recently used trimming */
+	if (res)
+		utime(name, NULL);
+#endif
+	/* also frees the data following the name */
+	obstack_free(&capture_obst, name);
+	return res;
+}
+
+static void store(uint64_t key, unsigned n_block_nrs, char const *data,
+                  size_t len)
+{
+	char *const name = get_cache_file_name(key, "");
+#ifndef _WIN32
+	char tmp_suffix[32];
+	snprintf(tmp_suffix, sizeof(tmp_suffix), ".%ld.tmp", (long)getpid());
+	char *const tmp_name = get_cache_file_name(key, tmp_suffix);
+#else
+	char *const tmp_name = get_cache_file_name(key, ".tmp");
+#endif
+
+	FILE *const f = fopen(tmp_name, "wb");
+	if (f == NULL) {
+		DB((dbg, LEVEL_1, "could not create %s\n", tmp_name));
+		goto out;
+	}
+	fprintf(f, CACHE_HEADER " %u %u\n", CACHE_VERSION, n_block_nrs);
+	fwrite(data, 1, len, f);
+	bool const failed = ferror(f);
+	/* concurrent compilers may store the same key, the rename is atomic */
+	if (fclose(f) != 0 || failed || rename(tmp_name, name) != 0) {
+		remove(tmp_name);
+		goto out;
+	}
+	++stats.stored;
+
+out:
+	obstack_free(&capture_obst, name);
+}
+
+#ifndef _WIN32
+typedef struct cache_file_t {
+	char  *name; /**< allocated on the capture obstack */
+	off_t  size;
+	time_t mtime;
+} cache_file_t;
+
+static int cmp_cache_file(void const *const p1, void const *const p2)
+{
+	cache_file_t const *const f1 = (cache_file_t const*)p1;
+	cache_file_t const *const f2 = (cache_file_t const*)p2;
+	return (f1->mtime > f2->mtime) - (f1->mtime < f2->mtime);
+}
+
+/**
+ * Removes the least recently used files until the cache fits into its size
+ * limit.
+ */
+static void trim_cache(void)
+{
+	DIR *const dir = opendir(cache_dir);
+	if (dir == NULL)
+		return;
+
+	size_t const suffix_len = strlen(CACHE_SUFFIX);
+	cache_file_t *files     = NULL;
+	size_t        n_files   = 0;
+	size_t        capacity  = 0;
+	uint64_t      total     = 0;
+	for (struct dirent *e; (e = readdir(dir)) != NULL;) {
+		size_t const len = strlen(e->d_name);
+		if (len <= suffix_len
+		    || strcmp(e->d_name + len - suffix_len, CACHE_SUFFIX) != 0)
+			continue;
+		obstack_printf(&capture_obst, "%s/%s", cache_dir, e->d_name);
+		obstack_1grow(&capture_obst, '\0');
+		char *const path = (char*)obstack_finish(&capture_obst);
+		struct stat st;
+		if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+			obstack_free(&capture_obst, path);
+			continue;
+		}
+		if (n_files == capacity) {
+			capacity = capacity > 0 ? 2 * capacity : 64;
+			files    = XREALLOC(files, cache_file_t, capacity);
+		}
+		files[n_files++] = (cache_file_t) {
+			.name  = path,
+			.size  = st.st_size,
+			.mtime = st.st_mtime,
+		};
+		total += st.st_size;
+	}
+	closedir(dir);
+
+	uint64_t const limit = (uint64_t)MAX(cache_size, 0) << 20;
+	if (total > limit) {
+		QSORT(files, n_files, cmp_cache_file);
+		for (size_t i = 0; i < n_files && total > limit; ++i) {
+			if (remove(files[i].name) == 0)
+				total -= files[i].size;
+		}
+	}
+	free(files);
+}
+#endif
+
+void be_cache_begin(void)
+{
+	active = cache_dir[0] != '\0'
+	      && !be_options.opt_profile_generate
+	      && !be_options.opt_profile_use
+	      && !be_dwarf_enabled();
+	if (!active)
+		return;
+
+	memset(&stats, 0, sizeof(stats));
+	unit_hash       = compute_unit_hash();
+	entity_nr_limit = irp->max_node_nr;
+	obstack_init(&capture_obst);
+}
+
+bool be_cache_begin_irg(ir_graph *const irg)
+{
+	if (!active)
+		return false;
+
+	uint64_t const graph_hash = get_irg_structural_hash(irg);
+	if (graph_hash == 0) {
+		DB((dbg, LEVEL_1, "%+F cannot be cached\n", irg));
+		++stats.rejected;
+		return false;
+	}
+	uint64_t key = hash64_u64(unit_hash, graph_hash);
+	key = hash64_u64(key, be_birg_from_irg(irg)->hotness);
+
+	if (replay(key)) {
+		DB((dbg, LEVEL_1, "%+F: hit %016" PRIx64 "\n", irg, key));
+		++stats.hits;
+		return true;
+	}
+	DB((dbg, LEVEL_1, "%+F: miss %016" PRIx64 "\n", irg, key));
+	++stats.misses;
+
+	current_key  = key;
+	reproducible = true;
+	capturing    = true;
+	current_base = be_gas_begin_fragment();
+	be_emit_capture_begin(&capture_obst);
+	return false;
+}
+
+void be_cache_end_irg(ir_graph *const irg)
+{
+	(void)irg;
+	if (!capturing)
+		return;
+
+	be_emit_capture_end();
+	capturing = false;
+	unsigned const n_block_nrs = be_gas_end_fragment();
+	size_t   const len         = obstack_object_size(&capture_obst);
+	char    *const data        = (char*)obstack_finish(&capture_obst);
+	write_fragment(data, len, current_base);
+
+	if (reproducible) {
+		store(current_key, n_block_nrs, data, len);
+	} else {
+		DB((dbg, LEVEL_1, "%+F: code not reproducible\n", irg));
+		++stats.rejected;
+	}
+	obstack_free(&capture_obst, data);
+}
+
+void be_cache_note_entity(ir_entity const *const entity)
+{
+	if (entity->kind == IR_ENTITY_LABEL || entity->nr >= entity_nr_limit)
+		reproducible = false;
+}
+
+void be_cache_mark_unreproducible(void)
+{
+	reproducible = false;
+}
+
+void be_cache_finish(void)
+{
+	if (!active)
+		return;
+	active = false;
+	assert(!capturing);
+
+	if (stat_ev_enabled) {
+		stat_ev_ull("becache_hits",     stats.hits);
+		stat_ev_ull("becache_misses",   stats.misses);
+		stat_ev_ull("becache_stored",   stats.stored);
+		stat_ev_ull("becache_rejected", stats.rejected);
+	}
+	if (cache_stats) {
+		fprintf(stderr, "code cache: %u hits, %u misses, %u stored, %u not cacheable\n",
+		        stats.hits, stats.misses, stats.stored, stats.rejected);
+	}
+
+#ifndef _WIN32
+	trim_cache();
+#endif
+	obstack_free(&capture_obst, NULL);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_cache)
+void be_init_cache(void)
+{
+	static const lc_opt_table_entry_t cache_options[] = {
+		LC_OPT_ENT_STR ("dir",   "directory of the code cache (empty disables the cache)", &cache_dir),
+		LC_OPT_ENT_INT ("size",  "size limit of the code cache in MiB", &cache_size),
+		LC_OPT_ENT_BOOL("stats", "print code cache statistics", &cache_stats),
+		LC_OPT_LAST
+	};
+	lc_opt_entry_t *be_grp    = lc_opt_get_grp(firm_opt_get_root(), "be");
+	lc_opt_entry_t *cache_grp = lc_opt_get_grp(be_grp, "cache");
+	lc_opt_add_table(cache_grp, cache_options);
+
+	FIRM_DBG_REGISTER(dbg, "firm.be.cache");
+}
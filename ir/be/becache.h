@@ -0,0 +1,54 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Content addressed cache for the assembly of single functions.
+ */
+#ifndef FIRM_BE_BECACHE_H
+#define FIRM_BE_BECACHE_H
+
+#include <stdbool.h>
+
+#include "firm_types.h"
+
+/**
+ * Prepares the cache for a compilation unit. Must be called after all graphs
+ * of the unit have been prepared for code generation.
+ */
+void be_cache_begin(void);
+
+/**
+ * Looks up the code of @p irg in the cache. On a hit the cached assembly is
+ * emitted and true is returned, the graph must not be compiled then.
+ * Otherwise the emitted code for @p irg is recorded until be_cache_end_irg().
+ */
+bool be_cache_begin_irg(ir_graph *irg);
+
+/**
+ * Ends recording the code of @p irg, writes it to the output and stores it in
+ * the cache if it does not depend on state outside of the graph.
+ */
+void be_cache_end_irg(ir_graph *irg);
+
+/**
+ * Finishes a compilation unit: Prints statistics and trims the cache
+ * directory to its size limit.
+ */
+void be_cache_finish(void);
+
+/**
+ * Called for every entity referenced in recorded code.
+ */
+void be_cache_note_entity(ir_entity const *entity);
+
+/**
+ * Marks the code currently being recorded as not reproducible from its
+ * graph alone (because it contains globally numbered labels, for example), so
+ * it is not stored in the cache.
+ */
+void be_cache_mark_unreproducible(void);
+
+#endif
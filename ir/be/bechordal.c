@@ -170,6 +170,32 @@ static void pair_up_operands(be_chordal_env_t *const env, be_insn_t *const insn)
 	}
 }
 
+/**
+ * Assigns to each node the first admissible register, which is not taken by a
+ * previous node. This succeeds for the common case of a few operands fixed to
+ * single registers. If it does, the result is the matching bipartite_matching()
+ * would compute, too.
+ *
+ * @return true if all nodes got a register
+ */
+static bool match_greedy(int const n_alloc, unsigned const *const *const alloc_regs, unsigned const n_regs, int *const assignment)
+{
+	unsigned *const taken = rbitset_alloca(n_regs);
+	for (int i = 0; i < n_alloc; ++i) {
+		unsigned const *const bs = alloc_regs[i];
+		if (!bs)
+			return false;
+		unsigned col = 0;
+		while (col < n_regs && (!rbitset_is_set(bs, col) || rbitset_is_set(taken, col)))
+			++col;
+		if (col == n_regs)
+			return false;
+		rbitset_set(taken, col);
+		assignment[i] = col;
+	}
+	return true;
+}
+
 static void handle_constraints(be_chordal_env_t *const env, ir_node *const irn)
 {
 	void *const base = obstack_base(&env->obst);
@@ -188,22 +214,18 @@ static void handle_constraints(be_chordal_env_t *const env, ir_node *const irn)
 	/* find suitable in operands to the out operands of the node. */
 	pair_up_operands(env, insn);
 
-	/* Look at the in/out operands and add each operand (and its possible partner)
-	 * to a bipartite graph (left: nodes with partners, right: admissible colors). */
-	int                        n_alloc     = 0;
-	int                  const n_regs      = env->cls->n_regs;
-	ir_node            **const alloc_nodes = ALLOCAN(ir_node*, n_regs);
-	pmap                *const partners    = pmap_create();
-#if USE_HUNGARIAN
-	hungarian_problem_t *const bp          = hungarian_new(n_regs, n_regs, HUNGARIAN_MATCH_PERFECT);
-#else
-	bipartite_t         *const bp          = bipartite_new(n_regs, n_regs);
-#endif
+	/* Look at the in/out operands and collect each operand (and its possible
+	 * partner) with its admissible colors for a bipartite matching. */
+	int                    n_alloc     = 0;
+	int              const n_regs      = env->cls->n_regs;
+	ir_node        **const alloc_nodes = ALLOCAN(ir_node*, n_regs);
+	unsigned const **const alloc_regs  = ALLOCAN(unsigned const*, n_regs);
+	pmap            *const partners    = pmap_create();
 	for (int i = 0, n_ops = insn->n_ops; i < n_ops; ++i) {
 		/* If the operand has no partner or the partner has not been marked
 		 * for allocation, determine the admissible registers and mark it
 		 * for allocation by associating the node and its partner with the
-		 * set of admissible registers via a bipartite graph. */
+		 * set of admissible registers. */
 		be_operand_t *const op = &insn->ops[i];
 		if (!op->carrier)
 			continue;
@@ -215,37 +237,29 @@ static void handle_constraints(be_chordal_env_t *const env, ir_node *const irn)
 		if (partner != NULL)
 			pmap_insert(partners, partner, op->carrier);
 
-		alloc_nodes[n_alloc] = op->carrier;
-
 		DBG((dbg, LEVEL_2, "\tassociating %+F and %+F\n", op->carrier, partner));
 
 		unsigned const *const bs = get_decisive_partner_regs(op, n_regs);
-		if (bs) {
 #ifdef DEBUG_libfirm
+		if (bs) {
 			DBG((dbg, LEVEL_2, "\tallowed registers for %+F:", op->carrier, bs[0]));
 			rbitset_foreach(bs, n_regs, col) {
 				arch_register_t const *const reg = arch_register_for_index(env->cls, col);
 				DB((dbg, LEVEL_2, " %s", reg->name));
 			}
 			DB((dbg, LEVEL_2, "\n"));
-#endif
-
-			rbitset_foreach(bs, n_regs, col) {
-#if USE_HUNGARIAN
-				hungarian_add(bp, n_alloc, col, 1);
-#else
-				bipartite_add(bp, n_alloc, col);
-#endif
-			}
 		} else {
 			DBG((dbg, LEVEL_2, "\tallowed registers for %+F: none\n", op->carrier));
 		}
+#endif
 
+		alloc_nodes[n_alloc] = op->carrier;
+		alloc_regs[n_alloc]  = bs;
 		n_alloc++;
 	}
 
 	/* Put all nodes which live through the constrained instruction also to the
-	 * allocation bipartite graph. They are considered unconstrained. */
+	 * allocation nodes. They are considered unconstrained. */
 	if (perm != NULL) {
 		foreach_out_edge(perm, edge) {
 			ir_node *const proj = get_edge_src_irn(edge);
@@ -258,29 +272,43 @@ static void handle_constraints(be_chordal_env_t *const env, ir_node *const irn)
 			assert(n_alloc < n_regs);
 
 			alloc_nodes[n_alloc] = proj;
+			alloc_regs[n_alloc]  = env->allocatable_regs->data;
 			pmap_insert(partners, proj, NULL);
-
-			bitset_foreach(env->allocatable_regs, col) {
-#if USE_HUNGARIAN
-				hungarian_add(bp, n_alloc, col, 1);
-#else
-				bipartite_add(bp, n_alloc, col);
-#endif
-			}
-
 			n_alloc++;
 		}
 	}
 
 	/* Compute a valid register allocation. */
 	int *const assignment = ALLOCAN(int, n_regs);
+	if (!match_greedy(n_alloc, alloc_regs, n_regs, assignment)) {
+		DBG((dbg, LEVEL_2, "\tsolving matching problem for %+F\n", irn));
 #if USE_HUNGARIAN
-	hungarian_prepare_cost_matrix(bp, HUNGARIAN_MODE_MAXIMIZE_UTIL);
-	int const match_res = hungarian_solve(bp, assignment, NULL, 1);
-	assert(match_res == 0 && "matching failed");
+		hungarian_problem_t *const bp = hungarian_new(n_regs, n_regs, HUNGARIAN_MATCH_PERFECT);
 #else
-	bipartite_matching(bp, assignment);
+		bipartite_t         *const bp = bipartite_new(n_regs, n_regs);
 #endif
+		for (int i = 0; i < n_alloc; ++i) {
+			unsigned const *const bs = alloc_regs[i];
+			if (!bs)
+				continue;
+			rbitset_foreach(bs, n_regs, col) {
+#if USE_HUNGARIAN
+				hungarian_add(bp, i, col, 1);
+#else
+				bipartite_add(bp, i, col);
+#endif
+			}
+		}
+#if USE_HUNGARIAN
+		hungarian_prepare_cost_matrix(bp, HUNGARIAN_MODE_MAXIMIZE_UTIL);
+		int const match_res = hungarian_solve(bp, assignment, NULL, 1);
+		assert(match_res == 0 && "matching failed");
+		hungarian_free(bp);
+#else
+		bipartite_matching(bp, assignment);
+		bipartite_free(bp);
+#endif
+	}
 
 	/* Assign colors obtained from the matching. */
 	for (int i = 0; i < n_alloc; ++i) {
@@ -298,11 +326,6 @@ static void handle_constraints(be_chordal_env_t *const env, ir_node *const irn)
 		}
 	}
 
-#if USE_HUNGARIAN
-	hungarian_free(bp);
-#else
-	bipartite_free(bp);
-#endif
 	pmap_destroy(partners);
 
 end:
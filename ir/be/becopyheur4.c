@@ -30,6 +30,7 @@
 #include "irprintf.h"
 #include "util.h"
 #include "irtools.h"
+#include "irgwalk.h"
 #include "list.h"
 #include "statev_t.h"
 
@@ -101,6 +102,7 @@ typedef struct co_mst_env_t {
 	be_ifg_t        *ifg;              /**< the interference graph */
 	copy_opt_t      *co;               /**< the copy opt object */
 	col_cost_t     **single_cols;
+	ir_node       ***neighbours;       /**< interfering neighbours per node index */
 	unsigned         n_regs;           /**< number of regs in class */
 	unsigned         chunk_visited;
 } co_mst_env_t;
@@ -155,9 +157,10 @@ static co_mst_irn_t *co_mst_irn_init(co_mst_env_t *env, const ir_node *irn)
 	res->constr_factor = (real_t)(1 + n_regs - bitset_popcount(adm)) / n_regs;
 
 	/* build list of interfering neighbours */
-	unsigned          len = 0;
-	neighbours_iter_t nodes_it;
-	be_ifg_foreach_neighbour(env->ifg, &nodes_it, irn, neigh) {
+	unsigned  len    = 0;
+	ir_node **neighs = env->neighbours[get_irn_idx(irn)];
+	for (size_t i = 0, n = ARR_LEN(neighs); i < n; ++i) {
+		ir_node *const neigh = neighs[i];
 		if (!arch_irn_is_ignore(neigh)) {
 			obstack_ptr_grow(&env->obst, neigh);
 			++len;
@@ -168,6 +171,83 @@ static co_mst_irn_t *co_mst_irn_init(co_mst_env_t *env, const ir_node *irn)
 	return res;
 }
 
+static void add_neighbour(co_mst_env_t *env, ir_node *irn, ir_node *neigh)
+{
+	ir_node ***const neighs = &env->neighbours[get_irn_idx(irn)];
+	ARR_APP1(ir_node*, *neighs, neigh);
+}
+
+/**
+ * Collects the interferences of a block: A value interferes with all values
+ * living when its live range starts (see find_neighbours() in beifg.c).
+ */
+static void collect_neighbours_walker(ir_node *block, void *data)
+{
+	co_mst_env_t *const env  = (co_mst_env_t*)data;
+	struct list_head   *head = get_block_border_head(env->co->cenv, block);
+
+	ir_nodeset_t living;
+	ir_nodeset_init(&living);
+	foreach_border_head(head, b) {
+		ir_node *const irn = b->irn;
+		if (b->is_def) {
+			foreach_ir_nodeset(&living, live, iter) {
+				add_neighbour(env, irn, live);
+				add_neighbour(env, live, irn);
+			}
+			ir_nodeset_insert(&living, irn);
+		} else {
+			ir_nodeset_remove(&living, irn);
+		}
+	}
+	ir_nodeset_destroy(&living);
+}
+
+static int cmp_node_idx(const void *a, const void *b)
+{
+	const ir_node *const n1 = *(const ir_node**)a;
+	const ir_node *const n2 = *(const ir_node**)b;
+	return QSORT_CMP(get_irn_idx(n1), get_irn_idx(n2));
+}
+
+/**
+ * Determines the interfering neighbours of all nodes with a single walk over
+ * the border lists. Querying the interference graph for each node walks the
+ * dominance subtree of its definition instead.
+ */
+static void build_neighbours(co_mst_env_t *env)
+{
+	ir_graph *const irg   = env->co->irg;
+	unsigned  const n_idx = get_irg_last_idx(irg);
+	env->neighbours = XMALLOCN(ir_node**, n_idx);
+	for (unsigned i = 0; i < n_idx; ++i)
+		env->neighbours[i] = NEW_ARR_F(ir_node*, 0);
+
+	irg_block_walk_graph(irg, collect_neighbours_walker, NULL, env);
+
+	/* a pair of values may interfere in several blocks */
+	for (unsigned i = 0; i < n_idx; ++i) {
+		ir_node **const neighs = env->neighbours[i];
+		size_t    const n      = ARR_LEN(neighs);
+		if (n == 0)
+			continue;
+		QSORT(neighs, n, cmp_node_idx);
+		size_t len = 1;
+		for (size_t j = 1; j < n; ++j) {
+			if (neighs[j] != neighs[len - 1])
+				neighs[len++] = neighs[j];
+		}
+		ARR_SHRINKLEN(neighs, len);
+	}
+}
+
+static void free_neighbours(co_mst_env_t *env)
+{
+	for (unsigned i = 0, n = get_irg_last_idx(env->co->irg); i < n; ++i)
+		DEL_ARR_F(env->neighbours[i]);
+	free(env->neighbours);
+}
+
 static co_mst_irn_t *get_co_mst_irn(co_mst_env_t *env, const ir_node *node)
 {
 	co_mst_irn_t *res = ir_nodemap_get(co_mst_irn_t, &env->map, node);
@@ -1270,6 +1350,8 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 
 	DBG((dbg, LEVEL_1, "==== Coloring %+F, class %s ====\n", co->irg, co->cls->name));
 
+	build_neighbours(&mst_env);
+
 	/* build affinity chunks */
 	stat_ev_tim_push();
 	build_affinity_chunks(&mst_env);
@@ -1299,6 +1381,7 @@ static int co_solve_heuristic_mst(copy_opt_t *co)
 	}
 
 	/* free allocated memory */
+	free_neighbours(&mst_env);
 	del_pqueue(mst_env.chunks);
 	obstack_free(&mst_env.obst, NULL);
 	ir_nodemap_destroy(&mst_env.map);
@@ -915,6 +915,15 @@ void be_dwarf_unit_end(void)
 		return;
 	be_gas_emit_switch_section(GAS_SECTION_TEXT);
 	emit_label("section_end");
+	/* functions may have been placed into the hot and unlikely sections */
+	if (be_gas_section_used(GAS_SECTION_TEXT_HOT)) {
+		be_gas_emit_switch_section(GAS_SECTION_TEXT_HOT);
+		emit_label("hot_section_end");
+	}
+	if (be_gas_section_used(GAS_SECTION_TEXT_UNLIKELY)) {
+		be_gas_emit_switch_section(GAS_SECTION_TEXT_UNLIKELY);
+		emit_label("unlikely_section_end");
+	}
 
 	be_gas_emit_switch_section(GAS_SECTION_DEBUG_INFO);
 	emit_uleb128(0); /* end of compile_unit DIE */
@@ -935,6 +944,11 @@ void be_dwarf_close(void)
 	pset_new_destroy(&env.emitted_types);
 }
 
+bool be_dwarf_enabled(void)
+{
+	return debug_level >= LEVEL_BASIC;
+}
+
 /* Opens a dwarf handler */
 void be_dwarf_open(void)
 {
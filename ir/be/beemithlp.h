@@ -102,10 +102,22 @@ bool be_is_fallthrough(ir_node const *jmp);
 	be_emit_char('\t'); \
 	if (in_delay_slot) \
 		be_emit_char(' '); \
+	BE_EMIT_FORMAT(node, fmt, ap, (be_emit_finish_line_gas(node), va_end(ap)))
+
+/**
+ * Like BE_EMITF() but appends @p fmt to the current line, which is not
+ * finished. Generated emitters use this for the parts of a template they do
+ * not translate into direct calls.
+ */
+#define BE_EMITF_PART(node, fmt, ap) \
+	va_list ap; \
+	va_start(ap, fmt); \
+	BE_EMIT_FORMAT(node, fmt, ap, va_end(ap))
+
+#define BE_EMIT_FORMAT(node, fmt, ap, finish) \
 	for (size_t node##__n;;) \
 		if (node##__n = strcspn(fmt, "\n%"), be_emit_string_len(fmt, node##__n), fmt += node##__n, *fmt == '\0') { \
-			be_emit_finish_line_gas(node); \
-			va_end(ap); \
+			finish; \
 			break; \
 		} else if (*fmt == '\n') { \
 			++fmt; \
@@ -119,16 +131,14 @@ bool be_is_fallthrough(ir_node const *jmp);
 			be_emit_cfop_target(va_arg(ap, ir_node const*)); \
 		} else if (*fmt == 'd') { \
 			++fmt; \
-			int const num = va_arg(ap, int); \
-			be_emit_irprintf("%d", num); \
+			be_emit_int(va_arg(ap, int)); \
 		} else if (*fmt == 's') { \
 			++fmt; \
 			char const *const string = va_arg(ap, char const*); \
 			be_emit_string(string); \
 		} else if (*fmt == 'u') { \
 			++fmt; \
-			unsigned const num = va_arg(ap, unsigned); \
-			be_emit_irprintf("%u", num); \
+			be_emit_int(va_arg(ap, unsigned)); \
 		} else
 
 #define BE_EMIT_JMP(arch, node, name, jmp) \
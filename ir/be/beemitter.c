@@ -13,18 +13,39 @@
 
 #include "irprintf.h"
 #include "panic.h"
+#include <assert.h>
+#include <stddef.h>
 
-static FILE    *emit_file;
-struct obstack  emit_obst;
+/** Size of finished lines after which the buffer is written to the file. */
+#define EMIT_BUFFER_SIZE (64 * 1024)
+
+static FILE           *emit_file;
+static struct obstack *capture_obst;
+struct obstack         emit_obst;
+size_t                 emit_line_start;
+int                    emit_column_adjust;
+
+/**
+ * Writes the finished lines in the buffer to the emitter file.
+ */
+static void flush_lines(void)
+{
+	size_t const size = obstack_object_size(&emit_obst);
+	fwrite(obstack_base(&emit_obst), 1, size, emit_file);
+	obstack_blank_fast(&emit_obst, -(ptrdiff_t)size);
+	emit_line_start = 0;
+}
 
 void be_emit_init(FILE *file)
 {
-	emit_file = file;
+	emit_file       = file;
+	emit_line_start = 0;
 	obstack_init(&emit_obst);
 }
 
 void be_emit_exit(void)
 {
+	flush_lines();
 	obstack_free(&emit_obst, NULL);
 }
 
@@ -41,10 +62,59 @@ void be_emit_irprintf(const char *fmt, ...)
 	va_end(ap);
 }
 
+void be_emit_int(int64_t const value)
+{
+	char      buf[24];
+	char     *p = buf + sizeof(buf);
+	uint64_t  u = value < 0 ? -(uint64_t)value : (uint64_t)value;
+	do {
+		*--p = '0' + u % 10;
+		u   /= 10;
+	} while (u != 0);
+	if (value < 0)
+		*--p = '-';
+	be_emit_string_len(p, buf + sizeof(buf) - p);
+}
+
 void be_emit_write_line(void)
 {
-	size_t const len  = obstack_object_size(&emit_obst);
-	char  *const line = (char*)obstack_finish(&emit_obst);
-	fwrite(line, 1, len, emit_file);
-	obstack_free(&emit_obst, line);
+	size_t const size = obstack_object_size(&emit_obst);
+	emit_column_adjust = 0;
+	if (capture_obst != NULL) {
+		size_t const len  = size - emit_line_start;
+		char  *const line = (char*)obstack_base(&emit_obst) + emit_line_start;
+		obstack_grow(capture_obst, line, len);
+		obstack_blank_fast(&emit_obst, -(ptrdiff_t)len);
+		return;
+	}
+	emit_line_start = size;
+	if (size >= EMIT_BUFFER_SIZE)
+		flush_lines();
+}
+
+void be_emit_capture_begin(struct obstack *obst)
+{
+	assert(capture_obst == NULL);
+	capture_obst = obst;
+}
+
+void be_emit_capture_end(void)
+{
+	assert(capture_obst != NULL);
+	capture_obst = NULL;
+}
+
+bool be_emit_is_capturing(void)
+{
+	return capture_obst != NULL;
+}
+
+void be_emit_write_raw(char const *const data, size_t const len)
+{
+	assert(capture_obst == NULL);
+	assert(obstack_object_size(&emit_obst) == emit_line_start);
+	obstack_grow(&emit_obst, data, len);
+	emit_line_start += len;
+	if (emit_line_start >= EMIT_BUFFER_SIZE)
+		flush_lines();
 }
@@ -15,11 +15,15 @@
 #ifndef FIRM_BE_BEEMITTER_H
 #define FIRM_BE_BEEMITTER_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include "obst.h"
 
 /* don't use the following vars directly, they're only here for the inlines */
 extern struct obstack  emit_obst;
+extern size_t          emit_line_start;
+extern int             emit_column_adjust;
 
 /**
  * Emit a character to the (assembler) output.
@@ -59,6 +63,11 @@ static inline void be_emit_string(const char *str)
 #define be_emit_cstring(str) \
 	be_emit_string_len(str, sizeof(str) - 1)
 
+/**
+ * Emit the decimal representation of @p value to the (assembler) output.
+ */
+void be_emit_int(int64_t value);
+
 /**
  * Initializes an emitter environment.
  *
@@ -86,14 +95,46 @@ void be_emit_irprintf(const char *fmt, ...);
 void be_emit_irvprintf(const char *fmt, va_list args);
 
 /**
- * Flush the line in the current line buffer to the emitter file.
+ * Finish the current line. Finished lines are collected in a buffer which is
+ * written to the emitter file in large chunks.
  */
 void be_emit_write_line(void);
 
+/**
+ * Redirect all following lines written by be_emit_write_line() to the end of
+ * @p obst instead of the output file.
+ */
+void be_emit_capture_begin(struct obstack *obst);
+
+/**
+ * Stop redirecting lines, they go to the output file again.
+ */
+void be_emit_capture_end(void);
+
+/**
+ * Returns true if lines are currently redirected by be_emit_capture_begin().
+ */
+bool be_emit_is_capturing(void);
+
+/**
+ * Write @p len bytes of already formatted assembly to the output file.
+ */
+void be_emit_write_raw(char const *data, size_t len);
+
 /** Return column in current line. Counting starts at 0. */
 static inline size_t be_emit_get_column(void)
 {
-	return obstack_object_size(&emit_obst);
+	return obstack_object_size(&emit_obst) - emit_line_start
+	     + emit_column_adjust;
+}
+
+/**
+ * Account for text in the current line that will have a different width in
+ * the final output (like relocatable labels in captured lines).
+ */
+static inline void be_emit_adjust_column(int delta)
+{
+	emit_column_adjust += delta;
 }
 
 #endif
@@ -13,8 +13,10 @@
 
 #include "be_t.h"
 #include "bearch.h"
+#include "becache.h"
 #include "beemithlp.h"
 #include "beemitter.h"
+#include "beirg.h"
 #include "bemodule.h"
 #include "betranshlp.h"
 #include "dbginfo.h"
@@ -36,8 +38,10 @@ bool                   be_gas_emit_types    = true;
 char                   be_gas_elf_type_char = '@';
 
 static be_gas_section_t current_section = (be_gas_section_t) -1;
+static unsigned         used_sections;
 static pmap            *block_numbers;
 static unsigned         next_block_nr;
+static unsigned         fragment_base;
 
 static bool is_macho(void)
 {
@@ -86,6 +90,8 @@ static void emit_section_macho(be_gas_section_t const section)
 		[GAS_SECTION_DEBUG_LINE]      = { "__DWARF,__debug_line",     "regular,debug" },
 		[GAS_SECTION_DEBUG_PUBNAMES]  = { "__DWARF,__debug_pubnames", "regular,debug" },
 		[GAS_SECTION_DEBUG_FRAME]     = { "__DWARF,__debug_frame",    "regular,debug" },
+		[GAS_SECTION_TEXT_HOT]        = { "__TEXT,__text",            "regular,pure_instructions" },
+		[GAS_SECTION_TEXT_UNLIKELY]   = { "__TEXT,__text",            "regular,pure_instructions" },
 	};
 	static const macho_sectioninfo_t macho_sectioninfos_coalesce[] = {
 		[GAS_SECTION_TEXT]    = { "__TEXT,__textcoal_nt", "coalesced,pure_instructions" },
@@ -137,6 +143,8 @@ static const elf_sectioninfo_t elf_sectioninfos[] = {
 	[GAS_SECTION_DEBUG_LINE]     = { "debug_line",        "progbits", ""   },
 	[GAS_SECTION_DEBUG_PUBNAMES] = { "debug_pubnames",    "progbits", ""   },
 	[GAS_SECTION_DEBUG_FRAME]    = { "debug_frame",       "progbits", ""   },
+	[GAS_SECTION_TEXT_HOT]       = { "text.hot",          "progbits", "ax" },
+	[GAS_SECTION_TEXT_UNLIKELY]  = { "text.unlikely",     "progbits", "ax" },
 };
 
 static void emit_section_sparc(be_gas_section_t section,
@@ -251,6 +259,7 @@ static void emit_section_elf_coff(be_gas_section_t const section, ir_entity cons
 
 static void emit_section(be_gas_section_t const section, ir_entity const *const entity)
 {
+	used_sections |= 1U << (section & GAS_SECTION_TYPE_MASK);
 	if (is_macho()) {
 		emit_section_macho(section);
 	} else if (be_gas_elf_variant == ELF_VARIANT_SPARC) {
@@ -269,6 +278,11 @@ void be_gas_emit_switch_section(be_gas_section_t section)
 	emit_section(section, NULL);
 }
 
+bool be_gas_section_used(be_gas_section_t const section)
+{
+	return used_sections & (1U << (section & GAS_SECTION_TYPE_MASK));
+}
+
 static ir_tarval *get_initializer_tarval(const ir_initializer_t *initializer)
 {
 	if (initializer->kind == IR_INITIALIZER_TARVAL)
@@ -592,12 +606,33 @@ static void emit_visibility(const ir_entity *entity, bool implicit_globl)
 	}
 }
 
+/**
+ * Moves functions into a hot or unlikely text section, if the profile
+ * classified them as such.
+ */
+static be_gas_section_t get_function_section(const ir_entity *entity)
+{
+	be_gas_section_t const section = determine_section(NULL, entity);
+	if (section != GAS_SECTION_TEXT)
+		return section;
+
+	ir_graph const *const irg = get_entity_irg(entity);
+	if (irg == NULL || irg->be_data == NULL)
+		return section;
+	switch (be_birg_from_irg(irg)->hotness) {
+	case BE_CODE_HOT:    return GAS_SECTION_TEXT_HOT;
+	case BE_CODE_COLD:   return GAS_SECTION_TEXT_UNLIKELY;
+	case BE_CODE_NORMAL: return section;
+	}
+	panic("invalid code hotness");
+}
+
 void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
                                  const parameter_dbg_info_t *parameter_infos)
 {
 	be_dwarf_function_before(entity, parameter_infos);
 
-	be_gas_section_t const section = determine_section(NULL, entity);
+	be_gas_section_t const section = get_function_section(entity);
 	emit_section(section, entity);
 
 	/* write the begin line (makes the life easier for scripts parsing the
@@ -721,15 +756,15 @@ static void emit_init_expression(ir_node *const init)
 		return;
 
 	case iro_Offset:
-		be_emit_irprintf("%d", get_entity_offset(get_Offset_entity(init)));
+		be_emit_int(get_entity_offset(get_Offset_entity(init)));
 		return;
 
 	case iro_Align:
-		be_emit_irprintf("%u", get_type_alignment(get_Align_type(init)));
+		be_emit_int(get_type_alignment(get_Align_type(init)));
 		return;
 
 	case iro_Size:
-		be_emit_irprintf("%u", get_type_size(get_Size_type(init)));
+		be_emit_int(get_type_size(get_Size_type(init)));
 		return;
 
 	case iro_Add:
@@ -1295,6 +1330,9 @@ static bool check_needs_quotes(char const *const s)
 
 void be_gas_emit_entity(const ir_entity *entity)
 {
+	if (be_emit_is_capturing())
+		be_cache_note_entity(entity);
+
 	if (entity->kind == IR_ENTITY_LABEL) {
 		ir_label_t label = get_entity_label(entity);
 		be_emit_irprintf("%s_%lu", be_gas_get_private_prefix(), label);
@@ -1326,7 +1364,18 @@ void be_gas_emit_block_name(const ir_node *block)
 		} else {
 			nr = PTR_TO_INT(nr_val) - 1;
 		}
-		be_emit_irprintf("%s%d", be_gas_get_private_prefix(), nr);
+		if (be_emit_is_capturing()) {
+			/* pad comments as if the final label was here */
+			size_t const col = be_emit_get_column();
+			be_emit_irprintf("%s%c%u%c", be_gas_get_private_prefix(),
+			                 BE_GAS_BLOCK_MARKER, nr - fragment_base,
+			                 BE_GAS_BLOCK_MARKER);
+			int const len = snprintf(NULL, 0, "%s%d",
+			                         be_gas_get_private_prefix(), nr);
+			be_emit_adjust_column(len - (int)(be_emit_get_column() - col));
+		} else {
+			be_emit_irprintf("%s%d", be_gas_get_private_prefix(), nr);
+		}
 	}
 }
 
@@ -1625,8 +1674,11 @@ void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const
 		be_emit_write_line();
 	}
 
-	if (entity && !is_macho())
-		be_gas_emit_switch_section(GAS_SECTION_TEXT);
+	if (entity && !is_macho()) {
+		/* continue in the section the function was placed in */
+		ir_entity const *const function = get_irg_entity(get_irn_irg(node));
+		emit_section(get_function_section(function), function);
+	}
 
 	free(labels);
 	free(targets);
@@ -1654,6 +1706,7 @@ bool be_gas_produces_dwarf_line_info(void)
 
 void be_gas_begin_compilation_unit(const be_main_env_t *env)
 {
+	used_sections = 0;
 	be_dwarf_open();
 	be_dwarf_unit_begin(env->cup_name);
 
@@ -1673,6 +1726,29 @@ void be_gas_end_compilation_unit(const be_main_env_t *env)
 	be_dwarf_close();
 }
 
+unsigned be_gas_begin_fragment(void)
+{
+	/* the fragment may be placed anywhere, so it must not rely on the
+	 * section selected before it */
+	current_section = (be_gas_section_t)-1;
+	fragment_base   = next_block_nr;
+	return fragment_base;
+}
+
+unsigned be_gas_end_fragment(void)
+{
+	current_section = (be_gas_section_t)-1;
+	return next_block_nr - fragment_base;
+}
+
+unsigned be_gas_skip_fragment(unsigned const n_block_nrs)
+{
+	unsigned const base = next_block_nr;
+	next_block_nr  += n_block_nrs;
+	current_section = (be_gas_section_t)-1;
+	return base;
+}
+
 void be_emit_finish_line_gas(const ir_node *node)
 {
 	if (node && be_options.verbose_asm) {
@@ -35,6 +35,8 @@ typedef enum {
 	GAS_SECTION_DEBUG_LINE,      /**< dwarf debug line */
 	GAS_SECTION_DEBUG_PUBNAMES,  /**< dwarf pub names */
 	GAS_SECTION_DEBUG_FRAME,     /**< dwarf callframe infos */
+	GAS_SECTION_TEXT_HOT,        /**< text section for frequently executed code */
+	GAS_SECTION_TEXT_UNLIKELY,   /**< text section for never executed code */
 	GAS_SECTION_TYPE_MASK    = 0xFF,
 
 	GAS_SECTION_FLAG_TLS     = 1 << 8,  /**< thread local flag */
@@ -63,6 +65,12 @@ extern char                 be_gas_elf_type_char;
  */
 void be_gas_emit_switch_section(be_gas_section_t section);
 
+/**
+ * Returns whether anything has been emitted into @p section (ignoring its
+ * flags) in the current compilation unit.
+ */
+bool be_gas_section_used(be_gas_section_t section);
+
 /**
  * emit assembler instructions necessary before starting function code
  */
@@ -117,6 +125,31 @@ void be_gas_begin_compilation_unit(const be_main_env_t *env);
  */
 void be_gas_end_compilation_unit(const be_main_env_t *env);
 
+/** Marks the number of a block label inside a relocatable fragment. */
+#define BE_GAS_BLOCK_MARKER '\x01'
+
+/**
+ * Starts emitting a relocatable fragment (usually a single function) into
+ * an emitter capture. Block labels inside the fragment are written as
+ * BE_GAS_BLOCK_MARKER-enclosed numbers relative to the returned base and the
+ * fragment starts with its own section directive.
+ */
+unsigned be_gas_begin_fragment(void);
+
+/**
+ * Ends a relocatable fragment.
+ * @return the number of block label numbers used by the fragment
+ */
+unsigned be_gas_end_fragment(void);
+
+/**
+ * Reserves block label numbers for a relocatable fragment emitted without
+ * be_gas_begin_fragment() (for example one replayed from a cache).
+ * @param n_block_nrs  result of be_gas_end_fragment() for the fragment
+ * @return the base to relocate the fragment's block labels to
+ */
+unsigned be_gas_skip_fragment(unsigned n_block_nrs);
+
 /**
  * Return the label prefix for labeled instructions.
  */
@@ -36,6 +36,13 @@ void be_invalidate_live_chk(ir_graph *irg);
  */
 void be_free_birg(ir_graph *irg);
 
+/** Profile based hotness of a function, used for section placement. */
+typedef enum be_code_hotness_t {
+	BE_CODE_NORMAL, /**< no profile information or neither hot nor cold */
+	BE_CODE_HOT,    /**< function is among the hottest of the program */
+	BE_CODE_COLD,   /**< function was never executed */
+} be_code_hotness_t;
+
 /**
  * An ir_graph with additional analysis data about this irg. Also includes some
  * backend structures
@@ -55,6 +62,10 @@ typedef struct be_irg_t {
 	/** Architecture specific per-graph data */
 	void             *isa_link;
 	bool              has_returns_twice_call;
+	/** stack pointer offset when entering each block (by index) as computed
+	 * by be_sim_stack_pointer(), NULL before */
+	int              *block_sp_offsets;
+	be_code_hotness_t hotness;
 } be_irg_t;
 
 static inline be_irg_t *be_birg_from_irg(const ir_graph *irg)
@@ -11,6 +11,7 @@
  */
 #include "be_t.h"
 #include "beasm.h"
+#include "becache.h"
 #include "bechordal_t.h"
 #include "bediagnostic.h"
 #include "beemitter.h"
@@ -30,6 +31,7 @@
 #include "bestat.h"
 #include "beutil.h"
 #include "beverify.h"
+#include "callgraph.h"
 #include "execfreq_t.h"
 #include "ident_t.h"
 #include "ircons.h"
@@ -37,6 +39,7 @@
 #include "irdump.h"
 #include "iredges_t.h"
 #include "irgopt.h"
+#include "irgwalk.h"
 #include "irloop_t.h"
 #include "iroptimize.h"
 #include "irprofile.h"
@@ -60,7 +63,11 @@ be_options_t be_options = {
 	.timing               = false,
 	.opt_profile_generate = false,
 	.opt_profile_use      = false,
+	.opt_reorder_funcs    = false,
+	.order_file           = "",
 	.omit_fp              = false,
+	.shrink_wrap          = true,
+	.post_sched           = false,
 	.do_verify            = true,
 	.ilp_solver           = "",
 	.verbose_asm          = true,
@@ -86,10 +93,14 @@ static lc_opt_enum_mask_var_t dump_var = {
 static const lc_opt_table_entry_t be_main_options[] = {
 	LC_OPT_ENT_ENUM_MASK("dump",       "dump irg on several occasions",                       &dump_var),
 	LC_OPT_ENT_BOOL     ("omitfp",     "omit frame pointer",                                  &be_options.omit_fp),
+	LC_OPT_ENT_BOOL     ("shrinkwrap", "set up the stack frame only where it is needed",      &be_options.shrink_wrap),
+	LC_OPT_ENT_BOOL     ("postsched",  "schedule again after register allocation",            &be_options.post_sched),
 	LC_OPT_ENT_BOOL     ("verify",     "verify the backend irg",                              &be_options.do_verify),
 	LC_OPT_ENT_BOOL     ("time",       "get backend timing statistics",                       &be_options.timing),
 	LC_OPT_ENT_BOOL     ("profilegenerate", "instrument the code for execution count profiling", &be_options.opt_profile_generate),
 	LC_OPT_ENT_BOOL     ("profileuse",      "use existing profile data",                         &be_options.opt_profile_use),
+	LC_OPT_ENT_BOOL     ("reorderfuncs",    "order functions and hot/cold sections by profile",  &be_options.opt_reorder_funcs),
+	LC_OPT_ENT_STR      ("orderfile",       "write function order for the linker to this file",  &be_options.order_file),
 	LC_OPT_ENT_BOOL     ("verboseasm", "enable verbose assembler output",                        &be_options.verbose_asm),
 
 	LC_OPT_ENT_STR("ilp.solver", "the ilp solver name", &be_options.ilp_solver),
@@ -281,6 +292,84 @@ static void initialize_birg(be_irg_t *birg, ir_graph *irg, be_main_env_t *env)
 	}
 }
 
+static double get_profile_count(const ir_node *const block)
+{
+	return ir_profile_get_block_execcount(block);
+}
+
+static void max_block_count(ir_node *const block, void *const data)
+{
+	uint32_t *const max   = (uint32_t*)data;
+	uint32_t  const count = ir_profile_get_block_execcount(block);
+	if (count > *max)
+		*max = count;
+}
+
+/**
+ * Classifies functions as hot or cold. A function is hot if one of its blocks
+ * is executed at least 1/HOT_FRACTION times as often as the hottest block of
+ * the compilation unit, and cold if it never executed.
+ */
+static void be_mark_function_hotness(void)
+{
+	enum { HOT_FRACTION = 1000 };
+
+	size_t    const n_irgs    = get_irp_n_irgs();
+	uint32_t *const max_count = XMALLOCNZ(uint32_t, n_irgs);
+	uint32_t        max_total = 0;
+	foreach_irp_irg(i, irg) {
+		irg_block_walk_graph(irg, max_block_count, NULL, &max_count[i]);
+		if (max_count[i] > max_total)
+			max_total = max_count[i];
+	}
+
+	foreach_irp_irg(i, irg) {
+		be_irg_t *const birg = be_birg_from_irg(irg);
+		if (birg == NULL)
+			continue;
+		if (max_count[i] == 0) {
+			birg->hotness = BE_CODE_COLD;
+		} else if ((uint64_t)max_count[i] * HOT_FRACTION >= max_total) {
+			birg->hotness = BE_CODE_HOT;
+		}
+	}
+	free(max_count);
+}
+
+/**
+ * Writes the names of all emitted functions in their final order, usable
+ * as --symbol-ordering-file for the linker.
+ */
+static void be_write_order_file(const char *const filename)
+{
+	FILE *const out = fopen(filename, "w");
+	if (out == NULL) {
+		be_warningf(NULL, "could not open order file '%s'", filename);
+		return;
+	}
+	foreach_irp_irg(i, irg) {
+		if (be_birg_from_irg(irg) == NULL)
+			continue;
+		ir_entity *const entity = get_irg_entity(irg);
+		if (get_entity_visibility(entity) == ir_visibility_private)
+			continue;
+		fprintf(out, "%s\n", get_entity_ld_name(entity));
+	}
+	fclose(out);
+}
+
+/**
+ * Orders the functions by profiled call chains and places hot and cold
+ * functions into separate sections.
+ */
+static void be_reorder_functions(void)
+{
+	order_irp_irgs_by_call_chains(get_profile_count);
+	be_mark_function_hotness();
+	if (be_options.order_file[0] != '\0')
+		be_write_order_file(be_options.order_file);
+}
+
 static ir_graph *be_prepare_profile(const char *const cup_name)
 {
 	obstack_printf(&obst, "%s.prof", cup_name);
@@ -293,7 +382,10 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 		if (!res) {
 			be_warningf(NULL, "could not read profile data '%s'", prof_filename);
 		} else {
+			ir_profile_specialize_values();
 			ir_create_execfreqs_from_profile();
+			if (be_options.opt_reorder_funcs)
+				be_reorder_functions();
 			ir_profile_free();
 			have_profile = true;
 		}
@@ -383,6 +475,7 @@ void be_begin(FILE *file_handle, const char *cup_name)
 		initialize_birg(&birgs[num_birgs++], prof_init_irg, &env);
 
 	be_gas_begin_compilation_unit(&env);
+	be_cache_begin();
 }
 
 void firm_be_finish(void)
@@ -465,6 +558,12 @@ bool be_step_first(ir_graph *irg)
 	if (get_entity_linkage(entity) & IR_LINKAGE_NO_CODEGEN)
 		return false;
 
+	/* replay the code from the cache if possible */
+	if (be_cache_begin_irg(irg)) {
+		be_free_birg(irg);
+		return false;
+	}
+
 	be_timer_push(T_OTHER);
 	if (stat_ev_enabled) {
 		stat_ev_ctx_push_fmt("bemain_irg", "%+F", irg);
@@ -513,6 +612,8 @@ void be_step_regalloc(ir_graph *irg, const regalloc_if_t *regif)
 
 void be_step_last(ir_graph *irg)
 {
+	be_cache_end_irg(irg);
+
 	if (stat_ev_enabled) {
 		stat_ev_ull("bemain_insns_finish", be_count_insns(irg));
 		stat_ev_ull("bemain_blocks_finish", be_count_blocks(irg));
@@ -551,6 +652,7 @@ void be_step_last(ir_graph *irg)
 
 void be_finish(void)
 {
+	be_cache_finish();
 	be_gas_end_compilation_unit(&env);
 
 	if (be_options.timing) {
@@ -29,6 +29,7 @@ struct be_module_list_entry_t {
 void be_init_2addr(void);
 void be_init_arch(void);
 void be_init_blocksched(void);
+void be_init_cache(void);
 void be_init_chordal(void);
 void be_init_chordal_common(void);
 void be_init_chordal_main(void);
@@ -45,9 +46,11 @@ void be_init_loopana(void);
 void be_init_pbqp(void);
 void be_init_pbqp_coloring(void);
 void be_init_peephole(void);
+void be_init_postsched(void);
 void be_init_pref_alloc(void);
 void be_init_ra(void);
 void be_init_sched(void);
+void be_init_sched_latency(void);
 void be_init_sched_normal(void);
 void be_init_sched_rand(void);
 void be_init_sched_trivial(void);
@@ -74,12 +77,14 @@ void be_init_modules(void)
 	be_init_2addr();
 	be_init_arch();
 	be_init_blocksched();
+	be_init_cache();
 	be_init_chordal_common();
 	be_init_copyopt();
 	be_init_dwarf();
 	be_init_live();
 	be_init_loopana();
 	be_init_peephole();
+	be_init_postsched();
 	be_init_ra();
 	be_init_sched();
 	be_init_spill();
@@ -101,6 +106,7 @@ void be_init_modules(void)
 	be_init_sched_normal();
 	be_init_sched_rand();
 	be_init_sched_trivial();
+	be_init_sched_latency();
 
 	be_init_chordal_main();
 	be_init_pref_alloc();
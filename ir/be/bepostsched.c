@@ -0,0 +1,379 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Instruction scheduling after register allocation.
+ *
+ * The spiller, the SSA destruction and the 2-address fixup insert reloads,
+ * copies and permutations right in front of their users. This pass builds a
+ * dependency graph for each block and list schedules it again, preferring
+ * nodes whose operands are available and which lie on the longest latency
+ * weighted path to the block end.
+ *
+ * As the registers are assigned already, every register is a resource with
+ * read after write, write after read and write after write dependencies. The
+ * flags register is written by all nodes which modify the flags, even if they
+ * do not produce a flags value. Nodes with a memory input read memory and
+ * nodes with a memory result write it.
+ *
+ * Spill slots are tracked separately, so reloads can be hoisted above stores
+ * and other spills: a reload cannot read a slot that a preceding spill
+ * overwrote, as the reloaded value would be dead then. Only a later spill to a
+ * coalesced slot has to stay behind the reload.
+ */
+#include "bepostsched.h"
+
+#include "be_t.h"
+#include "bearch.h"
+#include "bemodule.h"
+#include "besched.h"
+#include "debug.h"
+#include "iredges_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "obst.h"
+#include "raw_bitset.h"
+#include "target_t.h"
+#include "util.h"
+#include "xmalloc.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+typedef struct dep_edge_t dep_edge_t;
+struct dep_edge_t {
+	dep_edge_t *next;
+	unsigned    to;      /**< index of the dependent node */
+	unsigned    latency; /**< cycles between the issue of both nodes */
+};
+
+typedef struct dep_node_t {
+	ir_node    *node;
+	dep_edge_t *succs;
+	unsigned    n_preds;  /**< unscheduled predecessors */
+	unsigned    latency;
+	unsigned    path;     /**< latency weighted distance to the block end */
+	unsigned    ready;    /**< earliest cycle without stalls */
+} dep_node_t;
+
+typedef struct post_sched_env_t {
+	struct obstack              obst;
+	arch_register_class_t const *flag_cls;
+	unsigned                    *index;       /**< node idx -> dep node index */
+	unsigned                     n_res;       /**< registers and memory */
+	unsigned                     mem_res;
+	unsigned                     slot_res;    /**< spill slots */
+	int                         *last_writer;
+	unsigned                   **readers;     /**< readers after last_writer */
+	dep_node_t                  *deps;        /**< nodes of the block */
+	unsigned                    *order;       /**< new schedule of the block */
+} post_sched_env_t;
+
+static void add_dep(post_sched_env_t *const env, unsigned const from,
+                    unsigned const to, unsigned const latency)
+{
+	if (from == to)
+		return;
+	dep_edge_t *const edge = OALLOC(&env->obst, dep_edge_t);
+	edge->next    = env->deps[from].succs;
+	edge->to      = to;
+	edge->latency = latency;
+	env->deps[from].succs = edge;
+	++env->deps[to].n_preds;
+}
+
+static void read_res(post_sched_env_t *const env, unsigned const res,
+                     unsigned const n)
+{
+	int const writer = env->last_writer[res];
+	if (writer >= 0)
+		add_dep(env, writer, n, env->deps[writer].latency);
+	ARR_APP1(unsigned, env->readers[res], n);
+}
+
+static void write_res(post_sched_env_t *const env, unsigned const res,
+                      unsigned const n)
+{
+	int const writer = env->last_writer[res];
+	if (writer >= 0)
+		add_dep(env, writer, n, 0);
+	for (size_t i = 0, n_readers = ARR_LEN(env->readers[res]); i < n_readers;
+	     ++i) {
+		add_dep(env, env->readers[res][i], n, 0);
+	}
+	ARR_SHRINKLEN(env->readers[res], 0);
+	env->last_writer[res] = n;
+}
+
+/**
+ * Adds a spill to the resource @p res. Spills never overwrite a slot which is
+ * read later on, so unlike other writers they only depend on the preceding
+ * nodes.
+ */
+static void write_spill(post_sched_env_t *const env, unsigned const res,
+                        unsigned const n)
+{
+	int const writer = env->last_writer[res];
+	if (writer >= 0)
+		add_dep(env, writer, n, 0);
+	for (size_t i = 0, n_readers = ARR_LEN(env->readers[res]); i < n_readers;
+	     ++i) {
+		add_dep(env, env->readers[res][i], n, 0);
+	}
+}
+
+static void write_reg(post_sched_env_t *const env,
+                      arch_register_t const *const reg, unsigned const n)
+{
+	write_res(env, reg->global_index, n);
+}
+
+/**
+ * Adds the registers written by output @p pos of @p node. Outputs without a
+ * projection (e.g. the clobbers of a call) have no register assigned, so all
+ * registers they are limited to count as written.
+ */
+static void write_out(post_sched_env_t *const env, ir_node const *const node,
+                      unsigned const pos, unsigned const n)
+{
+	arch_register_t const *const reg = arch_get_irn_register_out(node, pos);
+	if (reg != NULL) {
+		write_reg(env, reg, n);
+		return;
+	}
+	arch_register_req_t const *const req
+		= arch_get_irn_register_req_out(node, pos);
+	arch_register_class_t const *const cls = req->cls;
+	if (cls == NULL || req->limited == NULL)
+		return;
+	rbitset_foreach(req->limited, cls->n_regs, i) {
+		write_reg(env, &cls->regs[i], n);
+	}
+}
+
+static bool writes_memory(ir_node const *const node)
+{
+	if (get_irn_mode(node) == mode_M)
+		return true;
+	if (get_irn_mode(node) != mode_T)
+		return false;
+	foreach_out_edge(node, edge) {
+		ir_node const *const proj = get_edge_src_irn(edge);
+		if (is_Proj(proj) && get_irn_mode(proj) == mode_M)
+			return true;
+	}
+	return false;
+}
+
+static bool is_barrier(ir_node const *const node)
+{
+	return is_cfop(node) || arch_irn_is(node, schedule_first);
+}
+
+static unsigned get_latency(ir_node const *const node)
+{
+	return arch_get_op_latency(node);
+}
+
+static void build_deps(post_sched_env_t *const env, ir_node *const block,
+                       unsigned const n_nodes)
+{
+	for (unsigned r = 0; r < env->n_res; ++r) {
+		env->last_writer[r] = -1;
+		ARR_SHRINKLEN(env->readers[r], 0);
+	}
+
+	int last_barrier = -1;
+	for (unsigned n = 0; n < n_nodes; ++n) {
+		ir_node *const node = env->deps[n].node;
+
+		if (is_barrier(node)) {
+			for (unsigned i = last_barrier + 1; i < n; ++i)
+				add_dep(env, i, n, 0);
+			last_barrier = n;
+		} else if (last_barrier >= 0) {
+			add_dep(env, last_barrier, n, 0);
+		}
+
+		bool reads_memory = false;
+		foreach_irn_in(node, i, op) {
+			if (get_irn_mode(op) == mode_M) {
+				reads_memory = true;
+				continue;
+			}
+			arch_register_t const *const reg = arch_get_irn_register(op);
+			if (reg != NULL)
+				read_res(env, reg->global_index, n);
+		}
+		/* Data dependencies on values without a register. */
+		foreach_irn_in(node, i, op) {
+			ir_node *const pred = skip_Proj(op);
+			if (get_nodes_block(pred) == block && !is_Phi(pred)
+			 && sched_is_scheduled(pred)) {
+				unsigned const p = env->index[get_irn_idx(pred)];
+				add_dep(env, p, n, env->deps[p].latency);
+			}
+		}
+		bool const is_spill  = arch_irn_is(node, spill);
+		bool const is_reload = arch_irn_is(node, reload);
+		if (is_reload) {
+			read_res(env, env->slot_res, n);
+		} else if (reads_memory && !is_spill) {
+			read_res(env, env->mem_res, n);
+			read_res(env, env->slot_res, n);
+		}
+
+		be_foreach_out(node, o) {
+			write_out(env, node, o, n);
+		}
+		if (arch_irn_is(node, modify_flags))
+			write_reg(env, &env->flag_cls->regs[0], n);
+		if (is_spill) {
+			write_spill(env, env->slot_res, n);
+		} else if (writes_memory(node)) {
+			write_res(env, env->mem_res, n);
+			write_res(env, env->slot_res, n);
+		}
+	}
+}
+
+static unsigned select_node(post_sched_env_t const *const env,
+                            unsigned const *const ready, unsigned const cycle)
+{
+	unsigned best       = (unsigned)-1;
+	unsigned best_ready = 0;
+	unsigned best_path  = 0;
+	for (size_t i = 0, n = ARR_LEN(ready); i < n; ++i) {
+		unsigned          const  c    = ready[i];
+		dep_node_t const *const  dep  = &env->deps[c];
+		unsigned          const  time = MAX(dep->ready, cycle);
+		if (best != (unsigned)-1) {
+			/* Avoid stalls first, then take the longest path, then keep the
+			 * original order. */
+			if (time != best_ready) {
+				if (time > best_ready)
+					continue;
+			} else if (dep->path != best_path) {
+				if (dep->path < best_path)
+					continue;
+			} else if (c > best) {
+				continue;
+			}
+		}
+		best       = c;
+		best_ready = time;
+		best_path  = dep->path;
+	}
+	return best;
+}
+
+static void sched_block(ir_node *const block, void *const data)
+{
+	post_sched_env_t *const env  = (post_sched_env_t*)data;
+	void             *const base = obstack_base(&env->obst);
+
+	unsigned n_nodes = 0;
+	sched_foreach_non_phi(block, node) {
+		dep_node_t const dep = { .node = node, .latency = get_latency(node) };
+		env->index[get_irn_idx(node)] = n_nodes++;
+		ARR_APP1(dep_node_t, env->deps, dep);
+	}
+	if (n_nodes > 1) {
+		build_deps(env, block, n_nodes);
+		ARR_RESIZE(unsigned, env->order, n_nodes);
+
+		for (unsigned n = n_nodes; n-- > 0;) {
+			dep_node_t *const dep  = &env->deps[n];
+			unsigned          path = 0;
+			for (dep_edge_t const *e = dep->succs; e != NULL; e = e->next)
+				path = MAX(path, env->deps[e->to].path);
+			dep->path = dep->latency + path;
+		}
+
+		unsigned *ready = NEW_ARR_F(unsigned, 0);
+		for (unsigned n = 0; n < n_nodes; ++n) {
+			if (env->deps[n].n_preds == 0)
+				ARR_APP1(unsigned, ready, n);
+		}
+
+		bool     changed = false;
+		unsigned cycle   = 0;
+		for (unsigned pos = 0; pos < n_nodes; ++pos) {
+			unsigned    const c   = select_node(env, ready, cycle);
+			dep_node_t *const dep = &env->deps[c];
+			for (size_t i = 0, n = ARR_LEN(ready); i < n; ++i) {
+				if (ready[i] == c) {
+					ready[i] = ready[n - 1];
+					ARR_SHRINKLEN(ready, n - 1);
+					break;
+				}
+			}
+			unsigned const issue = MAX(dep->ready, cycle);
+			cycle = issue + 1;
+			for (dep_edge_t const *e = dep->succs; e != NULL; e = e->next) {
+				dep_node_t *const succ = &env->deps[e->to];
+				succ->ready = MAX(succ->ready, issue + e->latency);
+				if (--succ->n_preds == 0)
+					ARR_APP1(unsigned, ready, e->to);
+			}
+
+			env->order[pos] = c;
+			changed |= c != pos;
+		}
+		assert(ARR_LEN(ready) == 0);
+		DEL_ARR_F(ready);
+
+		if (changed) {
+			DB((dbg, LEVEL_1, "rescheduling %+F\n", block));
+			for (unsigned pos = 0; pos < n_nodes; ++pos) {
+				ir_node *const node = env->deps[env->order[pos]].node;
+				DB((dbg, LEVEL_2, "\t%+F (path %u)\n", node,
+				    env->deps[env->order[pos]].path));
+				sched_remove(node);
+				sched_add_before(block, node);
+			}
+		}
+	}
+
+	ARR_SHRINKLEN(env->deps, 0);
+	obstack_free(&env->obst, base);
+}
+
+void be_schedule_after_ra(ir_graph *const irg,
+                          arch_register_class_t const *const flag_cls)
+{
+	unsigned const n_res = ir_target.isa->n_registers + 2;
+	post_sched_env_t env = {
+		.flag_cls    = flag_cls,
+		.index       = XMALLOCN(unsigned, get_irg_last_idx(irg)),
+		.n_res       = n_res,
+		.mem_res     = n_res - 2,
+		.slot_res    = n_res - 1,
+		.last_writer = XMALLOCN(int, n_res),
+		.readers     = XMALLOCN(unsigned*, n_res),
+		.deps        = NEW_ARR_F(dep_node_t, 0),
+		.order       = NEW_ARR_F(unsigned, 0),
+	};
+	obstack_init(&env.obst);
+	for (unsigned r = 0; r < n_res; ++r)
+		env.readers[r] = NEW_ARR_F(unsigned, 0);
+
+	irg_block_walk_graph(irg, NULL, sched_block, &env);
+
+	DEL_ARR_F(env.order);
+	for (unsigned r = 0; r < n_res; ++r)
+		DEL_ARR_F(env.readers[r]);
+	DEL_ARR_F(env.deps);
+	free(env.readers);
+	free(env.last_writer);
+	free(env.index);
+	obstack_free(&env.obst, NULL);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_postsched)
+void be_init_postsched(void)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.be.postsched");
+}
@@ -0,0 +1,26 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Instruction scheduling after register allocation.
+ */
+#ifndef FIRM_BE_BEPOSTSCHED_H
+#define FIRM_BE_BEPOSTSCHED_H
+
+#include "be_types.h"
+#include "firm_types.h"
+
+/**
+ * Reorders the instructions inside each block of @p irg after register
+ * allocation to hide latencies, e.g. of reloads inserted by the spiller.
+ * Besides the data dependencies, the assigned registers (anti and output
+ * dependencies), the flags register of @p flag_cls (clobbered by nodes marked
+ * with arch_irn_flag_modify_flags) and memory are respected.
+ * Must run before the x87 simulation.
+ */
+void be_schedule_after_ra(ir_graph *irg, arch_register_class_t const *flag_cls);
+
+#endif
@@ -33,6 +33,7 @@
 #include "bespill.h"
 #include "bespillutil.h"
 #include "bestack.h"
+#include "bestat.h"
 #include "beutil.h"
 #include "beverify.h"
 #include "debug.h"
@@ -318,6 +319,28 @@ static void analyze_block(ir_node *block, void *data)
 	ir_nodeset_destroy(&live_nodes);
 }
 
+/**
+ * Merge the congruence classes with the representatives @p set1 and @p set2
+ * and sum up their preferences in the new representative.
+ */
+static int merge_congruence_classes(int const set1, int const set2)
+{
+	/* adding the preferences to themselves would double them */
+	if (set1 == set2)
+		return set1;
+
+	int const head  = uf_union(congruence_classes, set1, set2);
+	int const other = head == set1 ? set2 : set1;
+	allocation_info_t *const head_info
+		= get_allocation_info(get_idx_irn(irg, head));
+	allocation_info_t *const other_info
+		= get_allocation_info(get_idx_irn(irg, other));
+	for (unsigned r = 0; r < n_regs; ++r) {
+		head_info->prefs[r] += other_info->prefs[r];
+	}
+	return head;
+}
+
 static void congruence_def(ir_nodeset_t *const live_nodes, ir_node const *const node, arch_register_req_t const *const req)
 {
 	/* should be same constraint? */
@@ -347,7 +370,7 @@ static void congruence_def(ir_nodeset_t *const live_nodes, ir_node const *const
 			if (interferes)
 				continue;
 
-			uf_union(congruence_classes, node_idx, op_idx);
+			merge_congruence_classes(node_idx, op_idx);
 			DB((dbg, LEVEL_3, "Merge %+F and %+F congruence classes\n",
 			    node, op));
 			/* one should_be_same is enough... */
@@ -419,19 +442,9 @@ static void create_congruence_class(ir_node *block, void *data)
 				continue;
 
 			/* merge the 2 congruence classes and sum up their preferences */
-			int old_node_idx = node_idx;
-			node_idx = uf_union(congruence_classes, node_idx, op_idx);
+			node_idx = merge_congruence_classes(node_idx, op_idx);
 			DB((dbg, LEVEL_3, "Merge %+F and %+F congruence classes\n",
 			    phi, op));
-
-			old_node_idx = node_idx == old_node_idx ? op_idx : old_node_idx;
-			allocation_info_t *head_info
-				= get_allocation_info(get_idx_irn(irg, node_idx));
-			allocation_info_t *other_info
-				= get_allocation_info(get_idx_irn(irg, old_node_idx));
-			for (unsigned r = 0; r < n_regs; ++r) {
-				head_info->prefs[r] += other_info->prefs[r];
-			}
 		}
 	}
 	ir_nodeset_destroy(&live_nodes);
@@ -1789,6 +1802,10 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 	/* determine a good coloring order */
 	determine_block_order();
 
+	be_node_stats_t last_node_stats;
+	if (stat_ev_enabled)
+		be_collect_node_stats(&last_node_stats, irg);
+
 	arch_register_class_t const *const reg_classes
 		= ir_target.isa->register_classes;
 	for (int c = 0, n_cls = ir_target.isa->n_register_classes; c < n_cls; ++c) {
@@ -1802,7 +1819,10 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 		normal_regs = rbitset_malloc(n_regs);
 		be_get_allocatable_regs(irg, cls, normal_regs);
 
+		double const pre_spill_cost
+			= stat_ev_enabled ? be_estimate_irg_costs(irg) : 0;
 		spill(regif);
+		stat_ev_dbl("bepref_spillcosts", be_estimate_irg_costs(irg) - pre_spill_cost);
 
 		/* verify schedule and register pressure */
 		if (be_options.do_verify) {
@@ -1823,6 +1843,14 @@ static void be_pref_alloc(ir_graph *new_irg, const regalloc_if_t *regif)
 		be_invalidate_live_sets(irg);
 		free(normal_regs);
 
+		if (stat_ev_enabled) {
+			be_node_stats_t node_stats;
+			be_collect_node_stats(&node_stats, irg);
+			be_subtract_node_stats(&node_stats, &last_node_stats);
+			be_emit_node_stats(&node_stats, "bepref_");
+			be_copy_node_stats(&last_node_stats, &node_stats);
+		}
+
 		stat_ev_ctx_pop("regcls");
 	}
 
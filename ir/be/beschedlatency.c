@@ -0,0 +1,312 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Latency driven list scheduler
+ *
+ * Prioritizes the ready nodes by the length of the longest latency weighted
+ * path from them to the end of their block (the critical path), using the
+ * latency model of the target (arch_get_op_latency()). The scheduler keeps
+ * track of the cycle in which the operands of each node become available and
+ * prefers nodes which can issue without stalling.
+ *
+ * To balance latency hiding against register pressure, the number of values
+ * defined in the block and still live is tracked per register class. Once a
+ * class gets close to the number of allocatable registers, nodes which end
+ * more live ranges than they start are preferred.
+ */
+#include "be_t.h"
+#include "bearch.h"
+#include "belistsched.h"
+#include "bemodule.h"
+#include "besched.h"
+#include "debug.h"
+#include "iredges_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "irnodeset.h"
+#include "target_t.h"
+#include "util.h"
+#include "xmalloc.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+typedef struct node_info_t {
+	unsigned path;       /**< latency weighted distance to the block end */
+	unsigned issue;      /**< cycle in which the node was scheduled */
+	unsigned n_users;    /**< unscheduled register users in the block */
+	bool     path_valid;
+	bool     live_out;   /**< value is used by a Phi or in another block */
+} node_info_t;
+
+typedef struct sched_env_t {
+	node_info_t *infos;
+	unsigned     n_classes;
+	unsigned    *live;      /**< live values per register class */
+	unsigned    *limit;     /**< allocatable registers per register class */
+	unsigned     cycle;     /**< cycle of the next issue */
+} sched_env_t;
+
+static sched_env_t env;
+
+static node_info_t *get_info(ir_node const *const node)
+{
+	return &env.infos[get_irn_idx(node)];
+}
+
+static unsigned get_latency(ir_node const *const node)
+{
+	if (arch_is_irn_not_scheduled(node))
+		return 0;
+	return arch_get_op_latency(node);
+}
+
+/**
+ * Returns the register class of @p value, if it occupies a register while
+ * it is live.
+ */
+static arch_register_class_t const *get_value_class(ir_node const *const value)
+{
+	arch_register_req_t const *const req = arch_get_irn_register_req(value);
+	if (req->cls == NULL || req->ignore || req->cls->manual_ra)
+		return NULL;
+	return req->cls;
+}
+
+static bool is_block_user(ir_node const *const user, ir_node const *const block)
+{
+	return !is_Block(user) && !is_Anchor(user) && !is_End(user)
+	    && !is_Phi(user) && get_nodes_block(user) == block;
+}
+
+static unsigned compute_path(ir_node *const node)
+{
+	node_info_t *const info = get_info(node);
+	if (info->path_valid)
+		return info->path;
+
+	ir_node const *const block = get_nodes_block(node);
+	unsigned             max   = 0;
+	foreach_out_edge(node, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_block_user(user, block))
+			max = MAX(max, compute_path(user));
+	}
+	info->path       = get_latency(node) + max;
+	info->path_valid = true;
+	return info->path;
+}
+
+static void init_value(ir_node const *const value, ir_node const *const block)
+{
+	node_info_t *const info = get_info(value);
+	foreach_out_edge(value, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_block_user(user, block))
+			++info->n_users;
+		else if (!is_Anchor(user) && !is_End(user))
+			info->live_out = true;
+	}
+}
+
+static void init_block(ir_node *const block)
+{
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (is_Phi(node) || arch_is_irn_not_scheduled(node))
+			continue;
+		compute_path(node);
+		be_foreach_value(node, value,
+			if (get_value_class(value) != NULL)
+				init_value(value, block);
+		);
+	}
+	memset(env.live, 0, env.n_classes * sizeof(*env.live));
+	env.cycle = 0;
+}
+
+/**
+ * Returns the cycle in which all operands of @p node are available.
+ */
+static unsigned get_ready_time(ir_node const *const node)
+{
+	ir_node const *const block = get_nodes_block(node);
+	unsigned             ready = 0;
+	foreach_irn_in(node, i, op) {
+		ir_node *const pred = skip_Proj(op);
+		if (is_Block(pred) || get_nodes_block(pred) != block || is_Phi(pred)
+		 || arch_is_irn_not_scheduled(pred))
+			continue;
+		ready = MAX(ready, get_info(pred)->issue + get_latency(pred));
+	}
+	return ready;
+}
+
+static bool is_pressured(arch_register_class_t const *const cls)
+{
+	return env.live[cls->index] + 1 >= env.limit[cls->index];
+}
+
+/**
+ * Returns how much scheduling @p node increases the number of live values in
+ * register classes which are short on registers.
+ */
+static int get_pressure_delta(ir_node *const node)
+{
+	int delta = 0;
+	be_foreach_value(node, value,
+		arch_register_class_t const *const cls = get_value_class(value);
+		if (cls != NULL && is_pressured(cls))
+			++delta;
+	);
+
+	ir_node const *const block = get_nodes_block(node);
+	foreach_irn_in(node, i, op) {
+		if (get_nodes_block(op) != block || is_Phi(op))
+			continue;
+		arch_register_class_t const *const cls = get_value_class(op);
+		if (cls == NULL || !is_pressured(cls))
+			continue;
+		node_info_t const *const info = get_info(op);
+		if (info->live_out)
+			continue;
+		/* The value dies if node holds all its remaining uses. */
+		unsigned n_uses = 0;
+		foreach_irn_in(node, j, other) {
+			if (other != op)
+				continue;
+			if (j < i)
+				goto next_op;
+			++n_uses;
+		}
+		if (info->n_users == n_uses)
+			--delta;
+next_op:;
+	}
+	return delta;
+}
+
+static bool any_pressured(void)
+{
+	for (unsigned i = 0; i < env.n_classes; ++i) {
+		if (env.limit[i] != 0 && env.live[i] + 1 >= env.limit[i])
+			return true;
+	}
+	return false;
+}
+
+static ir_node *latency_select(ir_nodeset_t *const ready_set)
+{
+	bool const pressured = any_pressured();
+
+	ir_node *best       = NULL;
+	int      best_delta = 0;
+	unsigned best_ready = 0;
+	unsigned best_path  = 0;
+	foreach_ir_nodeset(ready_set, node, iter) {
+		int      const delta = pressured ? get_pressure_delta(node) : 0;
+		unsigned const ready = MAX(get_ready_time(node), env.cycle);
+		unsigned const path  = get_info(node)->path;
+		if (best != NULL) {
+			/* Relieve register pressure first, then avoid stalls, then take
+			 * the node on the longest path. */
+			if (delta != best_delta) {
+				if (delta > best_delta)
+					continue;
+			} else if (ready != best_ready) {
+				if (ready > best_ready)
+					continue;
+			} else if (path != best_path) {
+				if (path < best_path)
+					continue;
+			} else if (get_irn_idx(node) > get_irn_idx(best)) {
+				continue;
+			}
+		}
+		best       = node;
+		best_delta = delta;
+		best_ready = ready;
+		best_path  = path;
+	}
+
+	DB((dbg, LEVEL_2, "\tselect %+F (path %u, ready %u, delta %d)\n", best,
+	    best_path, best_ready, best_delta));
+	return best;
+}
+
+static void update_after_schedule(ir_node *const node)
+{
+	unsigned const ready = MAX(get_ready_time(node), env.cycle);
+	get_info(node)->issue = ready;
+	env.cycle = ready + 1;
+
+	ir_node const *const block = get_nodes_block(node);
+	foreach_irn_in(node, i, op) {
+		if (get_nodes_block(op) != block || is_Phi(op))
+			continue;
+		arch_register_class_t const *const cls = get_value_class(op);
+		if (cls == NULL)
+			continue;
+		node_info_t *const info = get_info(op);
+		assert(info->n_users > 0);
+		if (--info->n_users == 0 && !info->live_out)
+			--env.live[cls->index];
+	}
+
+	be_foreach_value(node, value,
+		arch_register_class_t const *const cls = get_value_class(value);
+		if (cls != NULL) {
+			node_info_t const *const info = get_info(value);
+			if (info->n_users > 0 || info->live_out)
+				++env.live[cls->index];
+		}
+	);
+}
+
+static void sched_block(ir_node *const block, void *const data)
+{
+	(void)data;
+	init_block(block);
+
+	ir_nodeset_t *const cands = be_list_sched_begin_block(block);
+	while (ir_nodeset_size(cands) > 0) {
+		ir_node *const node = latency_select(cands);
+		update_after_schedule(node);
+		be_list_sched_schedule(node);
+	}
+	be_list_sched_end_block();
+}
+
+static void sched_latency(ir_graph *const irg)
+{
+	be_list_sched_begin(irg);
+
+	unsigned const n_classes = ir_target.isa->n_register_classes;
+	env.infos     = XMALLOCNZ(node_info_t, get_irg_last_idx(irg));
+	env.n_classes = n_classes;
+	env.live      = XMALLOCNZ(unsigned, n_classes);
+	env.limit     = XMALLOCNZ(unsigned, n_classes);
+	for (unsigned i = 0; i < n_classes; ++i) {
+		arch_register_class_t const *const cls
+			= &ir_target.isa->register_classes[i];
+		if (!cls->manual_ra)
+			env.limit[i] = be_get_n_allocatable_regs(irg, cls);
+	}
+
+	irg_block_walk_graph(irg, sched_block, NULL, NULL);
+
+	free(env.limit);
+	free(env.live);
+	free(env.infos);
+	be_list_sched_finish();
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_sched_latency)
+void be_init_sched_latency(void)
+{
+	be_register_scheduler("latency", sched_latency);
+	FIRM_DBG_REGISTER(dbg, "firm.be.sched.latency");
+}
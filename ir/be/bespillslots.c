@@ -358,6 +358,8 @@ typedef struct spill_slot_t {
 	ir_entity *entity;
 	unsigned   size;
 	unsigned   po2align;
+	bool       used;
+	double     freq;     /**< execution frequency of the accesses */
 } spill_slot_t;
 
 typedef struct memperm_entry_t memperm_entry_t;
@@ -417,9 +419,29 @@ static void assign_spill_entity(be_fec_env_t *env, ir_node *node,
 	env->set_frame_entity(node, entity, size, po2align);
 }
 
+static double get_access_freq(ir_node const *const node)
+{
+	if (is_Phi(node) || is_NoMem(node))
+		return 0;
+	return get_block_execfreq(get_nodes_block(node));
+}
+
+static int cmp_slot_freq(const void *p0, const void *p1)
+{
+	spill_slot_t const *const slot0 = *(spill_slot_t const**)p0;
+	spill_slot_t const *const slot1 = *(spill_slot_t const**)p1;
+	if (slot0->freq != slot1->freq)
+		return slot0->freq < slot1->freq ? -1 : 1;
+	return QSORT_CMP(slot0, slot1);
+}
+
 /**
  * Create stack entities for the spillslots and assign them to the spill and
  * reload nodes.
+ * The entities are created in order of increasing access frequency:
+ * be_sort_frame_entities() places the spillslots created last nearest to the
+ * register the frame is addressed with, so the most frequently accessed slots
+ * get the shortest displacements.
  */
 static void assign_spillslots(be_fec_env_t *env)
 {
@@ -436,18 +458,35 @@ static void assign_spillslots(be_fec_env_t *env)
 
 		slot->size     = MAX(slot->size, web->slot_size);
 		slot->po2align = MAX(slot->po2align, web->slot_po2align);
+		slot->used     = true;
+		slot->freq    += get_access_freq(spill->spill);
+	}
+	for (size_t s = 0; s < ARR_LEN(env->reloads); ++s) {
+		ir_node       *const reload = env->reloads[s];
+		const spill_t *const spill  = get_spill(env, get_memory_edge(reload));
+		spillslots[spill->spillslot].freq += get_access_freq(reload);
 	}
 
+	size_t               n_slots = 0;
+	spill_slot_t **const sorted  = ALLOCAN(spill_slot_t*, spillcount);
+	for (size_t s = 0; s < spillcount; ++s) {
+		if (spillslots[s].used)
+			sorted[n_slots++] = &spillslots[s];
+	}
+	QSORT(sorted, n_slots, cmp_slot_freq);
+
 	ir_type *const frame = get_irg_frame_type(env->irg);
+	for (size_t i = 0; i < n_slots; ++i) {
+		spill_slot_t *const slot = sorted[i];
+		slot->entity = new_spillslot(frame, slot->size, slot->po2align);
+	}
+
 	for (size_t s = 0; s < spillcount; ++s) {
 		const spill_t *spill  = spills[s];
 		ir_node       *node   = spill->spill;
 		int            slotid = spill->spillslot;
 		spill_slot_t  *slot   = &spillslots[slotid];
 
-		if (slot->entity == NULL)
-			slot->entity = new_spillslot(frame, slot->size, slot->po2align);
-
 		if (is_Phi(node)) {
 			ir_node *block = get_nodes_block(node);
 
@@ -461,10 +500,6 @@ static void assign_spillslots(be_fec_env_t *env)
 
 				if (slotid != argslotid) {
 					spill_slot_t *argslot = &spillslots[argslotid];
-					if (argslot->entity == NULL)
-						argslot->entity = new_spillslot(frame, argslot->size,
-						                                argslot->po2align);
-
 					memperm_t *const memperm = get_memperm(env, predblock);
 					memperm_entry_t *const entry
 						= OALLOC(&env->obst, memperm_entry_t);
@@ -347,6 +347,32 @@ static bool is_value_available(spill_env_t *env, const ir_node *arg)
 	return false;
 }
 
+/**
+ * Tests whether the flags are live before node @p before. Values of manually
+ * allocated register classes like the flags never live across blocks after
+ * be_sched_fix_flags(), so it is enough to look at the rest of the block.
+ * Conservatively returns true if @p before is not a scheduled node.
+ */
+static bool are_flags_live_before(const ir_node *before)
+{
+	if (before == NULL || is_Block(before) || is_Proj(before)
+	    || !sched_is_scheduled(before))
+		return true;
+
+	for (const ir_node *node = before; !sched_is_end(node);
+	     node = sched_next(node)) {
+		for (int i = 0, arity = get_irn_arity(node); i < arity; ++i) {
+			const arch_register_req_t *req
+				= arch_get_irn_register_req_in(node, i);
+			if (req->cls != NULL && req->cls->manual_ra)
+				return true;
+		}
+		if (arch_irn_is(node, modify_flags))
+			return false;
+	}
+	return false;
+}
+
 /**
  * Check if a node is rematerializable. This tests for the following conditions:
  *
@@ -373,11 +399,9 @@ static int check_remat_conditions_costs(spill_env_t *env,
 	if (parentcosts + costs >= spillcosts)
 		return REMAT_COST_INFINITE;
 
-	/* never rematerialize a node which modifies the flags.
-	 * (would be better to test whether the flags are actually live at point
-	 * reloader...)
-	 */
-	if (arch_irn_is(insn, modify_flags))
+	/* never rematerialize a node which modifies the flags while they are
+	 * live */
+	if (arch_irn_is(insn, modify_flags) && are_flags_live_before(reloader))
 		return REMAT_COST_INFINITE;
 
 	int argremats = 0;
@@ -17,15 +17,21 @@
  */
 #include "bestack.h"
 
+#include "array.h"
+#include "be_t.h"
 #include "beirg.h"
 #include "benode.h"
 #include "besched.h"
 #include "bessaconstr.h"
+#include "execfreq.h"
 #include "ircons_t.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
+#include "raw_bitset.h"
+#include "statev_t.h"
 #include "util.h"
 
 static unsigned round_up2_misaligned(unsigned const offset,
@@ -55,13 +61,15 @@ static void sim_be_IncSP(ir_node *node, stack_pointer_state_t *state)
  */
 static void process_stack_bias(sp_sim_func const sim, ir_node *const block,
                                unsigned const p2align, unsigned const misalign,
-                               int offset, unsigned align_padding)
+                               int offset, unsigned align_padding,
+                               int *const block_offsets)
 {
 	/* TODO: We really should check that offset corresponds to the one we got
 	 * last time when the block was already visited. Add a map in debug mode? */
 	if (Block_block_visited(block))
 		return;
 	mark_Block_block_visited(block);
+	block_offsets[get_irn_idx(block)] = offset;
 
 	stack_pointer_state_t state = {
 		.misalign      = misalign,
@@ -82,18 +90,23 @@ static void process_stack_bias(sp_sim_func const sim, ir_node *const block,
 	foreach_block_succ(block, edge) {
 		ir_node *succ = get_edge_src_irn(edge);
 		process_stack_bias(sim, succ, p2align, misalign,
-		                   state.offset, state.align_padding);
+		                   state.offset, state.align_padding, block_offsets);
 	}
 }
 
 void be_sim_stack_pointer(ir_graph *const irg, unsigned const misalign,
                           unsigned const p2align, sp_sim_func const sim)
 {
-	ir_node *const start_block = get_irg_start_block(irg);
+	ir_node  *const start_block   = get_irg_start_block(irg);
+	be_irg_t *const birg          = be_birg_from_irg(irg);
+	int      *const block_offsets
+		= NEW_ARR_DZ(int, &birg->obst, get_irg_last_idx(irg));
+	birg->block_sp_offsets = block_offsets;
 
 	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED);
 	inc_irg_block_visited(irg);
-	process_stack_bias(sim, start_block, p2align, misalign, 0, 0);
+	process_stack_bias(sim, start_block, p2align, misalign, 0, 0,
+	                   block_offsets);
 	ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
 }
 
@@ -177,6 +190,107 @@ void be_fix_stack_nodes(ir_graph *const irg, arch_register_t const *const sp)
 	}
 }
 
+/**
+ * Returns the block in which @p user uses the operand at position @p pos.
+ */
+static ir_node *get_use_block(ir_node const *const user, int const pos)
+{
+	ir_node *const block = get_nodes_block(user);
+	return is_Phi(user) ? get_Block_cfgpred_block(block, pos) : block;
+}
+
+typedef struct frame_region_env_t {
+	ir_node *head;      /**< the block dominating the region */
+	ir_node *end_block;
+	bool     closed;    /**< no control flow leaves the region */
+} frame_region_env_t;
+
+static void check_region_closed(ir_node *const block, void *const data)
+{
+	frame_region_env_t *const env = (frame_region_env_t*)data;
+	foreach_block_succ(block, edge) {
+		ir_node *const succ = get_edge_src_irn(edge);
+		if (succ == env->end_block)
+			continue;
+		if (succ == env->head || !block_dominates(env->head, succ))
+			env->closed = false;
+	}
+}
+
+ir_node *be_place_prologue(ir_node *const frame_value)
+{
+	ir_graph *const irg         = get_irn_irg(frame_value);
+	ir_node  *const start_block = get_irg_start_block(irg);
+	if (!be_options.shrink_wrap)
+		return start_block;
+
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+
+	/* The frame must be set up before any of its users, the returns get
+	 * their epilogue depending on the region they end up in. */
+	ir_node *head = NULL;
+	foreach_out_edge(frame_value, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_Anchor(user) || is_End(user) || is_cfop(user))
+			continue;
+		ir_node *const block = get_use_block(user, get_edge_src_pos(edge));
+		head = head ? ir_deepest_common_dominator(head, block) : block;
+	}
+	if (head == NULL)
+		return start_block;
+
+	/* Once allocated, the frame has to stay allocated until a return is
+	 * reached: No control flow may leave the dominance region of the head or
+	 * enter it again, which also keeps the head out of loops.  Move up the
+	 * dominance tree until this holds. */
+	for (;; head = get_Block_idom(head)) {
+		if (head == start_block)
+			return start_block;
+		frame_region_env_t env = {
+			.head      = head,
+			.end_block = get_irg_end_block(irg),
+			.closed    = true,
+		};
+		dom_tree_walk(head, check_region_closed, NULL, &env);
+		if (env.closed)
+			break;
+	}
+
+	if (get_block_execfreq(head) >= get_block_execfreq(start_block))
+		return start_block;
+	return head;
+}
+
+void be_reroute_frame_users(ir_node *const old_value, ir_node *const new_value,
+                            ir_node *const exception,
+                            ir_node *const prologue_block)
+{
+	ir_graph *const irg = get_irn_irg(old_value);
+	if (prologue_block == get_irg_start_block(irg)) {
+		edges_reroute_except(old_value, new_value, exception);
+		return;
+	}
+
+	foreach_out_edge_safe(old_value, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (user == exception || is_Anchor(user) || is_End(user))
+			continue;
+		int      const pos   = get_edge_src_pos(edge);
+		ir_node *const block = get_use_block(user, pos);
+		if (block_dominates(prologue_block, block))
+			set_irn_n(user, pos, new_value);
+	}
+}
+
+int be_get_block_sp_offset(ir_node const *const block)
+{
+	be_irg_t const *const birg = be_birg_from_irg(get_irn_irg(block));
+	unsigned        const idx  = get_irn_idx(block);
+	assert(birg->block_sp_offsets != NULL
+	    && idx < ARR_LEN(birg->block_sp_offsets));
+	return birg->block_sp_offsets[idx];
+}
+
 static int cmp_slots_last(void const *const p0, void const *const p1)
 {
 	ir_entity const *const e0 = *(ir_entity const**)p0;
@@ -205,18 +319,75 @@ static int cmp_slots_first(void const *const p0, void const *const p1)
 
 void be_sort_frame_entities(ir_type *const frame, bool spillslots_first)
 {
-	unsigned const n_members = get_compound_n_members(frame);
-	assert(is_compound_type(frame));
-	QSORT(frame->attr.compound.members, n_members,
-		  spillslots_first ? cmp_slots_first : cmp_slots_last);
+	sort_compound_members(frame,
+	                      spillslots_first ? cmp_slots_first : cmp_slots_last);
+}
+
+/** A gap between frame entities caused by alignment. */
+typedef struct frame_hole_t {
+	int begin; /**< offset of the lowest byte of the hole */
+	int end;   /**< offset after the highest byte of the hole */
+} frame_hole_t;
+
+static void add_hole(frame_hole_t **const holes, int const begin, int const end)
+{
+	if (begin < end) {
+		frame_hole_t const hole = { begin, end };
+		ARR_APP1(frame_hole_t, *holes, hole);
+	}
+}
+
+/**
+ * Tries to place an entity into a hole, preferring the highest or, if
+ * @p lowest is set, the lowest possible offset.
+ *
+ * @return the offset of the entity or INVALID_OFFSET if no hole fits
+ */
+static int place_in_hole(frame_hole_t **const holes, unsigned const size,
+                         unsigned const alignment, unsigned const misalign,
+                         bool const lowest)
+{
+	int    best_offset = INVALID_OFFSET;
+	size_t best        = 0;
+	for (size_t i = 0, n = ARR_LEN(*holes); i < n; ++i) {
+		frame_hole_t const *const hole = &(*holes)[i];
+		int offset;
+		if (lowest) {
+			offset = -round_up2_misaligned(-(hole->begin + (int)alignment - 1), alignment, misalign);
+			if (offset + (int)size > hole->end)
+				continue;
+		} else {
+			offset = -round_up2_misaligned(-(hole->end - (int)size), alignment, misalign);
+			if (offset < hole->begin)
+				continue;
+		}
+		if (best_offset == INVALID_OFFSET
+		 || (lowest ? offset < best_offset : offset > best_offset)) {
+			best_offset = offset;
+			best        = i;
+		}
+	}
+	if (best_offset != INVALID_OFFSET) {
+		frame_hole_t const hole = (*holes)[best];
+		size_t       const last = ARR_LEN(*holes) - 1;
+		(*holes)[best] = (*holes)[last];
+		ARR_SHRINKLEN(*holes, last);
+		add_hole(holes, hole.begin, best_offset);
+		add_hole(holes, best_offset + (int)size, hole.end);
+	}
+	return best_offset;
 }
 
 void be_layout_frame_type(ir_type *const frame, int const begin,
-                          unsigned const misalign)
+                          unsigned const misalign, bool const sp_relative)
 {
 	assert(get_type_state(frame) == layout_undefined);
-	/* Layout entities into negative direction. */
-	int offset = begin;
+	/* Layout entities into negative direction. Entities fitting into the
+	 * padding in front of a more strictly aligned entity are placed there
+	 * instead of growing the frame. Spill slots of a frame addressed relative
+	 * to the stack pointer take the lowest hole to stay close to it. */
+	frame_hole_t *holes  = NEW_ARR_F(frame_hole_t, 0);
+	int           offset = begin;
 	for (unsigned i = 0, n_members = get_compound_n_members(frame);
 		 i < n_members; ++i) {
 		ir_entity *const member        = get_compound_member(frame, i);
@@ -238,10 +409,27 @@ void be_layout_frame_type(ir_type *const frame, int const begin,
 			alignment = MAX(alignment, type_alignment);
 		}
 
-		offset -= size;
-		offset  = -round_up2_misaligned(-offset, alignment, misalign);
-		set_entity_offset(member, offset);
+		bool const lowest     = sp_relative && member->kind == IR_ENTITY_SPILLSLOT;
+		int        member_pos = place_in_hole(&holes, size, alignment, misalign, lowest);
+		if (member_pos == INVALID_OFFSET) {
+			int const end = offset;
+			offset    -= size;
+			offset     = -round_up2_misaligned(-offset, alignment, misalign);
+			member_pos = offset;
+			add_hole(&holes, offset + (int)size, end);
+		}
+		set_entity_offset(member, member_pos);
 	}
-	set_type_size(frame, -(offset-begin));
+	unsigned const frame_size = -(offset-begin);
+	set_type_size(frame, frame_size);
 	set_type_state(frame, layout_fixed);
+
+	if (stat_ev_enabled) {
+		unsigned padding = 0;
+		for (size_t i = 0, n = ARR_LEN(holes); i < n; ++i)
+			padding += holes[i].end - holes[i].begin;
+		stat_ev_int("frame_size", frame_size);
+		stat_ev_int("frame_padding", padding);
+	}
+	DEL_ARR_F(holes);
 }
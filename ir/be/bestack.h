@@ -36,6 +36,22 @@ typedef struct stack_pointer_state_t {
  */
 void be_fix_stack_nodes(ir_graph *irg, arch_register_t const *sp);
 
+/**
+ * Determine the block in which the stack frame should be set up, given the
+ * initial value @p frame_value of the register addressing it.  This is the
+ * deepest block dominating all users of the frame such that the frame stays
+ * allocated until the returns of its dominance region, if that block is
+ * executed less often than the start block; otherwise it is the start block.
+ */
+ir_node *be_place_prologue(ir_node *frame_value);
+
+/**
+ * Like edges_reroute_except() but only reroutes users which are dominated by
+ * @p prologue_block (as returned by be_place_prologue()).
+ */
+void be_reroute_frame_users(ir_node *old_value, ir_node *new_value,
+                            ir_node *exception, ir_node *prologue_block);
+
 typedef void (*sp_sim_func)(ir_node *node, stack_pointer_state_t *state);
 
 /**
@@ -46,11 +62,20 @@ typedef void (*sp_sim_func)(ir_node *node, stack_pointer_state_t *state);
 void be_sim_stack_pointer(ir_graph *irg, unsigned misalign, unsigned p2align,
                           sp_sim_func func);
 
+/**
+ * Returns the stack pointer offset relative to the function begin when
+ * entering @p block, as determined by be_sim_stack_pointer().
+ */
+int be_get_block_sp_offset(ir_node const *block);
+
 /**
  * Layout entities in frame type. This will not touch entities which already
  * have offsets assigned.
+ *
+ * @param sp_relative  the frame is addressed relative to the stack pointer
  */
-void be_layout_frame_type(ir_type *frame, int begin, unsigned misalign);
+void be_layout_frame_type(ir_type *frame, int begin, unsigned misalign,
+                          bool sp_relative);
 
 void be_sort_frame_entities(ir_type *const frame, bool spillslots_first);
 
@@ -13,6 +13,7 @@
 #include "beflags.h"
 #include "begnuas.h"
 #include "bemodule.h"
+#include "bepostsched.h"
 #include "bera.h"
 #include "besched.h"
 #include "bespillslots.h"
@@ -30,6 +31,7 @@
 #include "ident_t.h"
 #include "instrument.h"
 #include "ircons.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irgmod.h"
 #include "irgopt.h"
@@ -997,7 +999,8 @@ static void introduce_epilogue(ir_node *const ret, bool const omit_fp)
 		kill_node(first_sp);
 }
 
-static void introduce_prologue(ir_graph *const irg, bool omit_fp)
+static void introduce_prologue(ir_graph *const irg, bool omit_fp,
+                               ir_node *const prologue_block)
 {
 	const arch_register_t *sp         = &ia32_registers[REG_ESP];
 	const arch_register_t *bp         = &ia32_registers[REG_EBP];
@@ -1031,25 +1034,36 @@ static void introduce_prologue(ir_graph *const irg, bool omit_fp)
 		/* make sure the initial IncSP is really used by someone */
 		be_keep_if_unused(incsp);
 	} else {
-		ir_node *const incsp = ia32_new_IncSP(block, initial_sp, frame_size,
-		                                      false);
-		edges_reroute_except(initial_sp, incsp, incsp);
-		sched_add_after(start, incsp);
+		ir_node *const anchor = prologue_block == block ? start
+			: be_move_after_schedule_first(prologue_block);
+		ir_node *const incsp  = ia32_new_IncSP(prologue_block, initial_sp,
+		                                       frame_size, false);
+		be_reroute_frame_users(initial_sp, incsp, incsp, prologue_block);
+		sched_add_after(anchor, incsp);
 	}
 }
 
 /**
- * Put the prologue code at the beginning, epilogue code before each return
+ * Put the prologue code at the beginning, epilogue code before each return.
+ * Without a frame pointer the prologue may be sunk into the region actually
+ * using the frame, returns outside of it need no epilogue then.
  */
 static void introduce_prologue_epilogue(ir_graph *const irg, bool omit_fp)
 {
+	ir_node *const start_block    = get_irg_start_block(irg);
+	ir_node *const initial_sp     = be_get_Start_proj(irg, &ia32_registers[REG_ESP]);
+	ir_node *const prologue_block
+		= omit_fp ? be_place_prologue(initial_sp) : start_block;
+
 	/* introduce epilogue for every return node */
 	foreach_irn_in(get_irg_end_block(irg), i, ret) {
 		assert(is_ia32_Ret(ret));
-		introduce_epilogue(ret, omit_fp);
+		if (prologue_block == start_block
+		 || block_dominates(prologue_block, get_nodes_block(ret)))
+			introduce_epilogue(ret, omit_fp);
 	}
 
-	introduce_prologue(irg, omit_fp);
+	introduce_prologue(irg, omit_fp, prologue_block);
 }
 
 static x87_attr_t *ia32_get_x87_attr(ir_node *const node)
@@ -1078,7 +1092,7 @@ static void ia32_before_emit(ir_graph *irg)
 	be_sort_frame_entities(frame, omit_fp);
 	unsigned const misalign = IA32_REGISTER_SIZE; /* return address on stack */
 	int      const begin    = omit_fp ? 0 : -IA32_REGISTER_SIZE;
-	be_layout_frame_type(frame, begin, misalign);
+	be_layout_frame_type(frame, begin, misalign, omit_fp);
 
 	irg_block_walk_graph(irg, NULL, ia32_after_ra_walker, NULL);
 
@@ -1094,6 +1108,12 @@ static void ia32_before_emit(ir_graph *irg)
 	ia32_finish_irg(irg);
 	be_dump(DUMP_RA, irg, "2addr");
 
+	if (be_options.post_sched) {
+		be_timer_push(T_SCHED);
+		be_schedule_after_ra(irg, &ia32_reg_classes[CLASS_ia32_flags]);
+		be_timer_pop(T_SCHED);
+	}
+
 	/* we might have to rewrite x87 virtual registers */
 	if (ia32_get_irg_data(irg)->do_x87_sim) {
 		x86_prepare_x87_callbacks_ia32();
@@ -1558,7 +1578,7 @@ static const ir_settings_arch_dep_t ia32_arch_dep = {
 	.maximum_shifts       = 4,
 	.highest_shift_amount = 63,
 	.evaluate             = ia32_evaluate_insn,
-	.max_bits_for_mulh    = 32,
+	.max_bits_for_mulh    = 64,
 };
 
 static void ia32_lower_for_target(void)
@@ -30,6 +30,7 @@
 
 #include "beasm.h"
 #include "beblocksched.h"
+#include "becache.h"
 #include "bediagnostic.h"
 #include "beemithlp.h"
 #include "beemitter.h"
@@ -62,7 +63,6 @@ static ir_label_t exc_label_id;
 static bool       mark_spill_reload;
 
 static bool       omit_fp;
-static int        frame_type_size;
 static int        callframe_offset;
 static ir_entity *thunks[N_ia32_gp_REGS];
 static ir_type   *thunk_type;
@@ -229,7 +229,7 @@ static char get_xmm_mode_suffix(x86_insn_size_t const size)
 	panic("invalid XMM mode");
 }
 
-static void ia32_emit_xmm_mode_suffix(ir_node const *const node)
+void ia32_emit_xmm_mode_suffix(ir_node const *const node)
 {
 	ia32_attr_t const *const attr = get_ia32_attr_const(node);
 	be_emit_char(get_xmm_mode_suffix(attr->size));
@@ -282,233 +282,285 @@ typedef enum ia32_emit_mod_t {
 } ia32_emit_mod_t;
 ENUM_BITSET(ia32_emit_mod_t)
 
-/**
- * Emits address mode.
- */
-static void ia32_emit_am(ir_node const *const node)
+void ia32_emit_am(ir_node const *const node)
 {
 	ia32_attr_t const *const attr = get_ia32_attr_const(node);
 	x86_emit_addr(node, &attr->addr);
 }
 
-void ia32_emitf(ir_node const *const node, char const *fmt, ...)
+void ia32_emit_insn_suffix(ir_node const *const node)
 {
-	BE_EMITF(node, fmt, ap, false) {
-		ia32_emit_mod_t mod = EMIT_NONE;
-		for (;;) {
-			switch (*fmt) {
-			case '*': mod |= EMIT_ALTERNATE_AM; break;
-			case '<': mod |= EMIT_LOW_REG;      break;
-			case '>': mod |= EMIT_HIGH_REG;     break;
-			case '^': mod |= EMIT_16BIT_REG;    break;
-			case '#': mod |= EMIT_32BIT_REG;    break;
-			case ',': mod |= EMIT_SHIFT_COMMA;  break;
-			default:
-				goto end_of_mods;
-			}
-			++fmt;
-		}
-end_of_mods:
+	ia32_attr_t const *const attr = get_ia32_attr_const(node);
+	ia32_emit_mode_suffix(attr->size);
+}
 
-		switch (*fmt++) {
-			arch_register_t const *reg;
-			ir_node         const *imm;
-
-			case 'A': {
-				switch (*fmt++) {
-					case 'F':
-						if (get_ia32_op_type(node) == ia32_Normal) {
-							ia32_x87_attr_t const *const attr = get_ia32_x87_attr_const(node);
-							char            const *const fmt  = attr->x87.res_in_reg ? "%%st, %%%s" : "%%%s, %%st";
-							be_emit_irprintf(fmt, attr->x87.reg->name);
-							break;
-						} else {
-							goto emit_AM;
-						}
+void ia32_emit_out_register(ir_node const *const node, unsigned const pos)
+{
+	ia32_attr_t     const *const attr = get_ia32_attr_const(node);
+	arch_register_t const *const reg  = arch_get_irn_register_out(node, pos);
+	emit_register(reg, attr->size, attr->use_8bit_high);
+}
 
-emit_AM:
-					case 'M':
-						if (mod & EMIT_ALTERNATE_AM)
-							be_emit_char('*');
-						ia32_emit_am(node);
-						break;
+void ia32_emit_source(ir_node const *const node, unsigned const pos)
+{
+	ir_node const *const src = get_irn_n(node, pos);
+	if (is_ia32_Immediate(src)) {
+		emit_ia32_immediate_attr(true, src);
+	} else {
+		ia32_attr_t     const *const attr = get_ia32_attr_const(node);
+		arch_register_t const *const reg  = arch_get_irn_register(src);
+		emit_register(reg, attr->size, attr->use_8bit_high);
+	}
+}
 
-					case 'S':
-						if (get_ia32_op_type(node) == ia32_Normal) {
-							goto emit_S;
-						} else {
-							++fmt;
-							goto emit_AM;
-						}
-
-					default: goto unknown;
-				}
-				break;
-			}
+void ia32_emit_am_or_source(ir_node const *const node, unsigned const pos)
+{
+	if (get_ia32_op_type(node) == ia32_Normal) {
+		ia32_emit_source(node, pos);
+	} else {
+		ia32_emit_am(node);
+	}
+}
 
-			case 'B': {
-				ia32_attr_t const *const attr = get_ia32_attr_const(node);
-				ir_node const *const src = get_irn_n(node, n_ia32_binary_right);
-				if (is_ia32_Immediate(src)) {
-					emit_ia32_immediate_attr(true, src);
-					be_emit_cstring(", ");
-					if (attr->tp == ia32_Normal) {
-						goto destination_operand;
+void ia32_emit_binop(ir_node const *const node)
+{
+	ia32_attr_t const *const attr = get_ia32_attr_const(node);
+	ir_node     const *const src  = get_irn_n(node, n_ia32_binary_right);
+	if (is_ia32_Immediate(src)) {
+		emit_ia32_immediate_attr(true, src);
+		be_emit_cstring(", ");
+		if (attr->tp != ia32_Normal) {
+			ia32_emit_am(node);
+			return;
+		}
+	} else {
+		if (attr->tp == ia32_Normal) {
+			arch_register_t const *const reg = arch_get_irn_register(src);
+			emit_register(reg, attr->size, attr->use_8bit_high);
+		} else {
+			ia32_emit_am(node);
+		}
+		be_emit_cstring(", ");
+	}
+	arch_register_t const *const reg
+		= arch_get_irn_register_in(node, n_ia32_binary_left);
+	emit_register(reg, attr->size, attr->use_8bit_high);
+}
+
+/**
+ * Emits the conversion at @p *fmt_p and advances it behind the conversion.
+ */
+static void ia32_emit_conversion(ir_node const *const node,
+                                 char const **const fmt_p, va_list *const ap)
+{
+	char const *fmt = *fmt_p;
+	ia32_emit_mod_t mod = EMIT_NONE;
+	for (;;) {
+		switch (*fmt) {
+		case '*': mod |= EMIT_ALTERNATE_AM; break;
+		case '<': mod |= EMIT_LOW_REG;      break;
+		case '>': mod |= EMIT_HIGH_REG;     break;
+		case '^': mod |= EMIT_16BIT_REG;    break;
+		case '#': mod |= EMIT_32BIT_REG;    break;
+		case ',': mod |= EMIT_SHIFT_COMMA;  break;
+		default:
+			goto end_of_mods;
+		}
+		++fmt;
+	}
+end_of_mods:
+
+	switch (*fmt++) {
+		arch_register_t const *reg;
+		ir_node         const *imm;
+
+		case 'A': {
+			switch (*fmt++) {
+				case 'F':
+					if (get_ia32_op_type(node) == ia32_Normal) {
+						ia32_x87_attr_t const *const attr = get_ia32_x87_attr_const(node);
+						char            const *const fmt  = attr->x87.res_in_reg ? "%%st, %%%s" : "%%%s, %%st";
+						be_emit_irprintf(fmt, attr->x87.reg->name);
+						break;
 					} else {
-						ia32_emit_am(node);
+						goto emit_AM;
 					}
-				} else {
-					if (attr->tp == ia32_Normal) {
-						reg = arch_get_irn_register(src);
-						emit_register(reg, attr->size, attr->use_8bit_high);
+
+emit_AM:
+				case 'M':
+					if (mod & EMIT_ALTERNATE_AM)
+						be_emit_char('*');
+					ia32_emit_am(node);
+					break;
+
+				case 'S':
+					if (get_ia32_op_type(node) == ia32_Normal) {
+						goto emit_S;
 					} else {
-						ia32_emit_am(node);
+						++fmt;
+						goto emit_AM;
 					}
-					be_emit_cstring(", ");
-destination_operand:
-					reg = arch_get_irn_register_in(node, n_ia32_binary_left);
-					emit_register(reg, attr->size, attr->use_8bit_high);
-				}
-				break;
+
+				default: goto unknown;
 			}
+			break;
+		}
 
-			case 'D':
-				if (!is_digit(*fmt))
-					goto unknown;
-				reg = arch_get_irn_register_out(node, *fmt++ - '0');
-				goto emit_R;
+		case 'B':
+			ia32_emit_binop(node);
+			break;
 
-			case 'E': {
-				const ir_entity *const entity = va_arg(ap, const ir_entity*);
-				be_gas_emit_entity(entity);
-				break;
-			}
+		case 'D':
+			if (!is_digit(*fmt))
+				goto unknown;
+			reg = arch_get_irn_register_out(node, *fmt++ - '0');
+			goto emit_R;
 
-			case 'F':
-				if (*fmt == 'M') {
-					ia32_emit_x87_mode_suffix(node);
-				} else if (*fmt == 'I') {
-					ia32_emit_x87_mode_suffix_int(node);
-				} else if (*fmt == 'P') {
-					ia32_x87_attr_t const *const attr = get_ia32_x87_attr_const(node);
-					if (attr->x87.pop)
-						be_emit_char('p');
-				} else if (*fmt == 'R') {
-					/* NOTE: Work around a gas quirk for non-commutative operations if the
-					 * destination register is not %st0.  In this case r/non-r is swapped.
-					 * %st0 = %st0 - %st1 -> fsub  %st1, %st0 (as expected)
-					 * %st0 = %st1 - %st0 -> fsubr %st1, %st0 (as expected)
-					 * %st1 = %st0 - %st1 -> fsub  %st0, %st1 (expected: fsubr)
-					 * %st1 = %st1 - %st0 -> fsubr %st0, %st1 (expected: fsub)
-					 * In fact this corresponds to the encoding of the instruction:
-					 * - The r suffix selects whether %st0 is on the left (no r) or on the
-					 *   right (r) side of the executed operation.
-					 * - The placement of %st0 selects whether the result is written to
-					 *   %st0 (right) or the other register (left).
-					 * This means that it is sufficient to test whether the operands are
-					 * permuted.  In particular it is not necessary to consider whether the
-					 * result is to be placed into the explicit register operand. */
-					if (get_ia32_x87_attr_const(node)->x87.reverse)
-						be_emit_char('r');
-				} else if (*fmt == 'X') {
-					ia32_emit_xmm_mode_suffix(node);
-				} else if (*fmt == '0') {
-					be_emit_char('%');
-					be_emit_string(get_ia32_x87_attr_const(node)->x87.reg->name);
-				} else {
-					goto unknown;
-				}
-				++fmt;
-				break;
+		case 'E': {
+			const ir_entity *const entity = va_arg(*ap, const ir_entity*);
+			be_gas_emit_entity(entity);
+			break;
+		}
+
+		case 'F':
+			if (*fmt == 'M') {
+				ia32_emit_x87_mode_suffix(node);
+			} else if (*fmt == 'I') {
+				ia32_emit_x87_mode_suffix_int(node);
+			} else if (*fmt == 'P') {
+				ia32_x87_attr_t const *const attr = get_ia32_x87_attr_const(node);
+				if (attr->x87.pop)
+					be_emit_char('p');
+			} else if (*fmt == 'R') {
+				/* NOTE: Work around a gas quirk for non-commutative operations if the
+				 * destination register is not %st0.  In this case r/non-r is swapped.
+				 * %st0 = %st0 - %st1 -> fsub  %st1, %st0 (as expected)
+				 * %st0 = %st1 - %st0 -> fsubr %st1, %st0 (as expected)
+				 * %st1 = %st0 - %st1 -> fsub  %st0, %st1 (expected: fsubr)
+				 * %st1 = %st1 - %st0 -> fsubr %st0, %st1 (expected: fsub)
+				 * In fact this corresponds to the encoding of the instruction:
+				 * - The r suffix selects whether %st0 is on the left (no r) or on the
+				 *   right (r) side of the executed operation.
+				 * - The placement of %st0 selects whether the result is written to
+				 *   %st0 (right) or the other register (left).
+				 * This means that it is sufficient to test whether the operands are
+				 * permuted.  In particular it is not necessary to consider whether the
+				 * result is to be placed into the explicit register operand. */
+				if (get_ia32_x87_attr_const(node)->x87.reverse)
+					be_emit_char('r');
+			} else if (*fmt == 'X') {
+				ia32_emit_xmm_mode_suffix(node);
+			} else if (*fmt == '0') {
+				be_emit_char('%');
+				be_emit_string(get_ia32_x87_attr_const(node)->x87.reg->name);
+			} else {
+				goto unknown;
+			}
+			++fmt;
+			break;
 
-			case 'I':
-				imm = node;
+		case 'I':
+			imm = node;
 emit_I:
-				if (mod & EMIT_SHIFT_COMMA) {
-					const ia32_immediate_attr_t *attr
-						= get_ia32_immediate_attr_const(imm);
-					if (attr->imm.entity == NULL && attr->imm.offset == 1)
-						break;
-				}
-				emit_ia32_immediate_attr(!(mod & EMIT_ALTERNATE_AM), imm);
-				if (mod & EMIT_SHIFT_COMMA) {
-					be_emit_char(',');
-				}
-				break;
-
-			case 'M': {
-				ia32_attr_t const *const attr = get_ia32_attr_const(node);
-				if (mod & EMIT_32BIT_REG) {
-					assert(is_ia32_Load(node) || is_ia32_Conv_I2I(node));
-					if (attr->size == X86_SIZE_32)
-						break;
-					be_emit_char(attr->sign_extend ? 's' : 'z');
-				}
-				ia32_emit_mode_suffix(attr->size);
-				break;
+			if (mod & EMIT_SHIFT_COMMA) {
+				const ia32_immediate_attr_t *attr
+					= get_ia32_immediate_attr_const(imm);
+				if (attr->imm.entity == NULL && attr->imm.offset == 1)
+					break;
+			}
+			emit_ia32_immediate_attr(!(mod & EMIT_ALTERNATE_AM), imm);
+			if (mod & EMIT_SHIFT_COMMA) {
+				be_emit_char(',');
 			}
+			break;
 
-			case 'P': {
-				x86_condition_code_t cc;
-				if (*fmt == 'X') {
-					++fmt;
-					cc = (x86_condition_code_t)va_arg(ap, int);
-				} else if (is_digit(*fmt)) {
-					cc = ia32_determine_final_cc(node, *fmt - '0');
-					++fmt;
-				} else {
-					goto unknown;
-				}
-				x86_emit_condition_code(cc);
-				break;
+		case 'M': {
+			ia32_attr_t const *const attr = get_ia32_attr_const(node);
+			if (mod & EMIT_32BIT_REG) {
+				assert(is_ia32_Load(node) || is_ia32_Conv_I2I(node));
+				if (attr->size == X86_SIZE_32)
+					break;
+				be_emit_char(attr->sign_extend ? 's' : 'z');
+			}
+			ia32_emit_mode_suffix(attr->size);
+			break;
+		}
+
+		case 'P': {
+			x86_condition_code_t cc;
+			if (*fmt == 'X') {
+				++fmt;
+				cc = (x86_condition_code_t)va_arg(*ap, int);
+			} else if (is_digit(*fmt)) {
+				cc = ia32_determine_final_cc(node, *fmt - '0');
+				++fmt;
+			} else {
+				goto unknown;
 			}
+			x86_emit_condition_code(cc);
+			break;
+		}
 
-			case 'R':
-				reg = va_arg(ap, const arch_register_t*);
+		case 'R':
+			reg = va_arg(*ap, const arch_register_t*);
 emit_R:
-				if (mod & EMIT_ALTERNATE_AM)
-					be_emit_char('*');
-				const char *name;
-				if (mod & EMIT_HIGH_REG) {
-					name = get_register_name_8bit_high(reg);
-				} else if (mod & EMIT_LOW_REG) {
-					name = get_register_name_8bit_low(reg);
-				} else if (mod & EMIT_16BIT_REG) {
-					name = get_register_name_16bit(reg);
-				} else if (mod & EMIT_32BIT_REG) {
-					name = reg->name;
-				} else {
-					ia32_attr_t const *const attr = get_ia32_attr_const(node);
-					name = get_register_name_size(reg, attr->size,
-					                              attr->use_8bit_high);
-				}
-				be_emit_char('%');
-				be_emit_string(name);
-				if (mod & EMIT_SHIFT_COMMA) {
-					be_emit_char(',');
-				}
-				break;
+			if (mod & EMIT_ALTERNATE_AM)
+				be_emit_char('*');
+			const char *name;
+			if (mod & EMIT_HIGH_REG) {
+				name = get_register_name_8bit_high(reg);
+			} else if (mod & EMIT_LOW_REG) {
+				name = get_register_name_8bit_low(reg);
+			} else if (mod & EMIT_16BIT_REG) {
+				name = get_register_name_16bit(reg);
+			} else if (mod & EMIT_32BIT_REG) {
+				name = reg->name;
+			} else {
+				ia32_attr_t const *const attr = get_ia32_attr_const(node);
+				name = get_register_name_size(reg, attr->size,
+				                              attr->use_8bit_high);
+			}
+			be_emit_char('%');
+			be_emit_string(name);
+			if (mod & EMIT_SHIFT_COMMA) {
+				be_emit_char(',');
+			}
+			break;
 
 emit_S:
-			case 'S': {
-				if (!is_digit(*fmt))
-					goto unknown;
-
-				unsigned pos = *fmt++ - '0';
-				ir_node const *const src = get_irn_n(node, pos);
-				if (is_ia32_Immediate(src)) {
-					imm = src;
-					goto emit_I;
-				} else {
-					reg = arch_get_irn_register(src);
-					goto emit_R;
-				}
+		case 'S': {
+			if (!is_digit(*fmt))
+				goto unknown;
+
+			unsigned pos = *fmt++ - '0';
+			ir_node const *const src = get_irn_n(node, pos);
+			if (is_ia32_Immediate(src)) {
+				imm = src;
+				goto emit_I;
+			} else {
+				reg = arch_get_irn_register(src);
+				goto emit_R;
 			}
+		}
 
-			default:
+		default:
 unknown:
-				panic("unknown format conversion");
-		}
+			panic("unknown format conversion");
+	}
+	*fmt_p = fmt;
+}
+
+void ia32_emitf(ir_node const *const node, char const *fmt, ...)
+{
+	BE_EMITF(node, fmt, ap, false) {
+		ia32_emit_conversion(node, &fmt, &ap);
+	}
+}
+
+void ia32_emitf_part(ir_node const *const node, char const *fmt, ...)
+{
+	BE_EMITF_PART(node, fmt, ap) {
+		ia32_emit_conversion(node, &fmt, &ap);
 	}
 }
 
@@ -586,6 +638,7 @@ x86_condition_code_t ia32_determine_final_cc(ir_node const *const node,
  */
 static void ia32_emit_exc_label(const ir_node *node)
 {
+	be_cache_mark_unreproducible();
 	be_emit_string(be_gas_insn_label_prefix());
 	be_emit_irprintf("%lu", get_ia32_exc_label_id(node));
 }
@@ -1049,6 +1102,8 @@ static ir_type *get_thunk_type(void)
 
 static void emit_ia32_GetEIP(const ir_node *node)
 {
+	/* the PIC base label is numbered per compilation unit */
+	be_cache_mark_unreproducible();
 	switch ((get_ip_style_t)get_ip_style) {
 	case IA32_GET_IP_POP: {
 		char const *const base = pic_base_label;
@@ -1301,12 +1356,8 @@ static void ia32_gen_block(ir_node *block)
 	ia32_emit_block_header(block);
 
 	if (omit_fp) {
-		ir_graph *irg = get_irn_irg(block);
-		callframe_offset = 4; /* 4 bytes for the return address */
-		/* ESP guessing, TODO perform a real ESP simulation */
-		if (block != get_irg_start_block(irg)) {
-			callframe_offset += frame_type_size;
-		}
+		/* 4 bytes for the return address */
+		callframe_offset = 4 + be_get_block_sp_offset(block);
 		be_dwarf_callframe_offset(callframe_offset);
 	}
 
@@ -1457,8 +1508,6 @@ void ia32_emit_function(ir_graph *const irg)
 
 	omit_fp = ia32_get_irg_data(irg)->omit_fp;
 	if (omit_fp) {
-		ir_type *frame_type = get_irg_frame_type(irg);
-		frame_type_size = get_type_size(frame_type);
 		be_dwarf_callframe_register(&ia32_registers[REG_ESP]);
 	} else {
 		/* well not entirely correct here, we should emit this after the
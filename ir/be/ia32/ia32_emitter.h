@@ -46,6 +46,25 @@
  */
 void ia32_emitf(ir_node const *node, char const *fmt, ...);
 
+/**
+ * Like ia32_emitf() but appends to the current line without finishing it.
+ */
+void ia32_emitf_part(ir_node const *node, char const *fmt, ...);
+
+/**
+ * @{
+ * Emit single operands, used by the generated emitters instead of the
+ * ia32_emitf() conversions %AM, %AS, %B, %D, %FX, %M and %S.
+ */
+void ia32_emit_am(ir_node const *node);
+void ia32_emit_am_or_source(ir_node const *node, unsigned pos);
+void ia32_emit_binop(ir_node const *node);
+void ia32_emit_insn_suffix(ir_node const *node);
+void ia32_emit_out_register(ir_node const *node, unsigned pos);
+void ia32_emit_source(ir_node const *node, unsigned pos);
+void ia32_emit_xmm_mode_suffix(ir_node const *node);
+/** @} */
+
 void ia32_emit_function(ir_graph *irg);
 
 void ia32_emit_thunks(void);
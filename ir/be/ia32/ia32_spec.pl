@@ -98,6 +98,64 @@ sub ia32_custom_init_attr {
 }
 $custom_init_attr_func = \&ia32_custom_init_attr;
 
+# Emit template conversions translated into direct calls by the emitter
+# generator (see generate_emitter.pl).
+%emit_conversions = (
+	'AM'     => 'ia32_emit_am(node)',
+	'AS(\d)' => 'ia32_emit_am_or_source(node, $1)',
+	'B'      => 'ia32_emit_binop(node)',
+	'D(\d)'  => 'ia32_emit_out_register(node, $1)',
+	'FX'     => 'ia32_emit_xmm_mode_suffix(node)',
+	'M'      => 'ia32_emit_insn_suffix(node)',
+	'S(\d)'  => 'ia32_emit_source(node, $1)',
+);
+
+# Instruction selection rules for Firm nodes, see generate_isel.pl.
+%isel_rules = (
+	And => [
+		{ pattern => 'And(x, c:Const)', cond => 'get_Const_long(c) == 0xFF', cost => 1,
+		  emit => 'ia32_gen_zero_extension(node, mode_Bu, x)' },
+		{ pattern => 'And(x, c:Const)', cond => 'get_Const_long(c) == 0xFFFF', cost => 1,
+		  emit => 'ia32_gen_zero_extension(node, mode_Hu, x)' },
+		{ pattern => 'And(x, y)', cost => 1,
+		  emit => 'ia32_gen_binop(node, x, y, new_bd_ia32_And, match_commutative | match_mode_neutral | match_am | match_immediate)' },
+	],
+	Eor => [
+		{ pattern => 'Eor(x, y)', cost => 1,
+		  emit => 'ia32_gen_binop(node, x, y, new_bd_ia32_Xor, match_commutative | match_mode_neutral | match_am | match_immediate)' },
+	],
+	Not => [
+		# ~(1 << x) -> Rol(~1, x)
+		{ pattern => 'Not(Shl(c:Const, x))', cond => 'is_irn_one(c)', cost => 2,
+		  emit => 'ia32_gen_rotate_const(node, -2, x, new_bd_ia32_Rol)' },
+		# ~(0x80000000 >> x) -> Ror(~0x80000000, x)
+		{ pattern => 'Not(Shr(c:Const, x))', cond => 'get_tarval_lowest_bit(get_Const_tarval(c)) == 31', cost => 2,
+		  emit => 'ia32_gen_rotate_const(node, 0x7FFFFFFF, x, new_bd_ia32_Ror)' },
+		{ pattern => 'Not(x)', cost => 1,
+		  emit => 'ia32_gen_unop(node, x, new_bd_ia32_Not, match_mode_neutral)' },
+	],
+	Shl => [
+		# Lea has fewer register constraints than Shl
+		{ pattern => 'Shl(x, c:Const)', cond => 'is_irn_one(c)', cost => 1,
+		  emit => 'ia32_gen_lea(node, x, x)' },
+		{ pattern => 'Shl(x, y)', cost => 1,
+		  emit => 'ia32_gen_shift_binop(node, x, y, new_bd_ia32_Shl, new_bd_ia32_Shl_8bit, match_mode_neutral)' },
+	],
+	Shr => [
+		{ pattern => 'Shr(x, y)', cost => 1,
+		  emit => 'ia32_gen_shift_binop(node, x, y, new_bd_ia32_Shr, new_bd_ia32_Shr_8bit, match_zero_ext)' },
+	],
+);
+
+# Floating point operations and mode_b are lowered before the selection.
+%isel_asserts = (
+	And => [ '!mode_is_float(get_irn_mode(node))', 'get_irn_mode(node) != mode_b' ],
+	Eor => [ '!mode_is_float(get_irn_mode(node))', 'get_irn_mode(node) != mode_b' ],
+	Not => [ '!mode_is_float(get_irn_mode(node))', 'get_irn_mode(node) != mode_b' ],
+	Shl => [ '!mode_is_float(get_irn_mode(node))', 'get_irn_mode(node) != mode_b' ],
+	Shr => [ '!mode_is_float(get_irn_mode(node))', 'get_irn_mode(node) != mode_b' ],
+);
+
 %init_attr = (
 	ia32_attr_t =>
 		"init_ia32_attributes(res, size);",
@@ -17,6 +17,7 @@
 #include "betranshlp.h"
 #include "beutil.h"
 #include "debug.h"
+#include "gen_ia32_isel.h"
 #include "gen_ia32_regalloc_if.h"
 #include "heights.h"
 #include "ia32_architecture.h"
@@ -107,17 +108,10 @@ const x86_asm_constraint_list_t ia32_asm_constraints = {
 #undef GP
 #undef FP
 
-typedef ir_node *construct_binop_func(dbg_info *db, ir_node *block,
-        ir_node *base, ir_node *index, ir_node *mem, ir_node *op1,
-        ir_node *op2, x86_insn_size_t size);
-
 typedef ir_node *construct_binop_flags_func(dbg_info *db, ir_node *block,
         ir_node *base, ir_node *index, ir_node *mem, ir_node *op1, ir_node *op2,
         ir_node *flags, x86_insn_size_t size);
 
-typedef ir_node *construct_shift_func(dbg_info *db, ir_node *block,
-        ir_node *op1, ir_node *op2, x86_insn_size_t size);
-
 typedef ir_node *construct_binop_dest_func(dbg_info *db, ir_node *block,
         ir_node *base, ir_node *index, ir_node *mem, ir_node *op,
         x86_insn_size_t size);
@@ -129,9 +123,6 @@ typedef ir_node *construct_binop_float_func(dbg_info *db, ir_node *block,
         ir_node *base, ir_node *index, ir_node *mem, ir_node *op1, ir_node *op2,
         ir_node *fpcw, x86_insn_size_t size);
 
-typedef ir_node *construct_unop_func(dbg_info *db, ir_node *block, ir_node *op,
-                                     x86_insn_size_t size);
-
 static ir_node *create_immediate_or_transform(ir_node *node, char immediate_mode);
 
 static ir_node *create_I2I_Conv(ir_mode *src_mode, dbg_info *dbgi, ir_node *block, ir_node *op);
@@ -1042,8 +1033,8 @@ static ir_node *make_binop(ir_node *const node, ia32_address_mode_t const *const
  * @param func  The node constructor function
  * @return The constructed ia32 node.
  */
-static ir_node *gen_binop(ir_node *node, ir_node *op1, ir_node *op2,
-                          construct_binop_func *func, match_flags_t flags)
+ir_node *ia32_gen_binop(ir_node *node, ir_node *op1, ir_node *op2,
+                        construct_binop_func *func, match_flags_t flags)
 {
 	ir_node *block = get_nodes_block(node);
 	ia32_address_mode_t am;
@@ -1208,7 +1199,7 @@ static ir_node *skip_shift_amount_conv(ir_node *n)
  * @param func8  The node constructor function for an 8 bit operation
  * @return The constructed ia32 node.
  */
-static ir_node *gen_shift_binop(ir_node *const node, ir_node *op1, ir_node *op2, construct_shift_func *const func, construct_shift_func *const func8, match_flags_t const flags)
+ir_node *ia32_gen_shift_binop(ir_node *const node, ir_node *op1, ir_node *op2, construct_shift_func *const func, construct_shift_func *const func8, match_flags_t const flags)
 {
 	assert((flags & ~(match_mode_neutral | match_sign_ext | match_zero_ext)) == 0);
 
@@ -1255,8 +1246,8 @@ static ir_node *gen_shift_binop(ir_node *const node, ir_node *op1, ir_node *op2,
  * @param func  The node constructor function
  * @return The constructed ia32 node.
  */
-static ir_node *gen_unop(ir_node *node, ir_node *op, construct_unop_func *func,
-                         match_flags_t flags)
+ir_node *ia32_gen_unop(ir_node *node, ir_node *op, construct_unop_func *func,
+                       match_flags_t flags)
 {
 	assert(flags == 0 || flags == match_mode_neutral);
 	if (flags & match_mode_neutral)
@@ -1278,6 +1269,16 @@ static ir_node *create_lea(dbg_info *const dbgi, ir_node *const block, ir_node *
 	return lea;
 }
 
+ir_node *ia32_gen_lea(ir_node *const node, ir_node *const base,
+                      ir_node *const index)
+{
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_node  *const new_block = be_transform_nodes_block(node);
+	ir_node  *const new_base  = be_transform_node(base);
+	ir_node  *const new_index = be_transform_node(index);
+	return create_lea(dbgi, new_block, new_base, new_index, 0, 0);
+}
+
 static ir_node *create_lea_from_address(dbg_info *dbgi, ir_node *block,
                                         x86_address_t *addr)
 {
@@ -1398,12 +1399,12 @@ static ir_node *match_64bit_shift(ir_node *node)
 
 static ir_node *gen_Rol(ir_node *node, ir_node *op1, ir_node *op2)
 {
-	return gen_shift_binop(node, op1, op2, &new_bd_ia32_Rol, &new_bd_ia32_Rol_8bit, match_none);
+	return ia32_gen_shift_binop(node, op1, op2, &new_bd_ia32_Rol, &new_bd_ia32_Rol_8bit, match_none);
 }
 
 static ir_node *gen_Ror(ir_node *node, ir_node *op1, ir_node *op2)
 {
-	return gen_shift_binop(node, op1, op2, &new_bd_ia32_Ror, &new_bd_ia32_Ror_8bit, match_none);
+	return ia32_gen_shift_binop(node, op1, op2, &new_bd_ia32_Ror, &new_bd_ia32_Ror_8bit, match_none);
 }
 
 /**
@@ -1431,8 +1432,8 @@ static ir_node *gen_Add(ir_node *node)
 
 	if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2)
-			return gen_binop(node, op1, op2, new_bd_ia32_Adds,
-			                 match_commutative | match_am);
+			return ia32_gen_binop(node, op1, op2, new_bd_ia32_Adds,
+			                      match_commutative | match_am);
 		else
 			return gen_binop_x87_float(node, op1, op2, new_bd_ia32_fadd);
 	}
@@ -1501,8 +1502,8 @@ static ir_node *gen_Mul(ir_node *node)
 
 	if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2)
-			return gen_binop(node, op1, op2, new_bd_ia32_Muls,
-			                 match_commutative | match_am);
+			return ia32_gen_binop(node, op1, op2, new_bd_ia32_Muls,
+			                      match_commutative | match_am);
 		else
 			return gen_binop_x87_float(node, op1, op2, new_bd_ia32_fmul);
 	}
@@ -1534,12 +1535,12 @@ static ir_node *gen_Mulh(ir_node *node)
 	ir_node  *op2  = get_Mulh_right(node);
 	ir_node  *proj_res_high;
 	if (mode_is_signed(mode)) {
-		ir_node *new_node = gen_binop(node, op1, op2, new_bd_ia32_IMul1OP,
-		                              match_commutative | match_am);
+		ir_node *new_node = ia32_gen_binop(node, op1, op2, new_bd_ia32_IMul1OP,
+		                                   match_commutative | match_am);
 		proj_res_high = be_new_Proj(new_node, pn_ia32_IMul1OP_res_high);
 	} else {
-		ir_node *new_node = gen_binop(node, op1, op2, new_bd_ia32_Mul,
-		                              match_commutative | match_am);
+		ir_node *new_node = ia32_gen_binop(node, op1, op2, new_bd_ia32_Mul,
+		                                   match_commutative | match_am);
 		proj_res_high = be_new_Proj(new_node, pn_ia32_Mul_res_high);
 	}
 	return proj_res_high;
@@ -1550,36 +1551,12 @@ static bool is_Shl_1(ir_node *const node)
 	return is_Shl(node) && is_irn_one(get_Shl_left(node));
 }
 
-/**
- * Creates an ia32 And.
- *
- * @return The created ia32 And node
- */
-static ir_node *gen_And(ir_node *node)
-{
-	ir_node *op1 = get_And_left(node);
-	ir_node *op2 = get_And_right(node);
-	assert(!mode_is_float(get_irn_mode(node)));
-
-	/* is it a zero extension? */
-	if (is_Const(op2)) {
-		long const v = get_Const_long(op2);
-		if (v == 0xFF || v == 0xFFFF) {
-			ir_mode *src_mode;
-			if (v == 0xFF) {
-				src_mode = mode_Bu;
-			} else {
-				assert(v == 0xFFFF);
-				src_mode = mode_Hu;
-			}
-			dbg_info *dbgi  = get_irn_dbg_info(node);
-			ir_node  *block = get_nodes_block(node);
-			return create_I2I_Conv(src_mode, dbgi, block, op1);
-		}
-	}
-	return gen_binop(node, op1, op2, new_bd_ia32_And,
-	                 match_commutative | match_mode_neutral | match_am
-	                 | match_immediate);
+ir_node *ia32_gen_zero_extension(ir_node *const node, ir_mode *const src_mode,
+                                 ir_node *const op)
+{
+	dbg_info *const dbgi  = get_irn_dbg_info(node);
+	ir_node  *const block = get_nodes_block(node);
+	return create_I2I_Conv(src_mode, dbgi, block, op);
 }
 
 static ir_node *gen_Or(ir_node *node)
@@ -1598,23 +1575,9 @@ static ir_node *gen_Or(ir_node *node)
 
 	ir_node *op1 = get_Or_left(node);
 	ir_node *op2 = get_Or_right(node);
-	return gen_binop(node, op1, op2, new_bd_ia32_Or,
-	                 match_commutative | match_mode_neutral
-	                 | match_am | match_immediate);
-}
-
-/**
- * Creates an ia32 Eor.
- *
- * @return The created ia32 Eor node
- */
-static ir_node *gen_Eor(ir_node *node)
-{
-	assert(!mode_is_float(get_irn_mode(node)));
-	ir_node *op1 = get_Eor_left(node);
-	ir_node *op2 = get_Eor_right(node);
-	return gen_binop(node, op1, op2, new_bd_ia32_Xor, match_commutative
-	                 | match_mode_neutral | match_am | match_immediate);
+	return ia32_gen_binop(node, op1, op2, new_bd_ia32_Or,
+	                      match_commutative | match_mode_neutral
+	                      | match_am | match_immediate);
 }
 
 /**
@@ -1630,7 +1593,7 @@ static ir_node *gen_Sub(ir_node *node)
 
 	if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2)
-			return gen_binop(node, op1, op2, new_bd_ia32_Subs, match_am);
+			return ia32_gen_binop(node, op1, op2, new_bd_ia32_Subs, match_am);
 		else
 			return gen_binop_x87_float(node, op1, op2, new_bd_ia32_fsub);
 	}
@@ -1638,8 +1601,8 @@ static ir_node *gen_Sub(ir_node *node)
 	if (is_Const(op2))
 		be_warningf(node, "found unoptimized Sub with Const");
 
-	ir_node *ia32_sub = gen_binop(node, op1, op2, new_bd_ia32_Sub, match_mode_neutral
-	                              | match_am | match_immediate);
+	ir_node *ia32_sub = ia32_gen_binop(node, op1, op2, new_bd_ia32_Sub, match_mode_neutral
+	                                   | match_am | match_immediate);
 
 	/* A Cmp node that has the same operands as this Sub will use
 	 * this Sub's flags result. To be prepared for that, we change
@@ -1789,7 +1752,7 @@ static ir_node *gen_Div(ir_node *node)
 	ir_mode *const mode = get_Div_resmode(node);
 	if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2) {
-			return gen_binop(node, op1, op2, new_bd_ia32_Divs, match_am);
+			return ia32_gen_binop(node, op1, op2, new_bd_ia32_Divs, match_am);
 		} else {
 			return gen_binop_x87_float(node, op1, op2, new_bd_ia32_fdiv);
 		}
@@ -1799,41 +1762,6 @@ static ir_node *gen_Div(ir_node *node)
 	return create_Div(node, op1, op2, mem, mode);
 }
 
-/**
- * Creates an ia32 Shl.
- *
- * @return The created ia32 Shl node
- */
-static ir_node *gen_Shl(ir_node *node)
-{
-	ir_node *left  = get_Shl_left(node);
-	ir_node *right = get_Shl_right(node);
-
-	/* special case Shl x,1 => Lea x,x because Lea has fewer register
-	 * constraints */
-	if (is_irn_one(right)) {
-		dbg_info *dbgi      = get_irn_dbg_info(node);
-		ir_node  *new_block = be_transform_nodes_block(node);
-		ir_node  *new_left  = be_transform_node(left);
-		return create_lea(dbgi, new_block, new_left, new_left, 0, 0);
-	}
-
-	return gen_shift_binop(node, left, right, &new_bd_ia32_Shl, &new_bd_ia32_Shl_8bit, match_mode_neutral);
-}
-
-/**
- * Creates an ia32 Shr.
- *
- * @return The created ia32 Shr node
- */
-static ir_node *gen_Shr(ir_node *node)
-{
-	ir_node *left  = get_Shr_left(node);
-	ir_node *right = get_Shr_right(node);
-
-	return gen_shift_binop(node, left, right, &new_bd_ia32_Shr, &new_bd_ia32_Shr_8bit, match_zero_ext);
-}
-
 /**
  * Creates an ia32 Sar.
  *
@@ -1888,7 +1816,7 @@ static ir_node *gen_Shrs(ir_node *node)
 		}
 	}
 
-	return gen_shift_binop(node, left, right, &new_bd_ia32_Sar, &new_bd_ia32_Sar_8bit, match_sign_ext);
+	return ia32_gen_shift_binop(node, left, right, &new_bd_ia32_Sar, &new_bd_ia32_Sar_8bit, match_sign_ext);
 }
 
 /**
@@ -1926,46 +1854,20 @@ static ir_node *gen_Minus(ir_node *node)
 			return new_bd_ia32_fchs(dbgi, block, new_op);
 		}
 	} else {
-		return gen_unop(node, op, new_bd_ia32_Neg, match_mode_neutral);
+		return ia32_gen_unop(node, op, new_bd_ia32_Neg, match_mode_neutral);
 	}
 }
 
-/**
- * Transforms a Not node.
- *
- * @return The created ia32 Not node
- */
-static ir_node *gen_Not(ir_node *node)
-{
-	assert(get_irn_mode(node) != mode_b); /* should be lowered already */
-	ir_node *op = get_Not_op(node);
-
-	if (is_Shl_1(op)) {
-		/* ~(1 << x) -> Rol(~1, x) */
-		dbg_info   *const dbgi    = get_irn_dbg_info(node);
-		ir_node    *const block   = be_transform_nodes_block(node);
-		x86_imm32_t const imm     = { .offset = -2 };
-		ir_node    *const m2      = new_bd_ia32_Const(NULL, block, &imm);
-		ir_node    *const val     = get_Shl_right(op);
-		ir_node    *const new_val = be_transform_node(val);
-		return new_bd_ia32_Rol(dbgi, block, m2, new_val, X86_SIZE_32);
-	}
-
-	if (is_Shr(op)) {
-		ir_node *const shrl = get_Shr_left(op);
-		if (is_Const(shrl) && get_tarval_lowest_bit(get_Const_tarval(shrl)) == 31) {
-			/* ~(0x80000000 >> x) -> Ror(~0x80000000, x) */
-			dbg_info   *const dbgi    = get_irn_dbg_info(node);
-			ir_node    *const block   = be_transform_nodes_block(node);
-			x86_imm32_t const imm     = { .offset = 0x7FFFFFFF };
-			ir_node    *const m2      = new_bd_ia32_Const(NULL, block, &imm);
-			ir_node    *const val     = get_Shr_right(op);
-			ir_node    *const new_val = be_transform_node(val);
-			return new_bd_ia32_Ror(dbgi, block, m2, new_val, X86_SIZE_32);
-		}
-	}
-
-	return gen_unop(node, op, new_bd_ia32_Not, match_mode_neutral);
+ir_node *ia32_gen_rotate_const(ir_node *const node, int32_t const value,
+                               ir_node *const count,
+                               construct_shift_func *const func)
+{
+	dbg_info   *const dbgi      = get_irn_dbg_info(node);
+	ir_node    *const block     = be_transform_nodes_block(node);
+	x86_imm32_t const imm       = { .offset = value };
+	ir_node    *const cnst      = new_bd_ia32_Const(NULL, block, &imm);
+	ir_node    *const new_count = be_transform_node(count);
+	return func(dbgi, block, cnst, new_count, X86_SIZE_32);
 }
 
 static ir_node *create_float_abs(dbg_info *const dbgi, ir_node *const new_block, ir_node *const op, bool const negate)
@@ -3101,7 +3003,7 @@ static ir_node *create_set_32bit(dbg_info *dbgi, ir_node *new_block,
  */
 static ir_node *create_doz(ir_node *psi, ir_node *a, ir_node *b)
 {
-	ir_node *new_node = gen_binop(psi, a, b, new_bd_ia32_Sub,
+	ir_node *new_node = ia32_gen_binop(psi, a, b, new_bd_ia32_Sub,
 		match_mode_neutral | match_am | match_immediate | match_two_users);
 
 	ir_node *sub;
@@ -3387,22 +3289,22 @@ static ir_node *gen_Mux(ir_node *node)
 			if (relation == ir_relation_less || relation == ir_relation_less_equal) {
 				if (cmp_left == mux_true && cmp_right == mux_false) {
 					/* Mux(a <= b, a, b) => MIN */
-					return gen_binop(node, cmp_left, cmp_right, new_bd_ia32_Mins,
-			                 match_commutative | match_am | match_two_users);
+					return ia32_gen_binop(node, cmp_left, cmp_right, new_bd_ia32_Mins,
+			                      match_commutative | match_am | match_two_users);
 				} else if (cmp_left == mux_false && cmp_right == mux_true) {
 					/* Mux(a <= b, b, a) => MAX */
-					return gen_binop(node, cmp_left, cmp_right, new_bd_ia32_Maxs,
-			                 match_commutative | match_am | match_two_users);
+					return ia32_gen_binop(node, cmp_left, cmp_right, new_bd_ia32_Maxs,
+			                      match_commutative | match_am | match_two_users);
 				}
 			} else if (relation == ir_relation_greater || relation == ir_relation_greater_equal) {
 				if (cmp_left == mux_true && cmp_right == mux_false) {
 					/* Mux(a >= b, a, b) => MAX */
-					return gen_binop(node, cmp_left, cmp_right, new_bd_ia32_Maxs,
-			                 match_commutative | match_am | match_two_users);
+					return ia32_gen_binop(node, cmp_left, cmp_right, new_bd_ia32_Maxs,
+			                      match_commutative | match_am | match_two_users);
 				} else if (cmp_left == mux_false && cmp_right == mux_true) {
 					/* Mux(a >= b, b, a) => MIN */
-					return gen_binop(node, cmp_left, cmp_right, new_bd_ia32_Mins,
-			                 match_commutative | match_am | match_two_users);
+					return ia32_gen_binop(node, cmp_left, cmp_right, new_bd_ia32_Mins,
+			                      match_commutative | match_am | match_two_users);
 				}
 			}
 		}
@@ -4193,9 +4095,9 @@ static ir_node *gen_ia32_l_Add(ir_node *node)
 {
 	ir_node *left    = get_irn_n(node, n_ia32_l_Add_left);
 	ir_node *right   = get_irn_n(node, n_ia32_l_Add_right);
-	ir_node *lowered = gen_binop(node, left, right, new_bd_ia32_Add,
-	                             match_commutative | match_am | match_immediate
-	                             | match_mode_neutral);
+	ir_node *lowered = ia32_gen_binop(node, left, right, new_bd_ia32_Add,
+	                                  match_commutative | match_am | match_immediate
+	                                  | match_mode_neutral);
 
 	if (is_Proj(lowered)) {
 		lowered = get_Proj_pred(lowered);
@@ -4223,8 +4125,8 @@ static ir_node *gen_ia32_l_Mul(ir_node *node)
 {
 	ir_node *left  = get_irn_n(node, n_ia32_l_Mul_left);
 	ir_node *right = get_irn_n(node, n_ia32_l_Mul_right);
-	return gen_binop(node, left, right, new_bd_ia32_Mul,
-	                 match_commutative | match_am | match_mode_neutral);
+	return ia32_gen_binop(node, left, right, new_bd_ia32_Mul,
+	                      match_commutative | match_am | match_mode_neutral);
 }
 
 /**
@@ -4236,17 +4138,17 @@ static ir_node *gen_ia32_l_IMul(ir_node *node)
 {
 	ir_node *left  = get_irn_n(node, n_ia32_l_IMul_left);
 	ir_node *right = get_irn_n(node, n_ia32_l_IMul_right);
-	return gen_binop(node, left, right, new_bd_ia32_IMul1OP,
-	                 match_commutative | match_am | match_mode_neutral);
+	return ia32_gen_binop(node, left, right, new_bd_ia32_IMul1OP,
+	                      match_commutative | match_am | match_mode_neutral);
 }
 
 static ir_node *gen_ia32_l_Sub(ir_node *node)
 {
 	ir_node *left    = get_irn_n(node, n_ia32_l_Sub_minuend);
 	ir_node *right   = get_irn_n(node, n_ia32_l_Sub_subtrahend);
-	ir_node *lowered = gen_binop(node, left, right, new_bd_ia32_Sub,
-	                             match_am | match_immediate
-	                             | match_mode_neutral);
+	ir_node *lowered = ia32_gen_binop(node, left, right, new_bd_ia32_Sub,
+	                                  match_am | match_immediate
+	                                  | match_mode_neutral);
 
 	if (is_Proj(lowered)) {
 		lowered = get_Proj_pred(lowered);
@@ -5321,7 +5223,6 @@ static void register_transformers(void)
 	be_set_transform_function(op_Add,              gen_Add);
 	be_set_transform_function(op_Address,          gen_Address);
 	be_set_transform_function(op_Alloc,            gen_Alloc);
-	be_set_transform_function(op_And,              gen_And);
 	be_set_transform_function(op_ASM,              gen_ASM);
 	be_set_transform_function(op_Bitcast,          gen_Bitcast);
 	be_set_transform_function(op_Builtin,          gen_Builtin);
@@ -5332,7 +5233,6 @@ static void register_transformers(void)
 	be_set_transform_function(op_Conv,             gen_Conv);
 	be_set_transform_function(op_CopyB,            gen_CopyB);
 	be_set_transform_function(op_Div,              gen_Div);
-	be_set_transform_function(op_Eor,              gen_Eor);
 	be_set_transform_function(op_ia32_GetEIP,      be_duplicate_node);
 	be_set_transform_function(op_ia32_l_Adc,       gen_ia32_l_Adc);
 	be_set_transform_function(op_ia32_l_Add,       gen_ia32_l_Add);
@@ -5352,12 +5252,9 @@ static void register_transformers(void)
 	be_set_transform_function(op_Mul,              gen_Mul);
 	be_set_transform_function(op_Mulh,             gen_Mulh);
 	be_set_transform_function(op_Mux,              gen_Mux);
-	be_set_transform_function(op_Not,              gen_Not);
 	be_set_transform_function(op_Or,               gen_Or);
 	be_set_transform_function(op_Phi,              gen_Phi);
 	be_set_transform_function(op_Return,           gen_Return);
-	be_set_transform_function(op_Shl,              gen_Shl);
-	be_set_transform_function(op_Shr,              gen_Shr);
 	be_set_transform_function(op_Shrs,             gen_Shrs);
 	be_set_transform_function(op_Start,            gen_Start);
 	be_set_transform_function(op_Store,            gen_Store);
@@ -5365,6 +5262,8 @@ static void register_transformers(void)
 	be_set_transform_function(op_Switch,           gen_Switch);
 	be_set_transform_function(op_Unknown,          gen_Unknown);
 	be_set_transform_function(op_be_Relocation,    gen_be_Relocation);
+	ia32_register_isel_rules();
+
 	be_set_transform_proj_function(op_Alloc,            gen_Proj_Alloc);
 	be_set_transform_proj_function(op_Builtin,          gen_Proj_Builtin);
 	be_set_transform_proj_function(op_Call,             gen_Proj_Call);
@@ -12,6 +12,7 @@
 #define FIRM_BE_IA32_IA32_TRANSFORM_H
 
 #include "firm_types.h"
+#include "ia32_nodes_attr.h"
 #include "x86_asm.h"
 #include "x86_node.h"
 
@@ -58,4 +59,59 @@ static inline ir_node *ia32_create_Immediate(ir_graph *const irg,
 	return ia32_create_Immediate_full(irg, &imm);
 }
 
+typedef ir_node *construct_binop_func(dbg_info *db, ir_node *block,
+        ir_node *base, ir_node *index, ir_node *mem, ir_node *op1,
+        ir_node *op2, x86_insn_size_t size);
+
+typedef ir_node *construct_shift_func(dbg_info *db, ir_node *block,
+        ir_node *op1, ir_node *op2, x86_insn_size_t size);
+
+typedef ir_node *construct_unop_func(dbg_info *db, ir_node *block, ir_node *op,
+                                     x86_insn_size_t size);
+
+/**
+ * @name Selection helpers
+ * Used by the instruction selection rules in ia32_spec.pl.
+ * @{
+ */
+
+/**
+ * Transforms @p node into a binary operation with operands @p op1 and
+ * @p op2, matching address mode and immediates as allowed by @p flags.
+ */
+ir_node *ia32_gen_binop(ir_node *node, ir_node *op1, ir_node *op2,
+                        construct_binop_func *func, match_flags_t flags);
+
+/**
+ * Transforms @p node into a shift of @p op1 by @p op2. @p func8 is used for
+ * 8 bit operations.
+ */
+ir_node *ia32_gen_shift_binop(ir_node *node, ir_node *op1, ir_node *op2,
+                              construct_shift_func *func,
+                              construct_shift_func *func8,
+                              match_flags_t flags);
+
+/** Transforms @p node into a unary operation on @p op. */
+ir_node *ia32_gen_unop(ir_node *node, ir_node *op, construct_unop_func *func,
+                       match_flags_t flags);
+
+/**
+ * Transforms @p node into a zero extension of the lower bits of @p op given
+ * by @p src_mode.
+ */
+ir_node *ia32_gen_zero_extension(ir_node *node, ir_mode *src_mode,
+                                 ir_node *op);
+
+/** Transforms @p node into a Lea computing @p base + @p index. */
+ir_node *ia32_gen_lea(ir_node *node, ir_node *base, ir_node *index);
+
+/**
+ * Transforms @p node into a rotation (@p func) of the constant @p value by
+ * @p count.
+ */
+ir_node *ia32_gen_rotate_const(ir_node *node, int32_t value, ir_node *count,
+                               construct_shift_func *func);
+
+/** @} */
+
 #endif
@@ -23,7 +23,6 @@
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "irprintf.h"
-#include <inttypes.h>
 
 static bitset_t *non_address_mode_nodes;
 
@@ -510,12 +509,14 @@ void x86_emit_addr(ir_node const *const node, x86_addr_t const *const addr)
 	assert(variant != X86_ADDR_INVALID);
 	if (entity) {
 		x86_emit_relocation_no_offset(addr->immediate.kind, entity);
+		if (offset > 0)
+			be_emit_char('+');
 		if (offset != 0)
-			be_emit_irprintf("%+"PRId32, offset);
+			be_emit_int(offset);
 	} else if (offset != 0 || variant == X86_ADDR_JUST_IMM) {
 		assert(addr->immediate.kind == X86_IMM_VALUE);
 		/* also handle special case if nothing is set */
-		be_emit_irprintf("%"PRId32, offset);
+		be_emit_int(offset);
 	}
 
 	if (variant != X86_ADDR_JUST_IMM) {
@@ -537,8 +538,10 @@ void x86_emit_addr(ir_node const *const node, x86_addr_t const *const addr)
 				emit_register(reg);
 
 				unsigned const log_scale = addr->log_scale;
-				if (log_scale > 0)
-					be_emit_irprintf(",%u", 1u << log_scale);
+				if (log_scale > 0) {
+					be_emit_char(',');
+					be_emit_int(1u << log_scale);
+				}
 			}
 		}
 		be_emit_char(')');
@@ -40,7 +40,7 @@ static ir_settings_arch_dep_t const mips_arch_dep = {
 	.maximum_shifts       = 4,
 	.highest_shift_amount = 63,
 	.evaluate             = NULL,
-	.max_bits_for_mulh    = MIPS_MACHINE_SIZE,
+	.max_bits_for_mulh    = 2 * MIPS_MACHINE_SIZE,
 };
 
 static void mips_init_asm_constraints(void)
@@ -248,7 +248,7 @@ static void mips_generate_code(FILE *const output, char const *const cup_name)
 
 		ir_type *const frame = get_irg_frame_type(irg);
 		be_sort_frame_entities(frame, true);
-		be_layout_frame_type(frame, 0, 0);
+		be_layout_frame_type(frame, 0, 0, true);
 
 		mips_introduce_prologue_epilogue(irg);
 		be_fix_stack_nodes(irg, &mips_registers[REG_SP]);
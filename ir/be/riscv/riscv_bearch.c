@@ -89,7 +89,7 @@ static ir_settings_arch_dep_t const riscv_arch_dep = {
 	.maximum_shifts       = 4,
 	.highest_shift_amount = 63,
 	.evaluate             = NULL,
-	.max_bits_for_mulh    = RISCV_MACHINE_SIZE,
+	.max_bits_for_mulh    = 2 * RISCV_MACHINE_SIZE,
 };
 
 /**
@@ -443,7 +443,7 @@ static void riscv_generate_code(FILE *const output, char const *const cup_name)
 		int begin = is_method_variadic(fun_type) ? -(RISCV_REGISTER_SIZE * RISCV_N_PARAM_REGS) : 0;
 		// slot for saved frame pointer
 		begin -= omit_fp ? 0 : RISCV_REGISTER_SIZE;
-		be_layout_frame_type(frame, begin, 0);
+		be_layout_frame_type(frame, begin, 0, omit_fp);
 
 		riscv_introduce_prologue_epilogue(irg, omit_fp);
 		be_fix_stack_nodes(irg, &riscv_registers[REG_SP]);
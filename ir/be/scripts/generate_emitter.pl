@@ -8,6 +8,13 @@
 # This script generates C code which emits assembler code for the
 # assembler ir nodes. It takes a "emit" key from the node specification
 # and generates ${arch}_emitf() calls for them.
+#
+# If the specification provides %emit_conversions, the templates are
+# translated into direct calls instead: Text is appended as string constants
+# and each conversion matching one of the regular expressions in
+# %emit_conversions is replaced by the associated C code ($1... refer to the
+# groups of the expression). The rest of a line starting with any other
+# conversion is passed to ${arch}_emitf_part().
 
 use strict;
 use warnings;
@@ -17,6 +24,7 @@ our $target_dir = $ARGV[1];
 
 our $arch;
 our %nodes;
+our %emit_conversions;
 
 unless (my $return = do "${specfile}") {
 	die "Fatal error: couldn't parse $specfile: $@" if $@;
@@ -24,6 +32,69 @@ unless (my $return = do "${specfile}") {
 	die "Fatal error: couldn't run $specfile"       unless $return;
 }
 
+sub c_string
+{
+	my ($str) = @_;
+	$str =~ s/([\\"])/\\$1/g;
+	$str =~ s/\n/\\n/g;
+	return $str;
+}
+
+sub emit_literal
+{
+	my ($text) = @_;
+	return "" if $text eq "";
+	if (length($text) == 1) {
+		$text =~ s/([\\'])/\\$1/;
+		return "\tbe_emit_char('$text');\n";
+	}
+	return "\tbe_emit_cstring(\"" . c_string($text) . "\");\n";
+}
+
+# Translate an emit template into a sequence of direct emit calls.
+sub compile_template
+{
+	my ($emit) = @_;
+	my $code    = "\tbe_emit_char('\\t');\n";
+	my $literal = "";
+	while ($emit ne "") {
+		if ($emit =~ s/^([^%\n]+)//) {
+			$literal .= $1;
+		} elsif ($emit =~ s/^%%//) {
+			$literal .= "%";
+		} elsif ($emit =~ s/^\n//) {
+			$code    .= emit_literal($literal);
+			$literal  = "";
+			$code    .= "\tbe_emit_finish_line_gas(node);\n";
+			$code    .= "\tbe_emit_char('\\t');\n";
+		} else {
+			$code    .= emit_literal($literal);
+			$literal  = "";
+
+			# Take the longest matching conversion.
+			my $match_len = 0;
+			my $match_code;
+			foreach my $regex (sort(keys(%emit_conversions))) {
+				my @groups = ($emit =~ /^%(?:$regex)/);
+				next if !@groups || $+[0] <= $match_len;
+				$match_len  = $+[0];
+				$match_code = $emit_conversions{$regex};
+				$match_code =~ s/\$(\d)/$groups[$1 - 1]/g;
+			}
+			if (defined($match_code)) {
+				$code .= "\t$match_code;\n";
+				substr($emit, 0, $match_len) = "";
+			} else {
+				$emit =~ s/^([^\n]*)//;
+				$code .= "\t${arch}_emitf_part(node, \"" . c_string($1) . "\");\n";
+			}
+		}
+	}
+	$code .= emit_literal($literal);
+	$code .= "\tbe_emit_finish_line_gas(node);\n";
+	return $code;
+}
+
 # buffers for output
 my $obst_func            = ""; # buffer for the emit functions
 my $obst_register        = ""; # buffer for emitter register code
@@ -47,8 +118,12 @@ foreach my $op (sort(keys(%nodes))) {
 			$obst_func .= "{\n";
 			my $name = $n->{name} // lc($op);
 			$emit =~ s/{name}/$name/g;
-			$emit =~ s/\n/\\n/g;
-			$obst_func .= "\t${arch}_emitf(node, \"$emit\");\n";
+			if (%emit_conversions) {
+				$obst_func .= compile_template($emit);
+			} else {
+				$emit =~ s/\n/\\n/g;
+				$obst_func .= "\t${arch}_emitf(node, \"$emit\");\n";
+			}
 			$obst_func .= "}\n\n";
 		}
 		$obst_register .= "\tbe_set_emitter(op_${arch}_$op, $emit_func);\n";
@@ -109,6 +184,8 @@ print $out_c <<EOF;
 #include "gen_${arch}_emitter.h"
 
 #include "beemithlp.h"
+#include "beemitter.h"
+#include "begnuas.h"
 #include "gen_${arch}_new_nodes.h"
 #include "${arch}_emitter.h"
 
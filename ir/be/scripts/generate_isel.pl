@@ -0,0 +1,238 @@
+#! /usr/bin/env perl
+
+#
+# This file is part of libFirm.
+# Copyright (C) 2017 University of Karlsruhe.
+#
+
+# This script generates instruction selection functions from the
+# %isel_rules of a backend specification.
+#
+# %isel_rules maps the name of a Firm opcode to a list of rules. Each rule
+# consists of
+#   pattern => tree pattern rooted at the opcode, e.g. 'Not(Shl(c:Const, y))'.
+#              An operand is either an opcode with an optional list of
+#              operand patterns or a lowercase name matching any node.
+#              "name:" binds the node matched by an opcode to a name.
+#   cond    => (optional) C condition on the bound names
+#   cost    => cost of the instructions produced by the rule
+#   emit    => C expression creating the result, "node" is the matched root
+#
+# %isel_asserts optionally maps an opcode to a list of C conditions on "node"
+# which hold for every node reaching the selection, e.g. because earlier
+# lowering removed the other cases. They are asserted on function entry.
+#
+# The generated function for an opcode tries the rules covering the most
+# nodes first (maximal munch), rules of equal size in order of increasing cost
+# and otherwise in the order of the specification. The first rule whose
+# pattern and condition match produces the result; the operands are
+# transformed on demand by the helpers called in "emit".
+
+use strict;
+use warnings;
+
+our $specfile   = $ARGV[0];
+our $target_dir = $ARGV[1];
+
+our $arch;
+our %isel_rules;
+our %isel_asserts;
+
+unless (my $return = do "${specfile}") {
+	die "Fatal error: couldn't parse $specfile: $@" if $@;
+	die "Fatal error: couldn't do $specfile: $!"    unless defined $return;
+	die "Fatal error: couldn't run $specfile"       unless $return;
+}
+
+# Parse a pattern into a tree of { op, name, operands }. Wildcards have no op.
+sub parse_pattern
+{
+	my ($text, $pattern) = @_;
+	$$text =~ s/^\s*//;
+	my $name;
+	if ($$text =~ s/^([a-z]\w*)\s*//) {
+		$name = $1;
+		return { name => $name, operands => [] } unless $$text =~ s/^:\s*//;
+	}
+	$$text =~ s/^([A-Z]\w*)\s*// or die("$specfile: syntax error in pattern '$pattern'\n");
+	my $node = { op => $1, name => $name, operands => [] };
+	if ($$text =~ s/^\(//) {
+		do {
+			push(@{$node->{operands}}, parse_pattern($text, $pattern));
+			$$text =~ s/^\s*//;
+		} while ($$text =~ s/^,//);
+		$$text =~ s/^\)\s*// or die("$specfile: expected ')' in pattern '$pattern'\n");
+	}
+	return $node;
+}
+
+sub count_ops
+{
+	my ($node) = @_;
+	return 0 unless defined($node->{op});
+	my $n = 1;
+	$n += count_ops($_) foreach @{$node->{operands}};
+	return $n;
+}
+
+# Generate the code testing a rule; see the header for the semantics.
+sub generate_rule
+{
+	my ($rule, $op) = @_;
+	my $pattern = $rule->{pattern};
+	my $text    = $pattern;
+	my $root    = parse_pattern(\$text, $pattern);
+	die("$specfile: trailing garbage in pattern '$pattern'\n") if $text ne "";
+	die("$specfile: pattern '$pattern' is not rooted at $op\n") if !defined($root->{op}) || $root->{op} ne $op;
+
+	my $emit = $rule->{emit} // die("$specfile: rule '$pattern' has no emit\n");
+	my $cond = $rule->{cond};
+	my $uses = $emit . ($cond // "");
+
+	# Name the nodes and collect the levels of type checks: The operands of
+	# a node may only be accessed after its opcode has been checked.
+	my %names = (node => 1);
+	my $n_temps = 0;
+	$root->{var} = "node";
+	my @levels;
+	my @todo = ($root);
+	while (@todo) {
+		my @decls;
+		my @checks;
+		my @next;
+		foreach my $node (@todo) {
+			my $i = 0;
+			foreach my $operand (@{$node->{operands}}) {
+				my $var = $operand->{name};
+				if (defined($var)) {
+					die("$specfile: name '$var' bound twice in '$pattern'\n") if $names{$var}++;
+				} else {
+					$var = "n" . $n_temps++;
+				}
+				$operand->{var} = $var;
+				my $used = $uses =~ /\b\Q$var\E\b/;
+				if (defined($operand->{op})) {
+					push(@checks, "is_$operand->{op}($var)");
+					push(@next, $operand);
+					$used = 1;
+				}
+				push(@decls, "ir_node *const $var = get_irn_n($node->{var}, $i);") if $used;
+				++$i;
+			}
+		}
+		push(@levels, { decls => \@decls, checks => \@checks });
+		@todo = @next;
+	}
+	pop(@levels) while @levels > 1 && !@{$levels[-1]->{decls}} && !@{$levels[-1]->{checks}};
+	if (defined($cond)) {
+		$cond = "($cond)" if $cond =~ /\|\||\?/;
+		push(@{$levels[-1]->{checks}}, $cond);
+	}
+
+	my $code   = "\t/* $pattern */\n";
+	my $indent = "\t";
+	my $depth  = 0;
+	my $block  = 0;
+	foreach my $level (@levels) {
+		if (@{$level->{decls}} && !$block) {
+			$code .= "$indent\{\n";
+			$indent .= "\t";
+			$block = 1;
+		}
+		$code .= "$indent$_\n" foreach @{$level->{decls}};
+		next unless @{$level->{checks}};
+		$code .= "${indent}if (" . join(" && ", @{$level->{checks}}) . ") {\n";
+		$indent .= "\t";
+		++$depth;
+	}
+	$code .= "${indent}return $emit;\n";
+	while ($depth-- > 0 || $block-- > 0) {
+		$indent = substr($indent, 1);
+		$code .= "$indent}\n";
+	}
+	return ($code, !defined($cond) && !grep { @{$_->{checks}} } @levels);
+}
+
+foreach my $op (keys(%isel_asserts)) {
+	die("$specfile: asserts for $op without isel rules\n") unless defined($isel_rules{$op});
+}
+
+my $obst_func     = "";
+my $obst_register = "";
+
+foreach my $op (sort(keys(%isel_rules))) {
+	my $rules = $isel_rules{$op};
+	my $n     = 0;
+	my @sorted = map { $_->[0] } sort {
+		$b->[1] <=> $a->[1] || $a->[0]->{cost} <=> $b->[0]->{cost} || $a->[2] <=> $b->[2]
+	} map {
+		my $text = $_->{pattern};
+		die("$specfile: rule '$text' has no cost\n") unless defined($_->{cost});
+		[ $_, count_ops(parse_pattern(\$text, $text)), $n++ ]
+	} @$rules;
+
+	my $func = "isel_$op";
+	$obst_func .= "static ir_node *$func(ir_node *const node)\n{\n";
+	foreach my $assertion (@{$isel_asserts{$op} // []}) {
+		$obst_func .= "\tassert($assertion);\n";
+	}
+	my $complete = 0;
+	foreach my $rule (@sorted) {
+		die("$specfile: rule '$rule->{pattern}' is never tried\n") if $complete;
+		my ($code, $unconditional) = generate_rule($rule, $op);
+		$obst_func .= $code;
+		$complete = $unconditional;
+	}
+	$obst_func .= "\tpanic(\"no selection rule matches %+F\", node);\n" unless $complete;
+	$obst_func .= "}\n\n";
+
+	$obst_register .= "\tbe_set_transform_function(op_$op, $func);\n";
+}
+
+my $creation_time = localtime(time());
+
+sub create_with_header
+{
+	my ($name, $brief) = @_;
+
+	open(my $out, ">", $name) // die("Could not open $name, reason: $!\n");
+	print $out <<EOF;
+/**
+ * \@file
+ * \@brief $brief
+ * \@note  DO NOT EDIT THIS FILE, your changes will be lost.
+ *         Edit $specfile instead.
+ *         created by: $0 $specfile $target_dir
+ * \@date  $creation_time
+ */
+EOF
+	return $out;
+}
+
+my $out_h = create_with_header("$target_dir/gen_${arch}_isel.h", "Function prototypes for the generated instruction selection.");
+my $uarch = uc($arch);
+print $out_h <<EOF;
+#ifndef FIRM_BE_${uarch}_GEN_${uarch}_ISEL_H
+#define FIRM_BE_${uarch}_GEN_${uarch}_ISEL_H
+
+void ${arch}_register_isel_rules(void);
+
+#endif
+EOF
+close($out_h);
+
+my $out_c = create_with_header("$target_dir/gen_${arch}_isel.c", "Generated instruction selection functions.");
+print $out_c <<EOF;
+#include "gen_${arch}_isel.h"
+
+#include "betranshlp.h"
+#include "gen_${arch}_new_nodes.h"
+#include "irnode_t.h"
+#include "panic.h"
+#include "${arch}_transform.h"
+
+${obst_func}void ${arch}_register_isel_rules(void)
+{
+${obst_register}}
+EOF
+close($out_c);
@@ -21,6 +21,7 @@
 #include "firm.h"
 #include "ident_t.h"
 #include "ircons_t.h"
+#include "irdom_t.h"
 #include "iredges_t.h"
 #include "irflag_t.h"
 #include "irgraph_t.h"
@@ -73,6 +74,7 @@ void ir_init_library(void)
 	   later. */
 	init_irprog_2();
 	firm_init_memory_disambiguator();
+	firm_init_dom();
 	firm_init_loop_opt();
 
 	init_execfreq();
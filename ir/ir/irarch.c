@@ -865,7 +865,7 @@ static ir_node *replace_div_by_mulh(ir_node *div, ir_tarval *tv)
 			ir_node *increment = new_rd_Builtin(dbg, block, no_mem, 1, in,
 			                                    ir_bk_saturating_increment, utype);
 
-			n = new_r_Proj(increment, mode_Iu, pn_Builtin_max + 1);
+			n = new_r_Proj(increment, mode, pn_Builtin_max + 1);
 		}
 
 		/* generate the Mulh instruction */
@@ -0,0 +1,369 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Structural hash of graphs that is stable across compiler runs.
+ *
+ * Nodes are numbered in walk order and hashed by opcode, mode, attributes and
+ * the numbers of their operands.  Entities are identified by their linker
+ * name (or their position in the frame type), types by their structure, so
+ * neither pointers nor node numbers influence the result.
+ */
+#include "array.h"
+#include "entity_t.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "tv_t.h"
+#include "type_t.h"
+#include "util.h"
+#include <string.h>
+
+#define FNV64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV64_PRIME        0x100000001b3ULL
+
+/** Maximum nesting depth up to which types are hashed structurally. */
+#define MAX_TYPE_DEPTH 3
+
+typedef struct hash_env_t {
+	uint64_t   hash;
+	ir_graph  *irg;
+	ir_node  **nodes;    /**< nodes in walk order */
+	bool       unstable; /**< graph contains something we cannot hash */
+} hash_env_t;
+
+static void hash64_bytes(hash_env_t *env, void const *data, size_t len)
+{
+	unsigned char const *bytes = (unsigned char const*)data;
+	uint64_t             hash  = env->hash;
+	for (size_t i = 0; i < len; ++i) {
+		hash ^= bytes[i];
+		hash *= FNV64_PRIME;
+	}
+	env->hash = hash;
+}
+
+static void hash64_u64(hash_env_t *env, uint64_t value)
+{
+	hash64_bytes(env, &value, sizeof(value));
+}
+
+static void hash64_str(hash_env_t *env, char const *str)
+{
+	if (str == NULL) {
+		hash64_u64(env, 0);
+		return;
+	}
+	size_t const len = strlen(str);
+	hash64_u64(env, len);
+	hash64_bytes(env, str, len);
+}
+
+static void hash_ident(hash_env_t *env, ident *id)
+{
+	hash64_str(env, id != NULL ? get_id_str(id) : NULL);
+}
+
+static void hash_mode(hash_env_t *env, ir_mode const *mode)
+{
+	if (mode == NULL) {
+		hash64_u64(env, 0);
+		return;
+	}
+	hash64_str(env, get_mode_name(mode));
+	hash64_u64(env, get_mode_size_bits(mode));
+	hash64_u64(env, get_mode_arithmetic(mode));
+	hash64_u64(env, mode_is_signed(mode));
+	hash64_u64(env, get_mode_modulo_shift(mode));
+}
+
+static void hash_tarval(hash_env_t *env, ir_tarval *tv)
+{
+	ir_mode *const mode = get_tarval_mode(tv);
+	hash_mode(env, mode);
+	if (mode == mode_b) {
+		hash64_u64(env, tv == tarval_b_true);
+		return;
+	}
+	if (!mode_is_data(mode)) {
+		/* Bad and Unknown tarvals */
+		hash64_u64(env, tv == tarval_bad);
+		return;
+	}
+	for (unsigned i = 0, n = get_mode_size_bytes(mode); i < n; ++i) {
+		unsigned char const byte = get_tarval_sub_bits(tv, i);
+		hash64_bytes(env, &byte, 1);
+	}
+}
+
+static void hash_type(hash_env_t *env, ir_type const *type, unsigned depth);
+
+static void hash_entity(hash_env_t *env, ir_entity const *entity)
+{
+	hash64_u64(env, entity->kind);
+	if (entity->kind == IR_ENTITY_LABEL) {
+		/* label numbers are handed out globally */
+		env->unstable = true;
+		return;
+	}
+
+	ir_type *const owner = get_entity_owner(entity);
+	if (is_frame_type(owner)) {
+		/* Frame entities are local, identify them structurally. */
+		if (is_parameter_entity(entity))
+			hash64_u64(env, get_entity_parameter_number(entity));
+		hash_type(env, get_entity_type(entity), 1);
+		hash64_u64(env, (uint64_t)get_entity_offset(entity));
+		hash64_u64(env, get_entity_alignment(entity));
+		return;
+	}
+
+	hash64_u64(env, get_type_opcode(owner));
+	if (is_segment_type(owner))
+		hash_ident(env, get_compound_ident(owner));
+	hash_ident(env, get_entity_ld_ident(entity));
+	hash64_u64(env, entity_has_definition(entity));
+	hash64_u64(env, get_entity_visibility(entity));
+	hash64_u64(env, get_entity_linkage(entity));
+	hash64_u64(env, get_entity_alignment(entity));
+	if (is_compound_type(owner) && !is_segment_type(owner)) {
+		hash64_u64(env, (uint64_t)get_entity_offset(entity));
+		hash64_u64(env, get_entity_bitfield_offset(entity));
+		hash64_u64(env, get_entity_bitfield_size(entity));
+	}
+}
+
+static void hash_type(hash_env_t *env, ir_type const *type, unsigned depth)
+{
+	if (type == NULL) {
+		hash64_u64(env, 0);
+		return;
+	}
+	tp_opcode const opcode = get_type_opcode(type);
+	hash64_u64(env, opcode);
+	hash64_u64(env, get_type_size(type));
+	hash64_u64(env, get_type_alignment(type));
+	if (depth >= MAX_TYPE_DEPTH)
+		return;
+
+	switch (opcode) {
+	case tpo_primitive:
+		hash_mode(env, get_type_mode(type));
+		return;
+	case tpo_pointer:
+		hash_mode(env, get_type_mode(type));
+		hash_type(env, get_pointer_points_to_type(type), depth + 1);
+		return;
+	case tpo_array:
+		hash64_u64(env, get_array_size(type));
+		hash_type(env, get_array_element_type(type), depth + 1);
+		return;
+	case tpo_method:
+		hash64_u64(env, get_method_calling_convention(type));
+		hash64_u64(env, get_method_additional_properties(type));
+		hash64_u64(env, is_method_variadic(type));
+		hash64_u64(env, get_method_n_params(type));
+		for (size_t i = 0, n = get_method_n_params(type); i < n; ++i)
+			hash_type(env, get_method_param_type(type, i), depth + 1);
+		hash64_u64(env, get_method_n_ress(type));
+		for (size_t i = 0, n = get_method_n_ress(type); i < n; ++i)
+			hash_type(env, get_method_res_type(type, i), depth + 1);
+		return;
+	case tpo_class:
+	case tpo_struct:
+	case tpo_union:
+	case tpo_segment:
+		hash_ident(env, get_compound_ident(type));
+		hash64_u64(env, get_compound_n_members(type));
+		return;
+	case tpo_code:
+	case tpo_unknown:
+	case tpo_uninitialized:
+		return;
+	}
+}
+
+static void hash_except(hash_env_t *env, ir_node const *node)
+{
+	hash64_u64(env, ir_throws_exception(node));
+}
+
+static void hash_attrs(hash_env_t *env, ir_node *node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Address:
+	case iro_Offset:
+		hash_entity(env, get_entconst_entity(node));
+		return;
+	case iro_Member:
+		hash_entity(env, get_Member_entity(node));
+		return;
+	case iro_Align:
+	case iro_Size:
+		hash_type(env, get_typeconst_type(node), 0);
+		return;
+	case iro_Sel:
+		hash_type(env, get_Sel_type(node), 0);
+		return;
+	case iro_Const:
+		hash_tarval(env, get_Const_tarval(node));
+		return;
+	case iro_Proj:
+		hash64_u64(env, get_Proj_num(node));
+		return;
+	case iro_Cmp:
+		hash64_u64(env, get_Cmp_relation(node));
+		return;
+	case iro_Confirm:
+		hash64_u64(env, get_Confirm_relation(node));
+		return;
+	case iro_Cond:
+		hash64_u64(env, get_Cond_jmp_pred(node));
+		return;
+	case iro_Phi:
+		hash64_u64(env, get_Phi_loop(node));
+		return;
+	case iro_Alloc:
+		hash64_u64(env, get_Alloc_alignment(node));
+		return;
+	case iro_Block:
+		if (get_Block_entity(node) != NULL)
+			env->unstable = true;
+		return;
+	case iro_Load:
+		hash_except(env, node);
+		hash_mode(env, get_Load_mode(node));
+		hash_type(env, get_Load_type(node), 0);
+		hash64_u64(env, get_Load_volatility(node));
+		hash64_u64(env, get_Load_unaligned(node));
+		return;
+	case iro_Store:
+		hash_except(env, node);
+		hash_type(env, get_Store_type(node), 0);
+		hash64_u64(env, get_Store_volatility(node));
+		hash64_u64(env, get_Store_unaligned(node));
+		return;
+	case iro_CopyB:
+		hash_type(env, get_CopyB_type(node), 0);
+		hash64_u64(env, get_CopyB_volatility(node));
+		return;
+	case iro_Div:
+		hash_except(env, node);
+		hash_mode(env, get_Div_resmode(node));
+		hash64_u64(env, get_Div_no_remainder(node));
+		return;
+	case iro_Mod:
+		hash_except(env, node);
+		hash_mode(env, get_Mod_resmode(node));
+		return;
+	case iro_Call:
+		hash_except(env, node);
+		hash_type(env, get_Call_type(node), 0);
+		return;
+	case iro_Builtin:
+		hash_except(env, node);
+		hash64_u64(env, get_Builtin_kind(node));
+		hash_type(env, get_Builtin_type(node), 0);
+		return;
+	case iro_Raise:
+		hash_except(env, node);
+		return;
+	case iro_Switch: {
+		ir_switch_table const *const table = get_Switch_table(node);
+		size_t                 const n     = ir_switch_table_get_n_entries(table);
+		hash64_u64(env, get_Switch_n_outs(node));
+		hash64_u64(env, n);
+		for (size_t i = 0; i < n; ++i) {
+			ir_tarval *const min = ir_switch_table_get_min(table, i);
+			hash64_u64(env, ir_switch_table_get_pn(table, i));
+			if (min == NULL)
+				continue;
+			hash_tarval(env, min);
+			hash_tarval(env, ir_switch_table_get_max(table, i));
+		}
+		return;
+	}
+	case iro_ASM: {
+		hash_except(env, node);
+		hash_ident(env, get_ASM_text(node));
+		ir_asm_constraint const *const constraints = get_ASM_constraints(node);
+		size_t                   const n_cons      = get_ASM_n_constraints(node);
+		hash64_u64(env, n_cons);
+		for (size_t i = 0; i < n_cons; ++i) {
+			hash64_u64(env, (uint64_t)constraints[i].in_pos);
+			hash64_u64(env, (uint64_t)constraints[i].out_pos);
+			hash_ident(env, constraints[i].constraint);
+			hash_mode(env, constraints[i].mode);
+		}
+		ident **const clobbers   = get_ASM_clobbers(node);
+		size_t  const n_clobbers = get_ASM_n_clobbers(node);
+		hash64_u64(env, n_clobbers);
+		for (size_t i = 0; i < n_clobbers; ++i)
+			hash_ident(env, clobbers[i]);
+		return;
+	}
+	default:
+		return;
+	}
+}
+
+static void collect_node(ir_node *node, void *data)
+{
+	hash_env_t *env = (hash_env_t*)data;
+	set_irn_link(node, INT_TO_PTR(ARR_LEN(env->nodes) + 1));
+	ARR_APP1(ir_node*, env->nodes, node);
+}
+
+static uint64_t get_node_number(ir_node const *node)
+{
+	return node != NULL ? PTR_TO_INT(get_irn_link(node)) : 0;
+}
+
+static void hash_node(hash_env_t *env, ir_node *node)
+{
+	hash64_u64(env, get_irn_opcode(node));
+	hash_mode(env, get_irn_mode(node));
+	hash64_u64(env, get_irn_pinned(node));
+	if (!is_Block(node))
+		hash64_u64(env, get_node_number(get_nodes_block(node)));
+	int const arity = get_irn_arity(node);
+	hash64_u64(env, (uint64_t)arity);
+	for (int i = 0; i < arity; ++i)
+		hash64_u64(env, get_node_number(get_irn_n(node, i)));
+	hash_attrs(env, node);
+}
+
+uint64_t get_irg_structural_hash(ir_graph *irg)
+{
+	hash_env_t env;
+	env.hash     = FNV64_OFFSET_BASIS;
+	env.irg      = irg;
+	env.nodes    = NEW_ARR_F(ir_node*, 0);
+	env.unstable = false;
+
+	ir_entity *const entity = get_irg_entity(irg);
+	hash_entity(&env, entity);
+	hash_type(&env, get_entity_type(entity), 0);
+
+	ir_type *const frame = get_irg_frame_type(irg);
+	hash_type(&env, frame, 0);
+	for (size_t i = 0, n = get_compound_n_members(frame); i < n; ++i)
+		hash_entity(&env, get_compound_member(frame, i));
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	irg_walk_anchors(irg, NULL, collect_node, &env);
+	for (size_t i = 0, n = ARR_LEN(env.nodes); i < n; ++i)
+		hash_node(&env, env.nodes[i]);
+	hash64_u64(&env, get_node_number(get_irg_start_block(irg)));
+	hash64_u64(&env, get_node_number(get_irg_end(irg)));
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	DEL_ARR_F(env.nodes);
+
+	if (env.unstable)
+		return 0;
+	/* 0 is reserved to signal failure */
+	return env.hash != 0 ? env.hash : 1;
+}
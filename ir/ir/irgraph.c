@@ -267,11 +267,10 @@ ir_graph *create_irg_copy(ir_graph *irg)
 	return res;
 }
 
-void free_ir_graph(ir_graph *irg)
+static void free_ir_graph_data(ir_graph *irg)
 {
 	assert(irg->kind == k_ir_graph);
 
-	remove_irp_irg(irg);
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 
 	free_irg_outs(irg);
@@ -288,6 +287,19 @@ void free_ir_graph(ir_graph *irg)
 	free_graph(irg);
 }
 
+void free_ir_graph(ir_graph *irg)
+{
+	remove_irp_irg(irg);
+	free_ir_graph_data(irg);
+}
+
+void free_ir_graphs(size_t n, ir_graph *const *irgs)
+{
+	remove_irp_irgs(n, irgs);
+	for (size_t i = 0; i < n; ++i)
+		free_ir_graph_data(irgs[i]);
+}
+
 long get_irg_graph_nr(const ir_graph *irg)
 {
 #ifdef DEBUG_libfirm
@@ -112,6 +112,9 @@ struct ir_graph {
 	ir_type               *frame_type;
 	ir_node               *anchor;        /**< Pointer to the anchor node. */
 	struct obstack         obst;          /**< obstack allocator for nodes. */
+	/** Estimate of the obstack memory still occupied by nodes that in-place
+	 * dead node elimination found dead. */
+	size_t                 dead_node_bytes;
 
 	ir_graph_properties_t  properties;
 	ir_graph_constraints_t constraints;
@@ -125,6 +128,7 @@ struct ir_graph {
 	ir_visited_t     self_visited;  /**< Visited flag of the irg */
 	ir_node        **idx_irn_map;   /**< Map of node indexes to nodes. */
 	size_t           index;         /**< a unique number for each graph */
+	size_t           irp_pos;       /**< position in the graph list of irp */
 	/** A void* field to link any information to the graph. */
 	void            *link;
 	void            *be_data;       /**< backend can put in private data here */
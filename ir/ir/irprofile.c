@@ -11,12 +11,16 @@
  */
 #include "irprofile.h"
 
+#include "array.h"
 #include "debug.h"
 #include "execfreq_t.h"
 #include "hashptr.h"
 #include "ident_t.h"
+#include "irarch.h"
 #include "ircons_t.h"
 #include "irdump_t.h"
+#include "iredges_t.h"
+#include "irgmod.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "irprog_t.h"
@@ -38,12 +42,33 @@ typedef struct block_assoc_t {
 	unsigned int *counters;  /**< block execution counts */
 } block_assoc_t;
 
+/* Instrument value sites. */
+typedef struct value_instrument_t {
+	unsigned   id;     /**< current value site number */
+	ir_entity *slots;  /**< the value slots array */
+	ir_entity *record; /**< runtime function recording a value */
+	ir_entity *icall;  /**< runtime function announcing an indirect call */
+	ir_entity *callee; /**< runtime function recording the called function */
+} value_instrument_t;
+
 /* minimal execution frequency (an execfreq of 0 confuses algos) */
 #define MIN_EXECFREQ 0.00001
 
+/* number of (value, count) pairs recorded per value site */
+#define N_VALUE_SLOTS 4
+
+/* minimal execution count of a value site worth specializing */
+#define SPECIALIZE_MIN_COUNT 64
+
+/* percentage of the executions of a site the hottest value has to cover */
+#define SPECIALIZE_MIN_PERCENT 75
+
 /* keep the execcounts here because they are only read once per compiler run */
 static set *profile = NULL;
 
+/* the profiled values of the value sites */
+static set *value_profile = NULL;
+
 /* Hook for vcg output. */
 static hook_entry_t *hook;
 
@@ -60,6 +85,28 @@ typedef struct execcount_t {
 	uint32_t      count; /**< execution count */
 } execcount_t;
 
+/**
+ * The hottest values seen at an indirect call (identifiers of the called
+ * functions) or a division (divisors), associated by node number like the
+ * block counts.
+ */
+typedef struct value_profile_t {
+	unsigned long node;                  /**< node number */
+	uint64_t      values[N_VALUE_SLOTS];
+	uint64_t      counts[N_VALUE_SLOTS];
+} value_profile_t;
+
+/**
+ * Compare two value_profile_t entries.
+ */
+static int cmp_value_profile(const void *a, const void *b, size_t size)
+{
+	const value_profile_t *va = (const value_profile_t*)a;
+	const value_profile_t *vb = (const value_profile_t*)b;
+	(void)size;
+	return va->node != vb->node;
+}
+
 /**
  * Compare two execcount_t entries.
  */
@@ -116,6 +163,75 @@ static unsigned int get_irp_n_blocks(void)
 	return count;
 }
 
+/**
+ * Returns true if the values of @p node should be profiled: the callee of
+ * indirect calls and the divisor of integer divisions by a variable.
+ */
+static bool is_value_site(const ir_node *node)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Call:
+		return !is_Address(get_Call_ptr(node));
+	case iro_Div:
+		return mode_is_int(get_Div_resmode(node))
+		    && !is_Const(get_Div_right(node));
+	case iro_Mod:
+		return mode_is_int(get_Mod_resmode(node))
+		    && !is_Const(get_Mod_right(node));
+	default:
+		return false;
+	}
+}
+
+/**
+ * Walker, collects the value sites of a graph.
+ */
+static void collect_value_sites(ir_node *node, void *data)
+{
+	ir_node ***const sites = (ir_node***)data;
+	if (is_value_site(node))
+		ARR_APP1(ir_node*, *sites, node);
+}
+
+/**
+ * Walker, count number of value sites.
+ */
+static void value_site_counter(ir_node *node, void *data)
+{
+	unsigned *const count = (unsigned*)data;
+	if (is_value_site(node))
+		++*count;
+}
+
+/**
+ * Returns the number of value sites in the current ir program.
+ */
+static unsigned get_irp_n_value_sites(void)
+{
+	unsigned count = 0;
+	foreach_irp_irg(i, irg) {
+		irg_walk_graph(irg, value_site_counter, NULL, &count);
+	}
+	return count;
+}
+
+/**
+ * Returns the mode used to record values.
+ */
+static ir_mode *get_value_mode(void)
+{
+	return find_unsigned_mode(get_reference_offset_mode(mode_P));
+}
+
+/**
+ * Returns the identifier recorded for calls of @p entity.  It only depends
+ * on the name so it is stable across compilation units.
+ */
+static unsigned get_function_id(const ir_entity *entity)
+{
+	return hash_str(get_entity_ld_name(entity)) & 0x7FFFFFFF;
+}
+
 /* vcg helper */
 static void dump_profile_node_info(void *ctx, FILE *f, const ir_node *irn)
 {
@@ -164,6 +280,42 @@ static ir_entity *get_init_firmprof_ref(void)
 	return new_entity(get_glob_type(), init_name, init_type);
 }
 
+/**
+ * Returns an entity representing the __init_firmprof_values function from
+ * libfirmprof. This is the equivalent of:
+ * extern void __init_firmprof_values(char *filename, uintptr_t *slots, uint n_sites)
+ */
+static ir_entity *get_init_firmprof_values_ref(void)
+{
+	ident   *const init_name = new_id_from_str("__init_firmprof_values");
+	ir_type *const init_type = new_type_method(3, 0, false, cc_cdecl_set, mtp_no_property);
+	ir_type *const uint      = get_type_for_mode(mode_Iu);
+	ir_type *const slotptr   = new_type_pointer(get_type_for_mode(get_value_mode()));
+	ir_type *const string    = new_type_pointer(get_type_for_mode(mode_Bs));
+
+	set_method_param_type(init_type, 0, string);
+	set_method_param_type(init_type, 1, slotptr);
+	set_method_param_type(init_type, 2, uint);
+
+	return new_entity(get_glob_type(), init_name, init_type);
+}
+
+/**
+ * Creates a call of @p init_ent with the arguments (filename, array, size).
+ */
+static ir_node *new_init_call(ir_node *const bb, ir_node *const mem, ir_entity *const init_ent, ir_entity *const ent_filename, ir_entity *const array, unsigned const size)
+{
+	ir_graph *const irg       = get_irn_irg(bb);
+	ir_node  *const callee    = new_r_Address(irg, init_ent);
+	ir_node  *const filename  = new_r_Address(irg, ent_filename);
+	ir_node  *const counters  = new_r_Address(irg, array);
+	ir_node  *const n         = new_r_Const_long(irg, mode_Iu, size);
+	ir_node  *const ins[]     = { filename, counters, n };
+	ir_type  *const call_type = get_entity_type(init_ent);
+	ir_node  *const call      = new_r_Call(bb, mem, callee, ARRAY_SIZE(ins), ins, call_type);
+	return new_r_Proj(call, mode_M, pn_Call_M);
+}
+
 /**
  * Generates a new irg which calls the initializer
  *
@@ -171,28 +323,27 @@ static ir_entity *get_init_firmprof_ref(void)
  *    static void __firmprof_initializer(void) __attribute__ ((constructor))
  *    {
  *        __init_firmprof(ent_filename, bblock_counts, n_blocks);
+ *        if (n_sites > 0)
+ *            __init_firmprof_values(ent_filename, value_slots, n_sites);
  *    }
  */
-static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_counts, int n_blocks)
+static ir_graph *gen_initializer_irg(ir_entity *ent_filename, ir_entity *bblock_counts, int n_blocks, ir_entity *value_slots, unsigned n_sites)
 {
 	ident     *const name  = new_id_from_str("__firmprof_initializer");
 	ir_type   *const owner = get_glob_type();
 	ir_type   *const type  = new_type_method(0, 0, false, cc_cdecl_set, mtp_no_property);
 	ir_entity *const ent   = new_global_entity(owner, name, type, ir_visibility_local, IR_LINKAGE_DEFAULT);
 
-	ir_graph  *const irg       = new_ir_graph(ent, 0);
-	ir_node   *const bb        = get_r_cur_block(irg);
-	ir_node   *const init_mem  = get_irg_initial_mem(irg);
-	ir_entity *const init_ent  = get_init_firmprof_ref();
-	ir_node   *const callee    = new_r_Address(irg, init_ent);
-	ir_node   *const filename  = new_r_Address(irg, ent_filename);
-	ir_node   *const counters  = new_r_Address(irg, bblock_counts);
-	ir_node   *const size      = new_r_Const_long(irg, mode_Iu, n_blocks);
-	ir_node   *const ins[]     = { filename, counters, size };
-	ir_type   *const call_type = get_entity_type(init_ent);
-	ir_node   *const call      = new_r_Call(bb, init_mem, callee, ARRAY_SIZE(ins), ins, call_type);
-	ir_node   *const call_mem  = new_r_Proj(call, mode_M, pn_Call_M);
-	ir_node   *const ret       = new_r_Return(bb, call_mem, 0, NULL);
+	ir_graph  *const irg      = new_ir_graph(ent, 0);
+	ir_node   *const bb       = get_r_cur_block(irg);
+	ir_node   *const init_mem = get_irg_initial_mem(irg);
+	ir_entity *const init_ent = get_init_firmprof_ref();
+	ir_node   *mem            = new_init_call(bb, init_mem, init_ent, ent_filename, bblock_counts, n_blocks);
+	if (n_sites > 0) {
+		ir_entity *const values_ent = get_init_firmprof_values_ref();
+		mem = new_init_call(bb, mem, values_ent, ent_filename, value_slots, n_sites);
+	}
+	ir_node   *const ret      = new_r_Return(bb, mem, 0, NULL);
 
 	add_immBlock_pred(get_irg_end_block(irg), ret);
 	irg_finalize_cons(irg);
@@ -350,6 +501,131 @@ static void instrument_irg(ir_graph *irg, ir_entity *counters, block_id_walker_d
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 }
 
+/**
+ * Returns an entity representing a function of libfirmprof taking two
+ * parameters.
+ */
+static ir_entity *get_firmprof_function(char const *const name, ir_type *const param0, ir_type *const param1)
+{
+	ident   *const id   = new_id_from_str(name);
+	ir_type *const type = new_type_method(2, 0, false, cc_cdecl_set, mtp_no_property);
+	set_method_param_type(type, 0, param0);
+	set_method_param_type(type, 1, param1);
+	return new_entity(get_glob_type(), id, type);
+}
+
+/**
+ * Calls @p function with the given arguments after the memory @p mem and
+ * returns the resulting memory.
+ */
+static ir_node *new_firmprof_call(ir_node *const block, ir_node *const mem, ir_entity *const function, ir_node *const arg0, ir_node *const arg1)
+{
+	ir_graph *const irg    = get_irn_irg(block);
+	ir_node  *const callee = new_r_Address(irg, function);
+	ir_node  *const ins[]  = { arg0, arg1 };
+	ir_type  *const type   = get_entity_type(function);
+	ir_node  *const call   = new_r_Call(block, mem, callee, ARRAY_SIZE(ins), ins, type);
+	return new_r_Proj(call, mode_M, pn_Call_M);
+}
+
+/**
+ * Instrument a value site: indirect calls announce their callee to the
+ * runtime (which records the identifier of the function actually entered),
+ * divisions record their divisor.
+ */
+static void instrument_value_site(ir_node *const node, value_instrument_t *const env)
+{
+	ir_graph *const irg      = get_irn_irg(node);
+	ir_node  *const block    = get_nodes_block(node);
+	ir_mode  *const mode_val = get_value_mode();
+	ir_node  *const address  = new_r_Address(irg, env->slots);
+	ir_mode  *const mode_off = get_reference_offset_mode(get_irn_mode(address));
+	long      const offset   = env->id * 2 * N_VALUE_SLOTS * get_mode_size_bytes(mode_val);
+	ir_node  *const cnst     = new_r_Const_long(irg, mode_off, offset);
+	ir_node  *const slots    = new_r_Add(block, address, cnst);
+	++env->id;
+
+	switch (get_irn_opcode(node)) {
+	case iro_Call: {
+		ir_node *const ptr = get_Call_ptr(node);
+		ir_node *const mem = get_Call_mem(node);
+		set_Call_mem(node, new_firmprof_call(block, mem, env->icall, slots, ptr));
+		return;
+	}
+	case iro_Div: {
+		ir_node *const value = new_r_Conv(block, get_Div_right(node), mode_val);
+		ir_node *const mem   = get_Div_mem(node);
+		set_Div_mem(node, new_firmprof_call(block, mem, env->record, slots, value));
+		return;
+	}
+	case iro_Mod: {
+		ir_node *const value = new_r_Conv(block, get_Mod_right(node), mode_val);
+		ir_node *const mem   = get_Mod_mem(node);
+		set_Mod_mem(node, new_firmprof_call(block, mem, env->record, slots, value));
+		return;
+	}
+	default:
+		panic("unexpected value site %+F", node);
+	}
+}
+
+typedef struct reroute_mem_t {
+	ir_node *old_mem;
+	ir_node *new_mem;
+	ir_node *except;
+} reroute_mem_t;
+
+/**
+ * Walker, replaces all uses of a memory value except in the Anchor and one
+ * given node.
+ */
+static void reroute_mem(ir_node *node, void *data)
+{
+	reroute_mem_t const *const env = (reroute_mem_t const*)data;
+	if (node == env->except || is_Anchor(node))
+		return;
+	foreach_irn_in(node, i, pred) {
+		if (pred == env->old_mem)
+			set_irn_n(node, i, env->new_mem);
+	}
+}
+
+/**
+ * Instrument the entry of a graph to record its identifier if it was called
+ * from an instrumented indirect call.
+ */
+static void instrument_entry(ir_graph *const irg, value_instrument_t const *const env)
+{
+	ir_entity *const entity  = get_irg_entity(irg);
+	ir_node   *const block   = get_irg_start_block(irg);
+	ir_node   *const initial = get_irg_initial_mem(irg);
+	ir_node   *const self    = new_r_Address(irg, entity);
+	ir_node   *const id      = new_r_Const_long(irg, get_value_mode(), get_function_id(entity));
+	ir_node   *const mem     = new_firmprof_call(block, initial, env->callee, self, id);
+
+	reroute_mem_t reroute = {
+		.old_mem = initial,
+		.new_mem = mem,
+		.except  = get_Proj_pred(mem),
+	};
+	irg_walk_graph(irg, reroute_mem, NULL, &reroute);
+}
+
+/**
+ * Instrument the value sites of a graph.
+ */
+static void instrument_irg_values(ir_graph *const irg, value_instrument_t *const env)
+{
+	ir_node **sites = NEW_ARR_F(ir_node*, 0);
+	irg_walk_graph(irg, collect_value_sites, NULL, &sites);
+	for (size_t i = 0, n = ARR_LEN(sites); i < n; ++i) {
+		instrument_value_site(sites[i], env);
+	}
+	DEL_ARR_F(sites);
+
+	instrument_entry(irg, env);
+}
+
 /**
  * Creates a new entity representing the equivalent of
  * static <element_mode> <name>[<length>];
@@ -360,7 +636,10 @@ static ir_entity *new_array_entity(ident *const name, ir_mode *const element_mod
 	ir_type *const array_type   = new_type_array(element_type, length);
 	ident   *const id           = new_id_from_str(name);
 	ir_type *const owner        = get_glob_type();
-	return new_global_entity(owner, id, array_type, ir_visibility_private, linkage);
+	ir_entity *const result     = new_global_entity(owner, id, array_type, ir_visibility_private, linkage);
+	/* like any static array it is zero initialized */
+	set_entity_initializer(result, get_initializer_null());
+	return result;
 }
 
 /**
@@ -406,17 +685,86 @@ ir_graph *ir_profile_instrument(const char *filename)
 
 	ir_entity *const ent_filename = new_static_string_entity("__FIRMPROF__FILE_NAME", filename);
 
+	/* the value sites record pairs of (value, count) */
+	unsigned   const n_sites      = get_irp_n_value_sites();
+	ir_entity *const value_slots  = new_array_entity("__FIRMPROF__VALUE_SLOTS", get_value_mode(), MAX(n_sites, 1) * 2 * N_VALUE_SLOTS, IR_LINKAGE_DEFAULT);
+	ir_type   *const slot_ptr     = new_type_pointer(get_type_for_mode(get_value_mode()));
+	ir_type   *const value_type   = get_type_for_mode(get_value_mode());
+	ir_type   *const void_ptr     = new_type_pointer(get_type_for_mode(mode_Bu));
+	value_instrument_t vi = {
+		.id     = 0,
+		.slots  = value_slots,
+		.record = get_firmprof_function("__firmprof_value", slot_ptr, value_type),
+		.icall  = get_firmprof_function("__firmprof_icall", slot_ptr, void_ptr),
+		.callee = get_firmprof_function("__firmprof_callee", void_ptr, value_type),
+	};
+
 	/* initialize block id array and instrument blocks */
 	block_id_walker_data_t wd = { .id = 0 };
 	foreach_irp_irg_r(i, irg) {
+		/* value sites are numbered before any instrumentation code exists,
+		 * exactly as ir_profile_read() sees the graph */
+		instrument_irg_values(irg, &vi);
 		instrument_irg(irg, bblock_counts, &wd);
 	}
+	assert(vi.id == n_sites);
+
+	return gen_initializer_irg(ent_filename, bblock_counts, n_blocks, value_slots, n_sites);
+}
+
+/**
+ * Reads a little endian integer of @p n_bytes bytes.
+ */
+static bool read_little_endian(FILE *const f, unsigned const n_bytes, uint64_t *const value)
+{
+	unsigned char bytes[8];
+	assert(n_bytes <= sizeof(bytes));
+	if (fread(bytes, 1, n_bytes, f) < n_bytes)
+		return false;
+
+	uint64_t result = 0;
+	for (unsigned i = n_bytes; i-- > 0;) {
+		result = result << 8 | bytes[i];
+	}
+	*value = result;
+	return true;
+}
+
+/**
+ * Reads the optional value profile following the block counters: the
+ * header "firmvals", the number of sites and N_VALUE_SLOTS pairs of 64bit
+ * (value, count) per site.
+ */
+static uint64_t *parse_value_profile(FILE *const f, unsigned const num_sites)
+{
+	char buf[8];
+	if (fread(buf, 8, 1, f) == 0 || strncmp(buf, "firmvals", 8) != 0) {
+		DBG((dbg, LEVEL_2, "No value profile\n"));
+		return NULL;
+	}
+
+	uint64_t file_sites;
+	if (!read_little_endian(f, 4, &file_sites) || file_sites != num_sites) {
+		DBG((dbg, LEVEL_2, "Value profile does not match the program\n"));
+		return NULL;
+	}
 
-	return gen_initializer_irg(ent_filename, bblock_counts, n_blocks);
+	size_t    const n_values = (size_t)num_sites * 2 * N_VALUE_SLOTS;
+	uint64_t *const result   = XMALLOCN(uint64_t, MAX(n_values, 1));
+	for (size_t i = 0; i < n_values; ++i) {
+		if (!read_little_endian(f, 8, &result[i])) {
+			DBG((dbg, LEVEL_4, "Failed to read value profile\n"));
+			free(result);
+			return NULL;
+		}
+	}
+	return result;
 }
 
-static unsigned int *parse_profile(const char *filename, unsigned int num_blocks)
+static unsigned int *parse_profile(const char *filename, unsigned int num_blocks, unsigned num_sites, uint64_t **values)
 {
+	*values = NULL;
+
 	FILE *const f = fopen(filename, "rb");
 	if (!f) {
 		DBG((dbg, LEVEL_2, "Failed to open profile file (%s)\n", filename));
@@ -450,6 +798,8 @@ static unsigned int *parse_profile(const char *filename, unsigned int num_blocks
 			sizeof(unsigned int) * num_blocks));
 		free(result);
 		result = NULL;
+	} else {
+		*values = parse_value_profile(f, num_sites);
 	}
 
 end:
@@ -478,6 +828,35 @@ static void irp_associate_blocks(block_assoc_t *env)
 	}
 }
 
+/* Associate value slots with value sites. */
+typedef struct value_assoc_t {
+	unsigned  i;      /**< current value site number */
+	uint64_t *values; /**< (value, count) pairs of all sites */
+} value_assoc_t;
+
+static void value_associate_walker(ir_node *node, void *env)
+{
+	if (!is_value_site(node))
+		return;
+
+	value_assoc_t  *const v     = (value_assoc_t*)env;
+	uint64_t const *const slots = &v->values[v->i++ * 2 * N_VALUE_SLOTS];
+	value_profile_t query;
+	query.node = get_irn_node_nr(node);
+	for (unsigned i = 0; i < N_VALUE_SLOTS; ++i) {
+		query.values[i] = slots[2 * i];
+		query.counts[i] = slots[2 * i + 1];
+	}
+	(void)set_insert(value_profile_t, value_profile, &query, sizeof(query), query.node);
+}
+
+static void irp_associate_values(value_assoc_t *env)
+{
+	foreach_irp_irg_r(i, irg) {
+		irg_walk_graph(irg, value_associate_walker, NULL, env);
+	}
+}
+
 void ir_profile_free(void)
 {
 	if (profile) {
@@ -485,6 +864,11 @@ void ir_profile_free(void)
 		profile = NULL;
 	}
 
+	if (value_profile) {
+		del_set(value_profile);
+		value_profile = NULL;
+	}
+
 	if (hook != NULL) {
 		dump_remove_node_info_callback(hook);
 		hook = NULL;
@@ -496,9 +880,11 @@ bool ir_profile_read(const char *filename)
 	FIRM_DBG_REGISTER(dbg, "firm.ir.profile");
 
 	unsigned n_blocks = get_irp_n_blocks();
+	unsigned n_sites  = get_irp_n_value_sites();
+	uint64_t *values;
 	block_assoc_t env = {
 		.i        = 0,
-		.counters = parse_profile(filename, n_blocks)
+		.counters = parse_profile(filename, n_blocks, n_sites, &values)
 	};
 	if (!env.counters)
 		return false;
@@ -509,11 +895,245 @@ bool ir_profile_read(const char *filename)
 	irp_associate_blocks(&env);
 	free(env.counters);
 
+	if (values != NULL) {
+		value_profile = new_set(cmp_value_profile, 16);
+		value_assoc_t venv = { .i = 0, .values = values };
+		irp_associate_values(&venv);
+		free(values);
+	}
+
 	/* register the vcg hook */
 	hook = dump_add_node_info_callback(dump_profile_node_info, NULL);
 	return 1;
 }
 
+static void set_block_execcount(const ir_node *block, uint32_t count)
+{
+	execcount_t  const query = { .block = get_irn_node_nr(block), .count = count };
+	execcount_t *const ec    = set_insert(execcount_t, profile, &query, sizeof(query), query.block);
+	ec->count = count;
+}
+
+/**
+ * Returns the value that covers most executions of a value site if it is
+ * hot enough to be worth specializing.
+ */
+static bool get_dominant_value(const ir_node *node, uint64_t *value, uint32_t *count)
+{
+	value_profile_t query;
+	query.node = get_irn_node_nr(node);
+	value_profile_t const *const vp = set_find(value_profile_t, value_profile, &query, sizeof(query), query.node);
+	if (vp == NULL)
+		return false;
+
+	unsigned best = 0;
+	for (unsigned i = 1; i < N_VALUE_SLOTS; ++i) {
+		if (vp->counts[i] > vp->counts[best])
+			best = i;
+	}
+
+	uint64_t const total = ir_profile_get_block_execcount(get_nodes_block(node));
+	uint64_t const hot   = MIN(vp->counts[best], total);
+	if (hot < SPECIALIZE_MIN_COUNT || hot * 100 < total * SPECIALIZE_MIN_PERCENT)
+		return false;
+
+	*value = vp->values[best];
+	*count = hot;
+	return true;
+}
+
+/**
+ * Returns the function of the program with identifier @p id or NULL if there
+ * is none or it is ambiguous.
+ */
+static ir_entity *find_function(uint64_t const id)
+{
+	ir_type   *const glob   = get_glob_type();
+	ir_entity       *result = NULL;
+	for (size_t i = 0, n = get_compound_n_members(glob); i < n; ++i) {
+		ir_entity *const member = get_compound_member(glob, i);
+		if (!is_method_entity(member) || get_function_id(member) != id)
+			continue;
+		if (result != NULL)
+			return NULL;
+		result = member;
+	}
+	return result;
+}
+
+static void move_with_projs(ir_node *const node, ir_node *const block)
+{
+	set_nodes_block(node, block);
+	if (get_irn_mode(node) != mode_T)
+		return;
+	foreach_out_edge(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (is_Proj(proj))
+			move_with_projs(proj, block);
+	}
+}
+
+/**
+ * Merges the value @p hot of the specialized version and @p cold of the
+ * original node in @p block and replaces all uses of @p cold.
+ */
+static void merge_versions(ir_node *const block, ir_node *const hot, ir_node *const cold)
+{
+	ir_node *const in[] = { hot, cold };
+	ir_node *const phi  = new_r_Phi(block, ARRAY_SIZE(in), in, get_irn_mode(cold));
+	edges_reroute_except(cold, phi, phi);
+}
+
+/**
+ * Versions @p node on its input @p n being equal to @p value:
+ *
+ *   if (in[n] == value) copy of node using value else node
+ *
+ * and returns the copy.
+ */
+static ir_node *version_node(ir_node *const node, int const n, ir_node *const value, uint32_t const hot_count)
+{
+	ir_graph *const irg   = get_irn_irg(node);
+	uint32_t  const count = ir_profile_get_block_execcount(get_nodes_block(node));
+
+	ir_node *const lower      = part_block_edges(node);
+	ir_node *const upper      = get_nodes_block(node);
+	ir_node *const cmp        = new_r_Cmp(upper, get_irn_n(node, n), value, ir_relation_equal);
+	ir_node *const cond       = new_r_Cond(upper, cmp);
+	ir_node *const proj_true  = new_r_Proj(cond, mode_X, pn_Cond_true);
+	ir_node *const proj_false = new_r_Proj(cond, mode_X, pn_Cond_false);
+	ir_node *const hot_block  = new_r_Block(irg, 1, &proj_true);
+	ir_node *const cold_block = new_r_Block(irg, 1, &proj_false);
+
+	ir_node *const copy = exact_copy(node);
+	set_nodes_block(copy, hot_block);
+	set_irn_n(copy, n, value);
+	move_with_projs(node, cold_block);
+
+	ir_node *const in[] = { new_r_Jmp(hot_block), new_r_Jmp(cold_block) };
+	set_irn_in(lower, ARRAY_SIZE(in), in);
+
+	foreach_out_edge_safe(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (!is_Proj(proj))
+			continue;
+		ir_mode *const mode      = get_irn_mode(proj);
+		ir_node *const copy_proj = new_r_Proj(copy, mode, get_Proj_num(proj));
+		if (mode == mode_T) {
+			foreach_out_edge_safe(proj, res_edge) {
+				ir_node *const res      = get_edge_src_irn(res_edge);
+				ir_node *const copy_res = new_r_Proj(copy_proj, get_irn_mode(res), get_Proj_num(res));
+				merge_versions(lower, copy_res, res);
+			}
+		} else {
+			merge_versions(lower, copy_proj, proj);
+		}
+	}
+
+	set_block_execcount(upper, count);
+	set_block_execcount(hot_block, hot_count);
+	set_block_execcount(cold_block, count - hot_count);
+	return copy;
+}
+
+/**
+ * Replaces a division by a constant with the architecture dependent
+ * sequence, if there is one.
+ */
+static void lower_divmod_by_const(ir_node *const node, ir_node *const value, ir_node *const mem, unsigned const pn_M, unsigned const pn_res)
+{
+	if (value == node)
+		return;
+	foreach_out_edge_safe(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		unsigned const pn   = get_Proj_num(proj);
+		if (pn == pn_M) {
+			exchange(proj, mem);
+		} else if (pn == pn_res) {
+			exchange(proj, value);
+		} else {
+			panic("unexpected %+F of non-throwing %+F", proj, node);
+		}
+	}
+	kill_node(node);
+}
+
+/**
+ * Specializes a value site for its dominating value: indirect calls are
+ * promoted to a guarded direct call, divisions get a version with a constant
+ * divisor.
+ */
+static bool specialize_value_site(ir_node *const node)
+{
+	uint64_t value;
+	uint32_t count;
+	if (ir_throws_exception(node) || !get_dominant_value(node, &value, &count))
+		return false;
+
+	ir_graph *const irg = get_irn_irg(node);
+	switch (get_irn_opcode(node)) {
+	case iro_Call: {
+		ir_entity *const callee = find_function(value);
+		if (callee == NULL)
+			return false;
+		DB((dbg, LEVEL_2, "promote %+F to call %+F (%u times)\n", node, callee, count));
+		ir_node *const address = new_r_Address(irg, callee);
+		version_node(node, n_Call_ptr, address, count);
+		return true;
+	}
+	case iro_Div: {
+		ir_mode *const mode = get_irn_mode(get_Div_right(node));
+		ir_node *const cnst = new_r_Const_long(irg, mode, (long)value);
+		if (is_Const_null(cnst))
+			return false;
+		DB((dbg, LEVEL_2, "specialize %+F for divisor %+F (%u times)\n", node, cnst, count));
+		ir_node *const copy = version_node(node, n_Div_right, cnst, count);
+		lower_divmod_by_const(copy, arch_dep_replace_div_by_const(copy), get_Div_mem(copy), pn_Div_M, pn_Div_res);
+		return true;
+	}
+	case iro_Mod: {
+		ir_mode *const mode = get_irn_mode(get_Mod_right(node));
+		ir_node *const cnst = new_r_Const_long(irg, mode, (long)value);
+		if (is_Const_null(cnst))
+			return false;
+		DB((dbg, LEVEL_2, "specialize %+F for divisor %+F (%u times)\n", node, cnst, count));
+		ir_node *const copy = version_node(node, n_Mod_right, cnst, count);
+		lower_divmod_by_const(copy, arch_dep_replace_mod_by_const(copy), get_Mod_mem(copy), pn_Mod_M, pn_Mod_res);
+		return true;
+	}
+	default:
+		panic("unexpected value site %+F", node);
+	}
+}
+
+void ir_profile_specialize_values(void)
+{
+	if (value_profile == NULL)
+		return;
+
+	foreach_irp_irg(i, irg) {
+		ir_node **sites = NEW_ARR_F(ir_node*, 0);
+		irg_walk_graph(irg, collect_value_sites, NULL, &sites);
+
+		bool changed = false;
+		if (ARR_LEN(sites) > 0) {
+			assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+			for (size_t s = 0, n = ARR_LEN(sites); s < n; ++s) {
+				changed |= specialize_value_site(sites[s]);
+			}
+		}
+		DEL_ARR_F(sites);
+
+		confirm_irg_properties(irg, changed
+			? IR_GRAPH_PROPERTY_NO_BADS
+			| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+			| IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
+			| IR_GRAPH_PROPERTY_MANY_RETURNS
+			| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+			: IR_GRAPH_PROPERTIES_ALL);
+	}
+}
+
 typedef struct initialize_execfreq_env_t {
 	double freq_factor;
 } initialize_execfreq_env_t;
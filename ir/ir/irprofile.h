@@ -20,8 +20,9 @@
 /**
  * Instruments all irgs in the program with profile code.
  * The final code will have a counter for each basic block which is
- * incremented in that block. After the program has run the info is written
- * to @p filename.
+ * incremented in that block. Indirect calls record their most frequent
+ * callees and divisions their most frequent divisors. After the program has
+ * run the info is written to @p filename.
  */
 ir_graph *ir_profile_instrument(const char *filename);
 
@@ -32,6 +33,14 @@ ir_graph *ir_profile_instrument(const char *filename);
  */
 bool ir_profile_read(const char *filename);
 
+/**
+ * Specializes the value sites (indirect calls and divisions) whose profiled
+ * values are dominated by a single value: calls get a guarded direct call to
+ * the hot callee, divisions a version dividing by the hot constant.
+ * Must be called before ir_create_execfreqs_from_profile() as it adds blocks.
+ */
+void ir_profile_specialize_values(void);
+
 /**
  * Frees the profile info
  */
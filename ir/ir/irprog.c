@@ -18,6 +18,7 @@
 #include "irmemory.h"
 #include "irop_t.h"
 #include "obst.h"
+#include "util.h"
 
 /** The initial name of the irp program. */
 #define INITAL_PROG_NAME "no_name_set"
@@ -166,24 +167,54 @@ void add_irp_irg(ir_graph *irg)
 {
 	assert(irg != NULL);
 	assert(irp && irp->graphs);
+	irg->irp_pos = ARR_LEN(irp->graphs);
 	ARR_APP1(ir_graph *, irp->graphs, irg);
 }
 
-void remove_irp_irg(ir_graph *irg)
+/** Returns the position of irg in the graph list, or (size_t)-1. */
+static size_t get_irp_irg_pos(ir_graph const *irg)
+{
+	size_t const pos = irg->irp_pos;
+	if (pos < ARR_LEN(irp->graphs) && irp->graphs[pos] == irg)
+		return pos;
+	return (size_t)-1;
+}
+
+/** Closes the gaps left by removed graphs, keeping the order. */
+static void compact_irp_irgs(size_t from)
 {
-	size_t i, l;
+	size_t n_irgs = from;
+	for (size_t i = from, n = ARR_LEN(irp->graphs); i < n; ++i) {
+		ir_graph *irg = irp->graphs[i];
+		if (irg == NULL)
+			continue;
+		irg->irp_pos = n_irgs;
+		irp->graphs[n_irgs++] = irg;
+	}
+	ARR_SHRINKLEN(irp->graphs, n_irgs);
+}
 
+void remove_irp_irg(ir_graph *irg)
+{
 	assert(irg);
-	l = ARR_LEN(irp->graphs);
-	for (i = 0; i < l; ++i) {
-		if (irp->graphs[i] == irg) {
-			for (; i < l - 1; ++i) {
-				irp->graphs[i] = irp->graphs[i+1];
-			}
-			ARR_SETLEN(ir_graph*, irp->graphs, l - 1);
-			break;
-		}
+	size_t const pos = get_irp_irg_pos(irg);
+	if (pos == (size_t)-1)
+		return;
+	irp->graphs[pos] = NULL;
+	compact_irp_irgs(pos);
+}
+
+void remove_irp_irgs(size_t n, ir_graph *const *irgs)
+{
+	size_t first = ARR_LEN(irp->graphs);
+	for (size_t i = 0; i < n; ++i) {
+		size_t const pos = get_irp_irg_pos(irgs[i]);
+		if (pos == (size_t)-1)
+			continue;
+		irp->graphs[pos] = NULL;
+		first = MIN(first, pos);
 	}
+	compact_irp_irgs(first);
 }
 
 size_t (get_irp_n_irgs)(void)
@@ -206,30 +237,61 @@ void set_irp_irg(size_t pos, ir_graph *irg)
 	assert(irp && irg);
 	assert(pos < ARR_LEN(irp->graphs));
 	irp->graphs[pos] = irg;
+	irg->irp_pos     = pos;
 }
 
 void add_irp_type(ir_type *typ)
 {
 	assert(typ != NULL);
 	assert(irp);
+	typ->irp_pos = ARR_LEN(irp->types);
 	ARR_APP1(ir_type *, irp->types, typ);
 }
 
+/** Returns the position of typ in the type list, or (size_t)-1. */
+static size_t get_irp_type_pos(ir_type const *typ)
+{
+	size_t const pos = typ->irp_pos;
+	if (pos < ARR_LEN(irp->types) && irp->types[pos] == typ)
+		return pos;
+	return (size_t)-1;
+}
+
+/** Closes the gaps left by removed types, keeping the order. */
+static void compact_irp_types(size_t from)
+{
+	size_t n_types = from;
+	for (size_t i = from, n = ARR_LEN(irp->types); i < n; ++i) {
+		ir_type *typ = irp->types[i];
+		if (typ == NULL)
+			continue;
+		typ->irp_pos = n_types;
+		irp->types[n_types++] = typ;
+	}
+	ARR_SHRINKLEN(irp->types, n_types);
+}
+
 void remove_irp_type(ir_type *typ)
 {
-	size_t i, l;
 	assert(typ);
+	size_t const pos = get_irp_type_pos(typ);
+	if (pos == (size_t)-1)
+		return;
+	irp->types[pos] = NULL;
+	compact_irp_types(pos);
+}
 
-	l = ARR_LEN(irp->types);
-	for (i = 0; i < l; ++i) {
-		if (irp->types[i] == typ) {
-			for (; i < l - 1; ++i) {
-				irp->types[i] = irp->types[i+1];
-			}
-			ARR_SETLEN(ir_type *, irp->types, l - 1);
-			break;
-		}
+void remove_irp_types(size_t n, ir_type *const *types)
+{
+	size_t first = ARR_LEN(irp->types);
+	for (size_t i = 0; i < n; ++i) {
+		size_t const pos = get_irp_type_pos(types[i]);
+		if (pos == (size_t)-1)
+			continue;
+		irp->types[pos] = NULL;
+		first = MIN(first, pos);
 	}
+	compact_irp_types(first);
 }
 
 size_t (get_irp_n_types) (void)
@@ -247,6 +309,7 @@ void set_irp_type(size_t pos, ir_type *typ)
 	assert(irp && typ);
 	assert(pos < ARR_LEN((irp)->types));
 	irp->types[pos] = typ;
+	typ->irp_pos    = pos;
 }
 
 void set_irp_prog_name(ident *name)
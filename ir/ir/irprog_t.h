@@ -190,6 +190,10 @@ void add_irp_type(ir_type *typ);
     shrinks the list by one. */
 void remove_irp_type(ir_type *typ);
 
+/** Removes several types from the list of types in one pass, keeping the
+    order of the remaining ones. */
+void remove_irp_types(size_t n, ir_type *const *types);
+
 /** Adds irg to the list of ir graphs in the current irp. */
 FIRM_API void add_irp_irg(ir_graph *irg);
 
@@ -197,6 +201,10 @@ FIRM_API void add_irp_irg(ir_graph *irg);
     shrinks the list by one. */
 FIRM_API void remove_irp_irg(ir_graph *irg);
 
+/** Removes several irgs from the list of irgs in one pass, keeping the
+    order of the remaining ones. */
+FIRM_API void remove_irp_irgs(size_t n, ir_graph *const *irgs);
+
 #define foreach_irp_irg(idx, irg) \
 	for (bool irg##__b = true; irg##__b; irg##__b = false) \
 		for (size_t idx = 0, irg##__n = get_irp_n_irgs(); irg##__b && idx != irg##__n; ++idx) \
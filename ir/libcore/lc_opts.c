@@ -469,6 +469,29 @@ static void lc_opt_print_help_rec(lc_opt_entry_t *ent, char separator, lc_opt_en
 
 }
 
+static void lc_opt_walk_values_rec(lc_opt_entry_t *ent, lc_opt_entry_t *stop_ent, lc_opt_value_walker_t *walker, void *env)
+{
+	lc_grp_special_t *s = lc_get_grp_special(ent);
+	char path[512];
+	char value[256];
+
+	list_for_each_entry(lc_opt_entry_t, e, &s->opts, list) {
+		value[0] = '\0';
+		lc_opt_print_grp_path(path, sizeof(path), e, '.', stop_ent);
+		lc_opt_value_to_string(value, sizeof(value), e);
+		walker(e, path, value, env);
+	}
+
+	list_for_each_entry(lc_opt_entry_t, e, &s->grps, list) {
+		lc_opt_walk_values_rec(e, stop_ent, walker, env);
+	}
+}
+
+void lc_opt_walk_values(lc_opt_entry_t *grp, lc_opt_value_walker_t *walker, void *env)
+{
+	lc_opt_walk_values_rec(grp, grp, walker, env);
+}
+
 void lc_opt_print_help_for_entry(lc_opt_entry_t *ent, char separator, FILE *f)
 {
 	fprintf(f, HELP_TEMPL_VALS "\n", "option", "type", "description", "default", "possible options");
@@ -186,6 +186,22 @@ const char *lc_opt_get_type_name(const lc_opt_entry_t *ent);
  */
 void lc_opt_print_help_for_entry(lc_opt_entry_t *ent, char separator, FILE *f);
 
+/**
+ * Callback for lc_opt_walk_values().
+ * @param opt    The option.
+ * @param path   The path of the option relative to the walked group,
+ *               separated by '.'.
+ * @param value  The current value of the option as string.
+ * @param env    The environment passed to lc_opt_walk_values().
+ */
+typedef void (lc_opt_value_walker_t)(const lc_opt_entry_t *opt, const char *path, const char *value, void *env);
+
+/**
+ * Call @p walker for every option below @p grp (including subgroups), in
+ * registration order.
+ */
+void lc_opt_walk_values(lc_opt_entry_t *grp, lc_opt_value_walker_t *walker, void *env);
+
 bool lc_opt_add_table(lc_opt_entry_t *grp, const lc_opt_table_entry_t *table);
 
 /**
@@ -12,6 +12,7 @@
 #include "lower_dw.h"
 
 #include "array.h"
+#include "bitfiddle.h"
 #include "constbits.h"
 #include "dbginfo_t.h"
 #include "debug.h"
@@ -676,55 +677,147 @@ static void lower_Mod(ir_node *const node)
 	}
 }
 
+static ir_node *create_conv(ir_node *block, ir_node *node, ir_mode *dest_mode)
+{
+	if (get_irn_mode(node) == dest_mode)
+		return node;
+	return new_r_Conv(block, node, dest_mode);
+}
+
+bool is_high_word_zero(ir_node *const node)
+{
+	if (is_irn_null(get_lowered_high(node)))
+		return true;
+	bitinfo const *const b = get_bitinfo(node);
+	if (b == NULL)
+		return false;
+	unsigned const word_bits = get_mode_size_bits(env.p.word_unsigned);
+	return tarval_is_null(tarval_shr_unsigned(b->z, word_bits));
+}
+
 /**
- * Translate a binop.
- *
- * Create an intrinsic Call.
+ * Returns whether the high words of the double-word values @p left and
+ * @p right are known to be equal. Then the values compare like their
+ * (unsigned) low words.
  */
-static void lower_binop(ir_node *const node)
+static bool have_equal_high_words(ir_node *const left, ir_node *const right)
 {
-	ir_node  *left  = get_binop_left(node);
-	ir_node  *right = get_binop_right(node);
-	dbg_info *dbgi  = get_irn_dbg_info(node);
-	ir_node  *block = get_nodes_block(node);
-	ir_graph *irg   = get_irn_irg(block);
-	ir_mode  *mode  = get_node_high_mode(node);
-	ir_type  *mtp   = mode_is_signed(mode) ? binop_tp_s : binop_tp_u;
-	ir_node  *addr  = get_intrinsic_address(mtp, get_irn_op(node), mode, mode);
+	return get_lowered_high(left) == get_lowered_high(right)
+	    || (is_high_word_zero(left) && is_high_word_zero(right));
+}
 
-	ir_node  *in[4];
-	if (ir_target_big_endian()) {
-		in[0] = get_lowered_high(left);
-		in[1] = get_lowered_low(left);
-		in[2] = get_lowered_high(right);
-		in[3] = get_lowered_low(right);
-	} else {
-		in[0] = get_lowered_low(left);
-		in[1] = get_lowered_high(left);
-		in[2] = get_lowered_low(right);
-		in[3] = get_lowered_high(right);
-	}
-	ir_node *mem     = get_irg_no_mem(irg);
-	ir_node *call    = new_rd_Call(dbgi, block, mem, addr, 4, in, mtp);
-	ir_node *resproj = new_r_Proj(call, mode_T, pn_Call_T_result);
-	set_irn_pinned(call, get_irn_pinned(node));
+/**
+ * Returns 1 in mode @p mode if @p relation holds between @p left and
+ * @p right and 0 otherwise.
+ */
+static ir_node *create_flag(dbg_info *const dbgi, ir_node *const block,
+                            ir_node *const left, ir_node *const right,
+                            ir_relation const relation, ir_mode *const mode)
+{
+	ir_graph *const irg  = get_irn_irg(block);
+	ir_node  *const cmp  = new_rd_Cmp(dbgi, block, left, right, relation);
+	ir_node  *const one  = new_r_Const(irg, get_mode_one(mode));
+	ir_node  *const zero = new_r_Const(irg, get_mode_null(mode));
+	return new_rd_Mux(dbgi, block, cmp, zero, one);
+}
 
-	if (ir_target_big_endian()) {
-		ir_node *res_low  = new_r_Proj(resproj, env.p.word_unsigned, 1);
-		ir_node *res_high = new_r_Proj(resproj, mode,                0);
-		ir_set_dw_lowered(node, res_low, res_high);
-	} else {
-		ir_node *res_low  = new_r_Proj(resproj, env.p.word_unsigned, 0);
-		ir_node *res_high = new_r_Proj(resproj, mode,                1);
-		ir_set_dw_lowered(node, res_low, res_high);
+/**
+ * Translate a Mul.
+ *
+ * res_low  = left_low * right_low
+ * res_high = mulh(left_low, right_low) + left_high * right_low
+ *          + left_low * right_high
+ * The products with a high word are omitted if it is known to be zero.
+ */
+static void lower_Mul(ir_node *const node)
+{
+	dbg_info *const dbgi       = get_irn_dbg_info(node);
+	ir_node  *const block      = get_nodes_block(node);
+	ir_node  *const left       = get_Mul_left(node);
+	ir_node  *const right      = get_Mul_right(node);
+	ir_node  *const left_low   = get_lowered_low(left);
+	ir_node  *const right_low  = get_lowered_low(right);
+	ir_mode  *const mode       = get_node_high_mode(node);
+
+	ir_node *const res_low  = new_rd_Mul(dbgi, block, left_low, right_low);
+	ir_node *const mulh     = new_rd_Mulh(dbgi, block, left_low, right_low);
+	ir_node       *res_high = create_conv(block, mulh, mode);
+	if (!is_high_word_zero(left)) {
+		ir_node *const right_lowc = create_conv(block, right_low, mode);
+		ir_node *const lh_rl      = new_rd_Mul(dbgi, block, get_lowered_high(left), right_lowc);
+		res_high = new_rd_Add(dbgi, block, res_high, lh_rl);
+	}
+	if (!is_high_word_zero(right)) {
+		ir_node *const left_lowc = create_conv(block, left_low, mode);
+		ir_node *const ll_rh     = new_rd_Mul(dbgi, block, left_lowc, get_lowered_high(right));
+		res_high = new_rd_Add(dbgi, block, res_high, ll_rh);
 	}
+	ir_set_dw_lowered(node, res_low, res_high);
 }
 
-static ir_node *create_conv(ir_node *block, ir_node *node, ir_mode *dest_mode)
-{
-	if (get_irn_mode(node) == dest_mode)
-		return node;
-	return new_r_Conv(block, node, dest_mode);
+/**
+ * Translate a Mulh: The high double-word of the quadruple-word product is
+ * assembled from the four partial products of the words (see Hacker's
+ * Delight, chapter 8-2).
+ *
+ * For signed operands the unsigned result is corrected by subtracting each
+ * operand if the other one is negative.
+ */
+static void lower_Mulh(ir_node *const node)
+{
+	dbg_info *const dbgi       = get_irn_dbg_info(node);
+	ir_node  *const block      = get_nodes_block(node);
+	ir_node  *const left       = get_Mulh_left(node);
+	ir_node  *const right      = get_Mulh_right(node);
+	ir_mode  *const umode      = env.p.word_unsigned;
+	ir_mode  *const mode       = get_node_high_mode(node);
+	ir_node  *const left_low   = get_lowered_low(left);
+	ir_node  *const left_high  = create_conv(block, get_lowered_high(left), umode);
+	ir_node  *const right_low  = get_lowered_low(right);
+	ir_node  *const right_high = create_conv(block, get_lowered_high(right), umode);
+
+	/* t = left_low * right_high + mulh(left_low, right_low) */
+	ir_node *const ll_rl_h = new_rd_Mulh(dbgi, block, left_low, right_low);
+	ir_node *const ll_rh_l = new_rd_Mul(dbgi, block, left_low, right_high);
+	ir_node *const ll_rh_h = new_rd_Mulh(dbgi, block, left_low, right_high);
+	ir_node *const t_low   = new_rd_Add(dbgi, block, ll_rh_l, ll_rl_h);
+	ir_node *const t_carry = create_flag(dbgi, block, t_low, ll_rl_h, ir_relation_less, umode);
+	ir_node *const t_high  = new_rd_Add(dbgi, block, ll_rh_h, t_carry);
+
+	/* u = left_high * right_low + t_low */
+	ir_node *const lh_rl_l = new_rd_Mul(dbgi, block, left_high, right_low);
+	ir_node *const lh_rl_h = new_rd_Mulh(dbgi, block, left_high, right_low);
+	ir_node *const u_low   = new_rd_Add(dbgi, block, lh_rl_l, t_low);
+	ir_node *const u_carry = create_flag(dbgi, block, u_low, t_low, ir_relation_less, umode);
+	ir_node *const u_high  = new_rd_Add(dbgi, block, lh_rl_h, u_carry);
+
+	/* res = left_high * right_high + t_high + u_high */
+	ir_node *const lh_rh_l  = new_rd_Mul(dbgi, block, left_high, right_high);
+	ir_node *const lh_rh_h  = new_rd_Mulh(dbgi, block, left_high, right_high);
+	ir_node *const sum      = new_rd_Add(dbgi, block, t_high, u_high);
+	ir_node *const sum_c    = create_flag(dbgi, block, sum, t_high, ir_relation_less, umode);
+	ir_node       *res_low  = new_rd_Add(dbgi, block, lh_rh_l, sum);
+	ir_node *const res_c    = create_flag(dbgi, block, res_low, sum, ir_relation_less, umode);
+	ir_node       *res_high = new_rd_Add(dbgi, block, lh_rh_h, new_rd_Add(dbgi, block, sum_c, res_c));
+
+	if (mode_is_signed(mode)) {
+		/* res -= (left < 0 ? right : 0) + (right < 0 ? left : 0) */
+		ir_graph *const irg   = get_irn_irg(node);
+		ir_node  *const shift = new_r_Const_long(irg, umode, get_mode_size_bits(umode) - 1);
+		ir_node  *const operands[][3] = {
+			{ get_lowered_high(left),  right_low, right_high },
+			{ get_lowered_high(right), left_low,  left_high  },
+		};
+		for (size_t i = 0; i < ARRAY_SIZE(operands); ++i) {
+			ir_node *const sign   = create_conv(block, new_rd_Shrs(dbgi, block, operands[i][0], shift), umode);
+			ir_node *const sub_l  = new_rd_And(dbgi, block, sign, operands[i][1]);
+			ir_node *const sub_h  = new_rd_And(dbgi, block, sign, operands[i][2]);
+			ir_node *const borrow = create_flag(dbgi, block, res_low, sub_l, ir_relation_less, umode);
+			res_low  = new_rd_Sub(dbgi, block, res_low, sub_l);
+			res_high = new_rd_Sub(dbgi, block, new_rd_Sub(dbgi, block, res_high, sub_h), borrow);
+		}
+	}
+	ir_set_dw_lowered(node, res_low, create_conv(block, res_high, mode));
 }
 
 static void move_node(ir_node *node, ir_node *to_bl)
@@ -804,199 +897,244 @@ void set_dw_control_flow_changed(void)
 typedef ir_node* (*new_rd_shr_func)(dbg_info *dbgi, ir_node *block,
                                     ir_node *left, ir_node *right);
 
-static void lower_shr_helper(ir_node *const node, new_rd_shr_func const new_rd_shrs)
+/**
+ * Checks whether a double-word shift by @p right is known to shift by less
+ * than a word or by at least a word.
+ *
+ * @return true if it is known, the result is returned in @p large
+ */
+static bool is_shift_width_known(ir_node const *const right,
+                                 unsigned const word_bits, bool *const large)
 {
-	ir_node  *right         = get_binop_right(node);
-	ir_node  *left          = get_binop_left(node);
-	ir_mode  *shr_mode      = get_irn_mode(node);
-	unsigned  modulo_shift  = get_mode_modulo_shift(shr_mode);
-	ir_mode  *low_unsigned  = env.p.word_unsigned;
-	ir_mode  *mode          = get_node_high_mode(node);
-	unsigned  modulo_shift2 = get_mode_modulo_shift(mode);
-	ir_graph *irg           = get_irn_irg(node);
-	ir_node  *left_low      = get_lowered_low(left);
-	ir_node  *left_high     = get_lowered_high(left);
-	dbg_info *dbgi          = get_irn_dbg_info(node);
+	bitinfo const *const b = get_bitinfo(right);
+	if (b == NULL)
+		return false;
+	unsigned const bit = ntz(word_bits);
+	if (!tarval_get_bit(b->z, bit)) {
+		*large = false;
+		return true;
+	} else if (tarval_get_bit(b->o, bit)) {
+		*large = true;
+		return true;
+	}
+	return false;
+}
 
+static void check_shift_modes(ir_mode *const shr_mode, ir_mode *const mode)
+{
+	unsigned const modulo_shift  = get_mode_modulo_shift(shr_mode);
+	unsigned const modulo_shift2 = get_mode_modulo_shift(mode);
 	/* this version is optimized for modulo shift architectures
 	 * (and can't handle anything else) */
 	if (modulo_shift != get_mode_size_bits(shr_mode)
 	    || modulo_shift2 << 1 != modulo_shift) {
-		panic("Shr lowering only implemented for modulo shift shr operations");
+		panic("shift lowering only implemented for modulo shift operations");
 	}
 	if (!is_po2_or_zero(modulo_shift) || !is_po2_or_zero(modulo_shift2)) {
-		panic("Shr lowering only implemented for power-of-2 modes");
+		panic("shift lowering only implemented for power-of-2 modes");
 	}
 	/* without 2-complement the -x instead of (bit_width-x) trick won't work */
 	if (get_mode_arithmetic(shr_mode) != irma_twos_complement) {
-		panic("Shr lowering only implemented for two-complement modes");
+		panic("shift lowering only implemented for two-complement modes");
 	}
+}
 
-	ir_node *block = get_nodes_block(node);
-
+/**
+ * Returns the low word of the shift amount of a double-word shift.
+ */
+static ir_node *get_shift_width(ir_node *const node)
+{
 	/* if the right operand is a 64bit value, we're only interested in the
 	 * lower word */
+	ir_node *const right = get_binop_right(node);
 	assert(!mode_is_signed(get_irn_mode(right)));
-	if (needs_lowering(get_irn_mode(right))) {
-		right = get_lowered_low(right);
+	if (needs_lowering(get_irn_mode(right)))
+		return get_lowered_low(right);
+	/* shift should never have signed mode on the right */
+	return create_conv(get_nodes_block(node), right, env.p.word_unsigned);
+}
+
+/**
+ * Creates a right shift by less than a word.
+ *
+ * In theory the low value (for 64bit shifts) is:
+ *    Or(High << (32-x)), Low >> x)
+ * In practice High << 32-x will fail when x is zero (since we have
+ * modulo shift and 32 will be 0). So instead we use:
+ *    Or(High<<1<<~x, Low >> x)
+ */
+static void create_shr_small(ir_node *const node, ir_node *const block,
+                             ir_node *const right,
+                             new_rd_shr_func const new_rd_shrs,
+                             ir_node **const res_low, ir_node **const res_high)
+{
+	dbg_info *const dbgi         = get_irn_dbg_info(node);
+	ir_graph *const irg          = get_irn_irg(node);
+	ir_node  *const left         = get_binop_left(node);
+	ir_node  *const left_low     = get_lowered_low(left);
+	ir_node  *const left_high    = get_lowered_high(left);
+	ir_mode  *const low_unsigned = env.p.word_unsigned;
+	*res_high = new_rd_shrs(dbgi, block, left_high, right);
+	ir_node *const shift_low    = new_rd_Shr(dbgi, block, left_low, right);
+	ir_node *const not_shiftval = new_rd_Not(dbgi, block, right);
+	ir_node *const tconv        = create_conv(block, left_high, low_unsigned);
+	ir_node *const one          = new_r_Const_one(irg, low_unsigned);
+	ir_node *const carry0       = new_rd_Shl(dbgi, block, tconv, one);
+	ir_node *const carry1       = new_rd_Shl(dbgi, block, carry0, not_shiftval);
+	*res_low = new_rd_Or(dbgi, block, shift_low, carry1);
+}
+
+/**
+ * Creates a right shift by at least a word.
+ */
+static void create_shr_large(ir_node *const node, ir_node *const block,
+                             ir_node *const right,
+                             new_rd_shr_func const new_rd_shrs,
+                             ir_node **const res_low, ir_node **const res_high)
+{
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_graph *const irg       = get_irn_irg(node);
+	ir_node  *const left_high = get_lowered_high(get_binop_left(node));
+	ir_mode  *const mode      = get_node_high_mode(node);
+	ir_node  *const fconv     = create_conv(block, left_high, env.p.word_unsigned);
+	*res_low = new_rd_shrs(dbgi, block, fconv, right);
+	if (new_rd_shrs == new_rd_Shrs) {
+		int      const cnsti = get_mode_modulo_shift(mode) - 1;
+		ir_node *const cnst3 = new_r_Const_long(irg, env.p.word_unsigned, cnsti);
+		*res_high = new_rd_shrs(dbgi, block, left_high, cnst3);
 	} else {
-		/* shift should never have signed mode on the right */
-		right = create_conv(block, right, low_unsigned);
+		*res_high = new_r_Const_null(irg, mode);
 	}
+}
 
-	ir_node *lower_block = part_block_dw(node);
+/**
+ * Creates a left shift by less than a word.
+ */
+static void create_shl_small(ir_node *const node, ir_node *const block,
+                             ir_node *const right,
+                             new_rd_shr_func const new_rd_shrs,
+                             ir_node **const res_low, ir_node **const res_high)
+{
+	(void)new_rd_shrs;
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_graph *const irg       = get_irn_irg(node);
+	ir_node  *const left      = get_binop_left(node);
+	ir_node  *const left_low  = get_lowered_low(left);
+	ir_node  *const left_high = get_lowered_high(left);
+	ir_mode  *const mode      = get_node_high_mode(node);
+	*res_low = new_rd_Shl(dbgi, block, left_low, right);
+	ir_node *const shift_high   = new_rd_Shl(dbgi, block, left_high, right);
+	ir_node *const not_shiftval = new_rd_Not(dbgi, block, right);
+	ir_node *const conv         = create_conv(block, left_low, mode);
+	ir_node *const one          = new_r_Const_one(irg, env.p.word_unsigned);
+	ir_node *const carry0       = new_rd_Shr(dbgi, block, conv, one);
+	ir_node *const carry1       = new_rd_Shr(dbgi, block, carry0, not_shiftval);
+	*res_high = new_rd_Or(dbgi, block, shift_high, carry1);
+}
+
+/**
+ * Creates a left shift by at least a word.
+ */
+static void create_shl_large(ir_node *const node, ir_node *const block,
+                             ir_node *const right,
+                             new_rd_shr_func const new_rd_shrs,
+                             ir_node **const res_low, ir_node **const res_high)
+{
+	(void)new_rd_shrs;
+	dbg_info *const dbgi     = get_irn_dbg_info(node);
+	ir_graph *const irg      = get_irn_irg(node);
+	ir_node  *const left_low = get_lowered_low(get_binop_left(node));
+	ir_mode  *const mode     = get_node_high_mode(node);
+	ir_node  *const fconv    = create_conv(block, left_low, mode);
+	*res_low  = new_r_Const_null(irg, env.p.word_unsigned);
+	*res_high = new_rd_Shl(dbgi, block, fconv, right);
+}
+
+typedef void (*create_shift_func)(ir_node *node, ir_node *block,
+                                  ir_node *right, new_rd_shr_func new_rd_shrs,
+                                  ir_node **res_low, ir_node **res_high);
+
+static void lower_shift_helper(ir_node *const node,
+                               new_rd_shr_func const new_rd_shrs,
+                               create_shift_func const create_small,
+                               create_shift_func const create_large)
+{
+	ir_mode *const mode = get_node_high_mode(node);
+	check_shift_modes(get_irn_mode(node), mode);
+
+	ir_node *const right = get_shift_width(node);
+	ir_node       *res_low;
+	ir_node       *res_high;
+
+	/* if it is known whether we shift by more than a word, no control flow
+	 * is necessary */
+	unsigned const modulo_shift2 = get_mode_modulo_shift(mode);
+	bool           large;
+	if (is_shift_width_known(get_binop_right(node), modulo_shift2, &large)) {
+		ir_node          *const block  = get_nodes_block(node);
+		create_shift_func const create = large ? create_large : create_small;
+		create(node, block, right, new_rd_shrs, &res_low, &res_high);
+		ir_set_dw_lowered(node, res_low, res_high);
+		return;
+	}
+
+	ir_node *const lower_block = part_block_dw(node);
 	env.flags |= CF_CHANGED;
-	block = get_nodes_block(node);
+	ir_node *const block = get_nodes_block(node);
 
 	/* add a Cmp to test if highest bit is set <=> whether we shift more
 	 * than half the word width */
-	ir_node *cnst  = new_r_Const_long(irg, low_unsigned, modulo_shift2);
-	ir_node *andn  = new_r_And(block, right, cnst);
-	ir_node *cnst2 = new_r_Const_null(irg, low_unsigned);
-	ir_node *cmp   = new_rd_Cmp(dbgi, block, andn, cnst2, ir_relation_equal);
-	ir_node *cond       = new_rd_Cond(dbgi, block, cmp);
-	ir_node *proj_true  = new_r_Proj(cond, mode_X, pn_Cond_true);
-	ir_node *proj_false = new_r_Proj(cond, mode_X, pn_Cond_false);
+	ir_graph *const irg          = get_irn_irg(node);
+	dbg_info *const dbgi         = get_irn_dbg_info(node);
+	ir_mode  *const low_unsigned = env.p.word_unsigned;
+	ir_node  *const cnst  = new_r_Const_long(irg, low_unsigned, modulo_shift2);
+	ir_node  *const andn  = new_r_And(block, right, cnst);
+	ir_node  *const cnst2 = new_r_Const_null(irg, low_unsigned);
+	ir_node  *const cmp   = new_rd_Cmp(dbgi, block, andn, cnst2,
+	                                   ir_relation_equal);
+	ir_node  *const cond       = new_rd_Cond(dbgi, block, cmp);
+	ir_node  *const proj_true  = new_r_Proj(cond, mode_X, pn_Cond_true);
+	ir_node  *const proj_false = new_r_Proj(cond, mode_X, pn_Cond_false);
 
 	/* the true block => shift_width < 1word */
-	/* In theory the low value (for 64bit shifts) is:
-	 *    Or(High << (32-x)), Low >> x)
-	 * In practice High << 32-x will fail when x is zero (since we have
-	 * modulo shift and 32 will be 0). So instead we use:
-	 *    Or(High<<1<<~x, Low >> x)
-	 */
-	ir_node *true_in[1]   = { proj_true };
-	ir_node *block_true   = new_r_Block(irg, ARRAY_SIZE(true_in), true_in);
-	ir_node *tres_high    = new_rd_shrs(dbgi, block_true, left_high, right);
-	ir_node *shift_low    = new_rd_Shr(dbgi, block_true, left_low, right);
-	ir_node *not_shiftval = new_rd_Not(dbgi, block_true, right);
-	ir_node *tconv        = create_conv(block_true, left_high,
-	                                    low_unsigned);
-	ir_node *one          = new_r_Const_one(irg, low_unsigned);
-	ir_node *carry0       = new_rd_Shl(dbgi, block_true, tconv, one);
-	ir_node *carry1       = new_rd_Shl(dbgi, block_true, carry0, not_shiftval);
-	ir_node *tres_low     = new_rd_Or(dbgi, block_true, shift_low, carry1);
-
-	/* false block => shift_width > 1word */
+	ir_node *true_in[1] = { proj_true };
+	ir_node *block_true = new_r_Block(irg, ARRAY_SIZE(true_in), true_in);
+	ir_node *tres_low;
+	ir_node *tres_high;
+	create_small(node, block_true, right, new_rd_shrs, &tres_low, &tres_high);
+
+	/* false block => shift_width >= 1word */
 	ir_node *false_in[1] = { proj_false };
 	ir_node *block_false = new_r_Block(irg, ARRAY_SIZE(false_in), false_in);
-	ir_node *fconv       = create_conv(block_false, left_high, low_unsigned);
-	ir_node *fres_low    = new_rd_shrs(dbgi, block_false, fconv, right);
-	int      cnsti       = modulo_shift2 - 1;
-	ir_node *cnst3       = new_r_Const_long(irg, low_unsigned, cnsti);
+	ir_node *fres_low;
 	ir_node *fres_high;
-	if (new_rd_shrs == new_rd_Shrs) {
-		fres_high = new_rd_shrs(dbgi, block_false, left_high, cnst3);
-	} else {
-		fres_high = new_r_Const_null(irg, mode);
-	}
+	create_large(node, block_false, right, new_rd_shrs, &fres_low, &fres_high);
 
 	/* patch lower block */
 	ir_node *lower_in[]    = { new_r_Jmp(block_true), new_r_Jmp(block_false) };
 	ir_node *phi_low_in[]  = { tres_low,  fres_low };
 	ir_node *phi_high_in[] = { tres_high, fres_high };
 	set_irn_in(lower_block, ARRAY_SIZE(lower_in), lower_in);
-	ir_node *phi_low  = new_r_Phi(lower_block, ARRAY_SIZE(phi_low_in),
-	                              phi_low_in, low_unsigned);
-	ir_node *phi_high = new_r_Phi(lower_block, ARRAY_SIZE(phi_high_in),
-	                              phi_high_in, mode);
-	ir_set_dw_lowered(node, phi_low, phi_high);
+	res_low  = new_r_Phi(lower_block, ARRAY_SIZE(phi_low_in), phi_low_in,
+	                     low_unsigned);
+	res_high = new_r_Phi(lower_block, ARRAY_SIZE(phi_high_in), phi_high_in,
+	                     mode);
+	ir_set_dw_lowered(node, res_low, res_high);
 }
 
 static void lower_Shr(ir_node *const node)
 {
-	lower_shr_helper(node, new_rd_Shr);
+	lower_shift_helper(node, new_rd_Shr, create_shr_small, create_shr_large);
 }
 
 static void lower_Shrs(ir_node *const node)
 {
-	lower_shr_helper(node, new_rd_Shrs);
+	lower_shift_helper(node, new_rd_Shrs, create_shr_small, create_shr_large);
 }
 
 static void lower_Shl(ir_node *const node)
 {
-	ir_node  *right         = get_binop_right(node);
-	ir_node  *left          = get_binop_left(node);
-	ir_mode  *shr_mode      = get_irn_mode(node);
-	unsigned  modulo_shift  = get_mode_modulo_shift(shr_mode);
-	ir_mode  *low_unsigned  = env.p.word_unsigned;
-	ir_mode  *mode          = get_node_high_mode(node);
-	unsigned  modulo_shift2 = get_mode_modulo_shift(mode);
-	ir_graph *irg           = get_irn_irg(node);
-	ir_node  *left_low      = get_lowered_low(left);
-	ir_node  *left_high     = get_lowered_high(left);
-	dbg_info *dbgi          = get_irn_dbg_info(node);
-	ir_node  *lower_block   = get_nodes_block(node);
-
-	/* this version is optimized for modulo shift architectures
-	 * (and can't handle anything else) */
-	if (modulo_shift != get_mode_size_bits(shr_mode)
-	    || modulo_shift2<<1 != modulo_shift) {
-		panic("Shl lowering only implemented for modulo shift shl operations");
-	}
-	if (!is_po2_or_zero(modulo_shift) || !is_po2_or_zero(modulo_shift2)) {
-		panic("Shl lowering only implemented for power-of-2 modes");
-	}
-	/* without 2-complement the -x instead of (bit_width-x) trick won't work */
-	if (get_mode_arithmetic(shr_mode) != irma_twos_complement) {
-		panic("Shl lowering only implemented for two-complement modes");
-	}
-
-	/* if the right operand is a 64bit value, we're only interested in the
-	 * lower word */
-	assert(!mode_is_signed(get_irn_mode(right)));
-	if (needs_lowering(get_irn_mode(right))) {
-		right = get_lowered_low(right);
-	} else {
-		/* shift should never have signed mode on the right */
-		right = create_conv(lower_block, right, low_unsigned);
-	}
-
-	part_block_dw(node);
-	env.flags |= CF_CHANGED;
-	ir_node *block = get_nodes_block(node);
-
-	/* add a Cmp to test if highest bit is set <=> whether we shift more
-	 * than half the word width */
-	ir_node *cnst       = new_r_Const_long(irg, low_unsigned, modulo_shift2);
-	ir_node *andn       = new_r_And(block, right, cnst);
-	ir_node *cnst2      = new_r_Const_null(irg, low_unsigned);
-	ir_node *cmp        = new_rd_Cmp(dbgi, block, andn, cnst2,
-	                                 ir_relation_equal);
-	ir_node *cond       = new_rd_Cond(dbgi, block, cmp);
-	ir_node *proj_true  = new_r_Proj(cond, mode_X, pn_Cond_true);
-	ir_node *proj_false = new_r_Proj(cond, mode_X, pn_Cond_false);
-
-	/* the true block => shift_width < 1word */
-	ir_node *tin[]        = { proj_true };
-	ir_node *block_true   = new_r_Block(irg, ARRAY_SIZE(tin), tin);
-
-	ir_node *tres_low     = new_rd_Shl(dbgi, block_true, left_low, right);
-	ir_node *shift_high   = new_rd_Shl(dbgi, block_true, left_high, right);
-	ir_node *not_shiftval = new_rd_Not(dbgi, block_true, right);
-	ir_node *conv         = create_conv(block_true, left_low, mode);
-	ir_node *one          = new_r_Const_one(irg, low_unsigned);
-	ir_node *carry0       = new_rd_Shr(dbgi, block_true, conv, one);
-	ir_node *carry1       = new_rd_Shr(dbgi, block_true, carry0, not_shiftval);
-	ir_node *tres_high    = new_rd_Or(dbgi, block_true, shift_high, carry1);
-
-	/* false block => shift_width > 1word */
-	ir_node *fin[1]      = { proj_false };
-	ir_node *block_false = new_r_Block(irg, ARRAY_SIZE(fin), fin);
-	ir_node *fres_low    = new_r_Const_null(irg, low_unsigned);
-	ir_node *fconv       = create_conv(block_false, left_low, mode);
-	ir_node *fres_high   = new_rd_Shl(dbgi, block_false, fconv, right);
-
-	/* patch lower block */
-	ir_node *lower_in[]    = { new_r_Jmp(block_true), new_r_Jmp(block_false) };
-	ir_node *phi_low_in[]  = { tres_low, fres_low };
-	ir_node *phi_high_in[] = { tres_high, fres_high };
-	set_irn_in(lower_block, ARRAY_SIZE(lower_in), lower_in);
-	ir_node *phi_low  = new_r_Phi(lower_block, ARRAY_SIZE(phi_low_in),
-	                              phi_low_in, low_unsigned);
-	ir_node *phi_high = new_r_Phi(lower_block, ARRAY_SIZE(phi_high_in),
-	                              phi_high_in, mode);
-	ir_set_dw_lowered(node, phi_low, phi_high);
+	lower_shift_helper(node, NULL, create_shl_small, create_shl_large);
 }
 
 /**
@@ -1229,6 +1367,13 @@ static void lower_Cond(ir_node *const node)
 		return;
 	}
 
+	if (have_equal_high_words(left, right)) {
+		ir_node *cmp = new_rd_Cmp(dbg, block, lentry->low_word,
+		                          rentry->low_word, relation);
+		set_Cond_selector(node, cmp);
+		return;
+	}
+
 	assert(relation != ir_relation_equal);
 	assert(relation != ir_relation_less_greater);
 
@@ -1419,6 +1564,13 @@ static void lower_Cmp(ir_node *const cmp)
 		return;
 	}
 
+	if (have_equal_high_words(l, r)) {
+		ir_node *new_cmp = new_rd_Cmp(dbg, block, lentry->low_word,
+		                              rentry->low_word, relation);
+		exchange(cmp, new_cmp);
+		return;
+	}
+
 	assert(relation != ir_relation_equal);
 	assert(relation != ir_relation_less_greater);
 
@@ -2183,7 +2335,7 @@ static void lower_reduce_builtin(ir_node *const builtin)
 }
 
 /**
- * lowers builtins performing arithmetic (bswap)
+ * lowers builtins performing arithmetic (bswap, saturating_increment)
  */
 static void lower_arithmetic_builtin(ir_node *const builtin)
 {
@@ -2193,19 +2345,19 @@ static void lower_arithmetic_builtin(ir_node *const builtin)
 	if (!needs_lowering(operand_mode))
 		return;
 
-	dbg_info              *dbgi              = get_irn_dbg_info(builtin);
-	ir_type               *type              = get_Builtin_type(builtin);
-	ir_type               *lowered_type_high = lower_Builtin_type_high(type);
-	ir_type               *lowered_type_low  = lower_Builtin_type_low(type);
-	ir_node               *block             = get_nodes_block(builtin);
-	ir_node               *mem               = get_Builtin_mem(builtin);
-	const lower64_entry_t *entry             = get_node_entry(operand);
-	ir_mode               *mode_high         = get_irn_mode(entry->high_word);
+	dbg_info              *dbgi      = get_irn_dbg_info(builtin);
+	ir_node               *block     = get_nodes_block(builtin);
+	const lower64_entry_t *entry     = get_node_entry(operand);
+	ir_mode               *mode_high = get_irn_mode(entry->high_word);
 
 	ir_node               *res_high;
 	ir_node               *res_low;
 	switch (kind) {
 	case ir_bk_bswap: {
+		ir_type *type              = get_Builtin_type(builtin);
+		ir_type *lowered_type_high = lower_Builtin_type_high(type);
+		ir_type *lowered_type_low  = lower_Builtin_type_low(type);
+		ir_node *mem               = get_Builtin_mem(builtin);
 		ir_node *in_high[] = { entry->high_word };
 		ir_node *in_low[]  = { entry->low_word };
 		ir_node *swap_high = new_rd_Builtin(dbgi, block, mem, 1, in_high, kind, lowered_type_high);
@@ -2221,6 +2373,21 @@ static void lower_arithmetic_builtin(ir_node *const builtin)
 		}
 		break;
 	}
+	case ir_bk_saturating_increment: {
+		/* x + 1 - carry out of the high word */
+		ir_mode  *const umode    = env.p.word_unsigned;
+		ir_graph *const irg      = get_irn_irg(builtin);
+		ir_node  *const low      = entry->low_word;
+		ir_node  *const high     = create_conv(block, entry->high_word, umode);
+		ir_node  *const one      = new_r_Const_one(irg, umode);
+		ir_node  *const inc_low  = new_rd_Add(dbgi, block, low, one);
+		ir_node  *const carry    = create_flag(dbgi, block, inc_low, low, ir_relation_less, umode);
+		ir_node  *const inc_high = new_rd_Add(dbgi, block, high, carry);
+		ir_node  *const sat      = create_flag(dbgi, block, inc_high, high, ir_relation_less, umode);
+		res_low  = new_rd_Sub(dbgi, block, inc_low, sat);
+		res_high = create_conv(block, new_rd_Sub(dbgi, block, inc_high, sat), mode_high);
+		break;
+	}
 	default:
 		panic("unexpected builtin");
 	}
@@ -2231,10 +2398,7 @@ static void lower_arithmetic_builtin(ir_node *const builtin)
 		ir_set_dw_lowered(proj, res_low, res_high);
 }
 
-/**
- * Lower double word builtins.
- */
-static void lower_Builtin(ir_node *const builtin)
+void ir_default_lower_dw_Builtin(ir_node *const builtin)
 {
 	ir_builtin_kind kind = get_Builtin_kind(builtin);
 	switch (kind) {
@@ -2246,13 +2410,13 @@ static void lower_Builtin(ir_node *const builtin)
 	case ir_bk_outport:
 	case ir_bk_prefetch:
 	case ir_bk_return_address:
-	case ir_bk_saturating_increment:
 	case ir_bk_trap:
 	case ir_bk_va_start:
 	case ir_bk_va_arg:
 		/* Nothing to do/impossible to lower in a generic way */
 		return;
 	case ir_bk_bswap:
+	case ir_bk_saturating_increment:
 		lower_arithmetic_builtin(builtin);
 		return;
 	case ir_bk_clz:
@@ -2468,7 +2632,7 @@ void ir_prepare_dw_lowering(const lwrdw_param_t *params)
 	ir_register_dw_lower_function(op_And,     lower_And);
 	ir_register_dw_lower_function(op_Bad,     lower_Bad);
 	ir_register_dw_lower_function(op_Bitcast, lower_Bitcast);
-	ir_register_dw_lower_function(op_Builtin, lower_Builtin);
+	ir_register_dw_lower_function(op_Builtin, ir_default_lower_dw_Builtin);
 	ir_register_dw_lower_function(op_Call,    lower_Call);
 	ir_register_dw_lower_function(op_Cmp,     lower_Cmp);
 	ir_register_dw_lower_function(op_Cond,    lower_Cond);
@@ -2479,7 +2643,8 @@ void ir_prepare_dw_lowering(const lwrdw_param_t *params)
 	ir_register_dw_lower_function(op_Load,    lower_Load);
 	ir_register_dw_lower_function(op_Minus,   lower_Minus);
 	ir_register_dw_lower_function(op_Mod,     lower_Mod);
-	ir_register_dw_lower_function(op_Mul,     lower_binop);
+	ir_register_dw_lower_function(op_Mul,     lower_Mul);
+	ir_register_dw_lower_function(op_Mulh,    lower_Mulh);
 	ir_register_dw_lower_function(op_Mux,     lower_Mux);
 	ir_register_dw_lower_function(op_Not,     lower_Not);
 	ir_register_dw_lower_function(op_Or,      lower_Or);
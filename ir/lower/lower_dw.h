@@ -84,6 +84,17 @@ static inline ir_node *get_lowered_high(ir_node *node)
 
 void ir_default_lower_dw_Conv(ir_node *node);
 
+/**
+ * Lowers a double word Builtin in the generic way.
+ */
+void ir_default_lower_dw_Builtin(ir_node *builtin);
+
+/**
+ * Returns whether the high word of the double-word value @p node is known to
+ * be zero.  Only valid in a lowering callback.
+ */
+bool is_high_word_zero(ir_node *node);
+
 /**
  * We need a custom version of part_block_edges because during transformation
  * not all data-dependencies are explicit yet if a lowered nodes users are not
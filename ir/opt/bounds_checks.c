@@ -0,0 +1,569 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Elimination of redundant compares and bounds checks
+ *
+ * Decides integer compares controlling a Cond with the facts that are known
+ * to hold at the compare: Conditions of dominating branches, Confirm nodes
+ * and the monotony of simple induction variables. All facts are relations
+ * between two values, the prover searches chains of them for a common base,
+ * so i < n together with 0 <= i decides a check like (unsigned)i < n.
+ *
+ * Bounds are kept as a base value plus a constant offset. They are only
+ * propagated through an Add or Sub of a constant, if the other facts prove
+ * that the operation does not wrap around.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons.h"
+#include "irdom.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "iroptimize.h"
+#include "irtools.h"
+#include "obst.h"
+#include "statev_t.h"
+#include "tv.h"
+#include "util.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Maximum number of dominators searched for branch facts. */
+#define MAX_FACTS     64
+/** Maximum number of bounds collected for a single value. */
+#define MAX_BOUNDS    32
+/** Maximum length of a chain of facts. */
+#define MAX_DEPTH     4
+/** Offsets are limited, so adding two of them can not overflow. */
+#define OFFSET_LIMIT  ((int64_t)1 << 61)
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** A relation known to hold between two values: left relation right. */
+typedef struct fact_t {
+	ir_node    *left;
+	ir_node    *right;
+	ir_relation relation;
+} fact_t;
+
+/**
+ * A bound base + offset of a value. The base is NULL for constant bounds.
+ * All values are taken as mathematical integers in the interpretation of the
+ * mode they are compared in.
+ */
+typedef struct bound_t {
+	ir_node *base;
+	int64_t  offset;
+} bound_t;
+
+typedef struct bounds_t {
+	unsigned n;
+	bound_t  b[MAX_BOUNDS];
+} bounds_t;
+
+/** The facts holding in a block for values of a single mode. */
+typedef struct fact_ctx_t {
+	ir_mode *mode;
+	int64_t  min;
+	int64_t  max;
+	unsigned n_facts;
+	fact_t   facts[MAX_FACTS];
+} fact_ctx_t;
+
+static bool is_supported_mode(ir_mode const *const mode)
+{
+	return mode_is_int(mode) && get_mode_size_bits(mode) <= 64;
+}
+
+static int64_t get_signed_max(ir_mode const *const mode)
+{
+	return (int64_t)(UINT64_MAX >> (65 - get_mode_size_bits(mode)));
+}
+
+static bool is_valid_offset(int64_t const offset)
+{
+	return -OFFSET_LIMIT <= offset && offset <= OFFSET_LIMIT;
+}
+
+/**
+ * Returns the value of a constant as interpreted by its mode, if it fits in
+ * the range of offsets.
+ */
+static bool get_const_value(ir_node const *const node, int64_t *const value)
+{
+	if (!is_Const(node))
+		return false;
+	ir_tarval *const tv = get_Const_tarval(node);
+	if (!tarval_is_long(tv))
+		return false;
+	long const val = get_tarval_long(tv);
+	/* an unsigned value with the highest bit set */
+	if (!mode_is_signed(get_tarval_mode(tv)) && val < 0)
+		return false;
+	if (!is_valid_offset(val))
+		return false;
+	*value = val;
+	return true;
+}
+
+typedef struct bounds_env_t {
+	struct obstack obst;
+	ir_node      **conds;    /**< the compare controlled Conds */
+	unsigned       n_conds;
+	unsigned       n_folded;
+} bounds_env_t;
+
+/**
+ * Collects the Conds ending in @p block and records the fact implied by
+ * entering it, if the block is only entered through one exit of a compare
+ * controlled Cond.
+ */
+static void collect_branch_fact(ir_node *const block, void *const data)
+{
+	bounds_env_t *const env = (bounds_env_t*)data;
+	set_irn_link(block, NULL);
+
+	foreach_irn_in(block, i, pred) {
+		if (!is_Proj(pred))
+			continue;
+		ir_node *const cond = get_Proj_pred(pred);
+		if (is_Cond(cond) && is_Cmp(get_Cond_selector(cond))
+		 && !irn_visited_else_mark(cond))
+			ARR_APP1(ir_node*, env->conds, cond);
+	}
+
+	if (get_Block_n_cfgpreds(block) != 1)
+		return;
+	ir_node *const proj = get_Block_cfgpred(block, 0);
+	if (!is_Proj(proj))
+		return;
+	ir_node *const cond = get_Proj_pred(proj);
+	if (!is_Cond(cond))
+		return;
+	ir_node *const cmp = get_Cond_selector(cond);
+	if (!is_Cmp(cmp))
+		return;
+	ir_node *const left = get_Cmp_left(cmp);
+	if (!is_supported_mode(get_irn_mode(left)))
+		return;
+
+	ir_relation relation = get_Cmp_relation(cmp);
+	if (get_Proj_num(proj) == pn_Cond_false)
+		relation = get_negated_relation(relation);
+
+	fact_t *const fact = OALLOC(&env->obst, fact_t);
+	fact->left     = left;
+	fact->right    = get_Cmp_right(cmp);
+	fact->relation = relation & ir_relation_less_equal_greater;
+	set_irn_link(block, fact);
+}
+
+static void init_fact_ctx(fact_ctx_t *const ctx, ir_node const *const block,
+                          ir_mode *const mode)
+{
+	unsigned const bits = get_mode_size_bits(mode);
+	ctx->mode    = mode;
+	ctx->n_facts = 0;
+	if (mode_is_signed(mode)) {
+		ctx->max = get_signed_max(mode);
+		ctx->min = -ctx->max - 1;
+	} else {
+		ctx->max = bits < 64 ? (int64_t)(UINT64_MAX >> (64 - bits))
+		                     : INT64_MAX;
+		ctx->min = 0;
+	}
+
+	for (ir_node const *b = block; b != NULL && ctx->n_facts < MAX_FACTS;
+	     b = get_Block_idom(b)) {
+		fact_t const *const fact = (fact_t const*)get_irn_link(b);
+		if (fact != NULL && get_irn_mode(fact->left) == mode)
+			ctx->facts[ctx->n_facts++] = *fact;
+	}
+}
+
+static void add_bound(bounds_t *const bounds, ir_node *const base,
+                      int64_t const offset)
+{
+	if (bounds->n == MAX_BOUNDS || !is_valid_offset(offset))
+		return;
+	bounds->b[bounds->n++] = (bound_t){ base, offset };
+}
+
+static void collect_bounds(fact_ctx_t const *ctx, ir_node *node, bool upper,
+                           unsigned depth, int64_t shift, bounds_t *bounds);
+
+/**
+ * Collects bounds of a value for which value relation @p other holds.
+ */
+static void collect_from_fact(fact_ctx_t const *const ctx,
+                              ir_relation const relation, ir_node *const other,
+                              bool const upper, unsigned const depth,
+                              int64_t const shift, bounds_t *const bounds)
+{
+	if (relation == ir_relation_equal) {
+		collect_bounds(ctx, other, upper, depth, shift, bounds);
+	} else if (upper) {
+		if (relation == ir_relation_less)
+			collect_bounds(ctx, other, upper, depth, shift - 1, bounds);
+		else if (relation == ir_relation_less_equal)
+			collect_bounds(ctx, other, upper, depth, shift, bounds);
+	} else {
+		if (relation == ir_relation_greater)
+			collect_bounds(ctx, other, upper, depth, shift + 1, bounds);
+		else if (relation == ir_relation_greater_equal)
+			collect_bounds(ctx, other, upper, depth, shift, bounds);
+	}
+}
+
+/**
+ * Checks whether @p node + @p c does not wrap around in the mode of @p ctx.
+ */
+static bool is_exact_add(fact_ctx_t const *const ctx, ir_node *const node,
+                         int64_t const c, unsigned const depth)
+{
+	bounds_t bounds;
+	bounds.n = 0;
+	collect_bounds(ctx, node, c > 0, depth, 0, &bounds);
+	for (unsigned i = 0; i < bounds.n; ++i) {
+		bound_t const *const b = &bounds.b[i];
+		/* base + offset + c stays inside the range of the base */
+		if (c > 0 ? b->base != NULL ? b->offset + c <= 0
+		                            : b->offset + c <= ctx->max
+		          : b->base != NULL ? b->offset + c >= 0
+		                            : b->offset + c >= ctx->min)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Returns the constant added to @p node, if node is an Add or Sub of a
+ * constant.
+ */
+static ir_node *get_add_const(ir_node *const node, int64_t *const c)
+{
+	if (is_Add(node)) {
+		ir_node *const left  = get_Add_left(node);
+		ir_node *const right = get_Add_right(node);
+		if (get_const_value(right, c))
+			return left;
+		if (get_const_value(left, c))
+			return right;
+	} else if (is_Sub(node)) {
+		if (get_const_value(get_Sub_right(node), c)) {
+			*c = -*c;
+			return get_Sub_left(node);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Collects the initial value bound of a Phi, if it is an induction variable
+ * that only grows (for lower bounds) or shrinks (for upper bounds) without
+ * wrapping around.
+ */
+static void collect_induction_bound(fact_ctx_t const *const ctx,
+                                    ir_node *const phi, bool const upper,
+                                    unsigned const depth, int64_t const shift,
+                                    bounds_t *const bounds)
+{
+	ir_node *const block = get_nodes_block(phi);
+	ir_node       *init  = NULL;
+	foreach_irn_in(phi, i, pred) {
+		ir_node *const pred_block = get_Block_cfgpred_block(block, i);
+		if (pred_block == NULL)
+			continue;
+		if (!block_dominates(block, pred_block)) {
+			if (init != NULL && init != pred)
+				return;
+			init = pred;
+			continue;
+		}
+
+		/* a backedge, must be an increment (or decrement) of the Phi */
+		int64_t        c;
+		ir_node *const op = get_add_const(skip_Confirm(pred), &c);
+		if (op == NULL || skip_Confirm(op) != phi || (c > 0) == upper)
+			return;
+
+		fact_ctx_t inc_ctx;
+		init_fact_ctx(&inc_ctx, get_nodes_block(pred), ctx->mode);
+		if (!is_exact_add(&inc_ctx, op, c, depth))
+			return;
+	}
+	if (init != NULL)
+		collect_bounds(ctx, init, upper, depth, shift, bounds);
+}
+
+/**
+ * Collects upper (or lower) bounds of @p node + @p shift by following at most
+ * @p depth facts.
+ */
+static void collect_bounds(fact_ctx_t const *const ctx, ir_node *node,
+                           bool const upper, unsigned const depth,
+                           int64_t const shift, bounds_t *const bounds)
+{
+	if (bounds->n == MAX_BOUNDS)
+		return;
+
+	int64_t value;
+	if (node == NULL) {
+		add_bound(bounds, NULL, shift);
+		return;
+	} else if (get_const_value(node, &value)) {
+		add_bound(bounds, NULL, value + shift);
+		return;
+	}
+
+	add_bound(bounds, skip_Confirm(node), shift);
+	if (depth == 0)
+		return;
+
+	unsigned const next = depth - 1;
+	for (; is_Confirm(node); node = get_Confirm_value(node)) {
+		collect_from_fact(ctx, get_Confirm_relation(node),
+		                  get_Confirm_bound(node), upper, next, shift, bounds);
+	}
+
+	for (unsigned i = 0; i < ctx->n_facts; ++i) {
+		fact_t const *const fact = &ctx->facts[i];
+		if (skip_Confirm(fact->left) == node) {
+			collect_from_fact(ctx, fact->relation, fact->right, upper, next,
+			                  shift, bounds);
+		} else if (skip_Confirm(fact->right) == node) {
+			collect_from_fact(ctx, get_inversed_relation(fact->relation),
+			                  fact->left, upper, next, shift, bounds);
+		}
+	}
+
+	if (get_irn_mode(node) != ctx->mode)
+		return;
+	int64_t        c;
+	ir_node *const op = get_add_const(node, &c);
+	if (op != NULL) {
+		if (c != 0 && is_exact_add(ctx, op, c, next))
+			collect_bounds(ctx, op, upper, next, shift + c, bounds);
+	} else if (is_Phi(node)) {
+		collect_induction_bound(ctx, node, upper, next, shift, bounds);
+	}
+}
+
+/**
+ * Returns the relations still possible between @p left and @p right.
+ * A NULL node stands for the constant 0, both are offset by a constant.
+ */
+static ir_relation get_possible_relations(fact_ctx_t const *const ctx,
+                                          ir_node *const left,
+                                          int64_t const left_offset,
+                                          ir_node *const right,
+                                          int64_t const right_offset)
+{
+	bounds_t left_upper  = { .n = 0 };
+	bounds_t left_lower  = { .n = 0 };
+	bounds_t right_upper = { .n = 0 };
+	bounds_t right_lower = { .n = 0 };
+	collect_bounds(ctx, left,  true,  MAX_DEPTH, left_offset,  &left_upper);
+	collect_bounds(ctx, left,  false, MAX_DEPTH, left_offset,  &left_lower);
+	collect_bounds(ctx, right, true,  MAX_DEPTH, right_offset, &right_upper);
+	collect_bounds(ctx, right, false, MAX_DEPTH, right_offset, &right_lower);
+
+	/* the smallest known difference right - left and left - right */
+	int64_t right_minus_left = INT64_MIN;
+	int64_t left_minus_right = INT64_MIN;
+	for (unsigned i = 0; i < left_upper.n; ++i) {
+		bound_t const *const u = &left_upper.b[i];
+		for (unsigned j = 0; j < right_lower.n; ++j) {
+			bound_t const *const l = &right_lower.b[j];
+			if (u->base == l->base && l->offset - u->offset > right_minus_left)
+				right_minus_left = l->offset - u->offset;
+		}
+	}
+	for (unsigned i = 0; i < right_upper.n; ++i) {
+		bound_t const *const u = &right_upper.b[i];
+		for (unsigned j = 0; j < left_lower.n; ++j) {
+			bound_t const *const l = &left_lower.b[j];
+			if (u->base == l->base && l->offset - u->offset > left_minus_right)
+				left_minus_right = l->offset - u->offset;
+		}
+	}
+
+	ir_relation possible = ir_relation_less_equal_greater;
+	if (right_minus_left > 0)
+		possible &= ir_relation_less;
+	else if (right_minus_left == 0)
+		possible &= ir_relation_less_equal;
+	if (left_minus_right > 0)
+		possible &= ir_relation_greater;
+	else if (left_minus_right == 0)
+		possible &= ir_relation_greater_equal;
+	return possible;
+}
+
+/**
+ * Returns the signed value that an unsigned compare operand was converted
+ * from, or the value of a small constant.
+ */
+static bool get_signed_operand(ir_node *const node, ir_mode **const mode,
+                               ir_node **const value, int64_t *const offset)
+{
+	ir_node *const skipped = skip_Confirm(node);
+	if (is_Const(skipped)) {
+		int64_t c;
+		if (!get_const_value(skipped, &c)
+		 || c > get_signed_max(get_irn_mode(skipped)))
+			return false;
+		*value  = NULL;
+		*offset = c;
+		return true;
+	}
+	if (!is_Conv(skipped))
+		return false;
+	ir_node *const op      = get_Conv_op(skipped);
+	ir_mode *const op_mode = get_irn_mode(op);
+	if (!mode_is_int(op_mode) || !mode_is_signed(op_mode)
+	 || get_mode_size_bits(op_mode) != get_mode_size_bits(get_irn_mode(skipped))
+	 || (*mode != NULL && *mode != op_mode))
+		return false;
+	*mode   = op_mode;
+	*value  = op;
+	*offset = 0;
+	return true;
+}
+
+static bool is_non_negative(fact_ctx_t const *const ctx, ir_node *const node,
+                            int64_t const offset)
+{
+	bounds_t lower = { .n = 0 };
+	collect_bounds(ctx, node, false, MAX_DEPTH, offset, &lower);
+	for (unsigned i = 0; i < lower.n; ++i) {
+		if (lower.b[i].base == NULL && lower.b[i].offset >= 0)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Returns the relations possible between the operands of an unsigned compare
+ * of two converted signed values, if both are known to be non-negative.
+ */
+static ir_relation get_possible_signed_relations(ir_node *const block,
+                                                 ir_node *const left,
+                                                 ir_node *const right)
+{
+	ir_mode *mode = NULL;
+	ir_node *left_value;
+	ir_node *right_value;
+	int64_t  left_offset;
+	int64_t  right_offset;
+	if (!get_signed_operand(left, &mode, &left_value, &left_offset)
+	 || !get_signed_operand(right, &mode, &right_value, &right_offset)
+	 || mode == NULL)
+		return ir_relation_less_equal_greater;
+
+	fact_ctx_t ctx;
+	init_fact_ctx(&ctx, block, mode);
+	if (!is_non_negative(&ctx, left_value, left_offset)
+	 || !is_non_negative(&ctx, right_value, right_offset))
+		return ir_relation_less_equal_greater;
+	return get_possible_relations(&ctx, left_value, left_offset, right_value,
+	                              right_offset);
+}
+
+static void fold_cond(ir_node *const cond, bool const value)
+{
+	ir_node  *const block = get_nodes_block(cond);
+	ir_graph *const irg   = get_irn_irg(block);
+	ir_node  *const jmp   = new_r_Jmp(block);
+	ir_node  *const bad   = new_r_Bad(irg, mode_X);
+	ir_node *const in[] = {
+		[pn_Cond_false] = value ? bad : jmp,
+		[pn_Cond_true]  = value ? jmp : bad,
+	};
+	turn_into_tuple(cond, ARRAY_SIZE(in), in);
+	/* we might have removed the only exit of a loop */
+	keep_alive(block);
+}
+
+static void eliminate_compare(bounds_env_t *const env, ir_node *const node)
+{
+	ir_node *const cmp   = get_Cond_selector(node);
+	ir_node *const left  = get_Cmp_left(cmp);
+	ir_node *const right = get_Cmp_right(cmp);
+	ir_mode *const mode  = get_irn_mode(left);
+	if (!is_supported_mode(mode) || (is_Const(left) && is_Const(right)))
+		return;
+
+	++env->n_conds;
+
+	ir_node *const block = get_nodes_block(node);
+	fact_ctx_t     ctx;
+	init_fact_ctx(&ctx, block, mode);
+	ir_relation possible = get_possible_relations(&ctx, left, 0, right, 0);
+	if (!mode_is_signed(mode))
+		possible &= get_possible_signed_relations(block, left, right);
+
+	ir_relation const relation = get_Cmp_relation(cmp);
+	bool              value;
+	if ((possible & ~relation) == 0)
+		value = true;
+	else if ((possible & relation) == 0)
+		value = false;
+	else
+		return;
+
+	DB((dbg, LEVEL_2, "%+F in %+F is always %s\n", cmp, block,
+	    value ? "true" : "false"));
+	fold_cond(node, value);
+	++env->n_folded;
+}
+
+void opt_bounds_checks(ir_graph *irg)
+{
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+
+	FIRM_DBG_REGISTER(dbg, "firm.opt.bounds_checks");
+
+	DB((dbg, LEVEL_1, "===> Eliminating redundant compares in %+F\n", irg));
+
+	/* Blocks only kept alive by endless loops are not visited by the block
+	 * walker and have no valid dominance information, so we only look at
+	 * the Conds found by it. */
+	bounds_env_t env;
+	obstack_init(&env.obst);
+	env.conds    = NEW_ARR_F(ir_node*, 0);
+	env.n_conds  = 0;
+	env.n_folded = 0;
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
+	inc_irg_visited(irg);
+	irg_block_walk_graph(irg, collect_branch_fact, NULL, &env);
+
+	/* Folding a Cond only removes control flow edges, so dominance and the
+	 * collected facts stay valid for the remaining compares. */
+	for (size_t i = 0, n = ARR_LEN(env.conds); i < n; ++i)
+		eliminate_compare(&env, env.conds[i]);
+
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
+	DEL_ARR_F(env.conds);
+	obstack_free(&env.obst, NULL);
+
+	stat_ev_ctx_push_fmt("bounds_checks", "%+F", irg);
+	stat_ev_int("bounds_checks_conds", env.n_conds);
+	stat_ev_int("bounds_checks_folded", env.n_folded);
+	stat_ev_ctx_pop("bounds_checks");
+
+	if (env.n_folded > 0) {
+		remove_End_Bads_and_doublets(get_irg_end(irg));
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+	} else {
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+	}
+}
@@ -10,7 +10,9 @@
  *           Michael Beck
  */
 #include "ircons.h"
+#include "irdom_t.h"
 #include "irgopt.h"
+#include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "irop_t.h"
@@ -19,6 +21,7 @@
 typedef struct cf_env {
 	bool ignore_exc_edges; /**< set if exception edges should be ignored. */
 	bool changed;          /**< indicate that the cf graph has changed. */
+	bool update_dom;       /**< keep the dominance information valid. */
 } cf_env;
 
 /**
@@ -70,6 +73,8 @@ insert:;
 			ir_node *jmp = new_r_Jmp(new_block);
 			/* set successor of new block */
 			set_irn_n(block, i, jmp);
+			if (cenv->update_dom)
+				dom_split_edge(new_block, block);
 			cenv->changed = true;
 		}
 	}
@@ -80,13 +85,18 @@ void remove_critical_cf_edges_ex(ir_graph *irg, int ignore_exception_edges)
 	cf_env env;
 	env.ignore_exc_edges = ignore_exception_edges;
 	env.changed          = false;
+	env.update_dom       = irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 
 	irg_block_walk_graph(irg, NULL, walk_critical_cf_edges, &env);
 	if (env.changed) {
 		/* control flow changed */
-		clear_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL
-			& ~(IR_GRAPH_PROPERTY_ONE_RETURN
-				| IR_GRAPH_PROPERTY_MANY_RETURNS));
+		ir_graph_properties_t keep = IR_GRAPH_PROPERTY_ONE_RETURN
+		                           | IR_GRAPH_PROPERTY_MANY_RETURNS;
+		if (env.update_dom)
+			keep |= IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE;
+		clear_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL & ~keep);
+		if (env.update_dom)
+			dom_renumber_tree(irg);
 	}
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES);
 }
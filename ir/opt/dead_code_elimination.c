@@ -13,8 +13,16 @@
  * The only drawback is that the nodes still take up memory. This phase fixes
  * this by copying all (reachable) nodes to a new obstack and throwing away
  * the old one.
+ *
+ * Copying temporarily needs memory for the old and the new obstack at the
+ * same time. If only a small part of the obstack is garbage this is not worth
+ * it and the graph is compacted in place instead: The node indices are
+ * renumbered densely, so the index map and all index based data structures
+ * shrink, while the dead nodes stay on the obstack until a later run.
  */
+#include "array.h"
 #include "cgana.h"
+#include "debug.h"
 #include "iredges_t.h"
 #include "irgraph_t.h"
 #include "irgwalk.h"
@@ -25,8 +33,17 @@
 #include "irouts.h"
 #include "irtools.h"
 #include "pmap.h"
+#include "statev_t.h"
 #include "vrp.h"
 
+/**
+ * Copy the graph only if at least this fraction (in percent) of the obstack
+ * can be reclaimed. Otherwise compact in place.
+ */
+#define MIN_RECLAIM_PERCENT 25
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
 /**
  * Reroute the inputs of a node from nodes in the old graph to copied nodes in
  * the new graph
@@ -64,6 +81,60 @@ static void copy_graph_env(ir_graph *irg)
 	irg->anchor = new_anchor;
 }
 
+static size_t get_node_size(ir_node const *const node)
+{
+	size_t size = offsetof(ir_node, attr) + node->op->attr_size;
+	if (!is_irn_dynamic(node))
+		size += (get_irn_arity(node) + 1) * sizeof(ir_node*);
+	return size;
+}
+
+static void count_node(ir_node *node, void *env)
+{
+	(void)node;
+	size_t *const n_nodes = (size_t*)env;
+	++*n_nodes;
+}
+
+/**
+ * Estimates the obstack memory of nodes which were not reached by the last
+ * walk. Only the node itself and its static in array are counted, memory
+ * allocated separately for the node (e.g. dynamic in arrays) is not.
+ */
+static size_t get_dead_node_bytes(ir_graph const *const irg)
+{
+	size_t bytes = 0;
+	for (unsigned i = 0, n = irg->last_node_idx; i < n; ++i) {
+		ir_node const *const node = irg->idx_irn_map[i];
+		if (node != NULL && !irn_visited(node))
+			bytes += get_node_size(node);
+	}
+	return bytes;
+}
+
+static void renumber_node(ir_node *node, void *env)
+{
+	ir_graph *const irg = (ir_graph*)env;
+	node->node_idx = irg_register_node_idx(irg, node);
+	node->link     = NULL;
+}
+
+static void remember_node(ir_node *node, void *env)
+{
+	(void)env;
+	add_identities(node);
+}
+
+/**
+ * Renumbers the reachable nodes densely without moving them and enters them
+ * into the (new) value table, like copying does.
+ */
+static void compact_graph_in_place(ir_graph *irg)
+{
+	irg->last_node_idx = 0;
+	irg_walk_in_or_dep(irg->anchor, renumber_node, remember_node, irg);
+}
+
 /**
  * Copies all reachable nodes to a new obstack.  Removes bad inputs
  * from block nodes and the corresponding inputs from Phi nodes.
@@ -74,6 +145,7 @@ static void copy_graph_env(ir_graph *irg)
  */
 void dead_node_elimination(ir_graph *irg)
 {
+	FIRM_DBG_REGISTER(dbg, "firm.opt.dce");
 	edges_deactivate(irg);
 
 	/* Handle graph state */
@@ -81,24 +153,55 @@ void dead_node_elimination(ir_graph *irg)
 	free_irg_outs(irg);
 	free_loop_information(irg);
 	free_vrp_data(irg);
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+	                         | IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 
-	/* A quiet place, where the old obstack can rest in peace,
-	   until it will be cremated. */
-	struct obstack graveyard_obst = irg->obst;
-
-	/* A new obstack, where the reachable nodes will be copied to. */
-	obstack_init(&irg->obst);
-	irg->last_node_idx = 0;
+	size_t n_live_nodes = 0;
+	irg_walk_in_or_dep(irg->anchor, count_node, NULL, &n_live_nodes);
+	size_t const n_old_nodes = irg->last_node_idx;
+	size_t const dead_bytes  = irg->dead_node_bytes + get_dead_node_bytes(irg);
+	size_t const used        = obstack_memory_used(&irg->obst);
+	size_t       peak        = used;
+	bool   const copy        = dead_bytes * 100 >= used * MIN_RECLAIM_PERCENT;
 
 	/* We also need a new value table for CSE */
 	new_identities(irg);
 
-	/* Copy the graph from the old to the new obstack */
-	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
-	copy_graph_env(irg);
-	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+	if (copy) {
+		/* A quiet place, where the old obstack can rest in peace,
+		   until it will be cremated. */
+		struct obstack graveyard_obst = irg->obst;
+
+		/* A new obstack, where the reachable nodes will be copied to. */
+		obstack_init(&irg->obst);
+		irg->last_node_idx = 0;
+
+		/* Copy the graph from the old to the new obstack */
+		ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+		copy_graph_env(irg);
+		ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+
+		peak += obstack_memory_used(&irg->obst);
+		/* Free memory from old unoptimized obstack */
+		obstack_free(&graveyard_obst, 0);  /* First empty the obstack ... */
+		irg->dead_node_bytes = 0;
+	} else {
+		compact_graph_in_place(irg);
+		irg->dead_node_bytes = dead_bytes;
+	}
+
+	/* the indices of dead nodes are gone, shrink the index map */
+	ARR_RESIZE(ir_node*, irg->idx_irn_map, irg->last_node_idx);
 
-	/* Free memory from old unoptimized obstack */
-	obstack_free(&graveyard_obst, 0);  /* First empty the obstack ... */
+	DB((dbg, LEVEL_1, "%+F: %zu of %zu nodes live, about %zu of %zu bytes dead, %s\n",
+	    irg, n_live_nodes, n_old_nodes, dead_bytes, used,
+	    copy ? "copied" : "compacted in place"));
+	stat_ev_ctx_push_fmt("dead_node_elimination", "%+F", irg);
+	stat_ev_ull("dce_nodes_before", n_old_nodes);
+	stat_ev_ull("dce_nodes_after", n_live_nodes);
+	stat_ev_ull("dce_obst_before", used);
+	stat_ev_ull("dce_obst_after", obstack_memory_used(&irg->obst));
+	stat_ev_ull("dce_obst_peak", peak);
+	stat_ev_int("dce_copied", copy);
+	stat_ev_ctx_pop("dead_node_elimination");
 }
@@ -8,6 +8,7 @@
  * @brief    Removal of unreachable methods.
  * @author   Matthias Braun
  */
+#include "array.h"
 #include "debug.h"
 #include "entity_t.h"
 #include "irgwalk.h"
@@ -107,15 +108,17 @@ static void visit_segment(ir_type *segment)
 
 static void garbage_collect_in_segment(ir_type *segment)
 {
-	for (int i = get_compound_n_members(segment); i-- > 0; ) {
+	ir_entity **dead = NEW_ARR_F(ir_entity*, 0);
+	for (size_t i = 0, n = get_compound_n_members(segment); i < n; ++i) {
 		ir_entity *entity = get_compound_member(segment, i);
 		if (entity_visited(entity))
 			continue;
 
 		DB((dbg, LEVEL_1, "  removing entity %+F\n", entity));
-
-		free_entity(entity);
+		ARR_APP1(ir_entity*, dead, entity);
 	}
+	free_entities(ARR_LEN(dead), dead);
+	DEL_ARR_F(dead);
 }
 
 void garbage_collect_entities(void)
@@ -134,18 +137,19 @@ void garbage_collect_entities(void)
 		visit_segment(type);
 	}
 
-	/* remove graphs of non-visited functions
-	 * (we have to count backwards, because freeing the graph moves the last
-	 *  graph in the list to the free position) */
-	foreach_irp_irg_r(i, irg) {
+	/* remove graphs of non-visited functions */
+	ir_graph **dead = NEW_ARR_F(ir_graph*, 0);
+	foreach_irp_irg(i, irg) {
 		ir_entity *entity = get_irg_entity(irg);
 
 		if (entity_visited(entity))
 			continue;
 
 		DB((dbg, LEVEL_1, "  freeing method %+F\n", entity));
-		free_ir_graph(irg);
+		ARR_APP1(ir_graph*, dead, irg);
 	}
+	free_ir_graphs(ARR_LEN(dead), dead);
+	DEL_ARR_F(dead);
 
 	/* we can now remove all non-visited (global) entities */
 	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
@@ -95,12 +95,15 @@ void gc_irgs(size_t n_keep, ir_entity ** keep_arr)
 	}
 
 	/* clean */
-	foreach_irp_irg_r(i, irg) {
+	ir_graph **dead = NEW_ARR_F(ir_graph*, 0);
+	foreach_irp_irg(i, irg) {
 		ir_entity *ent = get_irg_entity(irg);
 		if (get_entity_link(ent) == MARK)
 			continue;
 
 		DB((dbg, LEVEL_1, "  freeing method %+F\n", ent));
-		free_ir_graph(irg);
+		ARR_APP1(ir_graph*, dead, irg);
 	}
+	free_ir_graphs(ARR_LEN(dead), dead);
+	DEL_ARR_F(dead);
 }
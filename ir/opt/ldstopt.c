@@ -1680,6 +1680,89 @@ static unsigned hash_cache_entry(const avail_entry_t *entry)
 	return get_irn_idx(entry->ptr)*9 + hash_ptr(entry->mode);
 }
 
+/** Maximum depth of an address computation moved in front of a loop. */
+#define MAX_ADDRESS_DEPTH 4
+
+/**
+ * Check if an address is loop invariant: It is a region constant or a
+ * computation of floating nodes from region constants, which can be moved in
+ * front of the loop.
+ *
+ * @param ptr           the address
+ * @param header_block  the header block of the loop
+ * @param depth         the maximum depth of the computation
+ */
+static bool is_loop_invariant_address(ir_node *ptr, ir_node *header_block,
+                                      unsigned depth)
+{
+	if (is_rc(ptr, header_block))
+		return true;
+	if (depth == 0 || is_Proj(ptr) || is_Phi(ptr)
+	    || get_irn_pinned(ptr) != op_pin_state_floats)
+		return false;
+	foreach_irn_in(ptr, i, pred) {
+		if (!is_loop_invariant_address(pred, header_block, depth - 1))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Move the computation of a loop invariant address into a block in front of
+ * the loop.
+ */
+static void move_address_out_of_loop(ir_node *ptr, ir_node *header_block,
+                                     ir_node *block)
+{
+	if (is_rc(ptr, header_block))
+		return;
+	foreach_irn_in(ptr, i, pred) {
+		move_address_out_of_loop(pred, header_block, block);
+	}
+	set_nodes_block(ptr, block);
+}
+
+/**
+ * Check if a Load can be executed in front of a loop without introducing a
+ * fault, even if the loop would not have executed it. This is the case for
+ * addresses of entities and for addresses that are accessed in front of the
+ * loop or in the header block, which is always executed when entering the
+ * loop.
+ *
+ * @param load          the Load
+ * @param header_block  the header block of the loop
+ */
+static bool is_non_faulting_load(ir_node *load, ir_node *header_block)
+{
+	if (get_nodes_block(load) == header_block)
+		return true;
+
+	ir_node  *ptr   = get_Load_ptr(load);
+	ir_node  *frame = get_irg_frame(get_irn_irg(load));
+	for (ir_node *base = ptr; ; base = get_Member_ptr(base)) {
+		if (is_Address(base) || base == frame)
+			return true;
+		if (!is_Member(base))
+			break;
+	}
+
+	unsigned  load_size = get_mode_size_bytes(get_Load_mode(load));
+	foreach_out_edge(ptr, edge) {
+		ir_node *user = get_edge_src_irn(edge);
+		unsigned size;
+		if (is_Load(user) && get_Load_ptr(user) == ptr) {
+			size = get_mode_size_bytes(get_Load_mode(user));
+		} else if (is_Store(user) && get_Store_ptr(user) == ptr) {
+			size = get_mode_size_bytes(get_irn_mode(get_Store_value(user)));
+		} else {
+			continue;
+		}
+		if (size >= load_size && is_rc(user, header_block))
+			return true;
+	}
+	return false;
+}
+
 /**
  * Move loops out of loops if possible.
  *
@@ -1721,6 +1804,9 @@ static void move_loads_out_of_loops(scc *pscc, loop_env *env)
 	if (phi_list->next != NULL)
 		return;
 
+	/* the memory enters the loop in its header */
+	ir_node *header_block = get_nodes_block(phi_list->phi);
+
 	set *avail = new_set(cmp_avail_entry, 8);
 
 	for (ir_node *load = pscc->head, *next; load != NULL; load = next) {
@@ -1737,8 +1823,9 @@ static void move_loads_out_of_loops(scc *pscc, loop_env *env)
 			    || info->projs[pn_Load_X_except] != NULL)
 				continue;
 
-			/* for now, we can only move Load(Global) */
-			if (!is_Address(ptr))
+			/* the Load is executed speculatively in front of the loop */
+			if (!is_loop_invariant_address(ptr, header_block, MAX_ADDRESS_DEPTH)
+			    || !is_non_faulting_load(load, header_block))
 				continue;
 			ir_type  *load_type  = get_Load_type(load);
 			ir_mode  *load_mode  = get_Load_mode(load);
@@ -1785,6 +1872,7 @@ static void move_loads_out_of_loops(scc *pscc, loop_env *env)
 					if (res != NULL) {
 						irn = res->load;
 					} else {
+						move_address_out_of_loop(ptr, header_block, pred);
 						irn        = new_rd_Load(db, pred, get_Phi_pred(phi, pos), ptr, load_mode, load_type, cons_none);
 						entry.load = irn;
 						(void)set_insert(avail_entry_t, avail, &entry, sizeof(entry), hash_cache_entry(&entry));
@@ -2123,6 +2211,245 @@ static int cmp_ptrs(const void *p0, const void *p1)
 	return (bo0.offset > bo1.offset) - (bo0.offset < bo1.offset);
 }
 
+/** Maximum number of Load pairs merged for a single packed Store. */
+#define MAX_PACKED_LOADS 4
+/** Maximum depth of the expression trees packed into a superword. */
+#define MAX_PACK_DEPTH   3
+
+/** A pair of adjacent Loads replaced by a single wide Load. */
+typedef struct packed_load_t {
+	ir_node *load0; /**< the Load from the lower address */
+	ir_node *load1; /**< the Load from the higher address */
+	ir_node *wide;  /**< the combined Load */
+} packed_load_t;
+
+/** Environment for packing two isomorphic expression trees. */
+typedef struct pack_env_t {
+	unsigned      lane_size;   /**< size of a single lane in bytes */
+	ir_mode      *lane_mode;   /**< unsigned mode of a single lane */
+	ir_mode      *packed_mode; /**< mode of the packed value */
+	ir_node      *block;       /**< block where arithmetic is constructed */
+	unsigned      n_loads;     /**< number of entries in loads */
+	packed_load_t loads[MAX_PACKED_LOADS];
+} pack_env_t;
+
+static ir_type *combine_types(ir_type *type0, ir_type *type1, char const *name)
+{
+	if (type0 == type1)
+		return type0;
+
+	/* Construct an anonymous struct type for the combined operation. */
+	ir_type *type = new_type_struct(id_unique(name));
+	new_entity(type, id_unique("__part"), type0);
+	new_entity(type, id_unique("__part"), type1);
+	return type;
+}
+
+/**
+ * Checks whether the value @p node is only used by the expression we are
+ * about to pack, so packing does not duplicate any work.
+ */
+static bool is_single_use(ir_node const *node)
+{
+	return get_irn_n_edges(node) == 1;
+}
+
+static bool can_pack_lanes(pack_env_t *env, ir_node *val0, ir_node *val1,
+                           unsigned depth);
+
+/**
+ * Checks whether the results of two Loads from adjacent addresses can be
+ * replaced by a single wide Load and records the pair in @p env.
+ */
+static bool can_pack_loads(pack_env_t *env, ir_node *load0, ir_node *load1)
+{
+	if (env->n_loads >= MAX_PACKED_LOADS
+	 || get_Load_volatility(load0) == volatility_is_volatile
+	 || get_Load_volatility(load1) == volatility_is_volatile
+	 || ir_throws_exception(load0) || ir_throws_exception(load1)
+	 || get_Load_mem(load0) != get_Load_mem(load1)
+	 || get_nodes_block(load0) != get_nodes_block(load1)
+	 || get_mode_size_bytes(get_Load_mode(load0)) != env->lane_size
+	 || get_mode_size_bytes(get_Load_mode(load1)) != env->lane_size)
+		return false;
+
+	base_offset_t base0;
+	base_offset_t base1;
+	get_base_and_offset(get_Load_ptr(load0), &base0);
+	get_base_and_offset(get_Load_ptr(load1), &base1);
+	if (base0.base   != base1.base
+	 || base1.offset != base0.offset + (long)env->lane_size)
+		return false;
+
+	/* a Load may only be part of a single pair */
+	for (unsigned i = 0; i < env->n_loads; ++i) {
+		packed_load_t const *const pair = &env->loads[i];
+		if (pair->load0 == load0 || pair->load1 == load0
+		 || pair->load0 == load1 || pair->load1 == load1)
+			return false;
+	}
+
+	packed_load_t *const pair = &env->loads[env->n_loads++];
+	pair->load0 = load0;
+	pair->load1 = load1;
+	pair->wide  = NULL;
+	return true;
+}
+
+/**
+ * Checks whether a value in the packed mode whose in-memory representation
+ * is @p val0 followed by @p val1 can be built.  This is the superword-level
+ * parallelism idea applied to general purpose registers: isomorphic
+ * lane-wise operations (Loads from adjacent addresses, constants and bitwise
+ * logic) are combined into a single operation on a twice as wide integer.
+ * No nodes are created, the Load pairs are recorded in @p env.
+ */
+static bool can_pack_lanes(pack_env_t *env, ir_node *val0, ir_node *val1,
+                           unsigned depth)
+{
+	if (depth > MAX_PACK_DEPTH || get_irn_mode(val0) != get_irn_mode(val1))
+		return false;
+	ir_mode *mode = get_irn_mode(val0);
+	if (get_mode_arithmetic(mode) != irma_twos_complement
+	 || get_mode_size_bytes(mode) != env->lane_size)
+		return false;
+
+	if (is_Const(val0) && is_Const(val1))
+		return true;
+
+	if (val0 == val1 || !is_single_use(val0) || !is_single_use(val1)
+	 || get_irn_op(val0) != get_irn_op(val1))
+		return false;
+
+	if (is_Proj(val0)) {
+		ir_node *pred0 = get_Proj_pred(val0);
+		ir_node *pred1 = get_Proj_pred(val1);
+		return is_Load(pred0) && is_Load(pred1)
+		    && get_Proj_num(val0) == pn_Load_res
+		    && get_Proj_num(val1) == pn_Load_res
+		    && can_pack_loads(env, pred0, pred1);
+	}
+
+	/* bitwise operations do not carry between lanes */
+	if (is_Not(val0))
+		return can_pack_lanes(env, get_Not_op(val0), get_Not_op(val1),
+		                      depth + 1);
+	if (is_And(val0) || is_Or(val0) || is_Eor(val0)) {
+		return can_pack_lanes(env, get_binop_left(val0), get_binop_left(val1),
+		                      depth + 1)
+		    && can_pack_lanes(env, get_binop_right(val0),
+		                      get_binop_right(val1), depth + 1);
+	}
+	return false;
+}
+
+/**
+ * Creates the wide Load for the pair recorded for @p load0.  The Loads are
+ * not modified yet, they are merged by commit_packed_loads().
+ */
+static ir_node *pack_loads(pack_env_t *env, ir_node *load0)
+{
+	for (unsigned i = 0; i < env->n_loads; ++i) {
+		packed_load_t *const pair = &env->loads[i];
+		if (pair->load0 != load0)
+			continue;
+
+		ir_node *load1 = pair->load1;
+		ir_type *type  = combine_types(get_Load_type(load0),
+		                               get_Load_type(load1),
+		                               "__combined_Load");
+		ir_cons_flags flags = cons_unaligned;
+		if (!get_irn_pinned(load0) || !get_irn_pinned(load1))
+			flags |= cons_floats;
+		dbg_info *dbgi  = get_irn_dbg_info(load0);
+		ir_node  *block = get_nodes_block(load0);
+		pair->wide = new_rd_Load(dbgi, block, get_Load_mem(load0),
+		                         get_Load_ptr(load0), env->packed_mode, type,
+		                         flags);
+		return new_r_Proj(pair->wide, env->packed_mode, pn_Load_res);
+	}
+	panic("no Load pair recorded for %+F", load0);
+}
+
+/**
+ * Packs two constants into a single constant of the packed mode, the value
+ * @p tv0 being located at the lower address.
+ */
+static ir_node *pack_consts(pack_env_t *env, ir_tarval *tv0, ir_tarval *tv1)
+{
+	if (ir_target_big_endian()) {
+		ir_tarval *tmp = tv0;
+		tv0 = tv1;
+		tv1 = tmp;
+	}
+	ir_mode   *lane_mode   = env->lane_mode;
+	ir_mode   *packed_mode = env->packed_mode;
+	ir_tarval *low  = tarval_convert_to(tarval_convert_to(tv0, lane_mode),
+	                                    packed_mode);
+	ir_tarval *high = tarval_convert_to(tarval_convert_to(tv1, lane_mode),
+	                                    packed_mode);
+	high = tarval_shl_unsigned(high, env->lane_size * 8);
+	ir_graph *irg = get_irn_irg(env->block);
+	return new_r_Const(irg, tarval_or(low, high));
+}
+
+/**
+ * Builds the packed value of @p val0 and @p val1 after can_pack_lanes()
+ * succeeded for them.
+ */
+static ir_node *pack_lanes(pack_env_t *env, ir_node *val0, ir_node *val1)
+{
+	if (is_Const(val0))
+		return pack_consts(env, get_Const_tarval(val0), get_Const_tarval(val1));
+	if (is_Proj(val0))
+		return pack_loads(env, get_Proj_pred(val0));
+
+	dbg_info *dbgi  = get_irn_dbg_info(val0);
+	ir_node  *block = env->block;
+	if (is_Not(val0)) {
+		ir_node *op = pack_lanes(env, get_Not_op(val0), get_Not_op(val1));
+		return new_rd_Not(dbgi, block, op);
+	}
+	ir_node *left  = pack_lanes(env, get_binop_left(val0),
+	                            get_binop_left(val1));
+	ir_node *right = pack_lanes(env, get_binop_right(val0),
+	                            get_binop_right(val1));
+	if (is_And(val0))
+		return new_rd_And(dbgi, block, left, right);
+	if (is_Or(val0))
+		return new_rd_Or(dbgi, block, left, right);
+	assert(is_Eor(val0));
+	return new_rd_Eor(dbgi, block, left, right);
+}
+
+/**
+ * Replaces the Load pairs recorded in @p env by their wide Loads.  The memory
+ * users of the old Loads are rerouted to the wide Load, the result Projs die
+ * together with the Stores that are replaced by the caller.
+ */
+static void commit_packed_loads(pack_env_t *env, ir_node **sync_in,
+                                int n_sync_in)
+{
+	for (unsigned i = 0; i < env->n_loads; ++i) {
+		packed_load_t const *const pair   = &env->loads[i];
+		ir_node             *const new_mem
+			= new_r_Proj(pair->wide, mode_M, pn_Load_M);
+		ir_node *const loads[] = { pair->load0, pair->load1 };
+		for (size_t l = 0; l < ARRAY_SIZE(loads); ++l) {
+			ir_node *const old_mem = get_Proj_for_pn(loads[l], pn_Load_M);
+			if (old_mem == NULL)
+				continue;
+			for (int s = 0; s < n_sync_in; ++s) {
+				if (sync_in[s] == old_mem)
+					sync_in[s] = new_mem;
+			}
+			exchange(old_mem, new_mem);
+		}
+		DBG((dbg, LEVEL_1, "combined %+F and %+F into %+F\n", pair->load0,
+		     pair->load1, pair->wide));
+	}
+}
+
 static void combine_memop(ir_node *sync, void *data)
 {
 	(void)data;
@@ -2198,63 +2525,64 @@ again:;
 			 || base1.offset != base0.offset + (long)(store_size))
 				continue;
 
-			/* sort values according to endianess */
-			if (ir_target_big_endian()) {
-				ir_node *tmp = store_val;
-				store_val  = store_val1;
-				store_val1 = tmp;
-			}
+			ir_node  *block = get_nodes_block(store0);
+			pack_env_t pack = {
+				.lane_size   = store_size,
+				.lane_mode   = mode_unsigned,
+				.packed_mode = double_mode,
+				.block       = block,
+			};
+			ir_node *packed;
+			if (can_pack_lanes(&pack, store_val, store_val1, 0)) {
+				packed = pack_lanes(&pack, store_val, store_val1);
+				commit_packed_loads(&pack, new_in, n_preds);
+				/* the Stores may have used the memory of a merged Load */
+				mem = get_Store_mem(store0);
+			} else {
+				/* sort values according to endianess */
+				if (ir_target_big_endian()) {
+					ir_node *tmp = store_val;
+					store_val  = store_val1;
+					store_val1 = tmp;
+				}
 
-			/* Abort optimisation if we can't guarantee that the extra
-			 * arithmetic code below will disappear. */
-			if (!is_Const(store_val1)) {
-				if (!is_Shr(store_val1))
-					continue;
-				ir_node *shiftval = get_Shr_right(store_val1);
-				if (!is_Const(shiftval))
-					continue;
-				ir_tarval *tv = get_Const_tarval(shiftval);
-				if (!tarval_is_long(tv)
-				    || get_tarval_long(tv) != (long)store_size*8)
-					continue;
-			}
+				/* Abort optimisation if we can't guarantee that the extra
+				 * arithmetic code below will disappear. */
+				if (!is_Const(store_val1)) {
+					if (!is_Shr(store_val1))
+						continue;
+					ir_node *shiftval = get_Shr_right(store_val1);
+					if (!is_Const(shiftval))
+						continue;
+					ir_tarval *tv = get_Const_tarval(shiftval);
+					if (!tarval_is_long(tv)
+					    || get_tarval_long(tv) != (long)store_size*8)
+						continue;
+				}
 
-			/* Combine types if necessary */
-			ir_type *type0 = get_Store_type(store0);
-			ir_type *type1 = get_Store_type(store1);
-			ir_type *type;
-			if (type0 != type1) {
-				/* Construct an anonymous struct type
-				 * for the combined Store.
-				 */
-				ident *struct_id = id_unique("__combined_Store");
-				type = new_type_struct(struct_id);
-				ident *member0_id = id_unique("__Store_part");
-				new_entity(type, member0_id, type0);
-				ident *member1_id = id_unique("__Store_part");
-				new_entity(type, member1_id, type1);
-			} else {
-				type = type0;
+				/* combine values */
+				ir_graph *irg    = get_irn_irg(store0);
+				ir_node  *convu0 = new_r_Conv(block, store_val, mode_unsigned);
+				ir_node  *conv0  = new_r_Conv(block, convu0, double_mode);
+				ir_node  *convu1 = new_r_Conv(block, store_val1, mode_unsigned);
+				ir_node  *conv1  = new_r_Conv(block, convu1, double_mode);
+				ir_node  *cnst   = new_r_Const_long(irg, mode_Iu, store_size*8);
+				ir_node  *shl    = new_r_Shl(block, conv1, cnst);
+				packed = new_r_Or(block, conv0, shl);
 			}
 
-			/* combine values */
-			dbg_info *dbgi   = get_irn_dbg_info(store0);
-			ir_node  *block  = get_nodes_block(store0);
-			ir_graph *irg    = get_irn_irg(store0);
-			ir_node  *convu0 = new_r_Conv(block, store_val, mode_unsigned);
-			ir_node  *conv0  = new_r_Conv(block, convu0, double_mode);
-			ir_node  *convu1 = new_r_Conv(block, store_val1, mode_unsigned);
-			ir_node  *conv1  = new_r_Conv(block, convu1, double_mode);
-			ir_node  *cnst   = new_r_Const_long(irg, mode_Iu, store_size*8);
-			ir_node  *shl    = new_r_Shl(block, conv1, cnst);
-			ir_node  *or     = new_r_Or(block, conv0, shl);
+			/* Combine types if necessary */
+			ir_type *type = combine_types(get_Store_type(store0),
+			                              get_Store_type(store1),
+			                              "__combined_Store");
 
 			/* create a new store and replace the two small stores */
+			dbg_info     *dbgi  = get_irn_dbg_info(store0);
 			ir_cons_flags flags = cons_unaligned;
 			if (!get_irn_pinned(store0) || !get_irn_pinned(store1))
 				flags |= cons_floats;
-			ir_node *new_store
-				= new_rd_Store(dbgi, block, mem, store_ptr0, or, type, flags);
+			ir_node *new_store = new_rd_Store(dbgi, block, mem, store_ptr0,
+			                                  packed, type, flags);
 			exchange(store0, new_store);
 			exchange(store1, new_store);
 			new_in[i]  = pred0;
@@ -2290,7 +2618,12 @@ void combine_memops(ir_graph *irg)
 	if (!ir_target.fast_unaligned_memaccess)
 		return;
 
+	FIRM_DBG_REGISTER(dbg, "firm.opt.ldstopt");
+
+	/* packing needs to know whether values are used elsewhere */
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
 	irg_walk_graph(irg, combine_memop, NULL, NULL);
+	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
 }
 
 void optimize_load_store(ir_graph *irg)
@@ -0,0 +1,1106 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2017 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Interchange and tiling of perfectly nested counted loops
+ *
+ * Looks at nests of two head controlled counted loops, where the outer loop
+ * contains nothing but the inner loop and the control of both loops. If the
+ * memory accesses of the inner loop stride through memory along the inner
+ * induction variable but are contiguous along the outer one, the loops are
+ * interchanged. Instead of moving blocks, the init, step and bound of both
+ * loops are exchanged and the uses of both induction variables in the inner
+ * loop are swapped.
+ *
+ * If accesses with a large stride remain, the inner loop is additionally
+ * strip mined and the loop over the strips is moved outside of the nest, so
+ * the outer loop iterates over a tile of the iteration space at a time.
+ *
+ * Both transformations are legal if no dependence between two iterations
+ * reverses its direction: Addresses are decomposed into a base plus a linear
+ * combination of both induction variables, and the difference of the
+ * addresses of a Store and any other access of the same base is bounded with
+ * the trip counts of the loops.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irloop_t.h"
+#include "irnode_t.h"
+#include "iroptimize.h"
+#include "irouts_t.h"
+#include "irtools.h"
+#include "tv.h"
+#include "type_t.h"
+#include "util.h"
+#include <inttypes.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+#define MAX_ACCESSES 64
+#define MAX_DEPTH    8
+/** Limit for the coefficients of address decompositions, keeps products of
+ * them with trip counts below RANGE_LIMIT in range. */
+#define COEF_LIMIT   ((int64_t)1 << 30)
+#define RANGE_LIMIT  ((int64_t)1 << 31)
+
+typedef struct counted_loop_t {
+	ir_loop     *loop;
+	ir_node     *header;
+	int          entry;      /**< index of the entry edge of header */
+	ir_node     *phi;        /**< the induction variable */
+	ir_node     *incr;       /**< Add of phi and step */
+	int          step_pos;   /**< index of step in incr */
+	ir_node     *step;
+	ir_node     *cond;
+	ir_node     *cmp;
+	ir_node     *bound;
+	ir_relation  relation;   /**< relation of phi and bound inside the loop */
+	bool         stay_true;  /**< whether the true Proj of cond stays */
+	ir_node     *exit_block; /**< the block cond leaves the loop to */
+	int          exit_pos;   /**< index of the exit edge of exit_block */
+	int64_t      range;      /**< maximal distance of two values of phi */
+} counted_loop_t;
+
+typedef struct access_t {
+	ir_node  *node;       /**< the Load or Store */
+	ir_type  *type;
+	unsigned  size;
+	ir_node  *base;       /**< loop invariant base pointer */
+	int64_t   coef[2];    /**< factors of the outer and the inner variable */
+	int64_t   offset;
+	bool      symbolic[2];/**< the factor is not a constant */
+	bool      affine;     /**< the address is exactly base+coef*ivs+offset */
+	bool      decomposed; /**< the address is linear in the ivs at all */
+} access_t;
+
+typedef struct nest_t {
+	counted_loop_t outer;
+	counted_loop_t inner;
+	ir_node      **carried;  /**< Phis of the outer header besides the iv */
+	ir_node      **moved;    /**< nodes to move into the inner loop */
+	size_t         n_accesses;
+	access_t       accesses[MAX_ACCESSES];
+} nest_t;
+
+static int64_t abs64(int64_t const value)
+{
+	return value < 0 ? -value : value;
+}
+
+static bool block_in_loop(ir_node const *const block, ir_loop const *const loop)
+{
+	for (ir_loop *l = get_irn_loop(block); l != NULL;) {
+		if (l == loop)
+			return true;
+		ir_loop *const outer = get_loop_outer_loop(l);
+		if (outer == l)
+			break;
+		l = outer;
+	}
+	return false;
+}
+
+static bool in_loop(ir_node const *const node, ir_loop const *const loop)
+{
+	ir_node const *const block = is_Block(node) ? node : get_nodes_block(node);
+	return block_in_loop(block, loop);
+}
+
+static bool find_header(ir_loop *const loop, counted_loop_t *const cl)
+{
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_loop) {
+			if (!find_header(element.son, cl))
+				return false;
+			continue;
+		}
+		ir_node *const block = element.node;
+		for (int p = 0, n = get_Block_n_cfgpreds(block); p < n; ++p) {
+			ir_node *const pred = get_Block_cfgpred_block(block, p);
+			if (pred == NULL || is_Bad(pred))
+				return false;
+			if (block_in_loop(pred, cl->loop))
+				continue;
+			/* more than one entry */
+			if (cl->header != NULL)
+				return false;
+			cl->header = block;
+			cl->entry  = p;
+		}
+	}
+	return true;
+}
+
+/**
+ * Checks that control flow only leaves the blocks of @p loop through the
+ * Cond of its header.
+ */
+static bool has_single_exit(ir_loop *const loop, counted_loop_t const *const cl)
+{
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_loop) {
+			if (!has_single_exit(element.son, cl))
+				return false;
+			continue;
+		}
+		ir_node *const block = element.node;
+		if (block == cl->header)
+			continue;
+		for (unsigned s = 0, n = get_Block_n_cfg_outs(block); s < n; ++s) {
+			if (!block_in_loop(get_Block_cfg_out(block, s), cl->loop))
+				return false;
+		}
+	}
+	return true;
+}
+
+static bool is_nest_invariant(nest_t const *const nest, ir_node const *const node)
+{
+	return !in_loop(node, nest->outer.loop);
+}
+
+/**
+ * Recognizes a loop controlled by the compare of an induction variable with
+ * a bound in its header. Init, step and bound must be invariant in the nest.
+ */
+static bool analyze_counted_loop(nest_t const *const nest, counted_loop_t *const cl)
+{
+	if (!find_header(cl->loop, cl))
+		return false;
+	ir_node *const header = cl->header;
+	if (header == NULL || get_Block_n_cfgpreds(header) != 2)
+		return false;
+	if (get_Block_n_cfg_outs(header) != 2 || !has_single_exit(cl->loop, cl))
+		return false;
+
+	ir_node *cond = NULL;
+	foreach_irn_out(header, i, node) {
+		if (is_Cond(node) && get_nodes_block(node) == header)
+			cond = node;
+	}
+	if (cond == NULL)
+		return false;
+	ir_node *const cmp = get_Cond_selector(cond);
+	if (!is_Cmp(cmp) || get_irn_n_outs(cmp) != 1)
+		return false;
+
+	ir_node    *phi      = get_Cmp_left(cmp);
+	ir_node    *bound    = get_Cmp_right(cmp);
+	ir_relation relation = get_Cmp_relation(cmp);
+	if (!is_Phi(phi) || get_nodes_block(phi) != header) {
+		ir_node *const tmp = phi;
+		phi      = bound;
+		bound    = tmp;
+		relation = get_inversed_relation(relation);
+	}
+	if (!is_Phi(phi) || get_nodes_block(phi) != header
+	    || !mode_is_int(get_irn_mode(phi)))
+		return false;
+
+	unsigned n_stay = 0;
+	foreach_irn_out(cond, i, proj) {
+		if (get_irn_n_outs(proj) != 1)
+			return false;
+		int      pos;
+		ir_node *target = get_irn_out_ex(proj, 0, &pos);
+		if (block_in_loop(target, cl->loop)) {
+			cl->stay_true = get_Proj_num(proj) == pn_Cond_true;
+			++n_stay;
+		} else {
+			cl->exit_block = target;
+			cl->exit_pos   = pos;
+		}
+	}
+	if (n_stay != 1 || cl->exit_block == NULL)
+		return false;
+	if (!cl->stay_true)
+		relation = get_negated_relation(relation);
+
+	ir_node *const init = get_Phi_pred(phi, cl->entry);
+	ir_node *const incr = get_Phi_pred(phi, 1 - cl->entry);
+	if (!is_Add(incr) || get_irn_n_outs(incr) != 1
+	    || !in_loop(incr, cl->loop))
+		return false;
+	int const step_pos = get_Add_left(incr) == phi ? n_Add_right : n_Add_left;
+	ir_node *const step = get_irn_n(incr, step_pos);
+	if (get_irn_n(incr, 1 - step_pos) != phi || !is_Const(step)
+	    || !tarval_is_long(get_Const_tarval(step)))
+		return false;
+	if (!is_nest_invariant(nest, init) || !is_nest_invariant(nest, bound))
+		return false;
+
+	cl->phi      = phi;
+	cl->incr     = incr;
+	cl->step_pos = step_pos;
+	cl->step     = step;
+	cl->cond     = cond;
+	cl->cmp      = cmp;
+	cl->bound    = bound;
+	cl->relation = relation;
+
+	/* the values of phi lie between init and the last value before bound */
+	cl->range = INT64_MAX;
+	if (is_Const(init) && is_Const(bound)) {
+		ir_tarval *const tv_init  = get_Const_tarval(init);
+		ir_tarval *const tv_bound = get_Const_tarval(bound);
+		if (tarval_is_long(tv_init) && tarval_is_long(tv_bound)
+		    && abs64(get_tarval_long(tv_init)) < RANGE_LIMIT
+		    && abs64(get_tarval_long(tv_bound)) < RANGE_LIMIT) {
+			/* both are limited, so the difference cannot overflow */
+			int64_t const distance = get_tarval_long(tv_bound)
+			                       - get_tarval_long(tv_init);
+			int64_t const step_val = get_tarval_long(get_Const_tarval(step));
+			int64_t       range    = INT64_MAX;
+			if (relation == ir_relation_less && step_val > 0)
+				range = distance - 1;
+			else if (relation == ir_relation_less_equal && step_val > 0)
+				range = distance;
+			else if (relation == ir_relation_greater && step_val < 0)
+				range = -distance - 1;
+			else if (relation == ir_relation_greater_equal && step_val < 0)
+				range = -distance;
+			if (range < RANGE_LIMIT)
+				cl->range = MAX(range, 0);
+		}
+	}
+	return true;
+}
+
+static bool scale_by(int64_t *const scale, int64_t const factor)
+{
+	if (abs64(factor) >= COEF_LIMIT || abs64(*scale) >= COEF_LIMIT / MAX(abs64(factor), 1))
+		return false;
+	*scale *= factor;
+	return true;
+}
+
+/**
+ * Decomposes @p node scaled by @p scale into the base, the coefficients of
+ * the induction variables and the offset of @p acc. A non-constant factor
+ * makes the scale symbolic.
+ */
+static bool decompose(nest_t const *const nest, ir_node *const node,
+                      int64_t scale, bool const symbolic, access_t *const acc,
+                      unsigned const depth)
+{
+	if (depth > MAX_DEPTH)
+		return false;
+
+	ir_node *const ivs[] = { nest->outer.phi, nest->inner.phi };
+	for (unsigned k = 0; k < ARRAY_SIZE(ivs); ++k) {
+		if (node != ivs[k])
+			continue;
+		if (symbolic) {
+			acc->symbolic[k] = true;
+			acc->affine      = false;
+		} else {
+			acc->coef[k] += scale;
+			if (abs64(acc->coef[k]) >= COEF_LIMIT)
+				return false;
+		}
+		return true;
+	}
+
+	ir_mode *const mode = get_irn_mode(node);
+	if (is_nest_invariant(nest, node)) {
+		if (mode_is_reference(mode)) {
+			if (acc->base != NULL || symbolic || scale != 1)
+				return false;
+			acc->base = node;
+		} else if (is_Const(node) && !symbolic
+		           && tarval_is_long(get_Const_tarval(node))) {
+			int64_t value = get_tarval_long(get_Const_tarval(node));
+			if (!scale_by(&value, scale))
+				return false;
+			acc->offset += value;
+		} else {
+			/* some unknown invariant value */
+			acc->affine = false;
+		}
+		return true;
+	}
+
+	switch (get_irn_opcode(node)) {
+	case iro_Add:
+		return decompose(nest, get_Add_left(node), scale, symbolic, acc, depth + 1)
+		    && decompose(nest, get_Add_right(node), scale, symbolic, acc, depth + 1);
+
+	case iro_Sub:
+		if (mode_is_reference(get_irn_mode(get_Sub_right(node))))
+			return false;
+		return decompose(nest, get_Sub_left(node), scale, symbolic, acc, depth + 1)
+		    && decompose(nest, get_Sub_right(node), -scale, symbolic, acc, depth + 1);
+
+	case iro_Mul: {
+		ir_node *left  = get_Mul_left(node);
+		ir_node *right = get_Mul_right(node);
+		if (is_Const(left)) {
+			ir_node *const tmp = left;
+			left  = right;
+			right = tmp;
+		}
+		if (is_Const(right) && tarval_is_long(get_Const_tarval(right))) {
+			if (!scale_by(&scale, get_tarval_long(get_Const_tarval(right))))
+				return false;
+			return decompose(nest, left, scale, symbolic, acc, depth + 1);
+		}
+		if (is_nest_invariant(nest, left)) {
+			ir_node *const tmp = left;
+			left  = right;
+			right = tmp;
+		}
+		if (!is_nest_invariant(nest, right))
+			return false;
+		return decompose(nest, left, scale, true, acc, depth + 1);
+	}
+
+	case iro_Shl: {
+		ir_node *const amount = get_Shl_right(node);
+		if (!is_Const(amount) || !tarval_is_long(get_Const_tarval(amount)))
+			return false;
+		int64_t const shift = get_tarval_long(get_Const_tarval(amount));
+		if (shift < 0 || shift >= 30 || !scale_by(&scale, (int64_t)1 << shift))
+			return false;
+		return decompose(nest, get_Shl_left(node), scale, symbolic, acc, depth + 1);
+	}
+
+	case iro_Conv: {
+		/* assumes that the converted index computation does not wrap */
+		ir_node *const op      = get_Conv_op(node);
+		ir_mode *const op_mode = get_irn_mode(op);
+		if (!mode_is_int(op_mode) || !mode_is_int(mode)
+		    || get_mode_size_bits(mode) < get_mode_size_bits(op_mode))
+			return false;
+		return decompose(nest, op, scale, symbolic, acc, depth + 1);
+	}
+
+	case iro_Sel: {
+		ir_type *const array_type = get_Sel_type(node);
+		ir_type *const elem_type  = get_array_element_type(array_type);
+		int64_t        elem_scale = scale;
+		if (!scale_by(&elem_scale, get_type_size(elem_type)))
+			return false;
+		return decompose(nest, get_Sel_ptr(node), scale, symbolic, acc, depth + 1)
+		    && decompose(nest, get_Sel_index(node), elem_scale, symbolic, acc, depth + 1);
+	}
+
+	case iro_Member: {
+		int64_t offset = get_entity_offset(get_Member_entity(node));
+		if (!scale_by(&offset, scale))
+			return false;
+		acc->offset += offset;
+		return decompose(nest, get_Member_ptr(node), scale, symbolic, acc, depth + 1);
+	}
+
+	default:
+		return false;
+	}
+}
+
+static bool add_access(nest_t *const nest, ir_node *const node)
+{
+	if (nest->n_accesses >= MAX_ACCESSES)
+		return false;
+	access_t *const acc = &nest->accesses[nest->n_accesses++];
+	memset(acc, 0, sizeof(*acc));
+	acc->node   = node;
+	acc->affine = true;
+	ir_node *ptr;
+	ir_mode *mode;
+	if (is_Load(node)) {
+		if (get_Load_volatility(node) == volatility_is_volatile)
+			return false;
+		ptr       = get_Load_ptr(node);
+		mode      = get_Load_mode(node);
+		acc->type = get_Load_type(node);
+	} else {
+		if (get_Store_volatility(node) == volatility_is_volatile)
+			return false;
+		ptr       = get_Store_ptr(node);
+		mode      = get_irn_mode(get_Store_value(node));
+		acc->type = get_Store_type(node);
+	}
+	acc->size       = get_mode_size_bytes(mode);
+	acc->decomposed = decompose(nest, ptr, 1, false, acc, 0);
+	if (!acc->decomposed || acc->base == NULL)
+		acc->affine = false;
+	DB((dbg, LEVEL_3, "\t%+F: base %+F, coef %" PRId64 "%s %" PRId64 "%s, offset %" PRId64 "%s\n",
+	    node, acc->base, acc->coef[0], acc->symbolic[0] ? "?" : "",
+	    acc->coef[1], acc->symbolic[1] ? "?" : "", acc->offset,
+	    acc->affine ? "" : " (not affine)"));
+	return true;
+}
+
+static int64_t sat_mul(int64_t const coef, int64_t const range)
+{
+	if (range >= RANGE_LIMIT)
+		return coef > 0 ? INT64_MAX : coef < 0 ? INT64_MIN : 0;
+	return coef * range;
+}
+
+static int64_t sat_add(int64_t const a, int64_t const b)
+{
+	if (a == INT64_MIN || b == INT64_MIN)
+		return INT64_MIN;
+	if (a == INT64_MAX || b == INT64_MAX)
+		return INT64_MAX;
+	return a + b;
+}
+
+/**
+ * Checks whether accesses @p a and @p b may overlap in two iterations, whose
+ * outer variables differ by a value with the sign of @p dir and whose inner
+ * variables differ by a value with the opposite sign.
+ */
+static bool may_overlap_crossed(nest_t const *const nest, access_t const *const a,
+                                access_t const *const b, int64_t const dir)
+{
+	int64_t const range[] = { nest->outer.range, nest->inner.range };
+	int64_t       lo      = a->offset - b->offset;
+	int64_t       hi      = lo;
+	for (unsigned k = 0; k < 2; ++k) {
+		int64_t const coef = k == 0 ? a->coef[k] * dir : -a->coef[k] * dir;
+		if (range[k] < 1)
+			return false;
+		/* the difference of the variables is in [1, range] times the sign */
+		int64_t const t1 = sat_mul(coef, 1);
+		int64_t const t2 = sat_mul(coef, range[k]);
+		lo = sat_add(lo, MIN(t1, t2));
+		hi = sat_add(hi, MAX(t1, t2));
+	}
+	return lo < (int64_t)b->size && hi > -(int64_t)a->size;
+}
+
+/**
+ * Skips constant offsets added to the pointer @p node and accumulates them in
+ * @p offset.
+ */
+static ir_node *skip_const_offset(ir_node *node, int64_t *const offset)
+{
+	for (;;) {
+		if (!is_Add(node) && !is_Sub(node))
+			return node;
+		ir_node *ptr   = get_binop_left(node);
+		ir_node *value = get_binop_right(node);
+		if (is_Add(node) && is_Const(ptr)) {
+			ir_node *const tmp = ptr;
+			ptr   = value;
+			value = tmp;
+		}
+		if (!mode_is_reference(get_irn_mode(ptr)) || !is_Const(value)
+		    || !tarval_is_long(get_Const_tarval(value)))
+			return node;
+		int64_t const c = get_tarval_long(get_Const_tarval(value));
+		if (abs64(c) >= COEF_LIMIT || abs64(*offset) >= COEF_LIMIT)
+			return node;
+		*offset += is_Add(node) ? c : -c;
+		node = ptr;
+	}
+}
+
+/**
+ * Returns the entity whose address is @p node, if it is a distinct object.
+ */
+static ir_entity *get_base_entity(ir_node *const node)
+{
+	ir_entity *entity;
+	if (is_Address(node)) {
+		entity = get_Address_entity(node);
+	} else if (is_Member(node)
+	           && get_Member_ptr(node) == get_irg_frame(get_irn_irg(node))) {
+		entity = get_Member_entity(node);
+	} else {
+		return NULL;
+	}
+	ir_entity_kind const kind = get_entity_kind(entity);
+	return kind == IR_ENTITY_NORMAL || kind == IR_ENTITY_PARAMETER ? entity : NULL;
+}
+
+/**
+ * Checks that interchanging the loops does not reverse any dependence of
+ * @p a and @p b, one of which is a Store.
+ */
+static bool is_independent(nest_t const *const nest, access_t const *a,
+                           access_t const *b)
+{
+	access_t rebased_a;
+	access_t rebased_b;
+	if (a->base != NULL && b->base != NULL && a->base != b->base) {
+		/* the accesses sweep whole ranges of memory: either both are relative
+		 * to a common base or they are in different objects */
+		int64_t        offset_a = 0;
+		int64_t        offset_b = 0;
+		ir_node *const base_a   = skip_const_offset(a->base, &offset_a);
+		ir_node *const base_b   = skip_const_offset(b->base, &offset_b);
+		if (base_a != base_b) {
+			ir_entity *const entity_a = get_base_entity(base_a);
+			ir_entity *const entity_b = get_base_entity(base_b);
+			return entity_a != NULL && entity_b != NULL && entity_a != entity_b;
+		}
+		rebased_a         = *a;
+		rebased_a.base    = base_a;
+		rebased_a.offset += offset_a;
+		rebased_b         = *b;
+		rebased_b.base    = base_b;
+		rebased_b.offset += offset_b;
+		a = &rebased_a;
+		b = &rebased_b;
+	}
+	if (!a->affine || !b->affine || a->base != b->base
+	    || a->coef[0] != b->coef[0] || a->coef[1] != b->coef[1])
+		return false;
+	return !may_overlap_crossed(nest, a, b, 1)
+	    && !may_overlap_crossed(nest, a, b, -1);
+}
+
+static bool check_dependences(nest_t const *const nest)
+{
+	for (size_t i = 0; i < nest->n_accesses; ++i) {
+		access_t const *const a = &nest->accesses[i];
+		if (!is_Store(a->node))
+			continue;
+		for (size_t j = 0; j < nest->n_accesses; ++j) {
+			access_t const *const b = &nest->accesses[j];
+			if (is_Store(b->node) && j < i)
+				continue;
+			if (!is_independent(nest, a, b)) {
+				DB((dbg, LEVEL_2, "\t%+F and %+F may depend\n", a->node, b->node));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Ranks the stride of an access along induction variable @p k: zero,
+ * contiguous, constant, unknown.
+ */
+static unsigned get_stride_rank(access_t const *const acc, unsigned const k)
+{
+	if (acc->symbolic[k])
+		return 3;
+	int64_t const stride = abs64(acc->coef[k]);
+	if (stride == 0)
+		return 0;
+	return stride <= (int64_t)acc->size ? 1 : 2;
+}
+
+static bool is_interchange_profitable(nest_t const *const nest)
+{
+	unsigned gain = 0;
+	unsigned loss = 0;
+	for (size_t i = 0; i < nest->n_accesses; ++i) {
+		access_t const *const acc = &nest->accesses[i];
+		if (!acc->decomposed)
+			continue;
+		unsigned const outer = get_stride_rank(acc, 0);
+		unsigned const inner = get_stride_rank(acc, 1);
+		if (inner > outer)
+			++gain;
+		else if (inner < outer)
+			++loss;
+	}
+	return gain > loss;
+}
+
+/**
+ * A reduction is a Phi of the inner header, which only adds a value to
+ * itself, and the Phi of the outer header that carries it around the outer
+ * loop. Integer additions may be reordered freely.
+ */
+static bool is_reduction(nest_t const *const nest, ir_node *const outer_phi,
+                         ir_node *const inner_phi)
+{
+	counted_loop_t const *const outer = &nest->outer;
+	counted_loop_t const *const inner = &nest->inner;
+	if (!is_Phi(outer_phi) || !mode_is_int(get_irn_mode(outer_phi))
+	    || get_nodes_block(outer_phi) != outer->header
+	    || get_nodes_block(inner_phi) != inner->header
+	    || get_Phi_pred(outer_phi, 1 - outer->entry) != inner_phi
+	    || get_Phi_pred(inner_phi, inner->entry) != outer_phi)
+		return false;
+
+	ir_node *const update = get_Phi_pred(inner_phi, 1 - inner->entry);
+	if (!is_Add(update) || get_irn_n_outs(update) != 1
+	    || (get_Add_left(update) == inner_phi) == (get_Add_right(update) == inner_phi))
+		return false;
+	foreach_irn_out(inner_phi, i, user) {
+		if (user != update && user != outer_phi)
+			return false;
+	}
+	foreach_irn_out(outer_phi, i, user) {
+		if (user != inner_phi && in_loop(user, outer->loop))
+			return false;
+	}
+	return true;
+}
+
+static bool check_header_phis(nest_t *const nest)
+{
+	counted_loop_t const *const outer = &nest->outer;
+	counted_loop_t const *const inner = &nest->inner;
+	foreach_irn_out(outer->header, i, node) {
+		if (!is_Phi(node) || node == outer->phi)
+			continue;
+		if (get_irn_mode(node) != mode_M
+		    && !is_reduction(nest, node, get_Phi_pred(node, 1 - outer->entry)))
+			return false;
+		ARR_APP1(ir_node*, nest->carried, node);
+	}
+	foreach_irn_out(inner->header, i, node) {
+		if (!is_Phi(node) || node == inner->phi || get_irn_mode(node) == mode_M)
+			continue;
+		if (!is_reduction(nest, get_Phi_pred(node, inner->entry), node))
+			return false;
+	}
+	return true;
+}
+
+static bool is_moved(nest_t const *const nest, ir_node const *const node)
+{
+	for (size_t i = 0, n = ARR_LEN(nest->moved); i < n; ++i) {
+		if (nest->moved[i] == node)
+			return true;
+	}
+	return false;
+}
+
+static bool is_pure(ir_node const *const node)
+{
+	ir_mode *const mode = get_irn_mode(node);
+	return get_irn_pinned(node) == op_pin_state_floats
+	    && mode != mode_M && mode != mode_T && mode != mode_X;
+}
+
+static bool depends_on_outer_iv(nest_t const *const nest, ir_node *const node,
+                                unsigned const depth)
+{
+	if (node == nest->outer.phi)
+		return true;
+	if (depth > MAX_DEPTH || !in_loop(node, nest->outer.loop)
+	    || in_loop(node, nest->inner.loop) || !is_pure(node))
+		return false;
+	foreach_irn_in(node, i, pred) {
+		if (depends_on_outer_iv(nest, pred, depth + 1))
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Checks that the blocks of the outer loop outside of the inner loop only
+ * contain the loop control and side effect free computations. Computations
+ * depending on the outer induction variable are moved into the inner loop.
+ */
+static bool check_outer_blocks(nest_t *const nest, ir_loop *const loop)
+{
+	counted_loop_t const *const outer = &nest->outer;
+	counted_loop_t const *const inner = &nest->inner;
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind != k_ir_node)
+			continue;
+		ir_node *const block = element.node;
+		foreach_irn_out(block, j, node) {
+			if (get_nodes_block(node) != block)
+				continue;
+			if (node == outer->incr || node == outer->cmp || node == outer->cond
+			    || is_Jmp(node))
+				continue;
+			if (is_Proj(node) && get_Proj_pred(node) == outer->cond)
+				continue;
+			if (is_Phi(node)) {
+				if (block != outer->header)
+					return false;
+				continue;
+			}
+			if (!is_pure(node))
+				return false;
+			/* values of the header may be used after the loop */
+			foreach_irn_out(node, k, user) {
+				if (!in_loop(user, outer->loop))
+					return false;
+			}
+			if (depends_on_outer_iv(nest, node, 0))
+				ARR_APP1(ir_node*, nest->moved, node);
+		}
+	}
+
+	for (size_t i = 0, n = ARR_LEN(nest->moved); i < n; ++i) {
+		foreach_irn_out(nest->moved[i], j, user) {
+			if (!in_loop(user, inner->loop) && !is_moved(nest, user))
+				return false;
+		}
+	}
+	foreach_irn_out(outer->phi, i, user) {
+		if (user != outer->incr && user != outer->cmp
+		    && !in_loop(user, inner->loop) && !is_moved(nest, user))
+			return false;
+	}
+	return true;
+}
+
+static bool check_inner_blocks(nest_t *const nest)
+{
+	counted_loop_t const *const inner = &nest->inner;
+	size_t const n_elements = get_loop_n_elements(inner->loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(inner->loop, i);
+		ir_node *const block = element.node;
+		foreach_irn_out(block, j, node) {
+			if (get_nodes_block(node) != block)
+				continue;
+			switch (get_irn_opcode(node)) {
+			case iro_Load:
+			case iro_Store:
+				if (!add_access(nest, node))
+					return false;
+				break;
+			case iro_Cond:
+			case iro_Div:
+			case iro_Jmp:
+			case iro_Mod:
+			case iro_Phi:
+			case iro_Proj:
+			case iro_Switch:
+			case iro_Sync:
+				break;
+			default: {
+				ir_mode *const mode = get_irn_mode(node);
+				if (mode == mode_M || mode == mode_T || mode == mode_X)
+					return false;
+			}
+			}
+		}
+	}
+	foreach_irn_out(inner->phi, i, user) {
+		if (user != inner->incr && user != inner->cmp
+		    && !in_loop(user, inner->loop))
+			return false;
+	}
+	return true;
+}
+
+static bool analyze_nest(nest_t *const nest, ir_loop *const outer_loop,
+                         ir_loop *const inner_loop)
+{
+	memset(nest, 0, sizeof(*nest));
+	nest->outer.loop = outer_loop;
+	nest->inner.loop = inner_loop;
+	nest->carried    = NEW_ARR_F(ir_node*, 0);
+	nest->moved      = NEW_ARR_F(ir_node*, 0);
+
+	if (!analyze_counted_loop(nest, &nest->outer)
+	    || !analyze_counted_loop(nest, &nest->inner)) {
+		DB((dbg, LEVEL_2, "\tno counted loops\n"));
+		return false;
+	}
+	DB((dbg, LEVEL_2, "\tvariables %+F, %+F with ranges %" PRId64 ", %" PRId64 "\n",
+	    nest->outer.phi, nest->inner.phi, nest->outer.range, nest->inner.range));
+	if (!check_header_phis(nest) || !check_outer_blocks(nest, outer_loop)
+	    || !check_inner_blocks(nest)) {
+		DB((dbg, LEVEL_2, "\tnot a perfect nest\n"));
+		return false;
+	}
+	return check_dependences(nest);
+}
+
+static void swap_nodes(ir_node **const a, ir_node **const b)
+{
+	ir_node *const tmp = *a;
+	*a = *b;
+	*b = tmp;
+}
+
+static void set_loop_cmp(counted_loop_t *const cl, ir_node *const bound,
+                         ir_relation const relation)
+{
+	ir_relation const cond_relation
+		= cl->stay_true ? relation : get_negated_relation(relation);
+	ir_node *const cmp = new_r_Cmp(cl->header, cl->phi, bound, cond_relation);
+	set_Cond_selector(cl->cond, cmp);
+	cl->cmp      = cmp;
+	cl->bound    = bound;
+	cl->relation = relation;
+}
+
+typedef struct use_t {
+	ir_node *user;
+	int      pos;
+} use_t;
+
+static use_t *collect_uses(use_t *uses, counted_loop_t const *const cl)
+{
+	for (unsigned i = 0, n = get_irn_n_outs(cl->phi); i < n; ++i) {
+		int            pos;
+		ir_node *const user = get_irn_out_ex(cl->phi, i, &pos);
+		if (user == cl->incr || user == cl->cmp)
+			continue;
+		use_t const use = { user, pos };
+		ARR_APP1(use_t, uses, use);
+	}
+	return uses;
+}
+
+/**
+ * Exchanges the iteration spaces of both loops and swaps the induction
+ * variables in the body, so that the outer loop iterates over the values of
+ * the former inner variable.
+ */
+static void interchange(nest_t *const nest)
+{
+	counted_loop_t *const outer = &nest->outer;
+	counted_loop_t *const inner = &nest->inner;
+	for (size_t i = 0, n = ARR_LEN(nest->moved); i < n; ++i) {
+		DB((dbg, LEVEL_3, "\tmove %+F into %+F\n", nest->moved[i], inner->header));
+		set_nodes_block(nest->moved[i], inner->header);
+	}
+
+	use_t *outer_uses = collect_uses(NEW_ARR_F(use_t, 0), outer);
+	use_t *inner_uses = collect_uses(NEW_ARR_F(use_t, 0), inner);
+	for (size_t i = 0, n = ARR_LEN(outer_uses); i < n; ++i)
+		set_irn_n(outer_uses[i].user, outer_uses[i].pos, inner->phi);
+	for (size_t i = 0, n = ARR_LEN(inner_uses); i < n; ++i)
+		set_irn_n(inner_uses[i].user, inner_uses[i].pos, outer->phi);
+	DEL_ARR_F(inner_uses);
+	DEL_ARR_F(outer_uses);
+
+	ir_node *const outer_init = get_Phi_pred(outer->phi, outer->entry);
+	ir_node *const inner_init = get_Phi_pred(inner->phi, inner->entry);
+	set_Phi_pred(outer->phi, outer->entry, inner_init);
+	set_Phi_pred(inner->phi, inner->entry, outer_init);
+	swap_nodes(&outer->step, &inner->step);
+	set_irn_n(outer->incr, outer->step_pos, outer->step);
+	set_irn_n(inner->incr, inner->step_pos, inner->step);
+
+	ir_node    *const outer_bound    = outer->bound;
+	ir_relation const outer_relation = outer->relation;
+	set_loop_cmp(outer, inner->bound, inner->relation);
+	set_loop_cmp(inner, outer_bound, outer_relation);
+	int64_t const range = outer->range;
+	outer->range = inner->range;
+	inner->range = range;
+
+	for (size_t i = 0; i < nest->n_accesses; ++i) {
+		access_t *const acc = &nest->accesses[i];
+		int64_t const coef = acc->coef[0];
+		acc->coef[0] = acc->coef[1];
+		acc->coef[1] = coef;
+		bool const symbolic = acc->symbolic[0];
+		acc->symbolic[0] = acc->symbolic[1];
+		acc->symbolic[1] = symbolic;
+	}
+}
+
+static bool is_tiling_profitable(nest_t const *const nest, unsigned const tile_size)
+{
+	counted_loop_t const *const inner = &nest->inner;
+	if (tile_size < 2 || (inner->relation != ir_relation_less
+	                      && inner->relation != ir_relation_less_equal))
+		return false;
+	int64_t const step = get_tarval_long(get_Const_tarval(inner->step));
+	ir_mode *const mode = get_irn_mode(inner->phi);
+	if (step <= 0 || step >= ((int64_t)1 << (get_mode_size_bits(mode) - 2)) / tile_size)
+		return false;
+	/* the whole inner loop fits into a tile */
+	if (inner->range != INT64_MAX && inner->range <= step * (int64_t)tile_size)
+		return false;
+
+	for (size_t i = 0; i < nest->n_accesses; ++i) {
+		access_t const *const acc = &nest->accesses[i];
+		if (acc->decomposed && get_stride_rank(acc, 1) >= 2)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Strip mines the inner loop and surrounds the nest with a loop over the
+ * strips. The strip limit is computed as start + min(bound - start, tile),
+ * comparing unsigned values, so it does not overflow for the last strip. For
+ * an inclusive bound the limit is the last value of the strip.
+ */
+static void tile(nest_t *const nest, unsigned const tile_size)
+{
+	counted_loop_t *const outer     = &nest->outer;
+	counted_loop_t *const inner     = &nest->inner;
+	ir_graph       *const irg       = get_irn_irg(outer->header);
+	ir_mode        *const mode      = get_irn_mode(inner->phi);
+	ir_relation     const relation  = inner->relation;
+	bool            const inclusive = relation == ir_relation_less_equal;
+
+	/* collect the uses after the nest before adding new ones */
+	size_t const n_carried = ARR_LEN(nest->carried);
+	use_t       *uses      = NEW_ARR_F(use_t, 0);
+	for (size_t i = 0; i < n_carried; ++i) {
+		ir_node *const phi = nest->carried[i];
+		for (unsigned j = 0, n = get_irn_n_outs(phi); j < n; ++j) {
+			int            pos;
+			ir_node *const user = get_irn_out_ex(phi, j, &pos);
+			/* keep-alive edges stay on the loop Phi */
+			if (in_loop(user, outer->loop) || is_End(user))
+				continue;
+			use_t const use = { user, pos };
+			ARR_APP1(use_t, uses, use);
+		}
+	}
+
+	ir_node *const exit_proj = get_Block_cfgpred(outer->exit_block, outer->exit_pos);
+	ir_node *const latch     = new_r_Block(irg, 1, &exit_proj);
+	ir_node *const header_in[] = {
+		get_Block_cfgpred(outer->header, outer->entry),
+		new_r_Jmp(latch),
+	};
+	ir_node *const header = new_r_Block(irg, ARRAY_SIZE(header_in), header_in);
+
+	ir_node *const phi_in[] = {
+		get_Phi_pred(inner->phi, inner->entry),
+		new_r_Dummy(irg, mode),
+	};
+	ir_node *const start = new_r_Phi(header, ARRAY_SIZE(phi_in), phi_in, mode);
+	ir_node *const cmp   = new_r_Cmp(header, start, inner->bound, relation);
+	ir_node *const cond  = new_r_Cond(header, cmp);
+	ir_node *const stay  = new_r_Proj(cond, mode_X, pn_Cond_true);
+	ir_node *const leave = new_r_Proj(cond, mode_X, pn_Cond_false);
+	ir_node *const body  = new_r_Block(irg, 1, &stay);
+
+	ir_mode   *const umode  = find_unsigned_mode(mode);
+	ir_tarval *const tv_one = get_mode_one(mode);
+	ir_tarval       *tv_len = tarval_mul(get_Const_tarval(inner->step),
+	                                     new_tarval_from_long(tile_size, mode));
+	if (inclusive)
+		tv_len = tarval_sub(tv_len, tv_one);
+	ir_node *const full  = new_r_Const(irg, tv_len);
+	ir_node *const rest  = new_r_Sub(body, inner->bound, start);
+	ir_node *const urest = new_r_Conv(body, rest, umode);
+	ir_node *const ufull = new_r_Const(irg, tarval_convert_to(tv_len, umode));
+	ir_node *const less  = new_r_Cmp(body, urest, ufull, ir_relation_less);
+
+	/* min() as a diamond, if conversion may turn it into a Mux later */
+	ir_node *const select     = new_r_Cond(body, less);
+	ir_node *const short_x    = new_r_Proj(select, mode_X, pn_Cond_true);
+	ir_node *const full_x     = new_r_Proj(select, mode_X, pn_Cond_false);
+	ir_node *const short_bl   = new_r_Block(irg, 1, &short_x);
+	ir_node *const full_bl    = new_r_Block(irg, 1, &full_x);
+	ir_node *const merge_in[] = { new_r_Jmp(short_bl), new_r_Jmp(full_bl) };
+	ir_node *const merge      = new_r_Block(irg, ARRAY_SIZE(merge_in), merge_in);
+	ir_node *const len_in[]   = { rest, full };
+	ir_node *const len        = new_r_Phi(merge, ARRAY_SIZE(len_in), len_in, mode);
+	ir_node *const limit      = new_r_Add(merge, start, len);
+	ir_node *const next       = inclusive
+		? new_r_Add(merge, limit, new_r_Const(irg, tv_one)) : limit;
+	set_Phi_pred(start, 1, next);
+
+	set_Block_cfgpred(outer->header, outer->entry, new_r_Jmp(merge));
+	set_Block_cfgpred(outer->exit_block, outer->exit_pos, leave);
+	for (size_t i = 0; i < n_carried; ++i) {
+		ir_node *const phi   = nest->carried[i];
+		ir_node *const in[]  = { get_Phi_pred(phi, outer->entry), phi };
+		ir_node *const carry = new_r_Phi(header, ARRAY_SIZE(in), in, get_irn_mode(phi));
+		set_Phi_pred(phi, outer->entry, carry);
+		for (size_t j = 0, n = ARR_LEN(uses); j < n; ++j) {
+			if (get_irn_n(uses[j].user, uses[j].pos) == phi)
+				set_irn_n(uses[j].user, uses[j].pos, carry);
+		}
+	}
+	DEL_ARR_F(uses);
+
+	set_Phi_pred(inner->phi, inner->entry, start);
+	set_loop_cmp(inner, limit, relation);
+}
+
+typedef struct loop_nest_env_t {
+	unsigned tile_size;
+	unsigned n_interchanged;
+	unsigned n_tiled;
+} loop_nest_env_t;
+
+static void optimize_nest(loop_nest_env_t *const env, ir_loop *const outer_loop,
+                          ir_loop *const inner_loop)
+{
+	DB((dbg, LEVEL_2, "inspect nest %+F, %+F\n", outer_loop, inner_loop));
+	nest_t nest;
+	if (analyze_nest(&nest, outer_loop, inner_loop)) {
+		if (get_irn_mode(nest.outer.phi) == get_irn_mode(nest.inner.phi)
+		    && is_interchange_profitable(&nest)) {
+			DB((dbg, LEVEL_2, "\tinterchange %+F and %+F\n",
+			    nest.outer.phi, nest.inner.phi));
+			interchange(&nest);
+			++env->n_interchanged;
+		}
+		if (is_tiling_profitable(&nest, env->tile_size)) {
+			DB((dbg, LEVEL_2, "\ttile %+F\n", nest.inner.phi));
+			tile(&nest, env->tile_size);
+			++env->n_tiled;
+		}
+	}
+	DEL_ARR_F(nest.moved);
+	DEL_ARR_F(nest.carried);
+}
+
+static unsigned count_sons(ir_loop const *const loop, ir_loop **const son)
+{
+	unsigned     n_sons     = 0;
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_loop) {
+			*son = element.son;
+			++n_sons;
+		}
+	}
+	return n_sons;
+}
+
+static void find_nests(loop_nest_env_t *const env, ir_loop *const loop,
+                       bool const is_root)
+{
+	size_t const n_elements = get_loop_n_elements(loop);
+	for (size_t i = 0; i < n_elements; ++i) {
+		loop_element const element = get_loop_element(loop, i);
+		if (*element.kind == k_ir_loop)
+			find_nests(env, element.son, false);
+	}
+
+	ir_loop *son;
+	ir_loop *grandson;
+	if (!is_root && count_sons(loop, &son) == 1
+	    && count_sons(son, &grandson) == 0)
+		optimize_nest(env, loop, son);
+}
+
+void optimize_loop_nests(ir_graph *const irg, unsigned const tile_size)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.loop_nest");
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+	/* The nests are disjoint, transforming one of them keeps the loop
+	 * information and the outs needed for the others valid. */
+	loop_nest_env_t env = { .tile_size = tile_size };
+	find_nests(&env, get_irg_loop(irg), true);
+
+	DB((dbg, LEVEL_1, "%+F: %u nests interchanged, %u tiled\n", irg,
+	    env.n_interchanged, env.n_tiled));
+	if (env.n_tiled > 0)
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+	else if (env.n_interchanged > 0)
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+	else
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+}
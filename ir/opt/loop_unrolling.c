@@ -281,9 +281,12 @@ static ir_node* skip_trivial_phis(ir_node *start) {
  * @param header loop header
  * @param max max allowed unroll factor
  * @param fully_unroll pointer to where the decision to fully unroll the loop is stored
+ * @param exit_cmp pointer to where the Cmp controlling the loop is stored
+ * @param fold_exits pointer to where the decision to fold the exit tests of
+ *        the copies is stored
  * @return unroll factor to use fot this loop; 0 if loop should not be unrolled
  */
-static unsigned find_suitable_factor(ir_node *const header, unsigned max, bool *fully_unroll) {
+static unsigned find_suitable_factor(ir_node *const header, unsigned max, bool *fully_unroll, ir_node **exit_cmp, bool *fold_exits) {
 	unsigned const DONT_UNROLL = 0;
 	unsigned const n_outs = get_irn_n_outs(header);
 	unsigned factor = 1;
@@ -383,7 +386,7 @@ static unsigned find_suitable_factor(ir_node *const header, unsigned max, bool *
 			// normalize: use less_equal as relation
 			if (!(cmp_rel & ir_relation_equal)) {
 				// interval -= 1
-				tarval_sub(tv_interval, tv_one);
+				tv_interval = tarval_sub(tv_interval, tv_one);
 			}
 
 			assert(!tarval_is_null(tv_step));
@@ -404,6 +407,10 @@ static unsigned find_suitable_factor(ir_node *const header, unsigned max, bool *
 			if (factor == (unsigned long) loop_count) {
 				*fully_unroll = true;
 			}
+			// only rely on the trip count if the counter hits the limit exactly
+			*fold_exits = factor != 0 && tarval_is_null(tarval_mod(tv_interval, tv_step))
+			              && (unsigned long) loop_count % factor == 0;
+			*exit_cmp = node;
 			break;
 		}
 	}
@@ -545,6 +552,48 @@ static void rewire_fully_unrolled(ir_loop *const loop, ir_node *header) {
 	DB((dbg, LEVEL_2, "fully unrolled %+F\n", loop));
 }
 
+/**
+ * Returns the value the loop controlling Cmp @p cmp has while the loop keeps
+ * iterating or NULL if this cannot be determined.
+ */
+static ir_tarval *get_staying_value(ir_node *const cmp, ir_loop *const loop)
+{
+	unsigned const n_outs = get_irn_n_outs(cmp);
+	for (unsigned i = 0; i < n_outs; ++i) {
+		ir_node *const cond = get_irn_out(cmp, i);
+		if (!is_Cond(cond))
+			continue;
+		unsigned const n_projs = get_irn_n_outs(cond);
+		for (unsigned j = 0; j < n_projs; ++j) {
+			ir_node *const proj = get_irn_out(cond, j);
+			if (get_irn_n_outs(proj) != 1)
+				continue;
+			ir_node *const succ = get_irn_out(proj, 0);
+			if (!is_Block(succ) || !block_is_inside_loop(succ, loop))
+				continue;
+			return get_Proj_num(proj) == pn_Cond_true ? tarval_b_true
+			                                          : tarval_b_false;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * The unroll factor divides the exact trip count, so the loop can only be left
+ * through the test of the original header: Fold the tests in the copies of
+ * the header.  This turns the unrolled body into straight-line code which
+ * later optimizations (e.g. combine_memops()) can treat as a widened
+ * iteration.
+ */
+static void fold_copied_exit_tests(ir_node **const copies, ir_tarval *const stay)
+{
+	for (size_t i = 0, n = ARR_LEN(copies); i < n; ++i) {
+		ir_node *const cmp = copies[i];
+		DB((dbg, LEVEL_3, "	fold exit test %+F\n", cmp));
+		exchange(cmp, new_r_Const(get_irn_irg(cmp), stay));
+	}
+}
+
 static unsigned n_loops_unrolled = 0;
 
 static bool unroll_loop(ir_loop *const loop, unsigned factor)
@@ -558,7 +607,9 @@ static bool unroll_loop(ir_loop *const loop, unsigned factor)
 	DB((dbg, LEVEL_4, "\tidentified loop header %+F\n", header));
 
 	bool fully_unroll = false;
-	factor = find_suitable_factor(header, factor, &fully_unroll);
+	bool fold_exits = false;
+	ir_node *exit_cmp = NULL;
+	factor = find_suitable_factor(header, factor, &fully_unroll, &exit_cmp, &fold_exits);
 	if (factor < 1 || (factor == 1 && !fully_unroll)) {
 		return false;
 	}
@@ -578,6 +629,8 @@ static bool unroll_loop(ir_loop *const loop, unsigned factor)
 		}
 	}
 
+	ir_tarval *const stay       = fold_exits ? get_staying_value(exit_cmp, loop) : NULL;
+	ir_node  **exit_tests       = NEW_ARR_F(ir_node*, 0);
 	for (unsigned j = 1; j < factor; ++j) {
 
 		// step 1: duplicate blocks
@@ -588,6 +641,8 @@ static bool unroll_loop(ir_loop *const loop, unsigned factor)
 				duplicate_block(element.node);
 			}
 		}
+		if (stay != NULL)
+			ARR_APP1(ir_node*, exit_tests, get_irn_link(exit_cmp));
 
 		// step 2: rewire the edges
 		for (size_t i = 0; i < n_elements; ++i) {
@@ -605,6 +660,8 @@ static bool unroll_loop(ir_loop *const loop, unsigned factor)
 	if (fully_unroll) {
 		rewire_fully_unrolled(loop, header);
 	}
+	fold_copied_exit_tests(exit_tests, stay);
+	DEL_ARR_F(exit_tests);
 	pset_new_destroy(&loop_blocks);
 	return fully_unroll;
 }
@@ -12,6 +12,7 @@
 
 #include "array.h"
 #include "debug.h"
+#include "execfreq.h"
 #include "ircons.h"
 #include "irdom.h"
 #include "irflag_t.h"
@@ -1474,6 +1475,32 @@ static void reroute_mem_through(ir_node *omem, ir_node *nmem, ir_node *pass_bl)
 	nmem->o.out = new_out;
 }
 
+/**
+ * Checks whether inserting Loads into the predecessors of a block, where the
+ * value is not available (the avail field is NULL), pays off.
+ * Because there are no critical edges, the inserted Loads never execute more
+ * often than the redundant one did. They only lengthen live ranges and add
+ * code, so we require them to be placed on the colder paths into @p block.
+ *
+ * @param block  the block
+ */
+static bool is_insertion_profitable(ir_node *block)
+{
+	double avail_freq  = 0.0;
+	double insert_freq = 0.0;
+	for (int i = get_Block_n_cfgpreds(block); i-- > 0; ) {
+		ir_node *pred    = get_Block_cfgpred_block(block, i);
+		block_t *pred_bl = get_block_entry(pred);
+		double   freq    = get_block_execfreq(pred);
+
+		if (pred_bl->avail == NULL)
+			insert_freq += freq;
+		else
+			avail_freq += freq;
+	}
+	return insert_freq <= avail_freq;
+}
+
 /**
  * insert Loads, making partly redundant Loads fully redundant
  */
@@ -1637,6 +1664,10 @@ static int insert_Load(block_t *bl)
 						all_same = 0;
 				}
 			}
+			if (have_some && !all_same && !is_insertion_profitable(block)) {
+				DB((dbg, LEVEL_2, "Inserting %+F into the hotter predecessors of %+F is not profitable\n", op->node, block));
+				have_some = 0;
+			}
 			if (have_some && !all_same) {
 				ir_mode *mode = op->value.mode;
 				ir_type *type = op->value.type;
@@ -1762,7 +1793,14 @@ void opt_ldst(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
 		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
-		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		/* needed by the execution frequency estimation */
+		| IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+
+	/* Loads are only inserted on cold paths */
+	ir_estimate_execfreq(irg);
 
 	const ir_disambiguator_options opts =
 		get_irg_memory_disambiguator_options(irg);
@@ -1784,7 +1822,8 @@ void opt_ldst(ir_graph *irg)
 	env.id_2_address  = NEW_ARR_F(ir_node *, 0);
 #endif
 
-	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_BLOCK_MARK);
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_BLOCK_MARK
+	                          | IR_RESOURCE_PHI_LIST);
 
 	/* first step: allocate block entries. Note that some blocks might be
 	   unreachable here. Using the normal walk ensures that ALL blocks are initialized. */
@@ -1876,7 +1915,8 @@ no_changes:
 		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
 	}
 
-	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_BLOCK_MARK);
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_BLOCK_MARK
+	                       | IR_RESOURCE_PHI_LIST);
 	ir_nodehashmap_destroy(&env.adr_map);
 	obstack_free(&env.obst, NULL);
 
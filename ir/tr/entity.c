@@ -206,10 +206,8 @@ ir_entity *clone_entity(ir_entity const *const old, ident *const name,
 	return res;
 }
 
-void free_entity(ir_entity *ent)
+static void free_entity_data(ir_entity *ent)
 {
-	remove_compound_member(ent->owner, ent);
-
 	assert(ent->firm_tag == k_entity);
 	free_entity_attrs(ent);
 #ifdef DEBUG_libfirm
@@ -218,6 +216,27 @@ void free_entity(ir_entity *ent)
 	free(ent);
 }
 
+void free_entity(ir_entity *ent)
+{
+	remove_compound_member(ent->owner, ent);
+	free_entity_data(ent);
+}
+
+void free_entities(size_t n, ir_entity *const *entities)
+{
+	/* remove each run of entities with the same owner in one pass */
+	for (size_t i = 0; i < n; ) {
+		ir_type *owner = entities[i]->owner;
+		size_t   end   = i + 1;
+		while (end < n && entities[end]->owner == owner)
+			++end;
+		remove_compound_members(owner, end - i, &entities[i]);
+		i = end;
+	}
+	for (size_t i = 0; i < n; ++i)
+		free_entity_data(entities[i]);
+}
+
 long get_entity_nr(const ir_entity *ent)
 {
 	assert(ent->firm_tag == k_entity);
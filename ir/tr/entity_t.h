@@ -198,6 +198,7 @@ struct ir_entity {
 	ir_entity **overwrittenby; /**< A list of entities that overwrite this
 	                                entity. */
 	long nr;                 /**< A unique number for each entity. */
+	size_t member_pos;       /**< Position in the member list of owner. */
 
 	union {
 		/** attributes for normal entities */
@@ -171,11 +171,8 @@ static void free_type_attrs(ir_type *const type)
 	panic("Invalid type");
 }
 
-void free_type(ir_type *tp)
+static void free_type_data(ir_type *tp)
 {
-	free_type_entities(tp);
-	/* Remove from list of all types */
-	remove_irp_type(tp);
 	/* Free the attributes of the type. */
 	free_type_attrs(tp);
 	/* And now the type itself... */
@@ -185,6 +182,23 @@ void free_type(ir_type *tp)
 	free(tp);
 }
 
+void free_type(ir_type *tp)
+{
+	free_type_entities(tp);
+	/* Remove from list of all types */
+	remove_irp_type(tp);
+	free_type_data(tp);
+}
+
+void free_types(size_t n, ir_type *const *types)
+{
+	for (size_t i = 0; i < n; ++i)
+		free_type_entities(types[i]);
+	remove_irp_types(n, types);
+	for (size_t i = 0; i < n; ++i)
+		free_type_data(types[i]);
+}
+
 void *(get_type_link)(const ir_type *tp)
 {
 	return get_type_link_(tp);
@@ -793,10 +807,10 @@ size_t get_compound_member_index(ir_type const *const type,
                                  ir_entity const *const entity)
 {
 	assert(is_compound_type(type));
-	for (size_t i = 0, n = get_compound_n_members(type); i < n; ++i) {
-		if (get_compound_member(type, i) == entity)
-			return i;
-	}
+	size_t const n   = get_compound_n_members(type);
+	size_t const pos = entity->member_pos;
+	if (pos < n && get_compound_member(type, pos) == entity)
+		return pos;
 	return INVALID_MEMBER_INDEX;
 }
 
@@ -819,29 +833,66 @@ const char *get_compound_name(const ir_type *tp)
 	return get_id_str(get_compound_ident(tp));
 }
 
+/**
+ * Clears the slot of @p member in the member list of @p type.
+ * Returns the position of the slot or INVALID_MEMBER_INDEX.
+ */
+static size_t clear_compound_member(ir_type *type, ir_entity *member)
+{
+	size_t const pos = get_compound_member_index(type, member);
+	if (pos == INVALID_MEMBER_INDEX)
+		return pos;
+	type->attr.compound.members[pos] = NULL;
+	/* members of global type must also be removed from map */
+	if (is_segment_type(type) && !(type->flags & tf_info)
+	 && get_entity_visibility(member) != ir_visibility_private) {
+		pmap *globals = irp->globals;
+		pmap_insert(globals, get_entity_ld_ident(member), NULL);
+	}
+	return pos;
+}
+
+/** Closes the gaps left by removed members, keeping the order. */
+static void compact_compound_members(ir_type *type, size_t from)
+{
+	ir_entity **members   = type->attr.compound.members;
+	size_t      n_members = from;
+	for (size_t i = from, n = ARR_LEN(members); i < n; ++i) {
+		ir_entity *member = members[i];
+		if (member == NULL)
+			continue;
+		member->member_pos   = n_members;
+		members[n_members++] = member;
+	}
+	ARR_SHRINKLEN(type->attr.compound.members, n_members);
+}
+
 void remove_compound_member(ir_type *type, ir_entity *member)
 {
 	assert(is_compound_type(type));
-	for (size_t i = 0, n = ARR_LEN(type->attr.compound.members); i < n; ++i) {
-		if (get_compound_member(type, i) != member)
-			continue;
-		for (; i < n - 1; ++i)
-			type->attr.compound.members[i] = type->attr.compound.members[i+1];
-		ARR_SETLEN(ir_entity*, type->attr.compound.members, n-1);
-		/* members of global type must also be removed from map */
-		if (is_segment_type(type) && !(type->flags & tf_info)
-		 && get_entity_visibility(member) != ir_visibility_private) {
-			pmap *globals = irp->globals;
-			pmap_insert(globals, get_entity_ld_ident(member), NULL);
-		}
-		break;
+	size_t const pos = clear_compound_member(type, member);
+	if (pos != INVALID_MEMBER_INDEX)
+		compact_compound_members(type, pos);
+}
+
+void remove_compound_members(ir_type *type, size_t n,
+                             ir_entity *const *members)
+{
+	assert(is_compound_type(type));
+	size_t first = get_compound_n_members(type);
+	for (size_t i = 0; i < n; ++i) {
+		size_t const pos = clear_compound_member(type, members[i]);
+		if (pos != INVALID_MEMBER_INDEX)
+			first = MIN(first, pos);
 	}
+	compact_compound_members(type, first);
 }
 
 void add_compound_member(ir_type *type, ir_entity *entity)
 {
 	assert(is_compound_type(type));
 	/* try to detect double-add */
+	entity->member_pos = ARR_LEN(type->attr.compound.members);
 	ARR_APP1(ir_entity *, type->attr.compound.members, entity);
 	/* Add segment members to globals map. */
 	if (is_segment_type(type) && !(type->flags & tf_info)
@@ -854,6 +905,16 @@ void add_compound_member(ir_type *type, ir_entity *entity)
 	}
 }
 
+void sort_compound_members(ir_type *type,
+                           int (*cmp)(void const *, void const *))
+{
+	assert(is_compound_type(type));
+	ir_entity **members = type->attr.compound.members;
+	QSORT_ARR(members, cmp);
+	for (size_t i = 0, n = ARR_LEN(members); i < n; ++i)
+		members[i]->member_pos = i;
+}
+
 int is_code_type(ir_type const *const type)
 {
 	return get_type_opcode(type) == tpo_code;
@@ -127,6 +127,7 @@ struct ir_type {
 	void *link;              /**< holds temporary data - like in irnode_t.h */
 	type_dbg_info *dbi;      /**< A pointer to information for debug support. */
 	long nr;                 /**< A unique number for each type. */
+	size_t irp_pos;          /**< Position in the type list of irp. */
 	union {
 		compound_attr compound;
 		class_attr    cls;
@@ -145,6 +146,13 @@ void free_method_attrs(ir_type *method);
 
 void add_compound_member(ir_type *compound, ir_entity *entity);
 
+/**
+ * Sorts the members of @p compound with the qsort() comparison function
+ * @p cmp on ir_entity** and updates their stored positions.
+ */
+void sort_compound_members(ir_type *compound,
+                           int (*cmp)(void const *, void const *));
+
 /** Initialize the type module. */
 void ir_init_type(ir_prog *irp);
 
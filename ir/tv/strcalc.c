@@ -413,6 +413,16 @@ void sc_val_from_ulong(unsigned long value, sc_word *buffer)
 	}
 }
 
+void sc_val_from_uint64(uint64_t value, sc_word *buffer)
+{
+	sc_word *pos = buffer;
+
+	while (pos < buffer + calc_buffer_size) {
+		*pos++ = value & SC_MASK;
+		value >>= SC_BITS;
+	}
+}
+
 long sc_val_to_long(const sc_word *val)
 {
 	unsigned long l = 0;
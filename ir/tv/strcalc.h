@@ -165,6 +165,9 @@ void sc_val_from_long(long l, sc_word *buffer);
 /** create a value form an unsigned long */
 void sc_val_from_ulong(unsigned long l, sc_word *buffer);
 
+/** create a value from an uint64_t */
+void sc_val_from_uint64(uint64_t value, sc_word *buffer);
+
 /**
  * Construct a strcalc value form a sequence of bytes in two complement little
  * endian format.
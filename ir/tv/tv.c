@@ -338,6 +338,25 @@ uint64_t get_tarval_uint64(ir_tarval const *tv)
 	return sc_val_to_uint64(tv->value);
 }
 
+uint64_t get_tarval_word(ir_tarval const *const tv)
+{
+	ir_mode *const mode = get_tarval_mode(tv);
+	if (mode == mode_b)
+		return tv == tarval_b_true;
+	unsigned const bits = get_mode_word_bits(mode);
+	assert(bits != 0);
+	return sc_val_to_uint64(tv->value) & word_mask(bits);
+}
+
+ir_tarval *new_tarval_from_word(uint64_t const w, ir_mode *const mode)
+{
+	if (mode == mode_b)
+		return w != 0 ? tarval_b_true : tarval_b_false;
+	assert(get_mode_word_bits(mode) != 0);
+	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
+	sc_val_from_uint64(w, buffer);
+	return get_int_tarval(buffer, mode);
+}
 ir_tarval *new_tarval_from_long_double(long double d, ir_mode *mode)
 {
 	assert(mode_is_float(mode));
@@ -161,4 +161,82 @@ bool tarval_in_range(ir_tarval const *min, ir_tarval const *val, ir_tarval const
 
 void init_mode_values(ir_mode *mode);
 
+/*
+ * Native words: Values of integer modes with at most 64 bits and of mode_b
+ * may be represented as uint64_t holding the bits of the value, with all bits
+ * beyond the size of the mode cleared.  Analyses use them to avoid creating
+ * tarvals for intermediate results.  Arithmetic on them must wrap around.
+ */
+
+/**
+ * Returns the number of bits of native words for mode @p mode, or 0 if its
+ * values cannot be represented as native words.
+ */
+static inline unsigned get_mode_word_bits(ir_mode const *const mode)
+{
+	if (mode == mode_b)
+		return 1;
+	if (!mode_is_int(mode))
+		return 0;
+	unsigned const bits = get_mode_size_bits(mode);
+	return bits <= 64 ? bits : 0;
+}
+
+/** Returns a native word with the lower @p bits bits set. */
+static inline uint64_t word_mask(unsigned const bits)
+{
+	assert(0 < bits && bits <= 64);
+	return UINT64_MAX >> (64 - bits);
+}
+
+/** Sign extends the lower @p bits bits of @p w to the full native word. */
+static inline uint64_t word_sign_extend(uint64_t const w, unsigned const bits)
+{
+	uint64_t const sign = (uint64_t)1 << (bits - 1);
+	return ((w & word_mask(bits)) ^ sign) - sign;
+}
+
+static inline uint64_t word_shift_amount(ir_mode const *const mode,
+                                         uint64_t const amount)
+{
+	unsigned const modulo_shift = get_mode_modulo_shift(mode);
+	return modulo_shift != 0 ? amount % modulo_shift : amount;
+}
+
+/** Native word version of tarval_shl(). */
+static inline uint64_t word_shl(ir_mode const *const mode, uint64_t const w,
+                                uint64_t const amount)
+{
+	unsigned const bits = get_mode_size_bits(mode);
+	uint64_t const a    = word_shift_amount(mode, amount);
+	return a < bits ? (w << a) & word_mask(bits) : 0;
+}
+
+/** Native word version of tarval_shr(). */
+static inline uint64_t word_shr(ir_mode const *const mode, uint64_t const w,
+                                uint64_t const amount)
+{
+	unsigned const bits = get_mode_size_bits(mode);
+	uint64_t const a    = word_shift_amount(mode, amount);
+	return a < bits ? w >> a : 0;
+}
+
+/** Native word version of tarval_shrs(). */
+static inline uint64_t word_shrs(ir_mode const *const mode, uint64_t const w,
+                                 uint64_t const amount)
+{
+	unsigned const bits = get_mode_size_bits(mode);
+	uint64_t const a    = word_shift_amount(mode, amount);
+	uint64_t const s    = a < bits ? a : bits - 1;
+	uint64_t const x    = word_sign_extend(w, bits);
+	uint64_t const r    = x >> 63 ? ~(~x >> s) : x >> s;
+	return r & word_mask(bits);
+}
+
+/** Returns the native word of @p tv. */
+uint64_t get_tarval_word(ir_tarval const *tv);
+
+/** Creates a tarval of mode @p mode from the native word @p w. */
+ir_tarval *new_tarval_from_word(uint64_t w, ir_mode *mode);
+
 #endif
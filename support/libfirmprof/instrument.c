@@ -3,22 +3,40 @@
  * This file is a supplement to libFirm. It is public domain.
  *  @author Matthias Braun, Steven Schaefer
  */
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-/* Prevent the compiler from mangling the name of this function. */
+/** Number of (value, count) pairs recorded per value site. */
+#define N_VALUE_SLOTS 4
+
+/* Prevent the compiler from mangling the name of these functions. */
 void __init_firmprof(const char*, unsigned int*, size_t)
      asm("__init_firmprof");
+void __init_firmprof_values(const char*, uintptr_t*, unsigned)
+     asm("__init_firmprof_values");
+void __firmprof_value(uintptr_t*, uintptr_t)
+     asm("__firmprof_value");
+void __firmprof_icall(uintptr_t*, void*)
+     asm("__firmprof_icall");
+void __firmprof_callee(void*, uintptr_t)
+     asm("__firmprof_callee");
 
 typedef struct _profile_counter_t {
 	const char *filename;
 	unsigned   *counters;
 	unsigned    len;
+	uintptr_t  *values;
+	unsigned    n_value_sites;
 	struct _profile_counter_t *next;
 } profile_counter_t;
 
 static profile_counter_t *counters = NULL;
 
+/* the value slots of the indirect call currently executed */
+static uintptr_t *icall_slots  = NULL;
+static void      *icall_callee = NULL;
+
 /**
  * Write counter values to profiling output file.
  * We define our output format to be a sequence of 32-bit unsigned integer
@@ -41,6 +59,37 @@ void write_little_endian(unsigned *counter, unsigned len, FILE *f)
 	}
 }
 
+static void write_little_endian64(uintptr_t *values, unsigned len, FILE *f)
+{
+	unsigned i;
+
+	for (i = 0; i < len; ++i) {
+		uint64_t      v = values[i];
+		unsigned char bytes[8];
+		unsigned      b;
+
+		for (b = 0; b < 8; ++b)
+			bytes[b] = (v >> (8 * b)) & 0xff;
+
+		fwrite(bytes, 1, 8, f);
+	}
+}
+
+/**
+ * Write the value profile: the header "firmvals", the number of sites and
+ * N_VALUE_SLOTS pairs of 64-bit (value, count) per site.
+ */
+static void write_values(profile_counter_t *counter, FILE *f)
+{
+	if (counter->values == NULL)
+		return;
+
+	fputs("firmvals", f);
+	write_little_endian(&counter->n_value_sites, 1, f);
+	write_little_endian64(counter->values,
+	                      counter->n_value_sites * 2 * N_VALUE_SLOTS, f);
+}
+
 static void write_profiles(void)
 {
 	profile_counter_t *counter = counters;
@@ -52,6 +101,7 @@ static void write_profiles(void)
 		} else {
 			fputs("firmprof", f);
 			write_little_endian(counter->counters, counter->len, f);
+			write_values(counter, f);
 			fclose(f);
 		}
 		free(counter);
@@ -79,10 +129,74 @@ void __init_firmprof(const char *filename,
 	if (counter == NULL)
 		return;
 
-	counter->filename = filename;
-	counter->counters = counts;
-	counter->next     = counters;
-	counter->len      = len;
+	counter->filename      = filename;
+	counter->counters      = counts;
+	counter->next          = counters;
+	counter->len           = len;
+	counter->values        = NULL;
+	counter->n_value_sites = 0;
 
 	counters = counter;
 }
+
+/**
+ * Register the value slots of a translation unit, called after
+ * __init_firmprof() with the same filename.
+ */
+void __init_firmprof_values(const char *filename, uintptr_t *slots,
+                            unsigned n_sites)
+{
+	profile_counter_t *counter;
+
+	for (counter = counters; counter != NULL; counter = counter->next) {
+		if (counter->filename == filename) {
+			counter->values        = slots;
+			counter->n_value_sites = n_sites;
+			return;
+		}
+	}
+}
+
+/**
+ * Record a value in the slots of a value site. The slots keep the most
+ * frequent values: if all slots are taken the least frequent value is
+ * replaced and inherits its count (space saving).
+ */
+void __firmprof_value(uintptr_t *slots, uintptr_t value)
+{
+	unsigned i;
+	unsigned min = 0;
+
+	for (i = 0; i < N_VALUE_SLOTS; ++i) {
+		uintptr_t *slot = &slots[2 * i];
+		if (slot[1] != 0 && slot[0] == value) {
+			++slot[1];
+			return;
+		}
+		if (slot[1] < slots[2 * min + 1])
+			min = i;
+	}
+
+	slots[2 * min]     = value;
+	slots[2 * min + 1] += 1;
+}
+
+/**
+ * Announce the callee of an indirect call.
+ */
+void __firmprof_icall(uintptr_t *slots, void *callee)
+{
+	icall_slots  = slots;
+	icall_callee = callee;
+}
+
+/**
+ * Called on entry of every instrumented function. Records the identifier of
+ * the function if it is the target of the announced indirect call.
+ */
+void __firmprof_callee(void *self, uintptr_t id)
+{
+	if (icall_slots != NULL && icall_callee == self)
+		__firmprof_value(icall_slots, id);
+	icall_slots = NULL;
+}
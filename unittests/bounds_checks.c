@@ -0,0 +1,143 @@
+/*
+ * Checks opt_bounds_checks() on a check inside a counted loop
+ * for (i = 0; i < n; ++i): checks implied by the loop condition and the
+ * induction variable must be removed, all others must stay.
+ */
+#include "firm.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+static int result = 0;
+
+typedef enum check_case_t {
+	CASE_SAME,      /**< i < n again, implied by the loop condition */
+	CASE_UNSIGNED,  /**< (unsigned)i < (unsigned)n, needs 0 <= i */
+	CASE_SUCC,      /**< i + 1 <= n */
+	CASE_OTHER,     /**< i < m, nothing is known about m */
+	CASE_SUCC_LESS, /**< i + 1 < n, fails in the last iteration */
+} check_case_t;
+
+static char const *const case_names[] = {
+	"same", "unsigned", "successor", "other bound", "successor less",
+};
+
+static void count_conds(ir_node *const node, void *const data)
+{
+	if (is_Cond(node))
+		++*(unsigned*)data;
+}
+
+/**
+ * Builds: for (i = 0; i < n; ++i) { if (!check) return -1; sum += i; }
+ * return sum;
+ */
+static ir_graph *build_loop(check_case_t const c)
+{
+	ir_type *const int_type    = get_type_for_mode(mode_Is);
+	ir_type *const method_type = new_type_method(2, 1, false, cc_cdecl_set,
+	                                             mtp_no_property);
+	set_method_param_type(method_type, 0, int_type);
+	set_method_param_type(method_type, 1, int_type);
+	set_method_res_type(method_type, 0, int_type);
+	ir_entity *const entity
+		= new_entity(get_glob_type(), id_unique("f"), method_type);
+	ir_graph  *const irg = new_ir_graph(entity, 2);
+	set_current_ir_graph(irg);
+
+	ir_node *const args = get_irg_args(irg);
+	ir_node *const n    = new_Proj(args, mode_Is, 0);
+	ir_node *const m    = new_Proj(args, mode_Is, 1);
+	ir_node *const one  = new_Const_long(mode_Is, 1);
+	set_value(0, new_Const_long(mode_Is, 0));
+	set_value(1, new_Const_long(mode_Is, 0));
+
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const i         = get_value(0, mode_Is);
+	ir_node *const loop_cond = new_Cond(new_Cmp(i, n, ir_relation_less));
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(loop_cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *check;
+	switch (c) {
+	case CASE_SAME:
+		check = new_Cmp(i, n, ir_relation_less);
+		break;
+	case CASE_UNSIGNED:
+		check = new_Cmp(new_Conv(i, mode_Iu), new_Conv(n, mode_Iu),
+		                ir_relation_less);
+		break;
+	case CASE_SUCC:
+		check = new_Cmp(new_Add(i, one), n, ir_relation_less_equal);
+		break;
+	case CASE_OTHER:
+		check = new_Cmp(i, m, ir_relation_less);
+		break;
+	case CASE_SUCC_LESS:
+		check = new_Cmp(new_Add(i, one), n, ir_relation_less);
+		break;
+	default:
+		return NULL;
+	}
+	ir_node *const check_cond = new_Cond(check);
+
+	ir_node *const fail = new_immBlock();
+	add_immBlock_pred(fail, new_Proj(check_cond, mode_X, pn_Cond_false));
+	mature_immBlock(fail);
+	set_cur_block(fail);
+	ir_node *const fail_res[] = { new_Const_long(mode_Is, -1) };
+	add_immBlock_pred(get_irg_end_block(irg),
+	                  new_Return(get_store(), 1, fail_res));
+
+	ir_node *const next = new_immBlock();
+	add_immBlock_pred(next, new_Proj(check_cond, mode_X, pn_Cond_true));
+	mature_immBlock(next);
+	set_cur_block(next);
+	set_value(1, new_Add(get_value(1, mode_Is), i));
+	set_value(0, new_Add(i, one));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(loop_cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *const res[] = { get_value(1, mode_Is) };
+	add_immBlock_pred(get_irg_end_block(irg), new_Return(get_store(), 1, res));
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static void test_case(check_case_t const c, bool const removable)
+{
+	ir_graph *const irg = build_loop(c);
+	opt_bounds_checks(irg);
+	irg_verify(irg);
+
+	unsigned n_conds = 0;
+	irg_walk_graph(irg, count_conds, NULL, &n_conds);
+	unsigned const expected = removable ? 1 : 2;
+	if (n_conds != expected) {
+		fprintf(stderr, "%s: %u Conds left, expected %u\n", case_names[c],
+		        n_conds, expected);
+		result = 1;
+	}
+}
+
+int main(void)
+{
+	ir_init();
+
+	test_case(CASE_SAME,      true);
+	test_case(CASE_UNSIGNED,  true);
+	test_case(CASE_SUCC,      true);
+	test_case(CASE_OTHER,     false);
+	test_case(CASE_SUCC_LESS, false);
+
+	ir_finish();
+	return result;
+}
@@ -0,0 +1,158 @@
+/*
+ * Checks the packing of isomorphic values in combine_memops(): bitwise
+ * operations on Loads from adjacent addresses stored to adjacent addresses
+ * become a single wide Load and Store, while rejected candidates must leave
+ * the graph untouched and must not create any nodes.
+ */
+#include "firm.h"
+#include "irgraph_t.h"
+#include <stdio.h>
+
+static int result = 0;
+
+typedef enum pack_case_t {
+	CASE_PACKED,         /**< Eor of adjacent Loads and constants */
+	CASE_ARITHMETIC,     /**< Add carries between the lanes */
+	CASE_NOT_ADJACENT,   /**< the second operands are not adjacent */
+	CASE_MULTIPLE_USERS, /**< a Load result is used elsewhere */
+} pack_case_t;
+
+static char const *const case_names[] = {
+	"packed", "arithmetic", "not adjacent", "multiple users",
+};
+
+typedef struct counts_t {
+	unsigned n_loads;
+	unsigned n_stores;
+	unsigned n_wide;
+} counts_t;
+
+static void count_memops(ir_node *const node, void *const data)
+{
+	counts_t *const counts = (counts_t*)data;
+	if (is_Load(node)) {
+		++counts->n_loads;
+		if (get_Load_mode(node) == mode_Hu)
+			++counts->n_wide;
+	} else if (is_Store(node)) {
+		++counts->n_stores;
+		if (get_irn_mode(get_Store_value(node)) == mode_Hu)
+			++counts->n_wide;
+	}
+}
+
+static ir_node *add_offset(ir_node *const ptr, long const offset)
+{
+	ir_mode *const mode = get_reference_offset_mode(get_irn_mode(ptr));
+	return new_Add(ptr, new_Const_long(mode, offset));
+}
+
+static ir_node *load_byte(ir_node *const mem, ir_node *const ptr,
+                          ir_node **const projs, unsigned *const n_projs)
+{
+	ir_type *const type = get_type_for_mode(mode_Bu);
+	ir_node *const load = new_Load(mem, ptr, mode_Bu, type, cons_none);
+	projs[(*n_projs)++] = new_Proj(load, mode_M, pn_Load_M);
+	return new_Proj(load, mode_Bu, pn_Load_res);
+}
+
+static void test_case(pack_case_t const c)
+{
+	ir_type *const ptr_type    = new_type_pointer(get_type_for_mode(mode_Bu));
+	ir_type *const method_type = new_type_method(3, 1, false, cc_cdecl_set,
+	                                             mtp_no_property);
+	set_method_param_type(method_type, 0, ptr_type);
+	set_method_param_type(method_type, 1, ptr_type);
+	set_method_param_type(method_type, 2, ptr_type);
+	set_method_res_type(method_type, 0, get_type_for_mode(mode_Bu));
+	ir_entity *const entity
+		= new_entity(get_glob_type(), id_unique("f"), method_type);
+	ir_graph  *const irg = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	ir_node *const args = get_irg_args(irg);
+	ir_node *const p    = new_Proj(args, mode_P, 0);
+	ir_node *const q    = new_Proj(args, mode_P, 1);
+	ir_node *const r    = new_Proj(args, mode_P, 2);
+	ir_node *const mem  = get_store();
+
+	ir_node *sync_in[8];
+	unsigned n_sync_in = 0;
+	ir_node *const a0 = load_byte(mem, p, sync_in, &n_sync_in);
+	ir_node *const a1 = load_byte(mem, add_offset(p, 1), sync_in, &n_sync_in);
+	ir_node *v0;
+	ir_node *v1;
+	ir_node *res = new_Const_long(mode_Bu, 0);
+	switch (c) {
+	case CASE_PACKED:
+		v0 = new_Eor(a0, new_Const_long(mode_Bu, 0x12));
+		v1 = new_Eor(a1, new_Const_long(mode_Bu, 0x34));
+		break;
+	case CASE_ARITHMETIC:
+		v0 = new_Add(a0, new_Const_long(mode_Bu, 0x12));
+		v1 = new_Add(a1, new_Const_long(mode_Bu, 0x34));
+		break;
+	case CASE_NOT_ADJACENT: {
+		ir_node *const b0 = load_byte(mem, r, sync_in, &n_sync_in);
+		ir_node *const b1 = load_byte(mem, add_offset(r, 2), sync_in, &n_sync_in);
+		v0 = new_And(a0, b0);
+		v1 = new_And(a1, b1);
+		break;
+	}
+	case CASE_MULTIPLE_USERS:
+		v0 = new_Or(a0, new_Const_long(mode_Bu, 0x12));
+		v1 = new_Or(a1, new_Const_long(mode_Bu, 0x34));
+		res = a1;
+		break;
+	default:
+		return;
+	}
+
+	ir_type *const type = get_type_for_mode(mode_Bu);
+	ir_node *const st0  = new_Store(mem, q, v0, type, cons_none);
+	ir_node *const st1  = new_Store(mem, add_offset(q, 1), v1, type, cons_none);
+	sync_in[n_sync_in++] = new_Proj(st0, mode_M, pn_Store_M);
+	sync_in[n_sync_in++] = new_Proj(st1, mode_M, pn_Store_M);
+	ir_node *const sync  = new_Sync(n_sync_in, sync_in);
+	ir_node *const ret_in[] = { res };
+	add_immBlock_pred(get_irg_end_block(irg), new_Return(sync, 1, ret_in));
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+
+	unsigned const last_idx = get_irg_last_idx(irg);
+	combine_memops(irg);
+	irg_verify(irg);
+
+	counts_t counts = { 0, 0, 0 };
+	irg_walk_graph(irg, count_memops, NULL, &counts);
+	bool ok;
+	if (c == CASE_PACKED) {
+		ok = counts.n_loads == 1 && counts.n_stores == 1 && counts.n_wide == 2;
+	} else {
+		unsigned const n_loads = c == CASE_NOT_ADJACENT ? 4 : 2;
+		ok = counts.n_loads == n_loads && counts.n_stores == 2
+		  && counts.n_wide == 0 && get_irg_last_idx(irg) == last_idx;
+	}
+	if (!ok) {
+		fprintf(stderr, "%s: %u Loads, %u Stores, %u wide, %u new nodes\n",
+		        case_names[c], counts.n_loads, counts.n_stores, counts.n_wide,
+		        get_irg_last_idx(irg) - last_idx);
+		result = 1;
+	}
+}
+
+int main(void)
+{
+	ir_init();
+	ir_target_set("x86_64-linux-gnu");
+	ir_target_init();
+	set_optimize(0);
+
+	test_case(CASE_PACKED);
+	test_case(CASE_ARITHMETIC);
+	test_case(CASE_NOT_ADJACENT);
+	test_case(CASE_MULTIPLE_USERS);
+
+	ir_finish();
+	return result;
+}
@@ -0,0 +1,132 @@
+/*
+ * Checks be_layout_frame_type(): entities have to be aligned, must not
+ * overlap and filling the alignment holes must never make the frame larger
+ * than laying out the entities one after another.
+ */
+#include "bestack.h"
+#include "bitfiddle.h"
+#include "entity_t.h"
+#include "firm.h"
+#include "util.h"
+#include <assert.h>
+#include <stdio.h>
+
+#define MAX_MEMBERS 24
+
+static int result = 0;
+
+static unsigned rand_state = 1;
+
+static unsigned next_rand(void)
+{
+	rand_state = rand_state * 1103515245u + 12345u;
+	return rand_state >> 16;
+}
+
+static void get_size_alignment(ir_entity const *const member,
+                               unsigned *const size, unsigned *const alignment)
+{
+	*alignment = get_entity_alignment(member);
+	if (member->kind == IR_ENTITY_SPILLSLOT) {
+		*size = member->attr.spillslot.size;
+	} else {
+		ir_type const *const type = get_entity_type(member);
+		*size      = get_type_size(type);
+		*alignment = MAX(*alignment, get_type_alignment(type));
+	}
+}
+
+static int align_down(int const offset, unsigned const alignment,
+                      unsigned const misalign)
+{
+	unsigned const up = round_up2(-offset + misalign, alignment) - misalign;
+	return -(int)up;
+}
+
+static void check_frame(unsigned const seed, bool const sp_relative,
+                        unsigned const misalign)
+{
+	ir_mode *const modes[] = { mode_Bs, mode_Hs, mode_Is, mode_Ls };
+
+	rand_state = seed;
+	ir_type *const frame     = new_type_frame();
+	unsigned const n_members = 2 + next_rand() % (MAX_MEMBERS - 2);
+	for (unsigned i = 0; i < n_members; ++i) {
+		unsigned const r = next_rand();
+		if (r % 3 == 0) {
+			unsigned const po2align = next_rand() % 5;
+			new_spillslot(frame, 1u << po2align, po2align);
+		} else {
+			char name[16];
+			snprintf(name, sizeof(name), "l%u", i);
+			ir_type *const type = get_type_for_mode(modes[r % ARRAY_SIZE(modes)]);
+			new_entity(frame, new_id_from_str(name), type);
+		}
+	}
+	be_sort_frame_entities(frame, sp_relative);
+	for (unsigned i = 0; i < n_members; ++i) {
+		if (get_compound_member_index(frame, get_compound_member(frame, i)) != i) {
+			fprintf(stderr, "seed %u, sp %d: member %u has a stale index\n",
+			        seed, sp_relative, i);
+			result = 1;
+		}
+	}
+
+	/* the frame size without filling any holes */
+	int naive = 0;
+	for (unsigned i = 0; i < n_members; ++i) {
+		unsigned size;
+		unsigned alignment;
+		get_size_alignment(get_compound_member(frame, i), &size, &alignment);
+		naive = align_down(naive - (int)size, alignment, misalign);
+	}
+
+	be_layout_frame_type(frame, 0, misalign, sp_relative);
+	int const frame_size = get_type_size(frame);
+	if (frame_size > -naive) {
+		fprintf(stderr, "seed %u, sp %d, misalign %u: frame size %d > %d\n",
+		        seed, sp_relative, misalign, frame_size, -naive);
+		result = 1;
+	}
+
+	for (unsigned i = 0; i < n_members; ++i) {
+		ir_entity const *const member = get_compound_member(frame, i);
+		unsigned size;
+		unsigned alignment;
+		get_size_alignment(member, &size, &alignment);
+		int const offset = get_entity_offset(member);
+		if (offset < -frame_size || offset + (int)size > 0
+		 || align_down(offset, alignment, misalign) != offset) {
+			fprintf(stderr, "seed %u, sp %d, misalign %u: member %u at %d misplaced\n",
+			        seed, sp_relative, misalign, i, offset);
+			result = 1;
+		}
+		for (unsigned j = 0; j < i; ++j) {
+			ir_entity const *const other = get_compound_member(frame, j);
+			unsigned other_size;
+			unsigned other_alignment;
+			get_size_alignment(other, &other_size, &other_alignment);
+			int const other_offset = get_entity_offset(other);
+			if (offset < other_offset + (int)other_size
+			 && other_offset < offset + (int)size) {
+				fprintf(stderr, "seed %u, sp %d, misalign %u: members %u and %u overlap\n",
+				        seed, sp_relative, misalign, j, i);
+				result = 1;
+			}
+		}
+	}
+	free_type(frame);
+}
+
+int main(void)
+{
+	ir_init();
+	for (unsigned seed = 1; seed <= 500; ++seed) {
+		check_frame(seed, false, 0);
+		check_frame(seed, true,  0);
+		check_frame(seed, false, 4);
+		check_frame(seed, true,  8);
+	}
+	ir_finish();
+	return result;
+}
@@ -0,0 +1,231 @@
+/*
+ * Checks unroll_loops() on counted loops: the unrolled graph is interpreted
+ * and has to compute the same result as the original loop, for trip counts
+ * which are odd, not divisible by the unroll factor or where the step does
+ * not divide the interval.
+ */
+#include "firm.h"
+#include "irgraph_t.h"
+#include "irnode_t.h"
+#include "irouts_t.h"
+#include "panic.h"
+#include "util.h"
+#include "xmalloc.h"
+#include <stdio.h>
+
+static int result = 0;
+
+typedef struct loop_case_t {
+	long        init;
+	ir_relation relation;
+	long        limit;
+	long        step;
+} loop_case_t;
+
+static ir_tarval **values;
+static unsigned   *visits;
+static unsigned    visit;
+static ir_node    *cur_block;
+
+/**
+ * Builds: sum = 0; for (i = init; i <relation> limit; i += step) sum += i;
+ * return sum;
+ */
+static ir_graph *build_loop(loop_case_t const *const c)
+{
+	ir_type *const int_type    = get_type_for_mode(mode_Is);
+	ir_type *const method_type = new_type_method(0, 1, false, cc_cdecl_set,
+	                                             mtp_no_property);
+	set_method_res_type(method_type, 0, int_type);
+	ir_entity *const entity
+		= new_entity(get_glob_type(), id_unique("f"), method_type);
+	ir_graph  *const irg = new_ir_graph(entity, 2);
+	set_current_ir_graph(irg);
+
+	set_value(0, new_Const_long(mode_Is, c->init));
+	set_value(1, new_Const_long(mode_Is, 0));
+	ir_node *const header = new_immBlock();
+	add_immBlock_pred(header, new_Jmp());
+	set_cur_block(header);
+	ir_node *const i    = get_value(0, mode_Is);
+	ir_node *const cmp  = new_Cmp(i, new_Const_long(mode_Is, c->limit),
+	                              c->relation);
+	ir_node *const cond = new_Cond(cmp);
+
+	ir_node *const body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	set_value(1, new_Add(get_value(1, mode_Is), i));
+	set_value(0, new_Add(i, new_Const_long(mode_Is, c->step)));
+	add_immBlock_pred(header, new_Jmp());
+	mature_immBlock(header);
+
+	ir_node *const exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *const ret_in[] = { get_value(1, mode_Is) };
+	add_immBlock_pred(get_irg_end_block(irg),
+	                  new_Return(get_store(), 1, ret_in));
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return irg;
+}
+
+static ir_tarval *eval(ir_node *const node)
+{
+	/* values of other blocks are those of their last execution */
+	unsigned const idx = get_irn_idx(node);
+	if (visits[idx] == visit || is_Phi(node)
+	 || (get_nodes_block(node) != cur_block && values[idx] != NULL))
+		return values[idx];
+	visits[idx] = visit;
+
+	ir_tarval *value;
+	switch (get_irn_opcode(node)) {
+	case iro_Const: value = get_Const_tarval(node);                              break;
+	case iro_Add:   value = tarval_add(eval(get_Add_left(node)), eval(get_Add_right(node))); break;
+	case iro_Sub:   value = tarval_sub(eval(get_Sub_left(node)), eval(get_Sub_right(node))); break;
+	case iro_Conv:  value = tarval_convert_to(eval(get_Conv_op(node)), get_irn_mode(node)); break;
+	case iro_Cmp: {
+		ir_relation const relation
+			= tarval_cmp(eval(get_Cmp_left(node)), eval(get_Cmp_right(node)));
+		value = relation & get_Cmp_relation(node) ? tarval_b_true : tarval_b_false;
+		break;
+	}
+	default:
+		panic("unexpected node %+F", node);
+	}
+	values[idx] = value;
+	return value;
+}
+
+/** Interprets @p irg, returns the returned value or NULL on a runaway loop. */
+static ir_tarval *interpret(ir_graph *const irg)
+{
+	assure_irg_outs(irg);
+	unsigned const n = get_irg_last_idx(irg);
+	values = XMALLOCNZ(ir_tarval*, n);
+	visits = XMALLOCNZ(unsigned, n);
+	visit  = 0;
+
+	ir_tarval *res   = NULL;
+	ir_node   *block = get_irg_start_block(irg);
+	for (unsigned steps = 0; steps < 10000; ++steps) {
+		++visit;
+		cur_block = block;
+		ir_node *x = NULL;
+		for (unsigned i = 0, n_outs = get_irn_n_outs(block); i < n_outs; ++i) {
+			ir_node *const node = get_irn_out(block, i);
+			if (is_Return(node)) {
+				res = eval(get_Return_res(node, 0));
+				goto out;
+			} else if (is_Jmp(node)) {
+				x = node;
+			} else if (is_Cond(node)) {
+				bool const taken = eval(get_Cond_selector(node)) == tarval_b_true;
+				for (unsigned j = 0, n_projs = get_irn_n_outs(node); j < n_projs; ++j) {
+					ir_node *const proj = get_irn_out(node, j);
+					if ((get_Proj_num(proj) == pn_Cond_true) == taken)
+						x = proj;
+				}
+			} else if (get_irn_mode(node) != mode_M && get_irn_mode(node) != mode_X
+			        && get_irn_mode(node) != mode_T && !is_Phi(node)
+			        && !is_Proj(node) && !is_End(node)) {
+				eval(node);
+			}
+		}
+		if (x == NULL)
+			panic("no control flow out of %+F", block);
+
+		/* enter the successor, evaluating its Phis in parallel */
+		ir_node *const next = get_irn_out(x, 0);
+		int pos = -1;
+		for (int i = 0, arity = get_Block_n_cfgpreds(next); i < arity; ++i) {
+			if (get_Block_cfgpred(next, i) == x)
+				pos = i;
+		}
+		ir_node   *phis[64];
+		ir_tarval *phi_values[64];
+		unsigned   n_phis = 0;
+		for (unsigned i = 0, n_outs = get_irn_n_outs(next); i < n_outs; ++i) {
+			ir_node *const phi = get_irn_out(next, i);
+			if (!is_Phi(phi) || get_irn_mode(phi) == mode_M)
+				continue;
+			phis[n_phis]         = phi;
+			phi_values[n_phis++] = eval(get_Phi_pred(phi, pos));
+		}
+		for (unsigned i = 0; i < n_phis; ++i)
+			values[get_irn_idx(phis[i])] = phi_values[i];
+		block = next;
+	}
+out:
+	free(values);
+	free(visits);
+	return res;
+}
+
+static void test_case(loop_case_t const *const c, unsigned const factor)
+{
+	long expected = 0;
+	for (long i = c->init;; i += c->step) {
+		bool stay;
+		switch (c->relation) {
+		case ir_relation_less:          stay = i <  c->limit; break;
+		case ir_relation_less_equal:    stay = i <= c->limit; break;
+		case ir_relation_greater:       stay = i >  c->limit; break;
+		case ir_relation_greater_equal: stay = i >= c->limit; break;
+		default:                        panic("unexpected relation");
+		}
+		if (!stay)
+			break;
+		expected += i;
+	}
+
+	ir_graph *const irg = build_loop(c);
+	unroll_loops(irg, factor, 128);
+	irg_verify(irg);
+	ir_tarval *const res = interpret(irg);
+	if (res == NULL || get_tarval_long(res) != expected) {
+		fprintf(stderr, "for (i = %ld; i %s %ld; i += %ld), factor %u: %ld != %ld\n",
+		        c->init, get_relation_string(c->relation), c->limit, c->step,
+		        factor, res != NULL ? get_tarval_long(res) : -1, expected);
+		result = 1;
+	}
+}
+
+int main(void)
+{
+	ir_init();
+	/* keep the relations as built, local optimization normalizes them */
+	set_optimize(0);
+
+	static loop_case_t const cases[] = {
+		{  0, ir_relation_less,           9,  1 },
+		{  0, ir_relation_less,          10,  1 },
+		{  0, ir_relation_less,          16,  1 },
+		{  0, ir_relation_less_equal,     9,  1 },
+		{  0, ir_relation_less_equal,    10,  1 },
+		{  1, ir_relation_less,          10,  1 },
+		{  0, ir_relation_less,           9,  2 },
+		{  0, ir_relation_less,          10,  2 },
+		{  0, ir_relation_less,          10,  3 },
+		{  0, ir_relation_less,          12,  3 },
+		{  0, ir_relation_less_equal,    11,  2 },
+		{ 10, ir_relation_greater,        0, -1 },
+		{  9, ir_relation_greater,        0, -1 },
+		{  9, ir_relation_greater_equal,  0, -1 },
+		{ 17, ir_relation_greater,        0, -2 },
+		{ 16, ir_relation_greater_equal,  1, -3 },
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(cases); ++i) {
+		test_case(&cases[i], 2);
+		test_case(&cases[i], 4);
+		test_case(&cases[i], 8);
+		test_case(&cases[i], 32);
+	}
+
+	ir_finish();
+	return result;
+}
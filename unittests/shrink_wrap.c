@@ -0,0 +1,402 @@
+/*
+ * Checks shrink wrapping on amd64 and ia32 without frame pointer: Functions
+ * which only need their stack frame after an early exit are compiled and the
+ * assembler output is simulated.  The early exit must not touch the stack
+ * pointer, every return must find it at the function entry value and every
+ * .cfi_def_cfa_offset must match the simulated stack pointer, also at blocks
+ * with several predecessors.
+ */
+#include "firm.h"
+#include "util.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int result = 0;
+
+static ir_type   *int_type;
+static ir_entity *ext;
+static ir_entity *glob_g;
+static ir_entity *glob_h;
+
+typedef enum sw_case_t {
+	CASE_EARLY,   /**< if (g == 0) return 0; the frame is used afterwards */
+	CASE_SEVERAL, /**< the frame is used in both branches of an if */
+	CASE_LOOP,    /**< the frame is used inside of a loop */
+} sw_case_t;
+
+static char const *const case_names[] = { "early", "several", "loop" };
+
+static ir_node *load_global(ir_entity *const entity)
+{
+	ir_node *const load = new_Load(get_store(), new_Address(entity), mode_Is,
+	                               int_type, cons_none);
+	set_store(new_Proj(load, mode_M, pn_Load_M));
+	return new_Proj(load, mode_Is, pn_Load_res);
+}
+
+/** Stores @p value to a local, passes its address to ext() and reloads it. */
+static ir_node *use_local(ir_entity *const local, long const value)
+{
+	ir_node *const addr  = new_Member(get_irg_frame(current_ir_graph), local);
+	ir_node *const store = new_Store(get_store(), addr,
+	                                 new_Const_long(mode_Is, value), int_type,
+	                                 cons_none);
+	set_store(new_Proj(store, mode_M, pn_Store_M));
+	ir_node *const in[] = { addr };
+	ir_node *const call = new_Call(get_store(), new_Address(ext), 1, in,
+	                               get_entity_type(ext));
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node *const load = new_Load(get_store(), addr, mode_Is, int_type,
+	                               cons_none);
+	set_store(new_Proj(load, mode_M, pn_Load_M));
+	return new_Proj(load, mode_Is, pn_Load_res);
+}
+
+static void add_return(ir_node *const value)
+{
+	ir_node *const in[] = { value };
+	add_immBlock_pred(get_irg_end_block(current_ir_graph),
+	                  new_Return(get_store(), 1, in));
+}
+
+/** Branches on @p selector, returns the true block, the false block in @p f */
+static ir_node *branch(ir_node *const selector, ir_node **const f)
+{
+	ir_node *const cond = new_Cond(selector);
+	ir_node *const t    = new_immBlock();
+	add_immBlock_pred(t, new_Proj(cond, mode_X, pn_Cond_true));
+	mature_immBlock(t);
+	*f = new_immBlock();
+	add_immBlock_pred(*f, new_Proj(cond, mode_X, pn_Cond_false));
+	mature_immBlock(*f);
+	return t;
+}
+
+static void build_function(sw_case_t const c)
+{
+	ir_type *const method_type = new_type_method(0, 1, false, cc_cdecl_set,
+	                                             mtp_no_property);
+	set_method_res_type(method_type, 0, int_type);
+	ir_entity *const entity = new_entity(get_glob_type(),
+	                                     new_id_from_str(case_names[c]),
+	                                     method_type);
+	ir_graph  *const irg    = new_ir_graph(entity, 1);
+	set_current_ir_graph(irg);
+	ir_entity *const local  = new_entity(get_irg_frame_type(irg),
+	                                     new_id_from_str("l"), int_type);
+
+	ir_node *rest;
+	ir_node *const exit = branch(new_Cmp(load_global(glob_g),
+	                                     new_Const_long(mode_Is, 0),
+	                                     ir_relation_equal), &rest);
+	set_cur_block(exit);
+	add_return(new_Const_long(mode_Is, 0));
+
+	set_cur_block(rest);
+	switch (c) {
+	case CASE_EARLY:
+		add_return(use_local(local, 1));
+		break;
+	case CASE_SEVERAL: {
+		ir_node *other;
+		ir_node *const then = branch(new_Cmp(load_global(glob_h),
+		                                     new_Const_long(mode_Is, 0),
+		                                     ir_relation_less_greater), &other);
+		ir_node *const join = new_immBlock();
+		set_cur_block(then);
+		set_value(0, use_local(local, 1));
+		add_immBlock_pred(join, new_Jmp());
+		set_cur_block(other);
+		set_value(0, use_local(local, 2));
+		add_immBlock_pred(join, new_Jmp());
+		mature_immBlock(join);
+		set_cur_block(join);
+		add_return(get_value(0, mode_Is));
+		break;
+	}
+	case CASE_LOOP: {
+		ir_node *const header = new_immBlock();
+		add_immBlock_pred(header, new_Jmp());
+		set_cur_block(header);
+		ir_node *done;
+		ir_node *const body = branch(new_Cmp(load_global(glob_h),
+		                                     new_Const_long(mode_Is, 0),
+		                                     ir_relation_less_greater), &done);
+		set_cur_block(body);
+		use_local(local, 3);
+		add_immBlock_pred(header, new_Jmp());
+		mature_immBlock(header);
+		set_cur_block(done);
+		add_return(new_Const_long(mode_Is, 1));
+		break;
+	}
+	}
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+typedef struct sp_edge_t {
+	char label[32];
+	int  offset;
+} sp_edge_t;
+
+typedef struct sp_sim_t {
+	char const *target;
+	char const *function;
+	int         ret_offset;     /**< offset with only the return address */
+	int         word_size;
+	int         offset;         /**< simulated CFA offset, -1 if unknown */
+	bool        in_entry_block;
+	bool        block_changed;  /**< the current block changed the sp */
+	bool        block_begin;    /**< no instruction in the current block yet */
+	bool        early_exit;     /**< found a return not touching the sp */
+	sp_edge_t   claims[64];     /**< CFA offsets claimed at block begins */
+	unsigned    n_claims;
+	sp_edge_t   edges[64];      /**< CFA offsets at jumps */
+	unsigned    n_edges;
+} sp_sim_t;
+
+static void fail(sp_sim_t const *const sim, char const *const line,
+                 char const *const message)
+{
+	fprintf(stderr, "%s %s: %s: %s", sim->target, sim->function, message,
+	        line);
+	result = 1;
+}
+
+static bool is_sp(sp_sim_t const *const sim, char const *const operand)
+{
+	return strcmp(operand, sim->word_size == 8 ? "%rsp" : "%esp") == 0;
+}
+
+static void sim_label(sp_sim_t *const sim, char const *const label)
+{
+	if (sim->n_claims == 64)
+		abort();
+	sp_edge_t *const claim = &sim->claims[sim->n_claims++];
+	snprintf(claim->label, sizeof(claim->label), "%s", label);
+	/* the offset when falling through, filled in by .cfi_def_cfa_offset */
+	claim->offset      = sim->offset;
+	sim->block_changed = false;
+	sim->block_begin   = true;
+	/* the first label is the one of the entry block */
+	if (sim->n_claims > 1)
+		sim->in_entry_block = false;
+}
+
+static void sim_jump(sp_sim_t *const sim, char const *const label)
+{
+	if (sim->n_edges == 64)
+		abort();
+	sp_edge_t *const edge = &sim->edges[sim->n_edges++];
+	snprintf(edge->label, sizeof(edge->label), "%s", label);
+	edge->offset = sim->offset;
+}
+
+static void sim_instruction(sp_sim_t *const sim, char const *const line)
+{
+	char mnemonic[32] = "";
+	char op0[64]      = "";
+	char op1[64]      = "";
+	if (sscanf(line, " %31s %63[^, \t\n] , %63s", mnemonic, op0, op1) < 1)
+		return;
+
+	if (strcmp(mnemonic, ".cfi_def_cfa_offset") == 0) {
+		int const offset = atoi(op0);
+		if (sim->block_begin) {
+			/* the offset falling through into the block */
+			sp_edge_t *const claim = &sim->claims[sim->n_claims - 1];
+			if (claim->offset >= 0 && claim->offset != offset)
+				fail(sim, line, "wrong CFA offset after fall through");
+			claim->offset = offset;
+			sim->offset   = offset;
+		} else if (offset != sim->offset) {
+			fail(sim, line, "wrong CFA offset");
+		}
+		return;
+	} else if (mnemonic[0] == '.' || mnemonic[0] == '/') {
+		return;
+	}
+
+	sim->block_begin = false;
+	int  change = 0;
+	long imm;
+	if (strcmp(mnemonic, "ret") == 0) {
+		if (sim->offset != sim->ret_offset)
+			fail(sim, line, "stack pointer not restored at return");
+		if (!sim->block_changed && !sim->in_entry_block
+		 && sim->offset == sim->ret_offset)
+			sim->early_exit = true;
+		sim->offset = -1;
+		return;
+	} else if (strcmp(mnemonic, "jmp") == 0) {
+		sim_jump(sim, op0);
+		sim->offset = -1;
+		return;
+	} else if (mnemonic[0] == 'j') {
+		sim_jump(sim, op0);
+		return;
+	} else if (strncmp(mnemonic, "push", 4) == 0) {
+		change = sim->word_size;
+	} else if (strncmp(mnemonic, "pop", 3) == 0) {
+		change = -sim->word_size;
+	} else if (is_sp(sim, op1) && sscanf(op0, "$%ld", &imm) == 1
+	        && strncmp(mnemonic, "sub", 3) == 0) {
+		change = (int)imm;
+	} else if (is_sp(sim, op1) && sscanf(op0, "$%ld", &imm) == 1
+	        && strncmp(mnemonic, "add", 3) == 0) {
+		change = -(int)imm;
+	} else if (is_sp(sim, op1) || is_sp(sim, op0) && op1[0] == '\0') {
+		fail(sim, line, "unexpected stack pointer modification");
+		return;
+	}
+	if (change != 0) {
+		if (sim->in_entry_block)
+			fail(sim, line, "frame set up before the early exit");
+		sim->offset        += change;
+		sim->block_changed  = true;
+	}
+}
+
+static void check_function(sp_sim_t *const sim)
+{
+	for (unsigned i = 0; i < sim->n_edges; ++i) {
+		sp_edge_t const *const edge = &sim->edges[i];
+		bool found = false;
+		for (unsigned j = 0; j < sim->n_claims; ++j) {
+			sp_edge_t const *const claim = &sim->claims[j];
+			if (strcmp(edge->label, claim->label) != 0)
+				continue;
+			found = true;
+			if (edge->offset != claim->offset) {
+				fprintf(stderr, "%s %s: jump to %s with CFA offset %d, block begins with %d\n",
+				        sim->target, sim->function, edge->label,
+				        edge->offset, claim->offset);
+				result = 1;
+			}
+		}
+		if (!found) {
+			fprintf(stderr, "%s %s: jump to unknown label %s\n", sim->target,
+			        sim->function, edge->label);
+			result = 1;
+		}
+	}
+	if (!sim->early_exit) {
+		fprintf(stderr, "%s %s: no early exit without stack frame\n",
+		        sim->target, sim->function);
+		result = 1;
+	}
+}
+
+static void check_assembler(FILE *const out, char const *const target,
+                            int const word_size)
+{
+	sp_sim_t sim;
+	memset(&sim, 0, sizeof(sim));
+	sim.target     = target;
+	sim.ret_offset = word_size;
+	sim.word_size  = word_size;
+
+	unsigned n_functions = 0;
+	char     line[256];
+	while (fgets(line, sizeof(line), out) != NULL) {
+		if (sim.function == NULL) {
+			for (size_t i = 0; i < ARRAY_SIZE(case_names); ++i) {
+				size_t const len = strlen(case_names[i]);
+				if (strncmp(line, case_names[i], len) == 0
+				 && line[len] == ':') {
+					sim.function       = case_names[i];
+					sim.offset         = word_size;
+					sim.in_entry_block = true;
+					sim.n_claims       = 0;
+					sim.n_edges        = 0;
+					sim.early_exit     = false;
+				}
+			}
+			continue;
+		}
+
+		char label[32];
+		if (sscanf(line, ".%30[^:]:", label + 1) == 1
+		 || sscanf(line, "/*.%30[^:]:*/", label + 1) == 1) {
+			label[0] = '.';
+			sim_label(&sim, label);
+		} else if (strstr(line, ".cfi_endproc") != NULL) {
+			check_function(&sim);
+			sim.function = NULL;
+			++n_functions;
+		} else if (line[0] == '\t') {
+			/* strip comments and trailing white space */
+			char *end = strstr(line, "/*");
+			if (end == NULL)
+				end = line + strlen(line);
+			while (end > line && isspace((unsigned char)end[-1]))
+				--end;
+			end[0] = '\n';
+			end[1] = '\0';
+			sim_instruction(&sim, line);
+		}
+	}
+	if (n_functions != ARRAY_SIZE(case_names)) {
+		fprintf(stderr, "%s: found %u of the functions\n", target,
+		        n_functions);
+		result = 1;
+	}
+}
+
+static void test_target(char const *const target, int const word_size)
+{
+	ir_target_set(target);
+	ir_target_option("omitfp=true");
+	ir_target_option("shrinkwrap=true");
+	ir_target_option("debug=frameinfo");
+	ir_target_init();
+
+	int_type = get_type_for_mode(mode_Is);
+	ir_type *const ext_type = new_type_method(1, 0, false, cc_cdecl_set,
+	                                          mtp_no_property);
+	set_method_param_type(ext_type, 0, new_type_pointer(int_type));
+	ext    = new_entity(get_glob_type(), new_id_from_str("ext"), ext_type);
+	glob_g = new_entity(get_glob_type(), new_id_from_str("g"), int_type);
+	glob_h = new_entity(get_glob_type(), new_id_from_str("h"), int_type);
+
+	for (size_t i = 0; i < ARRAY_SIZE(case_names); ++i)
+		build_function((sw_case_t)i);
+
+	FILE *const out = tmpfile();
+	if (out == NULL) {
+		perror("tmpfile");
+		exit(1);
+	}
+	be_lower_for_target();
+	be_main(out, "shrink_wrap");
+	rewind(out);
+	check_assembler(out, target, word_size);
+	fclose(out);
+
+	/* start over for the next target */
+	while (get_irp_n_irgs() > 0) {
+		ir_graph  *const irg    = get_irp_irg(0);
+		ir_entity *const entity = get_irg_entity(irg);
+		free_type(get_irg_frame_type(irg));
+		free_ir_graph(irg);
+		free_entity(entity);
+	}
+	free_entity(ext);
+	free_entity(glob_g);
+	free_entity(glob_h);
+}
+
+int main(void)
+{
+	ir_init();
+
+	test_target("x86_64-linux-gnu", 8);
+	test_target("i686-linux-gnu",   4);
+
+	ir_finish();
+	return result;
+}
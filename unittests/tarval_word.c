@@ -0,0 +1,157 @@
+#include "firm.h"
+#include "irprintf.h"
+#include "tv_t.h"
+#include "util.h"
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+static int result = 0;
+
+static ir_tarval const *context_tv;
+static unsigned         context_amount;
+
+static void compare_word(const char *file, unsigned line,
+                         const char *expr0, uint64_t v0,
+                         const char *expr1, uint64_t v1)
+{
+	if (v0 == v1)
+		return;
+	ir_fprintf(stderr, "%s:%d [%+F, shift %u]: Test failed %s != %s  (0x%" PRIx64 " != 0x%" PRIx64 ")\n",
+	           file, line, context_tv, context_amount, expr0, expr1, v0, v1);
+	result = 1;
+}
+#define COMPARE_WORD(val0,val1) compare_word(__FILE__, __LINE__, #val0, val0, #val1, val1)
+
+static void compare_tv(const char *file, unsigned line,
+                       const char *expr0, ir_tarval const *tv0,
+                       const char *expr1, ir_tarval const *tv1)
+{
+	if (tv0 == tv1)
+		return;
+	ir_fprintf(stderr, "%s:%d [%+F]: Test failed %s != %s  (%+F != %+F)\n",
+	           file, line, context_tv, expr0, expr1, tv0, tv1);
+	result = 1;
+}
+#define TVS_EQUAL(val0,val1) compare_tv(__FILE__, __LINE__, #val0, val0, #val1, val1)
+
+static void test_value(ir_tarval *const tv)
+{
+	ir_mode  *const mode = get_tarval_mode(tv);
+	unsigned  const bits = get_mode_word_bits(mode);
+	uint64_t  const mask = word_mask(bits);
+	uint64_t  const w    = get_tarval_word(tv);
+	context_tv     = tv;
+	context_amount = 0;
+
+	/* conversion in both directions */
+	COMPARE_WORD(w & ~mask, (uint64_t)0);
+	TVS_EQUAL(new_tarval_from_word(w, mode), tv);
+	if (tarval_is_long(tv))
+		COMPARE_WORD(w, (uint64_t)get_tarval_long(tv) & mask);
+
+	/* sign extension */
+	ir_mode *const signed_mode = find_signed_mode(mode);
+	if (signed_mode != NULL) {
+		ir_tarval *const stv = tarval_convert_to(tv, signed_mode);
+		COMPARE_WORD(word_sign_extend(w, bits), (uint64_t)get_tarval_long(stv));
+	}
+
+	/* shifts, with amounts around the mode size and the modulo shift */
+	unsigned const amounts[] = {
+		0, 1, bits / 2, bits - 1, bits, bits + 1, 2 * bits - 1, 2 * bits,
+		63, 64, 65, 127, 128, 255, 256, 0x7FFFFFFF, 0xFFFFFFFF,
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(amounts); ++i) {
+		unsigned   const amount = amounts[i];
+		ir_tarval *const atv    = new_tarval_from_long(amount, mode_Iu);
+		context_amount = amount;
+		COMPARE_WORD(word_shl(mode, w, amount), get_tarval_word(tarval_shl(tv, atv)));
+		COMPARE_WORD(word_shr(mode, w, amount), get_tarval_word(tarval_shr(tv, atv)));
+		/* tarval_shrs() only supports whole bytes */
+		if (bits % 8 == 0)
+			COMPARE_WORD(word_shrs(mode, w, amount), get_tarval_word(tarval_shrs(tv, atv)));
+	}
+}
+
+static void test_mode(ir_mode *const mode)
+{
+	unsigned   const bits = get_mode_size_bits(mode);
+	ir_tarval *const one  = get_mode_one(mode);
+	ir_tarval *const min  = get_mode_min(mode);
+	ir_tarval *const max  = get_mode_max(mode);
+
+	unsigned char buffer[8];
+	for (unsigned i = 0; i < sizeof(buffer); ++i)
+		buffer[i] = 0x55;
+	ir_tarval *const oddbits = new_tarval_from_bytes(buffer, mode);
+	for (unsigned i = 0; i < sizeof(buffer); ++i)
+		buffer[i] = 0xaa;
+	ir_tarval *const evenbits = new_tarval_from_bytes(buffer, mode);
+
+	ir_tarval *const values[] = {
+		get_mode_null(mode),
+		one,
+		get_mode_all_one(mode),
+		min,
+		tarval_add(min, one),
+		max,
+		tarval_sub(max, one),
+		oddbits,
+		evenbits,
+		new_tarval_from_long(bits - 1, mode),
+		tarval_shl_unsigned(one, bits / 2),
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(values); ++i)
+		test_value(values[i]);
+}
+
+int main(void)
+{
+	ir_init();
+
+	ir_mode *const modes[] = {
+		mode_Bu, mode_Bs, mode_Hu, mode_Hs, mode_Iu, mode_Is, mode_Lu, mode_Ls,
+
+		new_int_mode("uint1",  1,  false, 0),
+		new_int_mode("uint6",  6,  false, 0),
+		new_int_mode("uint13", 13, false, 0),
+		new_int_mode("uint33", 33, false, 0),
+		new_int_mode("uint63", 63, false, 0),
+
+		new_int_mode("int2",  2,  true, 0),
+		new_int_mode("int6",  6,  true, 0),
+		new_int_mode("int13", 13, true, 0),
+		new_int_mode("int33", 33, true, 0),
+		new_int_mode("int63", 63, true, 0),
+
+		/* modulo shift different from the mode size */
+		new_int_mode("uint32_m64",  32, false, 64),
+		new_int_mode("int32_m0",    32, true,  0),
+		new_int_mode("uint64_m0",   64, false, 0),
+		new_int_mode("int64_m128",  64, true,  128),
+	};
+	for (size_t i = 0; i < ARRAY_SIZE(modes); ++i) {
+		ir_mode *const mode = modes[i];
+		context_tv = get_mode_null(mode);
+		COMPARE_WORD(get_mode_word_bits(mode), get_mode_size_bits(mode));
+		test_mode(mode);
+	}
+
+	/* mode_b */
+	context_tv = tarval_b_true;
+	COMPARE_WORD(get_mode_word_bits(mode_b), 1);
+	COMPARE_WORD(get_tarval_word(tarval_b_false), 0);
+	COMPARE_WORD(get_tarval_word(tarval_b_true), 1);
+	TVS_EQUAL(new_tarval_from_word(0, mode_b), tarval_b_false);
+	TVS_EQUAL(new_tarval_from_word(1, mode_b), tarval_b_true);
+
+	/* no native words for wide and non-integer modes */
+	ir_mode *const wide = new_int_mode("uint65", 65, false, 0);
+	COMPARE_WORD(get_mode_word_bits(wide), 0);
+	COMPARE_WORD(get_mode_word_bits(mode_D), 0);
+	COMPARE_WORD(get_mode_word_bits(mode_P), 0);
+
+	ir_finish();
+	return result;
+}
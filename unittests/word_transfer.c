@@ -0,0 +1,282 @@
+/*
+ * Checks the native word transfer functions of constbits and vrp: every
+ * concrete combination of operand values, evaluated with tarval arithmetic,
+ * has to agree with the analysis results.  Debug builds additionally compare
+ * each word step against the tarval transfer functions.
+ */
+#include "array.h"
+#include "constbits.h"
+#include "firm.h"
+#include "irgraph_t.h"
+#include "irprintf.h"
+#include "irtools.h"
+#include "panic.h"
+#include "tv_t.h"
+#include "util.h"
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#define MAX_ARGS   128
+#define MAX_INPUTS 256
+
+/** An operand with some bits known, built from an Arg unless it is constant. */
+typedef struct input {
+	ir_node  *node;
+	uint64_t  ones;    /**< bits which are known to be one */
+	uint64_t  unknown; /**< bits which may be zero or one */
+} input;
+
+typedef struct test_case {
+	ir_node     *node;
+	input const *left;
+	input const *right; /**< NULL for unary nodes */
+} test_case;
+
+static int        result = 0;
+static ir_type   *method_type;
+static unsigned   n_args;
+static input      inputs[MAX_INPUTS];
+static unsigned   n_inputs;
+static test_case *cases;
+
+static input const *new_input(ir_mode *const mode, uint64_t const ones,
+                              uint64_t const unknown)
+{
+	assert(n_inputs < MAX_INPUTS);
+	input *const in = &inputs[n_inputs++];
+	in->ones    = ones;
+	in->unknown = unknown;
+	if (unknown == 0) {
+		in->node = new_Const(new_tarval_from_word(ones, mode));
+		return in;
+	}
+
+	assert(n_args < MAX_ARGS);
+	set_method_param_type(method_type, n_args, get_type_for_mode(mode));
+	ir_node *const arg  = new_Proj(get_irg_args(current_ir_graph), mode, n_args++);
+	ir_node *const bits = new_And(arg, new_Const(new_tarval_from_word(unknown, mode)));
+	in->node = ones != 0 ? new_Or(bits, new_Const(new_tarval_from_word(ones, mode))) : bits;
+	return in;
+}
+
+static void add_case(ir_node *const node, input const *const left,
+                     input const *const right)
+{
+	keep_alive(node);
+	test_case const c = { node, left, right != left ? right : NULL };
+	ARR_APP1(test_case, cases, c);
+}
+
+static ir_tarval *eval(ir_node const *const node)
+{
+	ir_tarval *const value = (ir_tarval*)get_irn_link(node);
+	if (value != NULL)
+		return value;
+
+	switch (get_irn_opcode(node)) {
+	case iro_Const: return get_Const_tarval(node);
+	case iro_Add:   return tarval_add(eval(get_Add_left(node)), eval(get_Add_right(node)));
+	case iro_Sub:   return tarval_sub(eval(get_Sub_left(node)), eval(get_Sub_right(node)));
+	case iro_Mul:   return tarval_mul(eval(get_Mul_left(node)), eval(get_Mul_right(node)));
+	case iro_And:   return tarval_and(eval(get_And_left(node)), eval(get_And_right(node)));
+	case iro_Or:    return tarval_or(eval(get_Or_left(node)), eval(get_Or_right(node)));
+	case iro_Eor:   return tarval_eor(eval(get_Eor_left(node)), eval(get_Eor_right(node)));
+	case iro_Shl:   return tarval_shl(eval(get_Shl_left(node)), eval(get_Shl_right(node)));
+	case iro_Shr:   return tarval_shr(eval(get_Shr_left(node)), eval(get_Shr_right(node)));
+	case iro_Shrs:  return tarval_shrs(eval(get_Shrs_left(node)), eval(get_Shrs_right(node)));
+	case iro_Minus: return tarval_neg(eval(get_Minus_op(node)));
+	case iro_Not:   return tarval_not(eval(get_Not_op(node)));
+	case iro_Conv:  return tarval_convert_to(eval(get_Conv_op(node)), get_irn_mode(node));
+	case iro_Cmp: {
+		ir_relation const relation = tarval_cmp(eval(get_Cmp_left(node)), eval(get_Cmp_right(node)));
+		return relation & get_Cmp_relation(node) ? tarval_b_true : tarval_b_false;
+	}
+	case iro_Mux:
+		return eval(get_Mux_sel(node)) == tarval_b_true
+		     ? eval(get_Mux_true(node)) : eval(get_Mux_false(node));
+	default:
+		panic("unexpected node %+F", node);
+	}
+}
+
+static void fail(test_case const *const c, char const *const what,
+                 ir_tarval const *const value)
+{
+	ir_fprintf(stderr, "%+F (%+F", c->node, c->left->node);
+	if (c->right != NULL)
+		ir_fprintf(stderr, ", %+F", c->right->node);
+	bitinfo const *const b = get_bitinfo(c->node);
+	ir_fprintf(stderr, "): %s does not match value %T (z %T, o %T)\n", what, value, b->z, b->o);
+	result = 1;
+}
+
+static void check_value(test_case const *const c, ir_tarval *const value)
+{
+	uint64_t       const w = get_tarval_word(value);
+	bitinfo const *const b = get_bitinfo(c->node);
+	if ((w & ~b->z_word) != 0 || (b->o_word & ~w) != 0)
+		fail(c, "constbits", value);
+	/* Ordered compares of negative values are not evaluated. */
+	bool const is_constant = c->left->unknown == 0
+	                      && (c->right == NULL || c->right->unknown == 0)
+	                      && !is_Cmp(c->node) && !is_Mux(c->node);
+	if (is_constant && (b->z_word != w || b->o_word != w))
+		fail(c, "constbits of constant", value);
+
+	if (!mode_is_int(get_irn_mode(c->node)))
+		return;
+	vrp_attr const *const vrp = vrp_get_info(c->node);
+	if (vrp == NULL)
+		return;
+	if ((w & ~get_tarval_word(vrp->bits_not_set)) != 0
+	 || (get_tarval_word(vrp->bits_set) & ~w) != 0)
+		fail(c, "vrp bits", value);
+	if (vrp->range_type == VRP_RANGE) {
+		if (tarval_cmp(value, vrp->range_bottom) == ir_relation_less
+		 || tarval_cmp(value, vrp->range_top) == ir_relation_greater)
+			fail(c, "vrp range", value);
+	} else if (vrp->range_type == VRP_ANTIRANGE) {
+		if (tarval_cmp(value, vrp->range_bottom) == ir_relation_greater
+		 && tarval_cmp(value, vrp->range_top) == ir_relation_less)
+			fail(c, "vrp antirange", value);
+	}
+}
+
+/** Returns the next subset of @p set after @p subset, 0 after the last one. */
+static uint64_t next_subset(uint64_t const subset, uint64_t const set)
+{
+	return (subset - set) & set;
+}
+
+static void check_case(test_case const *const c)
+{
+	input const *const l          = c->left;
+	input const *const r          = c->right;
+	ir_mode     *const l_mode     = get_irn_mode(l->node);
+	uint64_t     const r_unknown  = r != NULL ? r->unknown : 0;
+	uint64_t           l_subset   = 0;
+	do {
+		set_irn_link(l->node, new_tarval_from_word(l->ones | l_subset, l_mode));
+		uint64_t r_subset = 0;
+		do {
+			if (r != NULL)
+				set_irn_link(r->node, new_tarval_from_word(r->ones | r_subset, get_irn_mode(r->node)));
+			check_value(c, eval(c->node));
+			r_subset = next_subset(r_subset, r_unknown);
+		} while (r_subset != 0);
+		if (r != NULL)
+			set_irn_link(r->node, NULL);
+		l_subset = next_subset(l_subset, l->unknown);
+	} while (l_subset != 0);
+	set_irn_link(l->node, NULL);
+}
+
+static void build_cases(ir_mode *const mode, ir_mode *const *const modes,
+                        size_t const n_modes)
+{
+	unsigned const bits = get_mode_size_bits(mode);
+	uint64_t const mask = word_mask(bits);
+	uint64_t const sign = (uint64_t)1 << (bits - 1);
+
+	unsigned const first = n_inputs;
+	/* constants */
+	new_input(mode, 0, 0);
+	new_input(mode, 1, 0);
+	new_input(mode, mask, 0);
+	new_input(mode, sign, 0);
+	new_input(mode, mask >> 1, 0);
+	new_input(mode, UINT64_C(0x5555555555555555) & mask, 0);
+	/* unknown bits at the sign and at the bottom */
+	new_input(mode, 0, sign);
+	new_input(mode, (mask >> 1) & ~(uint64_t)1, sign | 1);
+	new_input(mode, 0, 7);
+	new_input(mode, sign >> 1, sign | sign >> 2);
+	new_input(mode, mask & ~(uint64_t)3, 3);
+	unsigned const last = n_inputs;
+
+	/* shift amounts around the mode size */
+	unsigned const first_amount = n_inputs;
+	new_input(mode_Iu, 0, 0);
+	new_input(mode_Iu, 1, 0);
+	new_input(mode_Iu, bits - 1, 0);
+	new_input(mode_Iu, bits, 0);
+	new_input(mode_Iu, bits + 1, 0);
+	new_input(mode_Iu, 0, 7);
+	new_input(mode_Iu, (bits - 1) & ~(uint64_t)3, 3);
+	new_input(mode_Iu, bits & ~(uint64_t)3, 3);
+	new_input(mode_Iu, 0, bits);
+	unsigned const last_amount = n_inputs;
+
+	for (unsigned i = first; i < last; ++i) {
+		input const *const l = &inputs[i];
+		for (unsigned j = first; j < last; ++j) {
+			input const *const r = &inputs[j];
+			add_case(new_Add(l->node, r->node), l, r);
+			add_case(new_Sub(l->node, r->node), l, r);
+			add_case(new_Mul(l->node, r->node), l, r);
+			add_case(new_And(l->node, r->node), l, r);
+			add_case(new_Or(l->node, r->node), l, r);
+			add_case(new_Eor(l->node, r->node), l, r);
+			add_case(new_Cmp(l->node, r->node, ir_relation_less), l, r);
+			add_case(new_Cmp(l->node, r->node, ir_relation_greater_equal), l, r);
+			add_case(new_Cmp(l->node, r->node, ir_relation_equal), l, r);
+			add_case(new_Cmp(l->node, r->node, ir_relation_less_greater), l, r);
+			ir_node *const sel = new_Cmp(l->node, r->node, ir_relation_less);
+			add_case(new_Mux(sel, l->node, r->node), l, r);
+		}
+
+		add_case(new_Minus(l->node), l, NULL);
+		add_case(new_Not(l->node), l, NULL);
+		for (size_t m = 0; m < n_modes; ++m) {
+			if (modes[m] != mode)
+				add_case(new_Conv(l->node, modes[m]), l, NULL);
+		}
+
+		for (unsigned j = first_amount; j < last_amount; ++j) {
+			input const *const r = &inputs[j];
+			add_case(new_Shl(l->node, r->node), l, r);
+			add_case(new_Shr(l->node, r->node), l, r);
+			add_case(new_Shrs(l->node, r->node), l, r);
+		}
+	}
+}
+
+int main(void)
+{
+	ir_init();
+	set_optimize(0);
+
+	ir_mode *const modes[] = {
+		mode_Bu, mode_Bs, mode_Hu, mode_Hs, mode_Iu, mode_Is, mode_Lu, mode_Ls,
+	};
+
+	method_type = new_type_method(MAX_ARGS, 0, false, cc_cdecl_set, mtp_no_property);
+	for (size_t i = 0; i < MAX_ARGS; ++i)
+		set_method_param_type(method_type, i, get_type_for_mode(mode_Iu));
+	ir_entity *const entity = new_entity(get_glob_type(), new_id_from_str("f"), method_type);
+	ir_graph  *const irg    = new_ir_graph(entity, 0);
+	set_current_ir_graph(irg);
+
+	cases = NEW_ARR_F(test_case, 0);
+	for (size_t i = 0; i < ARRAY_SIZE(modes); ++i)
+		build_cases(modes[i], modes, ARRAY_SIZE(modes));
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+
+	constbits_analyze(irg);
+	set_vrp_data(irg);
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+	irg_walk_graph(irg, firm_clear_link, NULL, NULL);
+	for (size_t i = 0, n = ARR_LEN(cases); i < n; ++i)
+		check_case(&cases[i]);
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+
+	free_vrp_data(irg);
+	constbits_clear(irg);
+	DEL_ARR_F(cases);
+
+	ir_finish();
+	return result;
+}